@@ -0,0 +1,146 @@
+/**
+ * \file ControllerExecutor.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A pool of threads shared by controllers which don't have their own.
+ */
+
+#ifndef IRIS_CONTROLLEREXECUTOR_H_
+#define IRIS_CONTROLLEREXECUTOR_H_
+
+#include <deque>
+#include <boost/bind.hpp>
+#include <boost/utility.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "irisapi/Controller.h"
+
+namespace iris
+{
+
+/** A ControllerExecutor runs controllers as tasks on a pool of threads.
+ *
+ *  Controllers schedule themselves when events are waiting (see
+ *  Controller::runEvents()). A controller is scheduled at most once at a
+ *  time, so each controller is only ever run by one thread and processes
+ *  its events in order. Controllers are run in the order they were
+ *  scheduled.
+ */
+class ControllerExecutor
+  : boost::noncopyable
+{
+public:
+  /** Create a ControllerExecutor and start its threads
+  *
+  *   \param  numThreads  Number of threads (at least 1)
+  */
+  explicit ControllerExecutor(unsigned numThreads)
+    :stopping_(false)
+  {
+    if(numThreads == 0)
+      numThreads = 1;
+    for(unsigned i = 0; i < numThreads; ++i)
+      workers_.create_thread(boost::bind(&ControllerExecutor::work, this));
+  }
+
+  /// Run the controllers which are still scheduled, then stop the threads
+  ~ControllerExecutor()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stopping_ = true;
+    lock.unlock();
+    readyVariable_.notify_all();
+    workers_.join_all();
+  }
+
+  /// Get the number of threads
+  std::size_t size() const { return workers_.size(); }
+
+  /// Run a controller on one of the threads
+  void schedule(Controller* cont)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    ready_.push_back(cont);
+    lock.unlock();
+    readyVariable_.notify_one();
+  }
+
+  /** Set the number of threads used for controllers
+  *
+  *   \param  numThreads  Number of threads shared by all controllers
+  *                       (0 to give each controller its own thread)
+  */
+  static void setDefaultThreads(unsigned numThreads)
+  {
+    defaultThreads() = numThreads;
+  }
+
+  /// Get the number of threads used for controllers (0 if each has its own thread)
+  static unsigned getDefaultThreads()
+  {
+    return defaultThreads();
+  }
+
+private:
+  /// Run controllers until we are stopped
+  void work()
+  {
+    while(true)
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(ready_.empty() && !stopping_)
+        readyVariable_.wait(lock);
+      if(ready_.empty())
+        return;
+      Controller* cont = ready_.front();
+      ready_.pop_front();
+      lock.unlock();
+
+      cont->runEvents();
+    }
+  }
+
+  static unsigned& defaultThreads()
+  {
+    static unsigned threads = 0;
+    return threads;
+  }
+
+  std::deque< Controller* > ready_;   ///< Controllers waiting to run.
+  bool stopping_;
+  boost::mutex mutex_;                ///< Guards ready_ and stopping_.
+  boost::condition_variable readyVariable_;
+  boost::thread_group workers_;
+};
+
+} // namespace iris
+
+#endif // IRIS_CONTROLLEREXECUTOR_H_
@@ -34,13 +34,19 @@
 #ifndef IRIS_CONTROLLERMANAGER_H_
 #define IRIS_CONTROLLERMANAGER_H_
 
+#include <map>
 #include <vector>
 #include <string>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
 #include "boost/filesystem.hpp"
 
-#include "iris/SharedLibrary.h"
+#include "iris/ControllerExecutor.h"
+#include "iris/LibraryCache.h"
+#include "iris/RepositoryIndex.h"
 #include "iris/ControllerManagerCallbackInterface.h"
 #include "iris/RadioRepresentation.h"
 #include "irisapi/Event.h"
@@ -63,7 +69,7 @@ struct ControllerLibrary
 {
   boost::filesystem::path path;
   std::string name;
-  boost::shared_ptr< SharedLibrary > libPtr;
+  boost::shared_ptr< CachedLibrary > libPtr;
 
   /// Constructor initializes our variables
   ControllerLibrary()
@@ -80,13 +86,6 @@ struct LoadedController
     :name(name), contPtr(contPtr){}
 };
 
-/// A repository containing a number of controller libraries
-struct ControllerRepository
-{
-  boost::filesystem::path path;
-  std::vector< ControllerLibrary > controllerLibs;
-};
-
 
 /// The ControllerManager manages all controllers running within the IRIS architecture.
 class ControllerManager
@@ -142,6 +141,14 @@ public:
    */
   void activateEvent(Event &e);
 
+  /** Register an event so that components can activate it by id.
+   *
+   * @param eventName       The event name.
+   * @param componentName   The name of the component which activates the event.
+   * @return The id to pass in Event::eventId.
+   */
+  int resolveEvent(std::string eventName, std::string componentName);
+
   /** Reconfigure the radio
    *
    * @param reconfigs   A set of reconfigurations.
@@ -162,30 +169,76 @@ public:
    */
   std::string getParameterValue(std::string paramName, std::string componentName);
 
+  /** Resolve a parameter for fast reconfiguration (Called by controllers)
+   *
+   * @param paramName       The name of the parameter.
+   * @param componentName   The name of the component.
+   */
+  ParameterHandle resolveParameter(std::string paramName, std::string componentName);
+
+  /** Reconfigure a resolved parameter (Called by controllers)
+   *
+   * @param reconfig  The typed reconfiguration.
+   */
+  void reconfigureParameter(const TypedParametricReconfig& reconfig);
+
   /** Subscribe to an event (Called by controllers)
    *
    * @param eventName       The event name.
    * @param componentName   The name of the component triggering the event.
    * @param cont            A pointer to the subscribing controller.
+   * @param policy          How the events are passed to the controller.
    */
-  virtual void subscribeToEvent(std::string eventName, std::string componentName, Controller* cont);
+  virtual void subscribeToEvent(std::string eventName, std::string componentName, Controller* cont,
+      const EventPolicy& policy);
+
+  /** Run a controller on the shared executor (Called by controllers)
+   *
+   * @param cont            A pointer to the controller.
+   */
+  virtual void scheduleController(Controller* cont);
 
   /// Utility function used for logging
   std::string getName(){return "ControllerManager";}
 
 private:
-  std::vector< ControllerLibrary > loadedLibraries_;
+  typedef boost::unordered_map< std::string, ControllerLibrary > LibraryMap;
+
+  LibraryMap loadedLibraries_;                        ///< Loaded libraries, keyed by controller type
   std::vector< LoadedController > loadedControllers_; ///< Our loaded controllers
-  std::vector<ControllerRepository> repositories_;    ///< Our repositories
+  std::vector< boost::shared_ptr<RepositoryIndex> > repositories_; ///< Our indexed repositories
   ControllerManagerCallbackInterface* engineManager_; ///< The EngineManager which owns this
-
-  /** Map of events to subscribed controllers
+  boost::scoped_ptr< ControllerExecutor > executor_;  ///< Runs controllers without their own thread, if enabled
+  TimerWheel timerWheel_;                             ///< Timer service shared by all controllers
+
+  /// A controller subscribed to an event
+  struct Subscriber
+  {
+    Controller* controller;
+    boost::shared_ptr<EventChannel> channel;  ///< Enforces the delivery policy - empty for the default policy
+  };
+  typedef std::vector<Subscriber> ControllerList;
+
+  /// A registered event and the controllers subscribed to it
+  struct EventSubscription
+  {
+    EventSource source;
+    boost::shared_ptr<const ControllerList> controllers;  ///< Replaced as a whole when changed
+  };
+  typedef std::vector< boost::shared_ptr<EventSubscription> > SubscriptionTable;
+
+  /// Register an event - subscriptionMutex_ must be held
+  int registerEvent(const std::string& eventName, const std::string& componentName);
+
+  /** Registered events, indexed by id.
   *
-  *  The keys for the map are formed by concatenating the component name with the event name.
-  *  Each key is associated with a vector of Controller* - these are the controllers that have
-  *  subscribed to that event.
+  *  Events are activated from component threads without locking - the table
+  *  and the controller lists are copied when they change and swapped in
+  *  atomically. Events are never unregistered, so their ids stay valid.
   */
-  std::map< std::string, std::vector<Controller*> >eventMap_;
+  boost::shared_ptr<const SubscriptionTable> subscriptions_;
+  std::map< std::pair<std::string, std::string>, int > eventIds_;  ///< Id of each event, by event and component name
+  boost::mutex subscriptionMutex_;                                  ///< Guards changes to subscriptions_
 
 };
 
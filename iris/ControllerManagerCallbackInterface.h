@@ -56,6 +56,10 @@ public:
   virtual void postCommand(Command command) = 0;
 
   virtual std::string getParameterValue(std::string paramName, std::string componentName) = 0;
+
+  virtual ParameterHandle resolveParameter(std::string paramName, std::string componentName) = 0;
+
+  virtual void reconfigureParameter(const TypedParametricReconfig& reconfig) = 0;
 };
 
 } // namespace iris
@@ -115,6 +115,22 @@ public:
     return is_not_empty();
   }
 
+  /** Get the timestamp of the next DataSet to read, without reading it.
+  *
+  *   \param timeStamp  Set to the timestamp if there is data.
+  *   \param wait       Block until there is data?
+  */
+  bool getNextTimeStamp(double& timeStamp, bool wait)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if(wait)
+      notEmptyCond_.wait(lock, boost::bind(&DataBuffer<T>::is_not_empty, this));
+    else if(!is_not_empty())
+      return false;
+    timeStamp = buffer_[readIndex_].timeStamp;
+    return true;
+  }
+
   /** Get the next DataSet to read.
   *
   *   \param setPtr   A DataSet pointer which will be set by the buffer.
@@ -141,6 +157,7 @@ public:
       throw DataBufferReleaseException("getWriteData() called before previous DataSet was released");
     notFullCond_.wait(lock, boost::bind(&DataBuffer<T>::is_not_full, this));
     isWriteLocked_ = true;
+    buffer_[writeIndex_].segments.clear();
     if(buffer_[writeIndex_].data.size() != size)
       buffer_[writeIndex_].data.resize(size);
     buffer_[writeIndex_].timeStamp = 0;
@@ -34,6 +34,7 @@
 #ifndef IRIS_ENGINECALLBACKINTERFACE_H_
 #define IRIS_ENGINECALLBACKINTERFACE_H_
 
+#include <string>
 #include "irisapi/Event.h"
 
 namespace iris
@@ -47,6 +48,12 @@ class EngineCallbackInterface{
 public:
   virtual ~EngineCallbackInterface(){};
   virtual void activateEvent(Event &e) = 0;
+
+  /// Register an event - returns the id to pass in Event::eventId or -1 if ids are not used
+  virtual int resolveEvent(std::string eventName, std::string componentName){ return -1; }
+
+  /// Tell the owner that components were replaced - called by the engine thread, so must not block
+  virtual void componentsReplaced(std::string engineName){}
 };
 
 } // namespace iris
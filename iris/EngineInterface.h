@@ -35,29 +35,66 @@
 #define IRIS_ENGINEINTERFACE_H_
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "iris/RadioRepresentation.h"
 #include "iris/EngineCallbackInterface.h"
 #include "irisapi/ReconfigurationDescriptions.h"
 #include "irisapi/Command.h"
 #include "irisapi/DataBufferInterfaces.h"
+#include "irisapi/ModuleParameters.h"
 
 namespace iris
 {
 
+/// Published parameters keyed by (component name, parameter name)
+typedef boost::unordered_map< std::pair<std::string, std::string>,
+                              PublishedParameter > PublishedParameterMap;
+
 /// The EngineInterface interface is implemented by all engines within the IRIS framework
 class EngineInterface{
 public:
   virtual ~EngineInterface(){};
   virtual void setEngineManager(EngineCallbackInterface *e) =0;
-  virtual std::vector< boost::shared_ptr< DataBufferBase > > loadEngine(EngineDescription eng, std::vector< boost::shared_ptr< DataBufferBase > > inputLinks) = 0;
+  virtual std::vector< boost::shared_ptr< DataBufferBase > > loadEngine(const EngineDescription& eng, std::vector< boost::shared_ptr< DataBufferBase > > inputLinks) = 0;
   virtual void unloadEngine() = 0;
   virtual void startEngine() = 0;
   virtual void stopEngine() = 0;
   virtual std::string getName() const = 0;
-  virtual void addReconfiguration(ReconfigSet reconfigs) = 0;
+
+  /** Add a set of reconfigurations for this engine
+   *
+   *   Reconfigurations which the engine cannot carry out are removed from
+   *   the set, so the caller can apply what remains to its representation.
+   *
+   *   \return Whether the whole set was accepted
+   */
+  virtual bool addReconfiguration(ReconfigSet& reconfigs) = 0;
+
   virtual void postCommand(Command command) = 0;
 
+  /** Resolve a component parameter for use with addReconfiguration(const TypedParametricReconfig&)
+   *
+   *   Fills in everything except handle.engineIndex.
+   *
+   *   \return Whether this engine has the component and parameter
+   */
+  virtual bool resolveParameter(std::string paramName, std::string componentName,
+                                ParameterHandle& handle) = 0;
+
+  /// Queue a typed parametric reconfiguration for a parameter resolved by this engine
+  virtual void addReconfiguration(const TypedParametricReconfig& reconfig) = 0;
+
+  /** Add the published parameters of all components in this engine to a map
+   *
+   *   The PublishedParameters can be read from any thread without stalling
+   *   the engine. Called when the radio is loaded and after the engine has
+   *   reported replaced components through EngineCallbackInterface.
+   *
+   *   \param params  The map to add to
+   */
+  virtual void getPublishedParameters(PublishedParameterMap& params) = 0;
+
 };
 
 } // namespace iris
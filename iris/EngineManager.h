@@ -36,6 +36,8 @@
 
 #include <boost/graph/topological_sort.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>   //Autodeleting, Exception-safe container of pointers
 #include "boost/filesystem.hpp"
 
@@ -71,12 +73,27 @@ private:
   /// The current radio representation - gets updated with any reconfigurations which occur.
   RadioRepresentation radioRep_;
 
+  /// Published parameters of all running components - replaced as a whole, never modified
+  boost::shared_ptr<const PublishedParameterMap> published_;
+  boost::atomic<bool> publishedStale_;    ///< Have components been replaced since published_ was built?
+  mutable boost::mutex publishedMutex_;   ///< Only guards swapping of published_
+
+  /// Rebuild published_ from the engines
+  void updatePublishedParameters();
+
   /** Create an engine
    *
    *   \param  d    Description of the engine to be created.
    *   \returns     Pointer to the created engine.
    */
-  EngineInterface* createEngine(EngineDescription& d);
+  EngineInterface* createEngine(const EngineDescription& d);
+
+  /** Load an engine whose input engines have been loaded
+   *
+   *   \param  engine   Index of the engine in the engine graph.
+   *   \param  outputs  Set to the output buffers of the engine.
+   */
+  void loadEngine(unsigned engine, std::vector< boost::shared_ptr< DataBufferBase > >& outputs);
 
   /** Check whether two links are equivalent
   *
@@ -88,9 +105,13 @@ private:
 
 public:
   EngineManager();
+
+  std::string getName() const
+  {   return "EngineManager"; };
+
   void setRepositories(Repositories reps){reps_ = reps;}
   Repositories getRepositories() const {return reps_;}
-  void loadRadio(RadioRepresentation rad);
+  void loadRadio(const RadioRepresentation& rad);
   void startRadio();
   void stopRadio();
   void unloadRadio();
@@ -98,7 +119,22 @@ public:
   void reconfigureRadio(ReconfigSet reconfigs);
   void postCommand(Command command);
   std::string getParameterValue(std::string paramName, std::string componentName);
+
+  /** Resolve a component parameter for reconfigureParameter()
+   *
+   *   \throw ParameterNotFoundException if no engine has the component and parameter
+   */
+  ParameterHandle resolveParameter(std::string paramName, std::string componentName);
+
+  /** Reconfigure a resolved parameter
+   *
+   *   Unlike reconfigureRadio(), this does not update the RadioRepresentation -
+   *   the new value can be read back with getParameterValue().
+   */
+  void reconfigureParameter(const TypedParametricReconfig& reconfig);
   void activateEvent(Event &e);
+  int resolveEvent(std::string eventName, std::string componentName);
+  void componentsReplaced(std::string engineName);
 };
 
 } // namespace iris
@@ -63,6 +63,24 @@ IRIS_DLL bool IRISSetContRepository(std::string rep);
 /// Set the log level
 IRIS_DLL bool IRISSetLogLevel(std::string level);
 
+/// Set the log level of a single component, engine or controller
+IRIS_DLL bool IRISSetLogLevel(std::string name, std::string level);
+
+/// Set the directory for cached radio configurations
+IRIS_DLL bool IRISSetCacheDirectory(std::string dir);
+
+/// Set the xml parser (dom or streaming)
+IRIS_DLL bool IRISSetXmlParser(std::string parser);
+
+/// Set the number of threads used to load radios (0 for one per processor)
+IRIS_DLL bool IRISSetLoadThreads(unsigned threads);
+
+/// Set the number of threads shared by controllers (0 for one thread per controller)
+IRIS_DLL bool IRISSetControllerThreads(unsigned threads);
+
+/// Allow components to be initialized concurrently while loading radios
+IRIS_DLL bool IRISSetParallelInit(bool parallel);
+
 /** Load the radio
 *
 *   \param  radioConfig   The radio configuration to load.
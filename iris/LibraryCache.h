@@ -0,0 +1,122 @@
+/**
+ * \file LibraryCache.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * The LibraryCache keeps component and controller libraries open between
+ * radio loads.
+ */
+
+#ifndef IRIS_LIBRARYCACHE_H_
+#define IRIS_LIBRARYCACHE_H_
+
+#include <ctime>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility.hpp>
+
+#include "iris/SharedLibrary.h"
+
+namespace iris
+{
+
+/** An open library which remembers the symbols resolved from it.
+ *
+ *  CachedLibraries are created by the LibraryCache and shared by everyone
+ *  using the library. The library is closed when the last reference is
+ *  released.
+ */
+class CachedLibrary : boost::noncopyable
+{
+public:
+  /** Get the address of a symbol, resolving it on first use
+  *
+  *   \param  symbolName  Name of the symbol
+  *   \throw  LibrarySymbolException if the symbol does not exist
+  */
+  SharedLibrary::SymbolPointer getSymbol(const std::string& symbolName);
+
+  /// Get the path of the library file
+  boost::filesystem::path getFilename() const { return library_.getFilename(); }
+
+  /// Get the SharedLibrary::LoadFlags the library was opened with
+  int getFlags() const { return flags_; }
+
+private:
+  friend class LibraryCache;
+  typedef boost::unordered_map< std::string, SharedLibrary::SymbolPointer > SymbolMap;
+
+  CachedLibrary(const boost::filesystem::path& filename, int flags, std::time_t writeTime);
+
+  SharedLibrary library_;
+  int flags_;               ///< SharedLibrary::LoadFlags used to open the library
+  std::time_t writeTime_;   ///< Modification time of the file when it was opened
+  SymbolMap symbols_;       ///< Symbols resolved so far
+  boost::mutex mutex_;
+};
+
+/** The LibraryCache keeps libraries open for the lifetime of the process.
+ *
+ *  Engines and the ControllerManager are destroyed when a radio is unloaded.
+ *  Getting their libraries from the cache means the next load finds them
+ *  already open and resolved. A library is opened again if its file has
+ *  been modified since it was cached.
+ */
+class LibraryCache
+{
+public:
+  /** Get a library, opening it if it is not in the cache
+  *
+  *   Libraries are cached by path and flags, so asking for a library with
+  *   other flags than a cached copy opens it again with those flags.
+  *
+  *   \param  filename  Path to the library file
+  *   \param  flags     SharedLibrary::LoadFlags used to open the library
+  *   \throw  FileNotFoundException or LibraryLoadException if the library cannot be opened
+  */
+  static boost::shared_ptr<CachedLibrary> get(const boost::filesystem::path& filename,
+                                              int flags = SharedLibrary::LOAD_DEFAULT);
+
+  /** Close all libraries which are only held by the cache
+  *
+  *   Make sure no objects created from these libraries are still in use.
+  */
+  static void releaseUnused();
+
+  /// Get the number of libraries in the cache
+  static std::size_t size();
+
+  static std::string getName() { return "LibraryCache"; }
+};
+
+} // namespace iris
+
+#endif // IRIS_LIBRARYCACHE_H_
@@ -35,9 +35,12 @@
 #define IRIS_PHYENGINE_H_
 
 #include <deque>
+#include <map>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
 #include "boost/filesystem.hpp"
 
 #include "iris/EngineInterface.h"
@@ -46,6 +49,7 @@
 #include "irisapi/ComponentCallbackInterface.h"
 #include "irisapi/ReconfigurationDescriptions.h"
 #include "irisapi/MessageQueue.h"
+#include "irisapi/PendingReconfigurations.h"
 #include "irisapi/Logging.h"
 
 namespace iris
@@ -53,16 +57,23 @@ namespace iris
 //Forward declarations to avoid inter-element dependencies
 class PhyComponent;
 class PhyComponentManager;
+class PhyDataBufferBase;
 
 /** The PhyEngine class implements a process network engine for the IRIS framework.
 *
 *  Each PhyEngine runs its own thread of execution and serves one or more PhyComponents.
+*
+*  A running PhyEngine can replace a component with one of another type which
+*  uses the same links. The new component is loaded, set up and given the
+*  buffers of the old one when the reconfiguration is added. The engine
+*  thread only switches the two components between blocks and a separate
+*  reaper thread destroys the old one.
 */
 class PhyEngine:public EngineInterface, public ComponentCallbackInterface
 {
 public:
   PhyEngine(std::string name, std::string repository);
-  ~PhyEngine();
+  virtual ~PhyEngine();
 
   void setEngineManager(EngineCallbackInterface *e);
 
@@ -73,63 +84,161 @@ public:
   *   \return             The output DataBuffers for this engine
   */
   std::vector< boost::shared_ptr< DataBufferBase > >
-  loadEngine(EngineDescription eng,
+  loadEngine(const EngineDescription& eng,
              std::vector< boost::shared_ptr< DataBufferBase > > inputLinks);
 
   void unloadEngine();
   void startEngine();
   void stopEngine();
   std::string getName() const;
-  void addReconfiguration(ReconfigSet reconfigs);
+
+  /// Get the reporting level of this engine - checked by LOG.
+  LogLevel getReportingLevel() const { return logLevel_.get(engineName_); }
+
+  bool addReconfiguration(ReconfigSet& reconfigs);
+  void addReconfiguration(const TypedParametricReconfig& reconfig);
+  bool resolveParameter(std::string paramName, std::string componentName,
+                        ParameterHandle& handle);
   void postCommand(Command command);
+  void getPublishedParameters(PublishedParameterMap& params);
   void activateEvent(Event &e);
+  int resolveEvent(std::string eventName, std::string componentName);
 
-private:
-  /// The component manager for this engine
-  boost::scoped_ptr< PhyComponentManager > compManager_;
-
-  /// Handle for this engine's thread of execution
-  boost::scoped_ptr< boost::thread > thread_;
+  /** Choose whether components may be initialized concurrently
+  *
+  *   By default initialize() is called for one component at a time across
+  *   all engines, as libraries such as FFTW must not be set up from several
+  *   threads at once. Libraries are loaded concurrently either way.
+  */
+  static void setParallelInitialize(bool parallel);
 
+protected:
   /// The graph representing the components within the engine and the links between them
   RadioGraph engineGraph_;
 
   /// The PhyComponents running within this engine
   std::vector< boost::shared_ptr<PhyComponent> > components_;
 
+  /// Name of this engine
+  std::string engineName_;
+
+  /// Our level in the LoggingPolicy - also inherited by our components
+  LogLevelCache logLevel_;
+
+  /// The internal loop which this engine's thread executes
+  virtual void threadLoop();
+
+  /// Destroy replaced components as the engine thread retires them
+  void reaperLoop();
+
+  /** Called once all components have been loaded, before the links between them are built
+  *
+  *   \param graph   The graph of the engine
+  */
+  virtual void componentsLoaded(RadioGraph& graph) {}
+
+  /** Get the number of DataSets to allocate on an internal link
+  *
+  *   \param link    Description of the link
+  *   \return        Number of DataSets in the PhyDataBuffer for the link
+  */
+  virtual int getBufferLength(const LinkDescription& link) const { return 2; }
+
+  /** Check that a component can take the place of a running one
+  *
+  *   Throws an IrisException if the replacement is not allowed.
+  *
+  *   \param current       The running component
+  *   \param replacement   The component which will replace it
+  */
+  virtual void checkReplacement(const PhyComponent& current, const PhyComponent& replacement) const {}
+
+  /// Carry out any reconfigurations which have been queued for this engine
+  void processReconfigurations();
+
+private:
+  /// The component manager for this engine
+  boost::scoped_ptr< PhyComponentManager > compManager_;
+
+  /// Handle for this engine's thread of execution
+  boost::scoped_ptr< boost::thread > thread_;
+
   /// The DataBuffers for the internal links between components of this engine
   std::vector< boost::shared_ptr< DataBufferBase > > internalBuffers_;
 
+  /// The internal output buffers of each component, indexed by vertex
+  std::vector< std::vector< PhyDataBufferBase* > > componentOutputs_;
+
   /// The DataBuffers for the external links into and out of this engine
   std::vector< boost::shared_ptr< DataBufferBase > > engInputBuffers_;
   std::vector< boost::shared_ptr< DataBufferBase > > engOutputBuffers_;
 
-  /// Name of this engine
-  std::string engineName_;
-
   /// The reconfiguration message queue for this engine
   MessageQueue< ReconfigSet > reconfigQueue_;
+  /// Typed parametric reconfigurations for this engine
+  MessageQueue< TypedParametricReconfig > typedReconfigQueue_;
+  /// ReconfigSets waiting for the data they apply to
+  PendingReconfigurations pendingReconfigs_;
 
   /// The interface to the owner of this engine
   EngineCallbackInterface *engineManager_;
 
+  /// How a component was connected when the engine was built
+  struct ComponentIO
+  {
+    std::map< std::string, int > inputTypes;
+    std::map< std::string, int > outputTypes;
+    std::vector< ReadBufferBase* > inBufs;
+    std::vector< WriteBufferBase* > outBufs;
+  };
+  /// The connections of each component, indexed by vertex
+  std::vector< ComponentIO > componentIO_;
+
+  /// Replacement components which are ready to be switched in, by name
+  std::map< std::string, boost::shared_ptr<PhyComponent> > preparedComponents_;
+  /// Guards prepared components and changes to components_
+  mutable boost::mutex componentsMutex_;
+  /// Replaced components waiting to be destroyed by the reaper thread
+  MessageQueue< boost::shared_ptr<PhyComponent> > retiredComponents_;
+  /// Thread which destroys replaced components away from the engine thread
+  boost::scoped_ptr< boost::thread > reaperThread_;
+  /// Last parameter generation given to a replacement component
+  boost::atomic<unsigned> generations_;
+
 
   /// Helper functions
    boost::shared_ptr< DataBufferBase >  createDataBuffer(int type) const;
-   boost::shared_ptr< DataBufferBase >  createPhyDataBuffer(int type) const;
+   boost::shared_ptr< DataBufferBase >  createPhyDataBuffer(int type, int length,
+                                                            std::size_t capacity, BufferPolicy policy) const;
   bool sameLink(LinkDescription first, LinkDescription second) const;
 
-  /// The internal loop which this engine's thread executes
-  void threadLoop();
+  /// Check whether any internal output buffer of a component is holding it back
+  bool outputsFull(unsigned component) const;
   /// Check that a given graph complies with the policies of this engine
   void checkGraph(RadioGraph& graph);
   /// Build a given graph
   void buildEngineGraph(RadioGraph& graph);
-
+  /// Load a component for this engine - may be called from several threads at once
+  void createComponent(const ComponentDescription& desc, boost::shared_ptr<PhyComponent>& comp);
+  /// Initialize a component, one at a time unless parallel initialization is on
+  static void initializeComponent(PhyComponent& comp);
+  /// The setting of setParallelInitialize()
+  static bool& parallelInitialize();
+
+  /// Get the timestamp of the next data to be processed by this engine
+  bool getDataTime(double& timeStamp);
+  /// Apply all reconfigurations in a set
+  void applyReconfigSet(const ReconfigSet& set);
   /// Reconfigure a parameter within a component running in the engine
   void reconfigureParameter(ParametricReconfig reconfig);
+  /// Reconfigure a parameter using a resolved handle
+  void reconfigureParameter(const TypedParametricReconfig& reconfig);
+  /// Load and set up a component to replace a running one - false if it failed
+  bool prepareComponent(const NewComponent& newComp);
   /// Reconfigure the structure of this engine
-  void reconfigureStructure();
+  void reconfigureStructure(const StructuralReconfig& reconfig);
+  /// Get the index of a named component or -1 if it was not found
+  int findComponentIndex(std::string name) const;
 
 };
 
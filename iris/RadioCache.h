@@ -0,0 +1,102 @@
+/**
+ * \file RadioCache.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * The RadioCache stores parsed radio configurations in a binary form
+ * which can be loaded without parsing xml.
+ */
+
+#ifndef IRIS_RADIOCACHE_H_
+#define IRIS_RADIOCACHE_H_
+
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "iris/RadioRepresentation.h"
+#include "irisapi/Exceptions.h"
+#include "irisapi/Logging.h"
+
+namespace iris
+{
+
+/** The RadioCache stores parsed radio configurations in a compact binary form.
+ *
+ *  A cache file holds the descriptions of the controllers, engines, components
+ *  and links of a radio. It is memory-mapped when loaded and the graphs are
+ *  rebuilt from the descriptions. Each file carries a key computed from the xml
+ *  configuration and the RepositoryIndex of each component repository, so a
+ *  cached radio is only used while neither has changed.
+ */
+class RadioCache
+{
+public:
+  /** Compute the key for a radio configuration
+  *
+  *   \param  xml           The xml configuration
+  *   \param  repositories  The repository strings (paths separated by ';')
+  *   \return The key - changes when the xml changes or a repository directory
+  *           is modified, e.g. by adding, removing or relinking a library
+  */
+  static boost::uint64_t computeKey(const std::string& xml, const std::vector<std::string>& repositories);
+
+  /** Get the cache file used for a radio configuration
+  *
+  *   \param  directory     The cache directory
+  *   \param  radioConfig   The path of the xml configuration
+  */
+  static std::string getCacheFile(std::string directory, std::string radioConfig);
+
+  /** Write a radio to a cache file
+  *
+  *   \param  radio     The radio - its graphs must have been built
+  *   \param  key       The key of the configuration the radio was parsed from
+  *   \param  filename  The cache file to write
+  */
+  static void save(const RadioRepresentation& radio, boost::uint64_t key, std::string filename);
+
+  /** Load a radio from a cache file
+  *
+  *   \param  filename  The cache file to read
+  *   \param  key       The key of the current configuration
+  *   \param  radio     The RadioRepresentation to fill in - only changed on success
+  *   \return False if the file is missing, corrupt or has a different key
+  */
+  static bool load(std::string filename, boost::uint64_t key, RadioRepresentation& radio);
+
+  static std::string getName() { return "RadioCache"; }
+
+private:
+  /// Disable constructor - all functions are static
+  RadioCache() {};
+};
+
+} // namespace iris
+
+#endif // IRIS_RADIOCACHE_H_
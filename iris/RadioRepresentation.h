@@ -38,7 +38,9 @@
 #include <cstdlib>
 #include <string>
 
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/graph/adjacency_list.hpp>
 
 #include "irisapi/Exceptions.h"
@@ -50,6 +52,7 @@ namespace iris
 class DataBufferBase;
 struct ReconfigSet;
 struct ParametricReconfig;
+struct NewComponent;
 struct ParameterDescription;
 
 /// Holds a controller type.
@@ -92,6 +95,11 @@ struct ComponentDescription
   std::string engineName;
   std::vector<ParameterDescription> parameters;
   std::vector<PortDescription> ports;
+  std::size_t fingerprint;  ///< Hash of the contents, set when the graphs are built (0 if unknown)
+
+  ComponentDescription()
+    :fingerprint(0)
+  {}
 
   /// == operator only looks at name, type and engineName
   bool operator==(const ComponentDescription& comp) const
@@ -128,6 +136,11 @@ struct EngineDescription
   RadioGraph engineGraph;
   std::vector<ComponentDescription> components;
   std::vector<LinkDescription> links;
+  std::size_t fingerprint;  ///< Hash of the components and links, set when the graphs are built (0 if unknown)
+
+  EngineDescription()
+    :fingerprint(0)
+  {}
 
   /// == operator only looks at name and type
   bool operator==(const EngineDescription& eng) const
@@ -164,6 +177,10 @@ typedef boost::graph_traits < EngineGraph >::in_edge_iterator   EngInEdgeIterato
  *
  *  A running radio will maintain a RadioRepresentation which describes
  *  itself and will update it as reconfigurations occur.
+ *
+ *  Copies of a RadioRepresentation share their contents. The contents are
+ *  only copied when a representation which shares them is changed, so
+ *  taking a snapshot of a large radio is cheap.
  */
 class RadioRepresentation
 {
@@ -177,9 +194,12 @@ public:
   /// Assignment operator
   RadioRepresentation& operator= (const RadioRepresentation& r);
 
-  /// Copy a RadioRepresentation
+  /// Copy a RadioRepresentation - the contents are shared until either is changed
   void copy(const RadioRepresentation& r);
 
+  /// Does this representation share its contents with another?
+  bool sharesContents(const RadioRepresentation& r) const;
+
   /// Add a ControllerDescription to this RadioRepresentation
   void addControllerDescription(ControllerDescription con);
   /// Add an EngineDescription to this RadioRepresentation
@@ -198,10 +218,25 @@ public:
   /// Have the graphs for this RadioRepresentation been built?
   bool isGraphBuilt() const;
 
-  /// Reconfigure the representation
+  /** Reconfigure the representation
+  *
+  *   Applies parametric reconfigurations and replaced components. Other
+  *   structural reconfigurations are not carried out by running engines and
+  *   are left out of the representation.
+  */
   void reconfigureRepresentation(ReconfigSet reconfigs);
 
-  /// Get the current value of a parameter
+  /** Get the current value of a parameter
+  *
+  *   Lookups use a hashed index of all component parameters. The index is
+  *   an immutable snapshot which is replaced as a whole by buildGraphs() and
+  *   reconfigureRepresentation(), so readers never wait for a rebuild or a
+  *   reconfiguration to finish.
+  *
+  *   \param paramName       Name of the parameter
+  *   \param componentName   Name of the component which owns the parameter
+  *   \return The parameter value or an empty string if it was not found
+  */
   std::string getParameterValue(std::string paramName, std::string componentName);
 
   /// Print the structure of theRadioGraph to a string
@@ -214,6 +249,13 @@ public:
   std::vector<LinkDescription> getLinks() const;
   std::vector<LinkDescription> getExternalLinks() const;
 
+  /** Get the engine descriptions without copying them
+  *
+  *   The descriptions are a snapshot - they stay valid and unchanged while
+  *   the pointer is held, even if the representation is changed.
+  */
+  boost::shared_ptr< const std::vector<EngineDescription> > getEngineDescriptions() const;
+
   RadioGraph getRadioGraph() const;
   EngineGraph getEngineGraph() const;
 
@@ -222,23 +264,61 @@ public:
   /// Find an engine in an EngineGraph
   static bool findEngine(std::string name, const EngineGraph& graph, EngVertex& ver);
 
+  /// Compute the fingerprint of a component from its name, type, parameters and ports
+  static std::size_t fingerprint(const ComponentDescription& comp);
+  /// Compute the fingerprint of an engine from its name, type, components and links
+  static std::size_t fingerprint(const EngineDescription& eng);
+
 private:
-  /// Reconfigure a parameter within the representation
-  void reconfigureParameter(ParametricReconfig reconfig);
+  /// Parameter values keyed by (component name, parameter name)
+  typedef boost::unordered_map< std::pair<std::string, std::string>,
+                                std::string > ParameterIndex;
+
+  /// Everything which describes the radio - shared between copies
+  struct Contents
+  {
+    RadioGraph radioGraph;     ///< Graph of all components and links
+    EngineGraph engineGraph;   ///< Graph of all engines and links
+
+    std::vector<ControllerDescription> controllers;
+    std::vector<LinkDescription> links;
+    std::vector<EngineDescription> engines;
+    std::vector<LinkDescription> externalLinks;   ///< All links between engines
+
+    bool isBuilt; ///< Have the graphs been built?
+
+    Contents()
+      :isBuilt(false)
+    {}
+  };
+
+  /// Reconfigure a parameter within the representation and the given index
+  static void reconfigureParameter(const ParametricReconfig& reconfig, Contents& c, ParameterIndex& index);
+  /// Replace a component within the representation and the given index
+  static void replaceComponent(std::string engineName, const NewComponent& comp, Contents& c, ParameterIndex& index);
+
+  /// Build a new parameter index from a radio graph and publish it
+  void rebuildParameterIndex(const RadioGraph& graph);
+  /// Get the current parameter index snapshot
+  boost::shared_ptr<const ParameterIndex> getParameterIndex() const;
+  /// Replace the current parameter index snapshot
+  void setParameterIndex(boost::shared_ptr<const ParameterIndex> index);
 
   /// Build an engine graph
   void buildEngineDescriptionGraph(EngineDescription& eng) const;
 
-  RadioGraph radioGraph_;     ///< Graph of all components and links
-  EngineGraph engineGraph_;   ///< Graph of all engines and links
+  /// Get the contents for changing, copying them first if they are shared
+  Contents& mutableContents();
+  /// Get the current contents for reading
+  boost::shared_ptr<Contents> getContents() const;
+  /// Update every copy of a component held by an engine
+  static void updateEngineComponent(Contents& c, std::string engineName, const ComponentDescription& comp);
 
-  std::vector<ControllerDescription> controllers_;
-  std::vector<LinkDescription> links_;
-  std::vector<EngineDescription> engines_;
-  std::vector<LinkDescription> externalLinks_;   ///< All links between engines
-
-  bool isBuilt_; ///< Have the graphs been built?
+  boost::shared_ptr<Contents> contents_;   ///< Never changed while shared with another representation
   mutable boost::mutex mutex_;
+
+  boost::shared_ptr<const ParameterIndex> paramIndex_;  ///< Current parameter index snapshot
+  mutable boost::mutex indexMutex_;   ///< Only guards swapping of paramIndex_
 };
 
 /// Output a RadioRepresentation to a stream
@@ -37,6 +37,8 @@
 #include <cstdlib>
 #include <string>
 
+#include <boost/unordered_map.hpp>
+
 #include "iris/RadioRepresentation.h"
 #include "irisapi/ReconfigurationDescriptions.h"
 
@@ -51,6 +53,14 @@ class ReconfigurationManager
 public:
   /** Compare two radio representations and generate a set of reconfigurations
   *
+  *   Components are matched by name within each engine. A component whose
+  *   type changed is reported as a replaced component, and parameters are
+  *   only compared between components of the same type.
+  *
+  *   Engines and components are looked up through hashed name indices.
+  *   Engines and components whose fingerprints match are skipped without
+  *   looking at their contents.
+  *
   *   \param  currentRadio  The currently loaded radio configuration
   *   \param  newRadio      The new radio configuration
   */
@@ -60,9 +70,12 @@ private:
   /// ctor - all static functions so prevent creation of a ReconfigurationManager object
   ReconfigurationManager();
 
-  static void checkParameters(const RadioRepresentation& first, const RadioRepresentation& second, ReconfigSet& reconfigs);
-  static void checkParameters(EngineDescription& first, EngineDescription& second, ReconfigSet& reconfigs);
-  static void checkParameters(ComponentDescription& first, ComponentDescription& second, ReconfigSet& reconfigs);
+  typedef boost::unordered_map< std::string, const EngineDescription* > EngineIndex;
+  typedef boost::unordered_map< std::string, const ComponentDescription* > ComponentIndex;
+
+  static void compareEngines(const EngineDescription& first, const EngineDescription& second, ReconfigSet& reconfigs);
+  static void compareParameters(const ComponentDescription& first, const ComponentDescription& second, ReconfigSet& reconfigs);
+  static NewComponent describeComponent(const ComponentDescription& comp);
 
 };
 
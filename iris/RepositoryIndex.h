@@ -0,0 +1,166 @@
+/**
+ * \file RepositoryIndex.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * The RepositoryIndex maps module types to the libraries in a repository
+ * directory.
+ */
+
+#ifndef IRIS_REPOSITORYINDEX_H_
+#define IRIS_REPOSITORYINDEX_H_
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility.hpp>
+
+#include "iris/SharedLibrary.h"
+#include "irisapi/Exceptions.h"
+
+namespace iris
+{
+
+/// Where the library for a type was found
+struct LibraryLocation
+{
+  boost::filesystem::path path; ///< The library file
+  int loadFlags;                ///< SharedLibrary::LoadFlags of the repository
+  bool bundled;                 ///< Is the type one of several in a component bundle?
+
+  LibraryLocation()
+    :loadFlags(SharedLibrary::LOAD_DEFAULT), bundled(false){}
+};
+
+/** The RepositoryIndex maps module types to the libraries in a repository directory.
+ *
+ *  Types are the lower case library names without the system prefix and
+ *  extension. A component bundle holds several types in one library and is
+ *  listed by a manifest next to the library, named like the library but
+ *  with a ".bundle" extension, which holds one type per line.
+ *
+ *  Indices are shared by all component and controller managers
+ *  and kept for the lifetime of the process, so a directory is only read
+ *  again when its modification time changes. Each combination of directory
+ *  and load flags has its own index, so the flags asked for by one manager
+ *  never change those used by another.
+ */
+class RepositoryIndex : boost::noncopyable
+{
+public:
+  /** Get the index of a repository directory, rescanning it if it has changed
+  *
+  *   \param  path      The repository directory
+  *   \param  loadFlags SharedLibrary::LoadFlags used for libraries in this repository
+  *   \throw  ResourceNotFoundException if the path is not a directory
+  */
+  static boost::shared_ptr<RepositoryIndex> get(std::string path,
+                                                int loadFlags = SharedLibrary::LOAD_DEFAULT);
+
+  /** Get the indices of the directories in a repository string
+  *
+  *   Each directory may be followed by "?" and a comma separated list of
+  *   binding modes for its libraries, e.g. "/path/to/repo?lazy,local".
+  *
+  *   \param  repoPaths   Repository directories separated by ";"
+  */
+  static std::vector< boost::shared_ptr<RepositoryIndex> > getAll(std::string repoPaths);
+
+  /** Find the library for a type in a number of repositories
+  *
+  *   If more than one library matches, the most recently modified one is used.
+  *
+  *   \param  repositories  The repositories to search
+  *   \param  type          The lower case type
+  *   \param  library       Set to the location of the library
+  *   \return False if no repository holds the type
+  */
+  static bool findLibrary(const std::vector< boost::shared_ptr<RepositoryIndex> >& repositories,
+                          const std::string& type, LibraryLocation& library);
+
+  /** Convert binding modes to SharedLibrary::LoadFlags
+  *
+  *   \param  modes   Comma separated list of "now", "lazy", "global", "local" and "deepbind"
+  *   \throw  InvalidDataException if a mode is unknown
+  */
+  static int parseLoadFlags(std::string modes);
+
+  /// Does this repository hold a library for a type?
+  bool contains(const std::string& type) const;
+
+  /// Get the repository directory
+  const boost::filesystem::path& getPath() const { return path_; }
+
+  /// Get the SharedLibrary::LoadFlags used for libraries in this repository
+  int getLoadFlags() const { return loadFlags_; }
+
+  /// Get the number of types in this repository
+  std::size_t size() const;
+
+  /// Get the sorted types in this repository
+  std::vector<std::string> getTypes() const;
+
+  /// Get the modification time of the directory when it was last scanned
+  std::time_t getDirectoryTime() const;
+
+  /// Rescan the directory if its modification time has changed
+  void refresh();
+
+  static std::string getName() { return "RepositoryIndex"; }
+
+private:
+  /// A library in the repository
+  struct Library
+  {
+    boost::filesystem::path path;
+    bool bundled;
+  };
+  typedef boost::unordered_map< std::string, Library > LibraryMap;
+
+  RepositoryIndex(const boost::filesystem::path& path, int loadFlags);
+  bool find(const std::string& type, LibraryLocation& library) const;
+  void scan();
+  static void addLibrary(LibraryMap& libraries, const std::string& type,
+                         const boost::filesystem::path& path, bool bundled);
+  static void readBundle(LibraryMap& libraries, const boost::filesystem::path& manifest);
+
+  boost::filesystem::path path_;
+  std::time_t dirWrite_;      ///< Modification time of the directory when it was scanned
+  std::time_t scanTime_;      ///< When the directory was scanned
+  const int loadFlags_;       ///< SharedLibrary::LoadFlags for libraries in the directory
+  LibraryMap libraries_;      ///< Library for each type
+  mutable boost::mutex mutex_;
+};
+
+} // namespace iris
+
+#endif // IRIS_REPOSITORYINDEX_H_
@@ -0,0 +1,129 @@
+/**
+ * \file SdfEngine.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * The SdfEngine implements a synchronous dataflow engine for the Iris framework.
+ */
+
+#ifndef IRIS_SDFENGINE_H_
+#define IRIS_SDFENGINE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "iris/PhyEngine.h"
+#include "irisapi/ComponentPorts.h"
+
+namespace iris
+{
+
+/// A link between two actors of a synchronous dataflow graph.
+struct SdfEdge
+{
+  unsigned source;        ///< Index of the producing actor.
+  unsigned sink;          ///< Index of the consuming actor.
+  unsigned production;    ///< DataSets produced on this edge per firing of the source.
+  unsigned consumption;   ///< DataSets consumed from this edge per firing of the sink.
+
+  SdfEdge(unsigned src = 0, unsigned snk = 0, unsigned prod = 1, unsigned cons = 1)
+    :source(src), sink(snk), production(prod), consumption(cons)
+  {}
+};
+
+/// A number of consecutive firings of a single actor.
+struct SdfFiring
+{
+  unsigned actor;   ///< Index of the actor.
+  unsigned count;   ///< Number of times to fire it.
+
+  SdfFiring(unsigned a = 0, unsigned c = 1)
+    :actor(a), count(c)
+  {}
+};
+
+/// A static schedule for one iteration of a synchronous dataflow graph.
+struct SdfSchedule
+{
+  std::vector< unsigned > repetitions;  ///< Firings of each actor per iteration.
+  std::vector< unsigned > bufferSizes;  ///< DataSets needed on each edge.
+  std::vector< SdfFiring > firings;     ///< The firing sequence of one iteration.
+};
+
+/** The SdfEngine class implements a synchronous dataflow engine for the IRIS framework.
+*
+*  The SdfEngine runs PhyComponents which declare a fixed number of DataSets
+*  consumed and produced on each port every time they run. When the engine is
+*  loaded, it solves the balance equations of the graph to find how often each
+*  component runs in one iteration and builds a schedule which keeps the
+*  links between components small. Each internal PhyDataBuffer is sized to
+*  exactly the number of DataSets it needs, so it never grows. The engine
+*  thread then runs the fixed firing sequence repeatedly, without checking
+*  buffers for data.
+*/
+class SdfEngine:public PhyEngine
+{
+public:
+  SdfEngine(std::string name, std::string repository);
+  ~SdfEngine();
+
+  /// Get the schedule computed when the engine was loaded
+  SdfSchedule getSchedule() const;
+
+  /** Compute a static schedule for a synchronous dataflow graph
+  *
+  *   \param numActors  Number of actors in the graph
+  *   \param edges      The edges between the actors
+  *   \return           The schedule for one iteration of the graph
+  */
+  static SdfSchedule computeSchedule(unsigned numActors, const std::vector< SdfEdge >& edges);
+
+protected:
+  void threadLoop();
+  void componentsLoaded(RadioGraph& graph);
+  int getBufferLength(const LinkDescription& link) const;
+  void checkReplacement(const PhyComponent& current, const PhyComponent& replacement) const;
+
+private:
+  /// The schedule for one iteration of the engine
+  SdfSchedule schedule_;
+
+  /// The number of DataSets required on each internal link, keyed by source component and port
+  std::map< std::string, int > bufferLengths_;
+
+  /// Get the rate of a named port
+  unsigned getPortRate(const std::vector< Port >& ports, std::string name, std::string component) const;
+  /// Check that a replacement declares the same rate on each port as the component it replaces
+  void checkPortRates(const std::vector< Port >& current, const std::vector< Port >& replacement,
+                      std::string component) const;
+};
+
+} // namespace iris
+
+#endif // IRIS_SDFENGINE_H_
@@ -68,13 +68,26 @@ public:
     typedef void* SymbolPointer;   ///< Type that can hold a pointer to a library symbol
 #endif
 
+  /** Flags controlling how a library is loaded - combine with |.
+   *
+   * Flags which are not supported by a platform are ignored.
+   */
+  enum LoadFlags
+  {
+    LOAD_DEFAULT  = 0,  ///< Resolve all symbols on load and make them globally available
+    LOAD_LAZY     = 1,  ///< Resolve functions on first use
+    LOAD_LOCAL    = 2,  ///< Keep the library's symbols out of the global namespace
+    LOAD_DEEPBIND = 4   ///< Prefer the library's own symbols to global ones
+  };
+
   // ---------- standard usage
 
   /** Constructs a SharedLibrary instance and loads a shared library.
    *
    * \param filename Path to the library file.
+   * \param flags    LoadFlags used to open the library.
    */
-  SharedLibrary(boost::filesystem::path filename);
+  SharedLibrary(boost::filesystem::path filename, int flags = LOAD_DEFAULT);
 
   /** Gets the address of a symbol from the dynamic library.
    *
@@ -102,8 +115,9 @@ public:
    * of parameters.
    *
    * \param filename    The path of the file to open.
+   * \param flags       LoadFlags used to open the library.
    */
-  void open(boost::filesystem::path filename);
+  void open(boost::filesystem::path filename, int flags = LOAD_DEFAULT);
 
   /// Check whether the library has been loaded.
   bool isLoaded() {return library_ == NULL;};
@@ -46,6 +46,7 @@
 #include "irisapi/ComponentCallbackInterface.h"
 #include "irisapi/ReconfigurationDescriptions.h"
 #include "irisapi/MessageQueue.h"
+#include "irisapi/TimerWheel.h"
 #include "irisapi/Logging.h"
 
 namespace iris
@@ -77,15 +78,24 @@ public:
   *   \returns The output DataBuffers for this engine
   */
   std::vector< boost::shared_ptr< DataBufferBase > >
-  loadEngine(EngineDescription eng,
+  loadEngine(const EngineDescription& eng,
              std::vector< boost::shared_ptr< DataBufferBase > > inputLinks);
   void unloadEngine();
   void startEngine();
   void stopEngine();
   std::string getName() const;
-  void addReconfiguration(ReconfigSet reconfigs);
+
+  /// Get the reporting level of this engine - checked by LOG.
+  LogLevel getReportingLevel() const { return logLevel_.get(engineName_); }
+
+  bool addReconfiguration(ReconfigSet& reconfigs);
+  void addReconfiguration(const TypedParametricReconfig& reconfig);
+  bool resolveParameter(std::string paramName, std::string componentName,
+                        ParameterHandle& handle);
   void postCommand(Command command);
+  void getPublishedParameters(PublishedParameterMap& params);
   void activateEvent(Event &e);
+  int resolveEvent(std::string eventName, std::string componentName);
 
 private:
   /// The graph representing the components within the engine and the links between them
@@ -107,24 +117,31 @@ private:
   /// Name of this engine
   std::string engineName_;
 
+  /// Our level in the LoggingPolicy - also inherited by our components
+  LogLevelCache logLevel_;
+
   /// The component manager for this engine
   boost::scoped_ptr< StackComponentManager > compManager_;
 
   /// The interface to the owner of this engine
   EngineCallbackInterface *engineManager_;
 
+  /// Timer service for the components - declared last so it stops before they are destroyed
+  TimerWheel timerWheel_;
+
   // Helper functions
-  void createExternalLink(LinkDescription& l);
+  void createExternalLink(const LinkDescription& l);
   bool sameLink(LinkDescription first, LinkDescription second) const;
   boost::shared_ptr< StackComponent > findComponent(std::string name);
 
   /// Check that a given graph complies with the policies of this engine
   void checkGraph(RadioGraph& graph);
   /// Build a given graph
-  void buildEngineGraph(EngineDescription& eng);
+  void buildEngineGraph(const EngineDescription& eng);
+
+  /// Load a component for this engine - may be called from several threads at once
+  void createComponent(const ComponentDescription& desc, boost::shared_ptr<StackComponent>& comp);
 
-  /// Reconfigure a parameter within a component running in the engine
-  void reconfigureParameter(ParametricReconfig reconfig);
   /// Reconfigure the structure of this engine
   void reconfigureStructure();
 
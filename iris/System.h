@@ -65,9 +65,27 @@ public:
   /// Set the Controller repository
   void setContRepository(std::string rep);
 
+  /// Set the directory for cached radio configurations (empty to disable)
+  void setCacheDirectory(std::string dir);
+
+  /// Set the xml parser (options are dom & streaming)
+  void setXmlParser(std::string parser);
+
+  /// Set the number of threads used to load radios (0 for one per processor)
+  void setLoadThreads(unsigned threads);
+
+  /// Set the number of threads shared by controllers (0 for one thread per controller)
+  void setControllerThreads(unsigned threads);
+
+  /// Allow components to be initialized concurrently while loading radios
+  void setParallelInit(bool parallel);
+
   /// Set the log level
   void setLogLevel(std::string level);
 
+  /// Set the log level of a single component, engine or controller
+  void setLogLevel(std::string name, std::string level);
+
   /// Load a radio given a configuration file name
   bool loadRadio(std::string radioConfig);
 
@@ -93,9 +111,16 @@ public:
   {   return "System"; };
 
 private:
+  /// Convert a log level name (debug, info, warning, error or fatal) - false if unknown
+  bool parseLogLevel(std::string level, LogLevel& l);
+
+  /// Read a radio configuration, using the cache if one is set
+  void readRadio(std::string radioConfig, RadioRepresentation& rad);
+
   EngineManager engineManager_; ///< Controls all engines running within the radio.
   RadioStatus status_;          ///< Current radio status.
   Repositories reps_;           ///< Module repositories.
+  std::string cacheDirectory_;  ///< Directory for cached radio configurations.
   FILE* pFile_;                 ///< Pointer to the log file.
 };
 
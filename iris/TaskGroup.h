@@ -0,0 +1,169 @@
+/**
+ * \file TaskGroup.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A group of independent tasks which are run on a number of threads.
+ */
+
+#ifndef IRIS_TASKGROUP_H_
+#define IRIS_TASKGROUP_H_
+
+#include <algorithm>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace iris
+{
+
+/** A TaskGroup runs a set of independent tasks concurrently and waits for
+ *  them to finish.
+ *
+ *  Tasks are taken in the order they were added by up to getMaxThreads()
+ *  worker threads. Tasks must not depend on each other - callers should
+ *  store results by task and combine them after run() returns, so the
+ *  outcome does not depend on scheduling.
+ */
+class TaskGroup
+{
+public:
+  /** Create a TaskGroup
+  *
+  *   \param  maxThreads  Maximum number of threads (0 for the default)
+  */
+  explicit TaskGroup(unsigned maxThreads = 0)
+    :next_(0)
+    ,maxThreads_(maxThreads != 0 ? maxThreads : getDefaultThreads())
+  {}
+
+  /// Add a task to the group
+  void add(boost::function< void () > task)
+  {
+    tasks_.push_back(task);
+  }
+
+  /// Get the number of tasks in the group
+  std::size_t size() const { return tasks_.size(); }
+
+  /// Get the maximum number of threads used by this group
+  unsigned getMaxThreads() const { return maxThreads_; }
+
+  /** Run all tasks and wait for them to finish
+  *
+  *   If any task throws, the remaining tasks still run and the exception
+  *   of the first failed task (in the order added) is rethrown.
+  */
+  void run()
+  {
+    errors_.assign(tasks_.size(), boost::exception_ptr());
+    next_ = 0;
+
+    std::size_t numThreads = std::min<std::size_t>(maxThreads_, tasks_.size());
+    if(numThreads <= 1)
+    {
+      work();
+    }
+    else
+    {
+      boost::thread_group workers;
+      for(std::size_t i = 0; i < numThreads; ++i)
+        workers.create_thread(boost::bind(&TaskGroup::work, this));
+      workers.join_all();
+    }
+
+    for(std::vector< boost::exception_ptr >::iterator i = errors_.begin(); i != errors_.end(); ++i)
+    {
+      if(*i)
+        boost::rethrow_exception(*i);
+    }
+  }
+
+  /** Set the default maximum number of threads for new groups
+  *
+  *   \param  maxThreads  Maximum number of threads (0 for one per processor,
+  *                       1 to run tasks in the calling thread)
+  */
+  static void setDefaultThreads(unsigned maxThreads)
+  {
+    defaultThreads() = maxThreads;
+  }
+
+  /// Get the default maximum number of threads for new groups
+  static unsigned getDefaultThreads()
+  {
+    if(defaultThreads() != 0)
+      return defaultThreads();
+    unsigned n = boost::thread::hardware_concurrency();
+    return n != 0 ? n : 1;
+  }
+
+private:
+  /// Run tasks until none are left
+  void work()
+  {
+    while(true)
+    {
+      std::size_t current;
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        if(next_ == tasks_.size())
+          return;
+        current = next_++;
+      }
+
+      try
+      {
+        tasks_[current]();
+      }
+      catch(...)
+      {
+        errors_[current] = boost::current_exception();
+      }
+    }
+  }
+
+  static unsigned& defaultThreads()
+  {
+    static unsigned threads = 0;
+    return threads;
+  }
+
+  std::vector< boost::function< void () > > tasks_;
+  std::vector< boost::exception_ptr > errors_;   ///< Exception thrown by each task, if any.
+  std::size_t next_;        ///< Index of the next task to run.
+  unsigned maxThreads_;     ///< Maximum number of worker threads.
+  boost::mutex mutex_;      ///< Guards next_.
+};
+
+} // namespace iris
+
+#endif // IRIS_TASKGROUP_H_
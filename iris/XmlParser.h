@@ -47,10 +47,24 @@ namespace iris
  *
  *  It also supports the generation of xml files and strings from RadioRepresentation
  *  objects.
+ *
+ *  Configurations can be parsed by building a document tree (the default) or
+ *  by streaming, which fills in the RadioRepresentation in a single pass
+ *  without a document tree and is faster for large configurations. Both
+ *  accept the same configurations and report the same errors.
  */
 class XmlParser
 {
 public:
+  /// The ways in which configurations can be parsed
+  enum ParserType { DOM_PARSER, STREAMING_PARSER };
+
+  /// Set the parser used by parseXmlFile and parseXmlString
+  static void setParserType(ParserType type);
+
+  /// Get the parser used by parseXmlFile and parseXmlString
+  static ParserType getParserType();
+
   /** Parse an xml file and generate a RadioRepresentation
   *
   *   \param  filename  The configuration file to parse
@@ -82,6 +96,10 @@ public:
 private:
   /// Disable constructor - all functions are static
   XmlParser() {};
+
+  static void parseXmlStream(const std::string &xml, RadioRepresentation &radio, std::string rootError);
+
+  static ParserType parserType_;  ///< The parser currently in use.
 };
 
 } // namespace iris
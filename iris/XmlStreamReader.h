@@ -0,0 +1,132 @@
+/**
+ * \file XmlStreamReader.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A streaming xml reader which reports elements to a handler as they are
+ * read, without building a document tree.
+ */
+
+#ifndef IRIS_XMLSTREAMREADER_H_
+#define IRIS_XMLSTREAMREADER_H_
+
+#include <string>
+#include <vector>
+
+#include "irisapi/Exceptions.h"
+
+namespace iris
+{
+
+/** An element reported by the XmlStreamReader.
+ *
+ *  The element is only valid during the call to the handler. Attribute
+ *  values point into the xml being read and are only copied when requested.
+ */
+class XmlStreamElement
+{
+public:
+  /// Get the element name
+  const std::string& getName() const { return name_; }
+
+  /// Does the element have a given attribute?
+  bool hasAttribute(const char* name) const;
+
+  /** Get the value of an attribute, with entities replaced
+  *
+  *   \param  name    The attribute name
+  *   \param  value   Set to the value - cleared if the attribute is missing
+  *   \return False if the attribute is missing
+  */
+  bool getAttribute(const char* name, std::string& value) const;
+
+private:
+  friend class XmlStreamReader;
+
+  struct Attribute
+  {
+    const char* name;
+    std::size_t nameLength;
+    const char* value;
+    std::size_t valueLength;
+  };
+  const Attribute* findAttribute(const char* name) const;
+
+  std::string name_;
+  std::vector<Attribute> attributes_;
+};
+
+/// Receives the elements read by an XmlStreamReader
+class XmlStreamHandler
+{
+public:
+  virtual ~XmlStreamHandler() {}
+  virtual void startElement(const XmlStreamElement& element) = 0;
+  virtual void endElement(const std::string& name) = 0;
+};
+
+/** The XmlStreamReader reads xml in a single pass and reports each element
+ *  to an XmlStreamHandler.
+ *
+ *  Declarations, comments, CDATA sections and text are skipped. Reading stops
+ *  when the root element is closed. Malformed xml results in an
+ *  XmlParsingException giving the line and column of the error.
+ */
+class XmlStreamReader
+{
+public:
+  /** Create a reader
+  *
+  *   \param  data    The xml to read - must stay valid while reading
+  *   \param  length  The length of the xml
+  */
+  XmlStreamReader(const char* data, std::size_t length);
+
+  /// Read the xml, calling the handler for each element
+  void parse(XmlStreamHandler& handler);
+
+private:
+  void readStartTag(XmlStreamHandler& handler);
+  void readEndTag(XmlStreamHandler& handler);
+  void skipPast(const char* terminator, const char* error);
+  void skipWhitespace();
+  bool startsWith(const char* s) const;
+  std::size_t readName();
+  void fail(const char* description) const;
+
+  const char* begin_;   ///< Start of the xml.
+  const char* pos_;     ///< Current read position.
+  const char* end_;     ///< End of the xml.
+  std::size_t depth_;   ///< Number of open elements.
+  std::vector<std::string> open_;  ///< Names of the open elements.
+  XmlStreamElement element_;       ///< Reused for each element read.
+};
+
+} // namespace iris
+
+#endif // IRIS_XMLSTREAMREADER_H_
@@ -38,9 +38,13 @@
 #include <irisapi/Command.h>
 
 #include <map>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/smart_ptr/detail/atomic_count.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
+#include <boost/thread/thread_time.hpp>
 
 namespace iris
 {
@@ -48,49 +52,99 @@ namespace iris
 /** A Cage holds a single thread while it blocks, waiting for a named command.
  *
  * A Cage exists within a CommandPrison. The CommandPrison can hold multiple
- * Cages, each holding a single thread waiting for a named command.
+ * Cages, each holding a single thread waiting for a named command. A Cage
+ * may be released before its thread starts to wait, in which case the
+ * thread does not block at all.
  */
 class Cage
 {
 public:
   Cage()
-    :locked_(false)
+    :state_(WAITING)
   {}
 
-  /** Trap a thread inside this Cage.
+  /** Trap a thread inside this Cage until it is released.
    *
-   * \param l   Reference to the CommandPrison lock which gets released.
+   * This is an interruption point. If the thread is interrupted, the Cage is
+   * abandoned and boost::thread_interrupted is thrown.
+   *
+   * \return The Command which released the thread.
    */
-  Command trap(boost::mutex::scoped_lock &l)
+  Command trap()
   {
     boost::mutex::scoped_lock lock(mutex_);
-    locked_ = true;
-    l.unlock();
-    while(locked_)
+    try
+    {
+      while(state_ == WAITING)
+      {
+        conditionVariable_.wait(lock);
+      }
+    }
+    catch(boost::thread_interrupted&)
     {
-      conditionVariable_.wait(lock);
+      state_ = ABANDONED;
+      throw;
     }
     return command_;
   }
 
+  /** Trap a thread inside this Cage until it is released or a deadline passes.
+   *
+   * This is an interruption point. If the thread is interrupted, the Cage is
+   * abandoned and boost::thread_interrupted is thrown.
+   *
+   * \param deadline   The time at which to give up waiting.
+   * \param c          Set to the Command which released the thread.
+   * \return True if the thread was released, false if the deadline passed.
+   */
+  bool timedTrap(const boost::system_time& deadline, Command& c)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    try
+    {
+      while(state_ == WAITING)
+      {
+        if(!conditionVariable_.timed_wait(lock, deadline) && state_ == WAITING)
+        {
+          state_ = ABANDONED;
+          return false;
+        }
+      }
+    }
+    catch(boost::thread_interrupted&)
+    {
+      state_ = ABANDONED;
+      throw;
+    }
+    c = command_;
+    return true;
+  }
+
   /** Release the thread inside this Cage.
    *
    * @param c   The Command object which releases the trapped thread.
+   * @return  True if the thread was released, false if it was already
+   *          released or has stopped waiting.
    */
-  void release(Command c)
+  bool release(Command c)
   {
     boost::mutex::scoped_lock lock(mutex_);
-    locked_ = false;
+    if(state_ != WAITING)
+      return false;
+    state_ = RELEASED;
     command_ = c;
     lock.unlock();
     conditionVariable_.notify_one();
+    return true;
   }
 
 private:
+  enum CageState { WAITING, RELEASED, ABANDONED };
+
   mutable boost::mutex mutex_;   ///< Mutex protecting this Cage.
   boost::condition_variable conditionVariable_;   ///< The thread waits for this.
   Command command_;              ///< The command which releases the thread.
-  bool locked_;                  ///< Is this Cage locked?
+  CageState state_;              ///< Is this Cage still waiting?
 
 };
 
@@ -102,11 +156,20 @@ private:
  * issued. The CommandPrison is used within StackComponents where a thread
  * can wait for a named Command. It will block within the CommandPrison
  * until that named Command is issued by a Controller.
+ *
+ * A thread can wait for one of several Commands, and can give up waiting
+ * after a timeout. Waiting is an interruption point - an interrupted thread
+ * removes its Cage before boost::thread_interrupted is propagated.
+ *
+ * Cages are held in a number of maps, selected by a hash of the Command
+ * name, each with its own mutex. Commands with different names can then be
+ * issued concurrently without contending for a single lock.
  */
 class CommandPrison
 {
 public:
   CommandPrison()
+    :numTrapped_(0)
   {}
 
   /** Trap a thread by blocking in a Cage until a named Command is issued by
@@ -117,10 +180,69 @@ public:
    */
   Command trap(std::string c)
   {
-    boost::mutex::scoped_lock lock(mutex_);
-    boost::shared_ptr< Cage > cage(new Cage);
-    cages_.insert(CagePair(c,cage));
-    return cage->trap(lock);
+    return trap(std::vector<std::string>(1, c));
+  }
+
+  /** Trap a thread until any one of a number of named Commands is issued.
+   *
+   * @param commands  The names of the Commands to wait for.
+   * @return  The Command object which has released the thread.
+   */
+  Command trap(const std::vector<std::string>& commands)
+  {
+    boost::shared_ptr< Cage > cage = enter(commands);
+    Command c;
+    try
+    {
+      c = cage->trap();
+    }
+    catch(boost::thread_interrupted&)
+    {
+      leave(commands, cage);
+      throw;
+    }
+    leave(commands, cage);
+    return c;
+  }
+
+  /** Trap a thread until a named Command is issued or a timeout expires.
+   *
+   * @param c         The name of the Command to wait for.
+   * @param timeout   The maximum time to wait.
+   * @param command   Set to the Command object which released the thread.
+   * @return  True if the Command was issued, false if the timeout expired.
+   */
+  bool trapFor(std::string c, boost::posix_time::time_duration timeout, Command& command)
+  {
+    return trapFor(std::vector<std::string>(1, c), timeout, command);
+  }
+
+  /** Trap a thread until one of a number of named Commands is issued or a
+   * timeout expires.
+   *
+   * @param commands  The names of the Commands to wait for.
+   * @param timeout   The maximum time to wait.
+   * @param command   Set to the Command object which released the thread.
+   * @return  True if a Command was issued, false if the timeout expired.
+   */
+  bool trapFor(const std::vector<std::string>& commands,
+               boost::posix_time::time_duration timeout,
+               Command& command)
+  {
+    boost::system_time deadline = boost::get_system_time() + timeout;
+    boost::shared_ptr< Cage > cage = enter(commands);
+    bool released = false;
+    try
+    {
+      released = cage->timedTrap(deadline, command);
+    }
+    catch(boost::thread_interrupted&)
+    {
+      leave(commands, cage);
+      throw;
+    }
+    leave(commands, cage);
+    return released;
   }
 
   /** Release any threads which are waiting for a named Command.
@@ -129,30 +251,80 @@ public:
    */
   void release(Command c)
   {
-    boost::mutex::scoped_lock lock(mutex_);
+    CageStripe& s = stripe(c.commandName);
+    boost::mutex::scoped_lock lock(s.mutex);
     std::pair<CageMM::iterator, CageMM::iterator> found;
     CageMM::iterator it;
-    found = cages_.equal_range(c.commandName);
+    found = s.cages.equal_range(c.commandName);
     for (it=found.first; it!=found.second; ++it)
     {
       it->second->release(c);
     }
-    cages_.erase(found.first, found.second);
+    s.cages.erase(found.first, found.second);
   }
 
   /// Get the number of threads currently held in this CommandPrison.
   int size()
   {
-    boost::mutex::scoped_lock lock(mutex_);
-    return cages_.size();
+    return numTrapped_;
   }
 
 private:
   typedef std::multimap<std::string, boost::shared_ptr< Cage > > CageMM;
   typedef std::pair<std::string, boost::shared_ptr< Cage > > CagePair;
 
-  mutable boost::mutex mutex_;  ///< Mutex protecting this CommandPrison.
-  CageMM cages_;                ///< The cages within this CommandPrison.
+  enum { NUM_STRIPES = 16 };
+
+  /// A map of Cages with its own mutex.
+  struct CageStripe
+  {
+    boost::mutex mutex;   ///< Mutex protecting this map.
+    CageMM cages;         ///< The cages waiting for Commands which hash to this map.
+  };
+
+  CageStripe& stripe(const std::string& command)
+  {
+    return stripes_[boost::hash<std::string>()(command) % NUM_STRIPES];
+  }
+
+  /// Create a Cage and add it to the map of each Command it waits for.
+  boost::shared_ptr< Cage > enter(const std::vector<std::string>& commands)
+  {
+    boost::shared_ptr< Cage > cage(new Cage);
+    ++numTrapped_;
+    std::vector<std::string>::const_iterator it;
+    for(it = commands.begin(); it != commands.end(); ++it)
+    {
+      CageStripe& s = stripe(*it);
+      boost::mutex::scoped_lock lock(s.mutex);
+      s.cages.insert(CagePair(*it, cage));
+    }
+    return cage;
+  }
+
+  /// Remove any remaining references to a Cage once its thread stops waiting.
+  void leave(const std::vector<std::string>& commands, boost::shared_ptr< Cage > cage)
+  {
+    std::vector<std::string>::const_iterator it;
+    for(it = commands.begin(); it != commands.end(); ++it)
+    {
+      CageStripe& s = stripe(*it);
+      boost::mutex::scoped_lock lock(s.mutex);
+      std::pair<CageMM::iterator, CageMM::iterator> found = s.cages.equal_range(*it);
+      for(CageMM::iterator c = found.first; c != found.second; ++c)
+      {
+        if(c->second == cage)
+        {
+          s.cages.erase(c);
+          break;
+        }
+      }
+    }
+    --numTrapped_;
+  }
+
+  CageStripe stripes_[NUM_STRIPES];           ///< The cages within this CommandPrison.
+  boost::detail::atomic_count numTrapped_;    ///< Number of threads currently trapped.
 
 };
 
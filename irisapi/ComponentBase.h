@@ -110,8 +110,15 @@ public:
   virtual void setLoggingPolicy(LoggingPolicy* policy) const
   {
     Logger::getPolicy() = policy;
+    logLevel_.reset();
   };
 
+  /// Get the reporting level of this component - checked by LOG.
+  LogLevel getReportingLevel() const
+  {
+    return logLevel_.get(getName());
+  }
+
   /** Assign all parameters and events from another class
    *  to this one
    * \param other The instance to copy the data from
@@ -142,6 +149,28 @@ public:
   template<typename T>
   inline void activateEvent(std::string name, std::vector<T> &data);
 
+  /** Activate an event with a single data element.
+   *
+   * Faster than activating the event by name.
+   *
+   * @param event The index returned by registerEvent().
+   * @param data  The data being passed with the event.
+   */
+  template<typename T>
+  inline void activateEvent(int event, T &data);
+
+  /** Activate an event with multiple data elements.
+   *
+   * Faster than activating the event by name.
+   *
+   * @param event The index returned by registerEvent().
+   * @param data  The vector of data being passed with the event.
+   */
+  template<typename T>
+  inline void activateEvent(int event, std::vector<T> &data);
+
+private:
+  LogLevelCache logLevel_;    ///< Our level in the LoggingPolicy.
 };
 
 // Get the name of this component and pass everything on to ComponentEvents
@@ -149,7 +178,7 @@ template<typename T>
 inline void ComponentBase::activateEvent(std::string name, T &data)
 {
   boost::to_lower(name);
-  activateEventInternal(getName(), name, data);
+  activateEventInternal(getName(), findEvent(name), data);
 }
 
 // Get the name of this component and pass everything on to ComponentEvents
@@ -157,7 +186,21 @@ template<typename T>
 inline void ComponentBase::activateEvent(std::string name, std::vector<T> &data)
 {
   boost::to_lower(name);
-  activateEventInternal(getName(), name, data);
+  activateEventInternal(getName(), findEvent(name), data);
+}
+
+// Get the name of this component and pass everything on to ComponentEvents
+template<typename T>
+inline void ComponentBase::activateEvent(int event, T &data)
+{
+  activateEventInternal(getName(), event, data);
+}
+
+// Get the name of this component and pass everything on to ComponentEvents
+template<typename T>
+inline void ComponentBase::activateEvent(int event, std::vector<T> &data)
+{
+  activateEventInternal(getName(), event, data);
 }
 
 } // namespace iris
@@ -0,0 +1,133 @@
+/**
+ * \file ComponentBundle.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Support for building several components into one library.
+ */
+
+#ifndef IRISAPI_COMPONENTBUNDLE_H_
+#define IRISAPI_COMPONENTBUNDLE_H_
+
+#include <cstddef>
+#include <string>
+
+#include <irisapi/LibraryDefs.h>
+#include <irisapi/Version.h>
+
+#include <boost/algorithm/string.hpp>
+
+/** Macros for a library which holds several components - a component bundle.
+ *  \param ComponentType Type of the components (PhyComponent, StackComponent)
+ *  \param TypeName Type name used for the component in radio configurations
+ *  \param ComponentClass Class of the component
+ *
+ *  A bundle defines GetApiVersion() and GetComponentBundle() instead of the
+ *  functions defined by IRIS_COMPONENT_EXPORTS. GetComponentBundle() returns a
+ *  table which maps type names to the functions creating and releasing each
+ *  component. The types in a bundle are listed, one per line, in a manifest
+ *  file which is installed next to the library and named like it, with a
+ *  ".bundle" extension.
+ *  Example, for a bundle of two Phy components:
+ *  \code
+ *  IRIS_COMPONENT_BUNDLE_BEGIN(PhyComponent)
+ *    IRIS_BUNDLE_COMPONENT(example, ExampleComponent)
+ *    IRIS_BUNDLE_COMPONENT(other, OtherComponent)
+ *  IRIS_COMPONENT_BUNDLE_END()
+ *  \endcode
+ */
+#define IRIS_COMPONENT_BUNDLE_BEGIN(ComponentType) \
+  extern "C" EXPORT_DECLSPEC const char* GetApiVersion() \
+  { \
+    return iris::Version::getApiVersion(); \
+  } \
+  extern "C" EXPORT_DECLSPEC const iris::ComponentBundleEntry<ComponentType>* GetComponentBundle() \
+  { \
+    typedef ComponentType BundleComponentType; \
+    static const iris::ComponentBundleEntry<ComponentType> entries[] = {
+
+/// Add a component to a bundle - see IRIS_COMPONENT_BUNDLE_BEGIN
+#define IRIS_BUNDLE_COMPONENT(TypeName, ComponentClass) \
+      { #TypeName, \
+        &iris::createBundledComponent<BundleComponentType, ComponentClass>, \
+        &iris::releaseBundledComponent<BundleComponentType> },
+
+/// End a component bundle - see IRIS_COMPONENT_BUNDLE_BEGIN
+#define IRIS_COMPONENT_BUNDLE_END() \
+      { NULL, NULL, NULL } \
+    }; \
+    return entries; \
+  }
+
+namespace iris
+{
+
+/// An entry in the table of a component bundle
+template <class ComponentType>
+struct ComponentBundleEntry
+{
+  const char* type;                             ///< Type name of the component
+  ComponentType* (*create)(std::string name);   ///< Creates a component
+  void (*release)(ComponentType* comp);         ///< Releases a component
+};
+
+/// Create a component in a bundle
+template <class ComponentType, class ComponentClass>
+ComponentType* createBundledComponent(std::string name)
+{
+  return new ComponentClass(name);
+}
+
+/// Release a component in a bundle
+template <class ComponentType>
+void releaseBundledComponent(ComponentType* comp)
+{
+  delete comp;
+}
+
+/** Find a type in the table of a component bundle
+ *
+ *  \param entries  The table, ending with an entry without a type
+ *  \param type     The type name, compared ignoring case
+ *  \return The entry or NULL if the bundle does not hold the type
+ */
+template <class ComponentType>
+const ComponentBundleEntry<ComponentType>* findBundledComponent(
+    const ComponentBundleEntry<ComponentType>* entries, const std::string& type)
+{
+  for(; entries != NULL && entries->type != NULL; ++entries)
+  {
+    if(boost::iequals(type, entries->type))
+      return entries;
+  }
+  return NULL;
+}
+
+} // namespace iris
+
+#endif // IRISAPI_COMPONENTBUNDLE_H_
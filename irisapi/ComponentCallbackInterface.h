@@ -50,6 +50,13 @@ public:
   virtual ~ComponentCallbackInterface(){};
 
   virtual void activateEvent(Event &e) = 0;
+
+  /** Register an event with the owner.
+   *
+   * \return The id to pass in Event::eventId or -1 if ids are not used,
+   *          in which case events must carry their names.
+   */
+  virtual int resolveEvent(std::string eventName, std::string componentName){ return -1; }
 };
 
 } // namespace iris
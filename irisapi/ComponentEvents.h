@@ -51,9 +51,10 @@ struct EventDescription
   std::string description;
   std::string name;
   int typeId;       ///< Type of data passed with event.
+  int id;           ///< Id registered with the core - resolved when the event is first activated.
 
   EventDescription(std::string n="", std::string d="", int t=0) :
-    description(d), name(n), typeId(t)
+    description(d), name(n), typeId(t), id(-1)
   {}
 };
 
@@ -61,107 +62,148 @@ struct EventDescription
  *
  * The ComponentEvents class permits components to register events of different types. 
  * These events can then be triggered by the component together with relevent data.
+ *
+ * Each event is registered with the core the first time it is activated. After
+ * that, activating an event passes only its id and the data, which is held in
+ * the Event itself when it is small enough.
  */
 class ComponentEvents : boost::noncopyable
 {
 public:
   ComponentEvents():engine_(NULL){}
-  void setEngine(ComponentCallbackInterface* e){engine_ = e;}
+  void setEngine(ComponentCallbackInterface* e)
+  {
+    engine_ = e;
+
+    //Ids are registered by the engine's owner - resolve them again
+    std::vector<EventDescription>::iterator it;
+    for(it = events_.begin(); it != events_.end(); ++it)
+      it->id = -1;
+  }
   size_t getNumEvents(){return events_.size();}
-  std::map<std::string, EventDescription> getEvents(){return events_;}
+  std::map<std::string, EventDescription> getEvents()
+  {
+    std::map<std::string, EventDescription> events;
+    std::vector<EventDescription>::const_iterator it;
+    for(it = events_.begin(); it != events_.end(); ++it)
+      events[it->name] = *it;
+    return events;
+  }
 
 protected:
   ComponentEvents& assignEvents(const ComponentEvents& other)
   {
     events_ = other.events_;
+    indices_ = other.indices_;
     engine_ = other.engine_;
 
     return *this;
   }
 
-  void registerEvent(std::string name, std::string description, int typeId)
+  /** Register an event
+   *
+   * \return The index of the event, which can be used to activate it.
+   */
+  int registerEvent(std::string name, std::string description, int typeId)
   {
     if(typeId < 0)
       throw InvalidDataTypeException("Invalid data type specified when registering event " + name);
 
     boost::to_lower(name);
     EventDescription e(name, description, typeId);
-    events_[name] = e;
+    std::map<std::string, int>::iterator it = indices_.find(name);
+    if(it != indices_.end())
+    {
+      events_[it->second] = e;
+      return it->second;
+    }
+    indices_[name] = events_.size();
+    events_.push_back(e);
+    return events_.size() - 1;
+  }
+
+  /// Get the index of an event
+  int findEvent(const std::string& name) const
+  {
+    std::map<std::string, int>::const_iterator it = indices_.find(name);
+    if (it == indices_.end())
+      throw EventNotFoundException("Event " + name + " not found");
+    return it->second;
   }
 
   template<typename T>
-  inline void activateEventInternal(std::string compName, std::string name, T &data);
+  inline void activateEventInternal(const std::string& compName, int index, T &data);
 
   template<typename T>
-  inline void activateEventInternal(std::string compName, std::string name, std::vector<T> &data);
+  inline void activateEventInternal(const std::string& compName, int index, std::vector<T> &data);
 
 private:
-  std::map<std::string, EventDescription> events_;
+  template<typename T>
+  inline bool prepareEvent(const std::string& compName, int index, Event& e);
+
+  std::vector<EventDescription> events_;
+  std::map<std::string, int> indices_;    ///< Index of each event in events_
   ComponentCallbackInterface* engine_;
 };
 
+// Check an event and fill in its id - returns false if there is nobody to pass it to
 template<typename T>
-inline void ComponentEvents::activateEventInternal(std::string compName, std::string name, T &data)
+inline bool ComponentEvents::prepareEvent(const std::string& compName, int index, Event& e)
 {
   //Check that we have an interface to the engine
   if(engine_ == NULL)
   {
-    return;
+    return false;
   }
 
   //Check that the event exists and that the datatypes match
-  std::map<std::string, EventDescription>::const_iterator it = events_.find(name);
-  if (it == events_.end())
-    throw EventNotFoundException("Event " + name + " not found");
-  
-  if(it->second.typeId == TypeInfo<T>::identifier)
+  if(index < 0 || index >= (int)events_.size())
+    throw EventNotFoundException("Event not found");
+
+  EventDescription& desc = events_[index];
+  if(desc.typeId != TypeInfo<T>::identifier)
+    throw InvalidDataTypeException("Event data type did not match registered type for event " + desc.name);
+
+  //Register the event the first time it is activated
+  if(desc.id < 0)
+    desc.id = engine_->resolveEvent(desc.name, compName);
+
+  e.eventId = desc.id;
+  e.typeId = TypeInfo<T>::identifier;
+  if(desc.id < 0)
   {
-    //std::vector<boost::any> d;
-    //d.push_back(boost::any(data));
-    //d_engine->activateEvent(name, d);
-    Event e;
-    e.data.push_back(boost::any(data));
-    e.eventName = name;
+    //No id was registered - pass the names instead
+    e.eventName = desc.name;
     e.componentName = compName;
-    e.typeId = TypeInfo<T>::identifier;
-    engine_->activateEvent(e);
-    return;
-  }else{
-    throw InvalidDataTypeException("Event data type did not match registered type for event " + name); 
   }
+  return true;
 }
 
 template<typename T>
-inline void ComponentEvents::activateEventInternal(std::string compName, std::string name, std::vector<T> &data)
+inline void ComponentEvents::activateEventInternal(const std::string& compName, int index, T &data)
 {
-  //Check that we have an interface to the engine
-  if(engine_ == NULL)
-  {
+  Event e;
+  if(!prepareEvent<T>(compName, index, e))
     return;
-  }
 
-  //Check that the event exists and that the datatypes match
-  std::map<std::string, EventDescription>::const_iterator it = events_.find(name);
-  if (it == events_.end())
-    throw EventNotFoundException("Event " + name + " not found");
+  if(!e.setValues(&data, 1))
+    e.data.push_back(boost::any(data));
+  engine_->activateEvent(e);
+}
 
-  if(it->second.typeId == TypeInfo<T>::identifier)
+template<typename T>
+inline void ComponentEvents::activateEventInternal(const std::string& compName, int index, std::vector<T> &data)
+{
+  Event e;
+  if(!prepareEvent<T>(compName, index, e))
+    return;
+
+  if(data.empty() || !e.setValues(&data[0], data.size()))
   {
-    //std::vector<boost::any> d;
-    //d.resize(data.size());
-    //std::copy(data.begin(), data.end(), d.begin());
-    //d_engine->activateEvent(name, d);
-    Event e;
     e.data.resize(data.size());
     std::copy(data.begin(), data.end(), e.data.begin());
-    e.eventName = name;
-    e.componentName = compName;
-    e.typeId = TypeInfo<T>::identifier;
-    engine_->activateEvent(e);
-    return;
-  }else{
-    throw InvalidDataTypeException("Event data type did not match registered type for event " + name); 
   }
+  engine_->activateEvent(e);
 }
 
 } // namespace iris
@@ -61,7 +61,7 @@ public:
   }
 
   /// Return the component name
-  std::string getName() const { return name_; }
+  const std::string& getName() const { return name_; }
 
   /// Return the component type
   std::string getType() const { return type_; }
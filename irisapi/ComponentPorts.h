@@ -48,18 +48,20 @@ struct Port
 {
   std::string portName;             ///< The name of this port.
   std::vector<int> supportedTypes;  ///< The data types supported by this port.
+  unsigned rate;                    ///< DataSets consumed or produced per firing (used by the SdfEngine).
 
   Port()
-    : portName("")
+    : portName(""), rate(1)
   {}
 
   /** Constructs a new Port object.
    *
    * \param name The name assigned to this port
    * \param types The types supported for this port
+   * \param r The number of DataSets consumed or produced each time the component runs
    */
-  Port(std::string name, const std::vector<int>& types)
-    : portName(name), supportedTypes(types)
+  Port(std::string name, const std::vector<int>& types, unsigned r = 1)
+    : portName(name), supportedTypes(types), rate(r)
   {}
 
 };
@@ -115,6 +117,21 @@ protected:
     inputPorts.push_back(Port(name, types));
   };
 
+  /** Register an input port of a child class with a fixed consumption rate.
+   *
+   * The rate is used by the SdfEngine to build a static schedule. The
+   * component must read exactly this many DataSets from the port each time
+   * it is run.
+   *
+   * \param name  Name of the port
+   * \param types Data types supported by the port
+   * \param rate  Number of DataSets consumed each time the component runs
+   */
+  void registerInputPort(std::string name, const std::vector<int>& types, unsigned rate)
+  {
+    inputPorts.push_back(Port(name, types, rate));
+  };
+
   /** Register an output port of a child class with a single type.
    *
    * \param name Name of the port
@@ -136,6 +153,21 @@ protected:
     outputPorts.push_back(Port(name, types));
   };
 
+  /** Register an output port of a child class with a fixed production rate.
+   *
+   * The rate is used by the SdfEngine to build a static schedule. The
+   * component must write exactly this many DataSets to the port each time
+   * it is run.
+   *
+   * \param name  Name of the port
+   * \param types Data types supported by the port
+   * \param rate  Number of DataSets produced each time the component runs
+   */
+  void registerOutputPort(std::string name, const std::vector<int>& types, unsigned rate)
+  {
+    outputPorts.push_back(Port(name, types, rate));
+  };
+
 private:
   std::vector<Port> inputPorts;   ///< Input ports registered for this component.
   std::vector<Port> outputPorts;  ///< Output ports registered for this component.
@@ -34,6 +34,7 @@
 #ifndef IRISAPI_CONTROLLER_H_
 #define IRISAPI_CONTROLLER_H_
 
+#include <map>
 #include <vector>
 #include <boost/any.hpp>
 #include <boost/thread/thread.hpp>
@@ -42,14 +43,19 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/chrono/chrono.hpp>
 
 #include <irisapi/ModuleParameters.h>
 #include <irisapi/TypeInfo.h>
 #include <irisapi/Event.h>
 #include <irisapi/Exceptions.h>
 #include <irisapi/Logging.h>
-#include <irisapi/MessageQueue.h>
 #include <irisapi/ControllerCallbackInterface.h>
+#include <irisapi/TimerWheel.h>
 
 /** Macro for Iris boilerplate code in each controller.
  *  \param ControllerClass Class of the controller class to be exported by the library
@@ -82,18 +88,44 @@
 namespace iris
 {
 
+/// Statistics of the events handled by a controller.
+struct ControllerMetrics
+{
+  unsigned long eventsProcessed;  ///< Number of processEvent() and processEvents() calls, counted as each starts.
+  unsigned long queueDepth;       ///< Events waiting to be processed.
+  unsigned long maxQueueDepth;    ///< Most events which have been waiting at once.
+  double meanHandlingTime;        ///< Mean time spent processing an event, in seconds.
+  double maxHandlingTime;         ///< Longest time spent processing an event, in seconds.
+};
+
 /** The base class for all Controllers.
  *
  * Controllers in Iris have a global view of the running radio. They
  * can subscribe to events on any component and carry out reconfigurations
  * of the running radio.
+ *
+ * Each controller normally has its own thread. Alternatively, controllers
+ * can be run as tasks by a shared executor: runEvents() is then scheduled
+ * through the ControllerCallbackInterface whenever events are waiting.
+ * A controller is never run by more than one thread at a time, so events
+ * are processed in the order they were queued in both cases.
+ *
+ * Controllers can also schedule timers using scheduleTimer() and
+ * schedulePeriodicTimer(). Timer callbacks are queued with the events, so
+ * they never run at the same time as processEvent().
  */
 class Controller
-  : public ModuleParameters
+  : public ModuleParameters, public TimerListener
 {
 public:
 
-  virtual ~Controller() {};
+  virtual ~Controller()
+  {
+    //Release any events which were never processed
+    QueuedEvent q;
+    while(eventQueue_.pop(q))
+      delete q.overflow;
+  };
 
   /** Construct this controller
    *
@@ -104,10 +136,21 @@ public:
    */
   Controller(std::string name, std::string description, std::string author, std::string version )
     : name_(name), description_(description), author_(author), version_(version)
+    ,eventQueue_(128)
+    ,eventSignal_(0)
     ,controllerManager_(NULL)
+    ,timerWheel_(NULL)
     ,thread_(NULL)
     ,started_(false)
     ,loaded_(false)
+    ,ownThread_(true)
+    ,initialized_(false)
+    ,scheduled_(false)
+    ,queueDepth_(0)
+    ,maxQueueDepth_(0)
+    ,eventsProcessed_(0)
+    ,totalHandlingTime_(0)
+    ,maxHandlingTime_(0)
   {
   }
 
@@ -117,6 +160,18 @@ public:
     LOG(LERROR) << "Function processEvent has not been implemented in controller " << name_;
   }
 
+  /** Process a batch of events - called for subscriptions with EventPolicy::batchSize > 1
+   *
+   * A batch holds fewer events if the first has waited EventPolicy::maxDelay.
+   * By default each event is passed to processEvent().
+   */
+  virtual void processEvents(std::vector<Event> &events)
+  {
+    std::vector<Event>::iterator it;
+    for(it = events.begin(); it != events.end(); ++it)
+      processEvent(*it);
+  }
+
   /// Called by derived controller to reconfigure the radio.
   void reconfigureRadio(ReconfigSet reconfigs)
   {
@@ -146,17 +201,86 @@ public:
     return controllerManager_->getParameterValue(paramName, componentName);
   }
 
-  /// Called by a derived controller to subscribe to an event on a component.
-  void subscribeToEvent(std::string eventName, std::string componentName)
+  /** Called by a derived controller to resolve a parameter for reconfigureParameter().
+   *
+   * Resolve once, then reconfigure as often as needed.
+   */
+  ParameterHandle resolveParameter(std::string paramName, std::string componentName)
+  {
+    if(controllerManager_ == NULL)
+      return ParameterHandle();
+
+    boost::to_lower(paramName);
+    boost::to_lower(componentName);
+    return controllerManager_->resolveParameter(paramName, componentName);
+  }
+
+  /** Called by a derived controller to change a resolved parameter.
+   *
+   * The value is passed in binary form, so nothing is parsed or looked up
+   * by name. T must be the type of the parameter.
+   */
+  template<typename T>
+  void reconfigureParameter(const ParameterHandle& handle, T value)
+  {
+    if(controllerManager_ == NULL)
+      return;
+
+    if(handle.typeIdentifier != ParameterTypeInfo<T>::identifier)
+      throw InvalidDataTypeException(std::string("Cannot reconfigure parameter with a value of type ")
+          + ParameterTypeInfo<T>::name());
+
+    TypedParametricReconfig reconfig;
+    reconfig.handle = handle;
+    reconfig.value = ParameterValue(value);
+    controllerManager_->reconfigureParameter(reconfig);
+  }
+
+  /** Called by a derived controller to subscribe to an event on a component.
+   *
+   * \param eventName       The event name.
+   * \param componentName   The name of the component which activates it.
+   * \param policy          How the events are passed to this controller.
+   */
+  void subscribeToEvent(std::string eventName, std::string componentName,
+      const EventPolicy& policy = EventPolicy())
   {
     if(controllerManager_ == NULL)
       return;
 
     boost::to_lower(eventName);
     boost::to_lower(componentName);
-    controllerManager_->subscribeToEvent(eventName, componentName, this);
+    controllerManager_->subscribeToEvent(eventName, componentName, this, policy);
+  }
+
+
+  /** Set the TimerWheel used to schedule timers for this controller
+  *
+  *   \param wheel  The TimerWheel of the ControllerManager
+  */
+  void setTimerWheel(TimerWheel* wheel)
+  {
+    timerWheel_ = wheel;
   }
 
+  /** Called by the TimerWheel when a timer has expired
+  *
+  *   \param id  The id of the expired timer
+  */
+  void timerExpired(TimerId id)
+  {
+    QueuedEvent q;
+    q.source = NULL;
+    q.channel = NULL;
+    q.timer = id;
+    q.overflow = NULL;
+    if(!eventQueue_.push(q))
+    {
+      LOG(LERROR) << "Failed to queue timer for controller " << name_;
+      return;
+    }
+    notify();
+  }
 
   /// Called by ControllerManager to set the callback interface.
   void setCallbackInterface(ControllerCallbackInterface* c)
@@ -167,18 +291,84 @@ public:
   /// Called by ControllerManager to pass an event to this Controller
   void postEvent(Event &e)
   {
-    eventQueue_.push(e);
+    postEvent(e, NULL);
   }
 
-  /// Called by ControllerManager to load the controller thread.
-  void load()
+  /** Called by ControllerManager to pass an event to this Controller
+   *
+   * Does not lock or allocate memory if the event's data is held inline.
+   *
+   * \param e        The event.
+   * \param source   The names of the event, filled in when it is processed.
+   */
+  void postEvent(const Event &e, const EventSource* source)
   {
-    //Load the controller thread (if it hasn't already been loaded)
-    if( thread_ == NULL)
+    QueuedEvent q;
+    q.source = source;
+    q.channel = NULL;
+    q.timer = 0;
+    q.typeId = e.typeId;
+    q.value = e.value;
+    q.overflow = NULL;
+    if(source == NULL || e.value.count == 0)
     {
-      loaded_ = true;
-      thread_.reset( new boost::thread( boost::bind( &Controller::eventLoop, this ) ) );
+      //Copy events which carry their names or data
+      q.overflow = new Event(e);
+      if(source != NULL)
+      {
+        q.overflow->eventId = source->id;
+        q.overflow->eventName = source->eventName;
+        q.overflow->componentName = source->componentName;
+      }
+    }
+    if(!eventQueue_.push(q))
+    {
+      LOG(LERROR) << "Failed to queue event for controller " << name_;
+      delete q.overflow;
+      return;
+    }
+    notify();
+  }
+
+  /** Called by ControllerManager to pass an event through a subscription's channel
+   *
+   * The channel's policy decides whether the event is dropped, queued
+   * on its own or held in the channel.
+   */
+  void postEvent(const Event &e, EventChannel& channel)
+  {
+    if(!channel.admit())
+      return;
+    if(!channel.isBuffered())
+    {
+      postEvent(e, channel.getSource());
+      return;
     }
+    EventChannel::StoreResult result = channel.store(e);
+    if(result == EventChannel::QUEUE)
+      queueChannel(channel);
+    else if(result == EventChannel::ARM_FLUSH)
+      armFlush(channel, (boost::int64_t)(channel.getPolicy().maxDelay * 1e9));
+  }
+
+  /** Called by ControllerManager to load the controller.
+   *
+   * \param ownThread  Run the controller in its own thread. If false, the
+   *                   controller is scheduled on the ControllerManager's
+   *                   executor whenever it has work to do.
+   */
+  void load(bool ownThread = true)
+  {
+    //Load the controller thread (if it hasn't already been loaded)
+    if(loaded_)
+      return;
+
+    ownThread_ = ownThread;
+    loaded_ = true;
+    if(ownThread_)
+      thread_.reset( new boost::thread( boost::bind( &Controller::eventLoop, this ) ) );
+    else
+      schedule();   //Initialize and subscribe on the executor
   }
 
   /// Called by ControllerManager to start this controller
@@ -188,6 +378,10 @@ public:
     started_ = true;
     lock.unlock();
     conditionVar_.notify_one();
+
+    //Process any events which arrived while we were stopped
+    if(!ownThread_)
+      schedule();
   }
 
   /// Called by ControllerManager to stop this controller
@@ -198,7 +392,11 @@ public:
     lock.unlock();
     conditionVar_.notify_one();
 
-    thread_->interrupt();
+    if(ownThread_ && thread_)
+    {
+      thread_->interrupt();
+      eventSignal_.post();
+    }
   }
 
   /// Called by ControllerManager to unload the controller thread
@@ -206,18 +404,35 @@ public:
   {
     //unload the controller thread
     loaded_ = false;
-    thread_->interrupt();
-    thread_->join();
+    if(ownThread_)
+    {
+      if(!thread_)
+        return;
+      thread_->interrupt();
+      eventSignal_.post();
+      thread_->join();
+      return;
+    }
+
+    //Wait until the executor is done with us
+    boost::mutex::scoped_lock lock(runMutex_);
+    while(scheduled_)
+      runFinished_.wait(lock);
+    if(initialized_)
+    {
+      initialized_ = false;
+      destroy();
+    }
   }
 
   /// The main loop for the Controller thread
   void eventLoop()
   {
-    //Initialize the controller and subscribe to events
-    initialize();
-    subscribeToEvents();
-
     try{
+      //Initialize the controller and subscribe to events
+      initialize();
+      subscribeToEvents();
+
       while(loaded_)
       {
         try{
@@ -232,10 +447,9 @@ public:
           //Interrupt thread here if necessary
           boost::this_thread::interruption_point();
 
-          //Check message queue for Events
-          Event currentEvent;
-          eventQueue_.waitAndPop(currentEvent);  //Blocks if queue is empty
-          processEvent(currentEvent);
+          //Check queue for Events - stop() and unload() also wake us up
+          eventSignal_.wait();  //Blocks if queue is empty
+          handleNextEvent();
         }
         catch(boost::thread_interrupted)
         {
@@ -252,6 +466,54 @@ public:
     destroy();
   }
 
+  /** Process waiting events - called by the executor when the controller was scheduled.
+   *
+   * At most maxEvents are processed, so that one busy controller cannot
+   * hold up the others. The controller is scheduled again if events remain.
+   */
+  void runEvents(unsigned maxEvents = 64)
+  {
+    boost::mutex::scoped_lock lock(runMutex_);
+    try{
+      if(loaded_ && !initialized_)
+      {
+        initialized_ = true;
+        initialize();
+        subscribeToEvents();
+      }
+      for(unsigned i = 0; i < maxEvents && loaded_ && started_; ++i)
+      {
+        if(!handleNextEvent() && eventQueue_.empty())
+          break;
+      }
+    }
+    catch(IrisException& ex)
+    {
+      LOG(LERROR) << "Error in controller " << name_ << ": " << ex.what() << std::endl << "Controller stopped.";
+      started_ = false;
+    }
+
+    //Events queued from now on schedule us again, so check the queue after clearing the flag
+    scheduled_.store(false);
+    bool more = loaded_ && started_ && !eventQueue_.empty() && !scheduled_.exchange(true);
+    runFinished_.notify_all();
+    lock.unlock();
+    if(more)
+      controllerManager_->scheduleController(this);
+  }
+
+  /// Get statistics of the events handled by this controller.
+  ControllerMetrics getMetrics() const
+  {
+    ControllerMetrics m;
+    m.eventsProcessed = eventsProcessed_.load();
+    m.queueDepth = queueDepth_.load();
+    m.maxQueueDepth = maxQueueDepth_.load();
+    m.meanHandlingTime = m.eventsProcessed == 0 ? 0 : totalHandlingTime_.load() * 1e-9 / m.eventsProcessed;
+    m.maxHandlingTime = maxHandlingTime_.load() * 1e-9;
+    return m;
+  }
+
   std::string getName() const
   {
     return name_;
@@ -276,8 +538,15 @@ public:
   virtual void setLoggingPolicy(LoggingPolicy* policy) const
   {
     Logger::getPolicy() = policy;
+    logLevel_.reset();
   };
 
+  /// Get the reporting level of this controller - checked by LOG.
+  LogLevel getReportingLevel() const
+  {
+    return logLevel_.get(name_);
+  }
+
 protected:
   /// Subscribe to events on Iris components - called by controller thread.
   virtual void subscribeToEvents() = 0;
@@ -288,14 +557,294 @@ protected:
   /// Destroy this controller - called by controller thread.
   virtual void destroy() = 0;
 
+  /** Schedule a timer
+  *
+  *   The callback is run by the controller thread, in turn with events.
+  *
+  *   \param delay      Time until the timer expires.
+  *   \param callback   The function to call when the timer expires.
+  *   \return The id of the timer, or 0 if no TimerWheel is available.
+  */
+  TimerId scheduleTimer(boost::posix_time::time_duration delay, TimerCallback callback)
+  {
+    if(timerWheel_ == NULL)
+    {
+      LOG(LERROR) << "scheduleTimer() failed. No TimerWheel available.";
+      return 0;
+    }
+    return timerWheel_->schedule(this, delay, callback);
+  }
+
+  /** Schedule a timer which expires repeatedly until it is cancelled
+  *
+  *   Expiry times are kept relative to the first one, so the timer does
+  *   not drift if callbacks are run late.
+  *
+  *   \param interval   Time between expiries.
+  *   \param callback   The function to call each time the timer expires.
+  *   \return The id of the timer, or 0 if no TimerWheel is available.
+  */
+  TimerId schedulePeriodicTimer(boost::posix_time::time_duration interval, TimerCallback callback)
+  {
+    if(timerWheel_ == NULL)
+    {
+      LOG(LERROR) << "schedulePeriodicTimer() failed. No TimerWheel available.";
+      return 0;
+    }
+    boost::shared_ptr<PeriodicTimer> timer(new PeriodicTimer);
+    timer->interval = boost::chrono::microseconds(interval.total_microseconds());
+    timer->nextExpiry = Clock::now() + timer->interval;
+    timer->callback = callback;
+
+    boost::mutex::scoped_lock lock(timerMutex_);
+    timer->current = timerWheel_->schedule(this, interval,
+        boost::bind(&Controller::runPeriodicTimer, this, timer));
+    timer->id = timer->current;
+    periodicTimers_[timer->id] = timer;
+    return timer->id;
+  }
+
+  /** Cancel a timer
+  *
+  *   \param id   The id returned by scheduleTimer() or schedulePeriodicTimer().
+  *   \return True if the timer was cancelled before it ran.
+  */
+  bool cancelTimer(TimerId id)
+  {
+    if(timerWheel_ == NULL)
+      return false;
+
+    boost::mutex::scoped_lock lock(timerMutex_);
+    PeriodicTimerMap::iterator it = periodicTimers_.find(id);
+    if(it == periodicTimers_.end())
+      return timerWheel_->cancel(id);
+    it->second->cancelled = true;
+    timerWheel_->cancel(it->second->current);
+    periodicTimers_.erase(it);
+    return true;
+  }
+
+  /** Set the reporting level of a component, engine or controller
+  *
+  *   Only messages logged under that name are affected - the level of an
+  *   engine also applies to its components, unless they have their own.
+  *
+  *   \param name    Name of the component, engine or controller.
+  *   \param level   The new reporting level.
+  */
+  void setLogLevel(const std::string& name, LogLevel level)
+  {
+    Logger::getPolicy()->setLevel(name, level);
+  }
+
+  /// Remove the reporting level set for a name - it uses the level of its engine or the global level again.
+  void clearLogLevel(const std::string& name)
+  {
+    Logger::getPolicy()->clearLevel(name);
+  }
+
 private:
+  typedef boost::chrono::steady_clock Clock;
+
+  /// Wake up the controller after an event was queued
+  void notify()
+  {
+    long depth = ++queueDepth_;
+    long maxDepth = maxQueueDepth_.load(boost::memory_order_relaxed);
+    while(depth > maxDepth && !maxQueueDepth_.compare_exchange_weak(maxDepth, depth))
+      ;
+
+    if(ownThread_)
+      eventSignal_.post();
+    else if(loaded_ && started_)
+      schedule();
+  }
+
+  /// Ask the executor to run this controller, unless it is already waiting to run
+  void schedule()
+  {
+    if(controllerManager_ != NULL && !scheduled_.exchange(true))
+      controllerManager_->scheduleController(this);
+  }
+
+  /// A timer scheduled with schedulePeriodicTimer()
+  struct PeriodicTimer
+  {
+    TimerId id;                           ///< Id returned to the controller.
+    TimerId current;                      ///< Id of the next expiry in the TimerWheel.
+    boost::chrono::microseconds interval;
+    Clock::time_point nextExpiry;
+    TimerCallback callback;
+    bool cancelled;
+
+    PeriodicTimer() : id(0), current(0), cancelled(false) {}
+  };
+  typedef std::map< TimerId, boost::shared_ptr<PeriodicTimer> > PeriodicTimerMap;
+
+  /// Schedule the next expiry of a periodic timer, then run its callback
+  void runPeriodicTimer(boost::shared_ptr<PeriodicTimer> timer)
+  {
+    {
+      boost::mutex::scoped_lock lock(timerMutex_);
+      if(timer->cancelled)
+        return;
+      timer->nextExpiry += timer->interval;
+      boost::int64_t delay = boost::chrono::duration_cast<boost::chrono::microseconds>(
+          timer->nextExpiry - Clock::now()).count();
+      timer->current = timerWheel_->schedule(this, boost::posix_time::microseconds(delay),
+          boost::bind(&Controller::runPeriodicTimer, this, timer));
+    }
+    timer->callback();
+  }
+
+  /// Queue a channel itself - the events are taken from it when processed
+  void queueChannel(EventChannel& channel)
+  {
+    QueuedEvent q;
+    q.source = channel.getSource();
+    q.channel = &channel;
+    q.timer = 0;
+    q.typeId = -1;
+    q.overflow = NULL;
+    if(!eventQueue_.push(q))
+    {
+      LOG(LERROR) << "Failed to queue event for controller " << name_;
+      channel.unqueue();
+      return;
+    }
+    notify();
+  }
+
+  /** Arm a timer which queues a partial batch held in a channel
+   *
+   * Without a TimerWheel, partial batches are held until they are full.
+   *
+   * \param channel  The channel holding the batch.
+   * \param delay    Time until the batch is due, in ns.
+   */
+  void armFlush(EventChannel& channel, boost::int64_t delay)
+  {
+    if(timerWheel_ == NULL)
+      return;
+    timerWheel_->schedule(this, boost::posix_time::microseconds((delay + 999) / 1000),
+        boost::bind(&Controller::flushChannel, this, &channel));
+  }
+
+  /// Called on the controller thread when the flush timer of a channel expires
+  void flushChannel(EventChannel* channel)
+  {
+    boost::int64_t wait = 0;
+    EventChannel::StoreResult result = channel->flush(wait);
+    if(result == EventChannel::QUEUE)
+      queueChannel(*channel);
+    else if(result == EventChannel::ARM_FLUSH)
+      armFlush(*channel, wait);
+  }
+
+  /// Take the next queued event or timer and process it
+  bool handleNextEvent()
+  {
+    QueuedEvent q;
+    if(!eventQueue_.pop(q))
+      return false;
+    --queueDepth_;
+
+    //Timers are run in turn with events
+    if(q.timer != 0)
+    {
+      if(timerWheel_ != NULL)
+        timerWheel_->dispatch(q.timer);
+      return true;
+    }
+
+    bool batched = false;
+    if(!takeEvents(q, events_, batched))
+      return true;
+
+    //Count the call before making it, so the count is up to date as soon as
+    //anything done by processEvent() can be seen
+    ++eventsProcessed_;
+    Clock::time_point start = Clock::now();
+    if(batched)
+      processEvents(events_);
+    else
+      processEvent(events_.front());
+    boost::int64_t taken = boost::chrono::duration_cast<boost::chrono::nanoseconds>(Clock::now() - start).count();
+
+    //Maximum first, so a concurrent getMetrics() never sees a mean above it
+    if(taken > maxHandlingTime_.load(boost::memory_order_relaxed))
+      maxHandlingTime_.store(taken);
+    totalHandlingTime_ += taken;
+    return true;
+  }
+
+  /// An event waiting to be processed - held in a lock-free queue
+  struct QueuedEvent
+  {
+    const EventSource* source;  ///< Names of the event.
+    EventChannel* channel;      ///< Channel holding the events, if they are buffered.
+    TimerId timer;              ///< Expired timer to dispatch instead of an event, or 0.
+    int typeId;                 ///< Type of data passed with the event.
+    EventValue value;           ///< Data held inline.
+    Event* overflow;            ///< Copy of the event if it is not held inline.
+  };
+
+  /** Fill in the names and data of a queued event
+   *
+   * \param q         The event taken from the queue.
+   * \param events    Filled with the event, or with all events held in its channel.
+   * \param batched   Set if the events should be passed to processEvents().
+   * \return false if there were no events.
+   */
+  bool takeEvents(const QueuedEvent& q, std::vector<Event>& events, bool& batched)
+  {
+    if(q.channel != NULL)
+    {
+      q.channel->take(events);
+      batched = q.channel->getPolicy().batchSize > 1;
+      if(events.empty())
+        return false;
+    }
+    else
+    {
+      events.resize(1);
+      batched = false;
+      Event& e = events.front();
+      if(q.overflow != NULL)
+      {
+        boost::scoped_ptr<Event> overflow(q.overflow);
+        e = *overflow;
+        e.unpack();
+        return true;
+      }
+      e.typeId = q.typeId;
+      e.value = q.value;
+    }
+
+    std::vector<Event>::iterator it;
+    for(it = events.begin(); it != events.end(); ++it)
+    {
+      it->eventId = q.source->id;
+      it->eventName = q.source->eventName;
+      it->componentName = q.source->componentName;
+      it->unpack();
+    }
+    return true;
+  }
+
   std::string name_;
   std::string description_;
   std::string author_;
   std::string version_;
+  LogLevelCache logLevel_;                            ///< Our level in the LoggingPolicy.
 
-  MessageQueue< Event > eventQueue_;                ///< Queue of incoming Event objects.
+  boost::lockfree::queue< QueuedEvent > eventQueue_;  ///< Queue of incoming events.
+  std::vector< Event > events_;                       ///< Events being processed.
+  boost::interprocess::interprocess_semaphore eventSignal_; ///< Counts incoming events.
   ControllerCallbackInterface* controllerManager_;  ///< Interface to the ControllerManager.
+  TimerWheel* timerWheel_;                          ///< Timer service of the ControllerManager.
+  PeriodicTimerMap periodicTimers_;                 ///< Periodic timers, by the id returned to the controller.
+  boost::mutex timerMutex_;                         ///< Guards periodicTimers_.
   boost::scoped_ptr< boost::thread > thread_;       ///< This controller's thread.
 
   bool started_;
@@ -303,6 +852,18 @@ private:
   mutable boost::mutex mutex_;
   boost::condition_variable conditionVar_;
 
+  bool ownThread_;                      ///< Do we have our own thread, or use the executor?
+  bool initialized_;                    ///< Has the executor initialized us?
+  boost::atomic<bool> scheduled_;       ///< Are we waiting in, or being run by, the executor?
+  boost::mutex runMutex_;               ///< Held while the executor runs us.
+  boost::condition_variable runFinished_;
+
+  boost::atomic<long> queueDepth_;
+  boost::atomic<long> maxQueueDepth_;
+  boost::atomic<unsigned long> eventsProcessed_;
+  boost::atomic<boost::int64_t> totalHandlingTime_;   ///< In ns.
+  boost::atomic<boost::int64_t> maxHandlingTime_;     ///< In ns.
+
 };
 
 } /* namespace iris */
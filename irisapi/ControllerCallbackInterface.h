@@ -36,6 +36,7 @@
 
 #include "irisapi/ReconfigurationDescriptions.h"
 #include "irisapi/Command.h"
+#include "irisapi/EventChannel.h"
 
 namespace iris
 {
@@ -54,7 +55,11 @@ public:
   virtual void reconfigureRadio(ReconfigSet reconfigs) = 0;
   virtual void postCommand(Command command) = 0;
   virtual std::string getParameterValue(std::string paramName, std::string componentName) = 0;
-  virtual void subscribeToEvent(std::string eventName, std::string componentName, Controller *cont) = 0;
+  virtual ParameterHandle resolveParameter(std::string paramName, std::string componentName) = 0;
+  virtual void reconfigureParameter(const TypedParametricReconfig& reconfig) = 0;
+  virtual void subscribeToEvent(std::string eventName, std::string componentName, Controller *cont,
+      const EventPolicy& policy) = 0;
+  virtual void scheduleController(Controller *cont) = 0;
 };
 
 } /* namespace iris */
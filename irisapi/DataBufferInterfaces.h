@@ -35,16 +35,65 @@
 #define IRISAPI_DATABUFFERINTERFACES_H_
 
 #include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <vector>
+#include <algorithm>
 #include <irisapi/LinkDescription.h>
+#include <irisapi/Exceptions.h>
 
 namespace iris
 {
 
+/** Get the current time as a DataSet timestamp.
+*
+*  Seconds since 1970-01-01 UTC. Data created by a source component is
+*  stamped with this time unless the component sets its own timestamps.
+*/
+inline double currentTimeStamp()
+{
+  using namespace boost::posix_time;
+  static const ptime epoch(boost::gregorian::date(1970, 1, 1));
+  return (microsec_clock::universal_time() - epoch).total_microseconds() * 1e-6;
+}
+
+/** A read-only reference to part of a block of shared data.
+*
+*  DataSegments allow a DataSet to refer to data held by other DataSets
+*  without copying it. The storage is reference counted, so it lives as long
+*  as any DataSet refers to it.
+*/
+template <typename T>
+struct DataSegment{
+  boost::shared_ptr< const std::vector<T> > storage;  ///< The shared data.
+  std::size_t offset;   ///< Index of the first element in storage.
+  std::size_t length;   ///< Number of elements.
+
+  DataSegment()
+    :offset(0), length(0){}
+
+  DataSegment(boost::shared_ptr< const std::vector<T> > s, std::size_t o, std::size_t l)
+    :storage(s), offset(o), length(l){}
+
+  //! Pointer to the first element
+  const T* begin() const
+  { return length == 0 ? NULL : &(*storage)[offset]; }
+
+  //! Pointer past the last element
+  const T* end() const
+  { return begin() + length; }
+};
+
 /** The DataSet struct wraps a block of data being used within the IRIS system.
 *
 *  Each DataBuffer between two components will contain a vector of DataSets which can be written and read
 *  by those components.
+*
+*  A DataSet can also be a view - a list of read-only segments of data shared with other DataSets. A
+*  splitter can share() its input and pass slices of it to each output with appendView(), and a combiner
+*  can gather the segments of several inputs into one output, without copying any samples. The data
+*  vector of a view is empty - use size(), at() or copyTo() to access the contents, or flatten() to copy
+*  them into data.
 */
 template <typename T>
 struct DataSet{
@@ -52,10 +101,124 @@ struct DataSet{
                         //use a custom allocator if we want
   double sampleRate;
   double timeStamp;
+  std::vector< DataSegment<T> > segments;  ///< The contents of a view (empty otherwise).
+  boost::shared_ptr< std::vector<T> > storage;  ///< Storage handed to views by share().
 
   //! Constructor initializes our variables
   DataSet(int l=10, double s=0, double t=0)
     :data(l), sampleRate(s), timeStamp(t){}
+
+  //! Is this DataSet a view of shared segments?
+  bool isView() const
+  { return !segments.empty(); }
+
+  //! Get the number of elements in this DataSet
+  std::size_t size() const
+  {
+    if(segments.empty())
+      return data.size();
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < segments.size(); ++i)
+      n += segments[i].length;
+    return n;
+  }
+
+  //! Get an element of this DataSet
+  const T& at(std::size_t index) const
+  {
+    if(segments.empty())
+      return data.at(index);
+    for(std::size_t i = 0; i < segments.size(); ++i)
+    {
+      if(index < segments[i].length)
+        return segments[i].begin()[index];
+      index -= segments[i].length;
+    }
+    throw InvalidDataException("DataSet index out of range");
+  }
+
+  //! Copy the contents of this DataSet to an output iterator
+  template <class OutputIterator>
+  OutputIterator copyTo(OutputIterator out) const
+  {
+    if(segments.empty())
+      return std::copy(data.begin(), data.end(), out);
+    for(std::size_t i = 0; i < segments.size(); ++i)
+      out = std::copy(segments[i].begin(), segments[i].end(), out);
+    return out;
+  }
+
+  /** Share the contents of this DataSet so that other DataSets can refer to them.
+  *
+  *   The data vector is swapped (not copied) into shared storage and this
+  *   DataSet becomes a view of it. The storage is kept with the DataSet - once
+  *   no view refers to it, the next share() swaps it back into data, so a
+  *   DataSet which is shared every time it is written does not allocate.
+  *
+  *   \return The segments holding the contents of this DataSet.
+  */
+  const std::vector< DataSegment<T> >& share()
+  {
+    if(segments.empty())
+    {
+      if(!storage || !storage.unique())
+        storage.reset(new std::vector<T>());
+      storage->swap(data);
+      data.clear();
+      segments.push_back(DataSegment<T>(storage, 0, storage->size()));
+    }
+    return segments;
+  }
+
+  /** Append a segment of shared data to this view
+  *
+  *   A DataSet holds either data or segments. Appending the first segment
+  *   makes this DataSet a view and discards anything in data - share() the
+  *   data first to keep it.
+  */
+  void appendSegment(const DataSegment<T>& segment)
+  {
+    if(segments.empty())
+      data.clear();
+    if(segment.length > 0)
+      segments.push_back(segment);
+  }
+
+  /** Append part of another DataSet to this view without copying it.
+  *
+  *   \param other   The DataSet to refer to - it is shared if necessary.
+  *   \param offset  Index of the first element of other to refer to.
+  *   \param length  Number of elements to refer to.
+  */
+  void appendView(DataSet<T>& other, std::size_t offset, std::size_t length)
+  {
+    if(offset > other.size() || length > other.size() - offset)
+      throw InvalidDataException("DataSet view out of range");
+    const std::vector< DataSegment<T> >& src = other.share();
+    for(std::size_t i = 0; i < src.size() && length > 0; ++i)
+    {
+      if(offset >= src[i].length)
+      {
+        offset -= src[i].length;
+        continue;
+      }
+      std::size_t n = std::min(length, src[i].length - offset);
+      appendSegment(DataSegment<T>(src[i].storage, src[i].offset + offset, n));
+      length -= n;
+      offset = 0;
+    }
+  }
+
+  //! Copy the contents of a view into data, so this is no longer a view
+  void flatten()
+  {
+    if(segments.empty())
+      return;
+    std::vector<T> flat(size());
+    copyTo(flat.begin());
+    data.swap(flat);
+    segments.clear();
+  }
 };
 
 /** The DataBufferBase class allows us to store vectors of DataBuffers of different types
@@ -72,6 +235,15 @@ public:
   virtual void setLinkDescription(LinkDescription desc) = 0;
   virtual LinkDescription getLinkDescription() const = 0;
   virtual bool hasData() const = 0;
+
+  /** Get the timestamp of the next DataSet to be read, without reading it.
+  *
+  *   \param timeStamp  Set to the timestamp if there is data.
+  *   \param wait       Block until there is data? Buffers which are written by
+  *                     the thread which reads them throw rather than wait forever.
+  *   \return Whether there was data.
+  */
+  virtual bool getNextTimeStamp(double& timeStamp, bool wait) = 0;
 };
 
 /** The ReadBufferBase class allows us to store vectors of ReadBuffers of different types
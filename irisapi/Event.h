@@ -34,17 +34,48 @@
 #ifndef IRISAPI_EVENT_H_
 #define IRISAPI_EVENT_H_
 
+#include <cstring>
+#include <string>
 #include <vector>
 #include <boost/any.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/for_each.hpp>
+
+#include "irisapi/Exceptions.h"
+#include "irisapi/TypeInfo.h"
 
 namespace iris
 {
 
+/// The names of an event registered with the core - see Event::eventId.
+struct EventSource
+{
+  int id;                     ///< The id of the event.
+  std::string eventName;      ///< The name of the event.
+  std::string componentName;  ///< The name of the component which activates it.
+};
+
+/** Values passed with an event, held inline so that no memory is allocated.
+ *
+ * Large enough for four doubles or a single std::complex<long double>.
+ */
+struct EventValue
+{
+  static const std::size_t capacity = 32;   ///< Bytes available.
+  boost::uint64_t storage[capacity / 8];    ///< The values.
+  unsigned count;                           ///< Number of values held.
+};
+
 /** Event objects which can be activated by Components.
  *
  * Events can be registered and activated by Components to notify
  * Controllers that something has happened. This permits a Controller
  * to take action such as reconfiguring the radio.
+ *
+ * Components pass up to EventValue::capacity bytes of data inline in
+ * value and give the id registered for the event instead of its names.
+ * The Controller fills in the names and moves the values into data
+ * before processEvent() is called, so both can be read there.
  */
 struct Event
 {
@@ -52,9 +83,85 @@ struct Event
   int typeId;                     ///< The type of data being passed.
   std::string eventName;          ///< The name of this event.
   std::string componentName;      ///< The name of the component which created it.
+  int eventId;                    ///< Id registered for the event by the core, -1 if none.
+  EventValue value;               ///< Data held inline - see unpack().
+
+  Event()
+    :typeId(-1), eventId(-1)
+  {
+    value.count = 0;
+  }
+
+  /** Hold values inline.
+   *
+   * \param values   The values.
+   * \param n        Number of values.
+   * \return False if the values do not fit.
+   */
+  template<typename T>
+  bool setValues(const T* values, std::size_t n)
+  {
+    if(n == 0 || n * sizeof(T) > EventValue::capacity)
+      return false;
+    std::memcpy(value.storage, values, n * sizeof(T));
+    value.count = n;
+    typeId = TypeInfo<T>::identifier;
+    return true;
+  }
+
+  /// Get the number of values passed with the event.
+  std::size_t size() const
+  {
+    return value.count > 0 ? value.count : data.size();
+  }
+
+  /// Get value i without converting it - T must match typeId.
+  template<typename T>
+  T get(std::size_t i = 0) const
+  {
+    if(TypeInfo<T>::identifier != typeId)
+      throw InvalidDataTypeException("Event data type does not match the type requested");
+    if(value.count == 0)
+      return boost::any_cast<T>(data.at(i));
+    if(i >= value.count)
+      throw InvalidDataException("Event value index out of range");
+
+    T v;
+    std::memcpy(&v, reinterpret_cast<const char*>(value.storage) + i * sizeof(T), sizeof(T));
+    return v;
+  }
+
+  /// Move values held inline into data.
+  inline void unpack();
 };
 
+namespace detail {
+/// Moves the inline values of an event into its data - used with boost::mpl::for_each.
+struct EventUnpacker
+{
+  Event& e;
+  explicit EventUnpacker(Event& event) : e(event) {}
+
+  template<typename T>
+  void operator()(T)
+  {
+    if(TypeInfo<T>::identifier != e.typeId)
+      return;
+    for(std::size_t i = 0; i < e.value.count; ++i)
+      e.data.push_back(boost::any(e.get<T>(i)));
+  }
+};
+} // namespace detail
+
+inline void Event::unpack()
+{
+  if(value.count == 0)
+    return;
+  data.clear();
+  boost::mpl::for_each<IrisDataTypes>(detail::EventUnpacker(*this));
+  value.count = 0;
+}
+
 } /* namespace iris */
 
 #endif /* IRISAPI_EVENT_H_ */
-
@@ -0,0 +1,354 @@
+/**
+ * \file EventChannel.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Delivery policies for events passed to controllers and the channels
+ * which enforce them.
+ */
+
+#ifndef IRISAPI_EVENTCHANNEL_H_
+#define IRISAPI_EVENTCHANNEL_H_
+
+#include <vector>
+#include <algorithm>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/chrono/chrono.hpp>
+
+#include "irisapi/Event.h"
+#include "irisapi/Exceptions.h"
+
+namespace iris
+{
+
+/** How events are passed to a controller which subscribes to them.
+ *
+ * By default every event is queued for the controller. Policies can be
+ * combined, e.g. a maximum rate with batching - but a subscription which
+ * only wants the latest value cannot be batched.
+ */
+struct EventPolicy
+{
+  bool latestOnly;      ///< Newer events replace an event which is still waiting.
+  double maxRate;       ///< Maximum events per second - 0 for no limit.
+  unsigned batchSize;   ///< Number of events passed together to Controller::processEvents().
+  double maxDelay;      ///< Longest time in seconds a partial batch is held - 0 to wait until it is full.
+
+  EventPolicy()
+    :latestOnly(false), maxRate(0), batchSize(1), maxDelay(0)
+  {}
+
+  /// Only pass the latest value of the event.
+  static EventPolicy latest()
+  {
+    EventPolicy p;
+    p.latestOnly = true;
+    return p;
+  }
+
+  /// Drop events which arrive faster than eventsPerSecond.
+  static EventPolicy rate(double eventsPerSecond)
+  {
+    EventPolicy p;
+    p.maxRate = eventsPerSecond;
+    return p;
+  }
+
+  /// Pass events in batches of n, or fewer once the first has waited maxDelay seconds.
+  static EventPolicy batch(unsigned n, double maxDelay = 0.1)
+  {
+    EventPolicy p;
+    p.batchSize = n;
+    p.maxDelay = maxDelay;
+    return p;
+  }
+
+  /// Does this policy change how events are delivered?
+  bool isDefault() const
+  {
+    return !latestOnly && maxRate <= 0 && batchSize <= 1;
+  }
+};
+
+/** Enforces an EventPolicy for one subscription of a controller.
+ *
+ * Events are filtered on the thread which activates them, before they are
+ * queued for the controller. Latest-only and batched events are held in two
+ * buffers which are allocated when the subscription is made: the activating
+ * thread fills one while the controller takes the other, so only the type
+ * and inline value of an event are copied while the lock is held. Events
+ * which do not fit inline are copied before the lock is taken.
+ *
+ * A partial batch is queued once its first event has been held for
+ * EventPolicy::maxDelay - the controller arms a flush timer when store()
+ * asks for one. Events which are filtered out are counted.
+ */
+class EventChannel
+  : boost::noncopyable
+{
+public:
+  /// What the controller must do after an event was stored or flushed.
+  enum StoreResult
+  {
+    HELD,         ///< Nothing - the event waits in the channel.
+    QUEUE,        ///< Queue the channel for the controller.
+    ARM_FLUSH     ///< Arm a timer which calls flush().
+  };
+
+  /** Create a channel
+   *
+   * \param source   The event - must outlive the channel.
+   * \param policy   The delivery policy.
+   */
+  EventChannel(const EventSource* source, const EventPolicy& policy)
+    :source_(source)
+    ,policy_(policy)
+    ,interval_(0)
+    ,maxDelay_((boost::int64_t)(policy.maxDelay * 1e9))
+    ,lastAdmitted_(0)
+    ,pending_(policy.latestOnly ? 1 : policy.batchSize)
+    ,spare_(pending_.size())
+    ,count_(0)
+    ,firstHeld_(0)
+    ,queued_(false)
+    ,armed_(false)
+    ,dropped_(0)
+  {
+    if(policy.latestOnly && policy.batchSize > 1)
+      throw InvalidDataException("Events which pass only the latest value cannot be batched");
+    if(policy.batchSize == 0)
+      throw InvalidDataException("Event batch size must be at least 1");
+    if(policy.maxRate > 0)
+    {
+      interval_ = (boost::int64_t)(1e9 / policy.maxRate);
+      lastAdmitted_ = now() - interval_;
+    }
+  }
+
+  ~EventChannel()
+  {
+    for(std::size_t i = 0; i < pending_.size(); ++i)
+    {
+      delete pending_[i].overflow;
+      delete spare_[i].overflow;
+    }
+  }
+
+  const EventSource* getSource() const
+  {
+    return source_;
+  }
+
+  const EventPolicy& getPolicy() const
+  {
+    return policy_;
+  }
+
+  /// Are events held in the channel rather than queued one by one?
+  bool isBuffered() const
+  {
+    return policy_.latestOnly || policy_.batchSize > 1;
+  }
+
+  /// Number of events which were dropped or replaced.
+  unsigned long getDropped() const
+  {
+    return dropped_.load(boost::memory_order_relaxed);
+  }
+
+  /** Apply the rate limit - called by the activating thread.
+   *
+   * \return  false if the event must be dropped.
+   */
+  bool admit()
+  {
+    if(interval_ == 0)
+      return true;
+
+    boost::int64_t t = now();
+    boost::int64_t last = lastAdmitted_.load(boost::memory_order_relaxed);
+    //If another thread admits an event at the same time, only one wins
+    if(t - last < interval_ || !lastAdmitted_.compare_exchange_strong(last, t))
+    {
+      dropped_.fetch_add(1, boost::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  /** Hold an event until the controller takes it - called by the activating thread.
+   *
+   * \return  QUEUE if the channel must be queued for the controller, ARM_FLUSH
+   *          if a partial batch was started and no flush timer is armed.
+   */
+  StoreResult store(const Event& e)
+  {
+    HeldEvent held;
+    held.typeId = e.typeId;
+    held.value = e.value;
+    held.overflow = e.value.count == 0 ? new Event(e) : NULL;
+
+    StoreResult result = HELD;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if(count_ < pending_.size())
+      {
+        if(count_ == 0 && maxDelay_ > 0)
+          firstHeld_ = now();
+        pending_[count_++] = held;
+        held.overflow = NULL;
+      }
+      else
+      {
+        //A latest-only event replaces the waiting one; a full batch is kept
+        if(policy_.latestOnly)
+          std::swap(pending_[0], held);
+        dropped_.fetch_add(1, boost::memory_order_relaxed);
+      }
+
+      if(!queued_ && count_ == pending_.size())
+      {
+        queued_ = true;
+        result = QUEUE;
+      }
+      else if(!queued_ && !armed_ && count_ == 1 && maxDelay_ > 0)
+      {
+        armed_ = true;
+        result = ARM_FLUSH;
+      }
+    }
+
+    //Release a dropped or replaced copy without holding the lock
+    delete held.overflow;
+    return result;
+  }
+
+  /** Check a partial batch when its flush timer expires - called by the controller thread.
+   *
+   * \param wait  Set to the time left in ns if the held events are not yet due.
+   * \return  QUEUE if the channel must be queued now, ARM_FLUSH if the timer
+   *          must be armed again for wait ns, HELD if there is nothing to do.
+   */
+  StoreResult flush(boost::int64_t& wait)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if(count_ == 0 || queued_)
+    {
+      armed_ = false;
+      return HELD;
+    }
+    //The timer may have been armed for an earlier batch
+    wait = firstHeld_ + maxDelay_ - now();
+    if(wait > 0)
+      return ARM_FLUSH;
+    armed_ = false;
+    queued_ = true;
+    return QUEUE;
+  }
+
+  /** Take the held events - called by the controller thread.
+   *
+   * \param events   Filled with the events, in the order they were activated.
+   *                 Names are left for the caller to fill in.
+   */
+  void take(std::vector<Event>& events)
+  {
+    std::size_t n;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      pending_.swap(spare_);
+      n = count_;
+      count_ = 0;
+      queued_ = false;
+    }
+
+    events.resize(n);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+      HeldEvent& held = spare_[i];
+      if(held.overflow != NULL)
+      {
+        events[i] = *held.overflow;
+        delete held.overflow;
+        held.overflow = NULL;
+        continue;
+      }
+      events[i].typeId = held.typeId;
+      events[i].value = held.value;
+    }
+  }
+
+  /// Called if the channel could not be queued, so that it will be queued again.
+  void unqueue()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    queued_ = false;
+  }
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  /// An event waiting in the channel.
+  struct HeldEvent
+  {
+    int typeId;           ///< Type of data passed with the event.
+    EventValue value;     ///< Data held inline.
+    Event* overflow;      ///< Copy of the event if it is not held inline.
+
+    HeldEvent() : typeId(-1), overflow(NULL) {}
+  };
+
+  static boost::int64_t now()
+  {
+    return boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+  }
+
+  const EventSource* source_;
+  EventPolicy policy_;
+  boost::int64_t interval_;                     ///< Minimum time between events, in ns.
+  boost::int64_t maxDelay_;                     ///< Longest time a partial batch is held, in ns.
+  boost::atomic<boost::int64_t> lastAdmitted_;  ///< Time the last event was admitted, in ns.
+
+  std::vector<HeldEvent> pending_;  ///< Events being filled in - never resized.
+  std::vector<HeldEvent> spare_;    ///< Events last taken by the controller - swapped with pending_.
+  std::size_t count_;               ///< Number of held events.
+  boost::int64_t firstHeld_;        ///< Time the first held event was stored, in ns.
+  bool queued_;                     ///< Is the channel waiting in the controller's queue?
+  bool armed_;                      ///< Is a flush timer waiting to expire?
+  boost::atomic<unsigned long> dropped_;
+  boost::mutex mutex_;              ///< Guards pending_, count_, firstHeld_, queued_ and armed_.
+};
+
+} /* namespace iris */
+
+#endif /* IRISAPI_EVENTCHANNEL_H_ */
@@ -35,6 +35,7 @@
 #define IRISAPI_LINKDESCRIPTION_H_
 
 #include <string>
+#include <cstddef>
 #include <boost/shared_ptr.hpp>
 
 namespace iris{
@@ -42,6 +43,14 @@ namespace iris{
 // Forward declaration
 class DataBufferBase;
 
+/// What a buffer within an engine does when it reaches its capacity.
+enum BufferPolicy
+{
+  POLICY_GROW,          ///< Grow up to the capacity, then hold back the writer.
+  POLICY_BACKPRESSURE,  ///< Allocate the full capacity and hold back the writer when full.
+  POLICY_DROP           ///< Allocate the full capacity and overwrite the oldest data when full.
+};
+
 /// A link between two components
 struct LinkDescription
 {
@@ -52,6 +61,12 @@ struct LinkDescription
   std::string sinkComponent;    ///< Name of the sink component.
   std::string sourcePort;       ///< Name of the source port.
   std::string sinkPort;         ///< Name of the sink port.
+  std::size_t bufferCapacity;   ///< Max number of DataSets in the link buffer (0 for the engine default).
+  BufferPolicy bufferPolicy;    ///< What the link buffer does when it reaches its capacity.
+
+  LinkDescription()
+    :bufferCapacity(0), bufferPolicy(POLICY_GROW)
+  {}
 
   /// Check if two LinkDescriptions are identical.
   bool operator==(const LinkDescription& link) const
@@ -0,0 +1,156 @@
+/**
+ * \file LogQueue.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A bounded lock-free queue of log records.
+ */
+
+#ifndef IRISAPI_LOGQUEUE_H_
+#define IRISAPI_LOGQUEUE_H_
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/utility.hpp>
+
+#include "irisapi/LogRecord.h"
+
+namespace iris
+{
+
+/** A bounded queue of LogRecords for many writers and a single reader.
+ *
+ * The slots are allocated when the queue is created. Each slot carries a
+ * sequence number which tells writers when it is free and the reader when
+ * it has been filled, so neither side takes a lock. Records are swapped in
+ * and out of the slots, so text held in a record is never copied.
+ */
+class LogQueue
+  : boost::noncopyable
+{
+public:
+  /** Create a LogQueue
+   *
+   * \param capacity  Number of records held - rounded up to a power of two.
+   */
+  explicit LogQueue(std::size_t capacity)
+    :capacity_(1)
+    ,enqueuePos_(0)
+    ,dequeuePos_(0)
+  {
+    while(capacity_ < capacity)
+      capacity_ <<= 1;
+    slots_.reset(new Slot[capacity_]);
+    for(std::size_t i = 0; i < capacity_; ++i)
+      slots_[i].sequence.store(i, boost::memory_order_relaxed);
+  }
+
+  std::size_t capacity() const { return capacity_; }
+
+  /** Add a record - may be called from any thread.
+   *
+   * \param record    The record - its contents are swapped into the queue.
+   * \param position  Set to the position of the record in the queue.
+   * \return false if the queue is full.
+   */
+  bool push(LogRecord& record, boost::uint64_t& position)
+  {
+    boost::uint64_t pos = enqueuePos_.load(boost::memory_order_relaxed);
+    Slot* slot;
+    while(true)
+    {
+      slot = &slots_[pos & (capacity_ - 1)];
+      boost::uint64_t seq = slot->sequence.load(boost::memory_order_acquire);
+      boost::int64_t diff = (boost::int64_t)seq - (boost::int64_t)pos;
+      if(diff == 0)
+      {
+        if(enqueuePos_.compare_exchange_weak(pos, pos + 1, boost::memory_order_relaxed))
+          break;
+      }
+      else if(diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = enqueuePos_.load(boost::memory_order_relaxed);
+      }
+    }
+    slot->record.swap(record);
+    slot->sequence.store(pos + 1, boost::memory_order_release);
+    position = pos;
+    return true;
+  }
+
+  /** Take the oldest record - must only be called by the reader.
+   *
+   * \param record    Filled with the record.
+   * \return false if the queue is empty.
+   */
+  bool pop(LogRecord& record)
+  {
+    boost::uint64_t pos = dequeuePos_.load(boost::memory_order_relaxed);
+    Slot& slot = slots_[pos & (capacity_ - 1)];
+    boost::uint64_t seq = slot.sequence.load(boost::memory_order_acquire);
+    if((boost::int64_t)seq - (boost::int64_t)(pos + 1) < 0)
+      return false;
+    record.swap(slot.record);
+    slot.sequence.store(pos + capacity_, boost::memory_order_release);
+    dequeuePos_.store(pos + 1, boost::memory_order_release);
+    return true;
+  }
+
+  /// Number of records which have been added.
+  boost::uint64_t pushed() const
+  {
+    return enqueuePos_.load(boost::memory_order_acquire);
+  }
+
+  /// Number of records which have been taken.
+  boost::uint64_t popped() const
+  {
+    return dequeuePos_.load(boost::memory_order_acquire);
+  }
+
+private:
+  struct Slot
+  {
+    boost::atomic<boost::uint64_t> sequence;
+    LogRecord record;
+  };
+
+  std::size_t capacity_;
+  boost::scoped_array<Slot> slots_;
+  boost::atomic<boost::uint64_t> enqueuePos_;
+  boost::atomic<boost::uint64_t> dequeuePos_;
+};
+
+} // namespace iris
+
+#endif // IRISAPI_LOGQUEUE_H_
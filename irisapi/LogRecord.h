@@ -0,0 +1,206 @@
+/**
+ * \file LogRecord.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Log messages held as binary arguments until they are written.
+ */
+
+#ifndef IRISAPI_LOGRECORD_H_
+#define IRISAPI_LOGRECORD_H_
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace iris
+{
+
+/// The log levels available for logging
+enum LogLevel {LDEBUG, LINFO, LWARNING, LERROR, LFATAL};
+
+/// Types of the arguments held in a LogRecord
+enum LogArgType
+{
+  LOG_ARG_BOOL,
+  LOG_ARG_CHAR,
+  LOG_ARG_INT,
+  LOG_ARG_UINT,
+  LOG_ARG_LONG,
+  LOG_ARG_ULONG,
+  LOG_ARG_LLONG,
+  LOG_ARG_ULLONG,
+  LOG_ARG_FLOAT,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_STRING,         ///< Length (uint16) followed by the characters.
+  LOG_ARG_MANIPULATOR,    ///< std::ostream& (*)(std::ostream&), e.g. std::endl.
+  LOG_ARG_IOS_MANIPULATOR ///< std::ios_base& (*)(std::ios_base&), e.g. std::hex.
+};
+
+/** A log message waiting to be written.
+ *
+ * Values streamed into a message are copied into the record in binary
+ * form, each preceded by its type. They are only converted to text by
+ * format(), which is called by the thread which writes the message.
+ * Values which cannot be held in binary form - or which don't fit - are
+ * formatted straight away and held in text.
+ */
+struct LogRecord
+{
+  enum { ARGS_CAPACITY = 200 };   ///< Bytes available for binary arguments.
+
+  LogLevel level;
+  boost::posix_time::ptime time;  ///< When the message was logged (UTC).
+  std::string text;               ///< The formatted message, if it is not held in args.
+  std::size_t argsSize;           ///< Bytes used in args.
+  unsigned char args[ARGS_CAPACITY];
+
+  LogRecord() : level(LINFO), argsSize(0) {}
+
+  /// Exchange contents without copying the text.
+  void swap(LogRecord& other)
+  {
+    std::swap(level, other.level);
+    std::swap(time, other.time);
+    text.swap(other.text);
+    std::swap(argsSize, other.argsSize);
+    std::swap_ranges(args, args + std::max(argsSize, other.argsSize), other.args);
+  }
+
+  /// Remove all arguments and text.
+  void clear()
+  {
+    text.clear();
+    argsSize = 0;
+  }
+
+  /// Add a value - returns false if there is no room.
+  template<typename T>
+  bool append(LogArgType type, const T& value)
+  {
+    if(argsSize + 1 + sizeof(T) > ARGS_CAPACITY)
+      return false;
+    args[argsSize++] = (unsigned char)type;
+    std::memcpy(args + argsSize, &value, sizeof(T));
+    argsSize += sizeof(T);
+    return true;
+  }
+
+  /// Add a string - returns false if there is no room.
+  bool appendString(const char* str, std::size_t length)
+  {
+    if(argsSize + 3 + length > ARGS_CAPACITY)
+      return false;
+    boost::uint16_t len = (boost::uint16_t)length;
+    args[argsSize++] = (unsigned char)LOG_ARG_STRING;
+    std::memcpy(args + argsSize, &len, sizeof(len));
+    std::memcpy(args + argsSize + sizeof(len), str, length);
+    argsSize += sizeof(len) + length;
+    return true;
+  }
+
+  /// Write the binary arguments to a stream.
+  void decode(std::ostream& os) const
+  {
+    std::size_t i = 0;
+    while(i < argsSize)
+    {
+      LogArgType type = (LogArgType)args[i++];
+      switch(type)
+      {
+      case LOG_ARG_BOOL:            i += put<bool>(os, i); break;
+      case LOG_ARG_CHAR:            i += put<char>(os, i); break;
+      case LOG_ARG_INT:             i += put<int>(os, i); break;
+      case LOG_ARG_UINT:            i += put<unsigned int>(os, i); break;
+      case LOG_ARG_LONG:            i += put<long>(os, i); break;
+      case LOG_ARG_ULONG:           i += put<unsigned long>(os, i); break;
+      case LOG_ARG_LLONG:           i += put<long long>(os, i); break;
+      case LOG_ARG_ULLONG:          i += put<unsigned long long>(os, i); break;
+      case LOG_ARG_FLOAT:           i += put<float>(os, i); break;
+      case LOG_ARG_DOUBLE:          i += put<double>(os, i); break;
+      case LOG_ARG_MANIPULATOR:     i += put<std::ostream& (*)(std::ostream&)>(os, i); break;
+      case LOG_ARG_IOS_MANIPULATOR: i += put<std::ios_base& (*)(std::ios_base&)>(os, i); break;
+      case LOG_ARG_STRING:
+        {
+          boost::uint16_t len;
+          std::memcpy(&len, args + i, sizeof(len));
+          os.write((const char*)args + i + sizeof(len), len);
+          i += sizeof(len) + len;
+          break;
+        }
+      default:
+        return;
+      }
+    }
+  }
+
+  /** Append the complete line to a string - level, message and newline.
+   *
+   * \param out       The string to append to.
+   * \param scratch   Stream used to format the arguments - its contents
+   *                  and format flags are reset first.
+   */
+  void format(std::string& out, std::ostringstream& scratch) const
+  {
+    static const char* const prefixes[] = {"[DEBUG]   ", "[INFO]    ", "[WARNING] ", "[ERROR]   ", "[FATAL]   "};
+    out += prefixes[level];
+    if(argsSize == 0)
+    {
+      out += text;
+    }
+    else
+    {
+      static const std::ostringstream blank;
+      scratch.str("");
+      scratch.clear();
+      scratch.copyfmt(blank);
+      decode(scratch);
+      out += scratch.str();
+    }
+    out += '\n';
+  }
+
+private:
+  template<typename T>
+  std::size_t put(std::ostream& os, std::size_t i) const
+  {
+    T value;
+    std::memcpy(&value, args + i, sizeof(T));
+    os << value;
+    return sizeof(T);
+  }
+};
+
+} // namespace iris
+
+#endif // IRISAPI_LOGRECORD_H_
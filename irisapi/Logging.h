@@ -42,48 +42,359 @@
 
 #include <sstream>
 #include <string>
+#include <map>
 #include <cstdio>
+#include <cstring>
 
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
 #include <boost/utility.hpp>
 
+#include "irisapi/LogQueue.h"
+
 namespace iris
 {
 
 /// Get the current time
 inline std::string NowTime();
 
-/// The log levels available for logging
-enum LogLevel {LDEBUG, LINFO, LWARNING, LERROR, LFATAL};
+/// What to do with a message when the queue of an asynchronous LoggingPolicy is full
+enum LogOverflowPolicy
+{
+  LOG_DROP,   ///< Drop the message - the number dropped is logged later.
+  LOG_BLOCK   ///< Wait until the writer thread has made space.
+};
+
+/// The reporting level of a named logger, shared with the objects which log under that name
+typedef boost::atomic<int> LogLevelSlot;
 
 /** The logging policy. This class determines the output streams of the logging element.
 *
 *   Logger objects use a policy to determine the output streams.
 *   The default output stream is stderr. A log file can be created by setting the file stream.
+*
+*   By default, messages are written by the thread which logs them. In
+*   asynchronous mode, messages are passed through a LogQueue to a writer
+*   thread, which writes them in batches - so logging never waits for the
+*   console or disk. Fatal messages are always written before the LOG
+*   statement returns.
+*
+*   Components, engines and controllers can be given their own reporting
+*   level with setLevel(). Each of them looks up its LogLevelSlot once and
+*   then checks it with a single load - levels are resolved (own level,
+*   then parent level, then the global level) when they are set, not when
+*   messages are logged.
 */
 class LoggingPolicy
 {
 private:
-  boost::mutex mutex_;
+  /// A named reporting level
+  struct NamedLevel
+  {
+    boost::shared_ptr< LogLevelSlot > slot;   ///< The level in effect for this name.
+    int level;                                ///< Level set for this name, or -1 to inherit.
+    std::string parent;                       ///< Name to inherit from (e.g. the engine of a component).
+    NamedLevel() : slot(new LogLevelSlot(LDEBUG)), level(-1) {}
+  };
+
+  boost::mutex mutex_;    ///< Guards the streams.
   FILE* consoleStream;
   FILE* fileStream;
-  LogLevel reportingLevel;
+  boost::atomic<int> reportingLevel;
+
+  boost::mutex levelMutex_;                       ///< Guards namedLevels_.
+  std::map< std::string, NamedLevel > namedLevels_;
+
+  boost::scoped_ptr< LogQueue > queue_;           ///< Messages waiting for the writer thread.
+  boost::scoped_ptr< boost::thread > writer_;     ///< Writes queued messages.
+  boost::atomic<bool> async_;                     ///< Are messages queued for the writer thread?
+  boost::atomic<bool> stopping_;
+  boost::atomic<bool> writerWaiting_;
+  boost::atomic<unsigned long> dropped_;          ///< Messages dropped because the queue was full.
+  unsigned long reportedDrops_;                   ///< Dropped messages which have been reported in the log.
+  boost::atomic<boost::uint64_t> written_;        ///< Number of queued messages which have been written.
+  LogOverflowPolicy overflowPolicy_;
+  boost::mutex writerMutex_;
+  boost::condition_variable wakeWriter_;
+  boost::condition_variable batchWritten_;        ///< Notified after each batch is written.
 
 public:
   LoggingPolicy()
     : consoleStream(stderr),
     fileStream(NULL),
-    reportingLevel(LDEBUG)
+    reportingLevel(LDEBUG),
+    async_(false),
+    stopping_(false),
+    writerWaiting_(false),
+    dropped_(0),
+    reportedDrops_(0),
+    written_(0),
+    overflowPolicy_(LOG_DROP)
   {}
 
+  ~LoggingPolicy()
+  {
+    setAsynchronous(false);
+  }
+
   static LoggingPolicy* getPolicyInstance()
   {
     static LoggingPolicy thePolicy;
     return &thePolicy;
   }
 
+  /// Write a message - kept for callers which don't give a level.
   void output(const std::string& msg)
+  {
+    LogRecord record;
+    record.level = LINFO;
+    record.text = msg;
+    output(record);
+  }
+
+  /** Write a message
+  *
+  *   In asynchronous mode the record is queued for the writer thread,
+  *   which converts its arguments to text. Otherwise it is converted and
+  *   written straight away.
+  *
+  *   \param record  The message - its contents are taken.
+  */
+  void output(LogRecord& record)
+  {
+    LogLevel level = record.level;
+    if(!async_.load(boost::memory_order_acquire))
+    {
+      std::string msg;
+      std::ostringstream scratch;
+      record.format(msg, scratch);
+      write(msg, NowTime());
+      return;
+    }
+
+    record.time = boost::posix_time::microsec_clock::universal_time();
+    boost::uint64_t position;
+    while(!queue_->push(record, position))
+    {
+      if(overflowPolicy_ == LOG_DROP && level < LFATAL)
+      {
+        dropped_.fetch_add(1, boost::memory_order_relaxed);
+        return;
+      }
+      wakeUpWriter();
+      boost::this_thread::yield();
+    }
+
+    if(level >= LFATAL)
+    {
+      wakeUpWriter();
+      waitForWriter(position + 1);
+    }
+    else if(writerWaiting_.load(boost::memory_order_relaxed))
+    {
+      wakeUpWriter();
+    }
+  }
+
+  /** Switch asynchronous logging on or off
+  *
+  *   Switching it off writes all queued messages and stops the writer thread.
+  *
+  *   \param async     Queue messages for a writer thread?
+  *   \param capacity  Number of messages which can be queued - it can only be
+  *                    changed while no other thread is logging.
+  */
+  void setAsynchronous(bool async, std::size_t capacity = 8192)
+  {
+    if(async == (bool)writer_)
+      return;
+
+    if(async)
+    {
+      if(!queue_ || queue_->capacity() != capacity)
+      {
+        queue_.reset(new LogQueue(capacity));
+        written_ = 0;
+      }
+      stopping_ = false;
+      writer_.reset(new boost::thread(boost::bind(&LoggingPolicy::writerLoop, this)));
+      async_.store(true, boost::memory_order_release);
+    }
+    else
+    {
+      async_.store(false, boost::memory_order_release);
+      stopping_ = true;
+      wakeUpWriter();
+      writer_->join();
+      writer_.reset();
+    }
+  }
+
+  /// Are messages written by a writer thread?
+  bool isAsynchronous() const
+  {
+    return async_.load();
+  }
+
+  /// Set what happens to messages when the queue is full.
+  void setOverflowPolicy(LogOverflowPolicy policy)
+  {
+    overflowPolicy_ = policy;
+  }
+
+  /// Get the number of messages which were dropped because the queue was full.
+  unsigned long getDropped() const
+  {
+    return dropped_.load();
+  }
+
+  /// Wait until all queued messages have been written.
+  void flush()
+  {
+    if(async_.load(boost::memory_order_acquire))
+    {
+      wakeUpWriter();
+      waitForWriter(queue_->pushed());
+    }
+  }
+
+  /// Set the console stream (NULL to switch off console output)
+  void setConsoleStream(FILE* pFile)
+  {
+    flush();
+    boost::mutex::scoped_lock lock(mutex_);
+    consoleStream = pFile;
+  }
+
+  void setFileStream(FILE* pFile)
+  {
+    //Queued messages go to the stream they were logged for
+    flush();
+    boost::mutex::scoped_lock lock(mutex_);
+    fileStream = pFile;
+  }
+
+  /// Reference to the global reporting level, which keeps named levels up to date when assigned.
+  class LevelReference
+  {
+  public:
+    explicit LevelReference(LoggingPolicy& policy) : policy_(policy) {}
+    LevelReference& operator=(LogLevel level)
+    {
+      policy_.setReportingLevel(level);
+      return *this;
+    }
+    operator LogLevel() const { return policy_.getReportingLevel(); }
+  private:
+    LoggingPolicy& policy_;
+  };
+
+  /// Get and/or set the reporting level - anything below this level is ignored
+  LevelReference ReportingLevel()
+  {
+    return LevelReference(*this);
+  }
+
+  /// Get the global reporting level
+  LogLevel getReportingLevel() const
+  {
+    return (LogLevel)reportingLevel.load(boost::memory_order_relaxed);
+  }
+
+  /// Set the global reporting level - used by all names without a level of their own
+  void setReportingLevel(LogLevel level)
+  {
+    boost::mutex::scoped_lock lock(levelMutex_);
+    reportingLevel.store(level);
+    updateLevels();
+  }
+
+  /** Get the level slot for a name - the slot stays valid for the life of the policy.
+  *
+  *   \param name  Name of the component, engine or controller.
+  */
+  const LogLevelSlot* getLevelSlot(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(levelMutex_);
+    std::map< std::string, NamedLevel >::iterator it = namedLevels_.find(name);
+    if(it == namedLevels_.end())
+    {
+      it = namedLevels_.insert(std::make_pair(name, NamedLevel())).first;
+      it->second.slot->store(resolveLevel(it->second));
+    }
+    return it->second.slot.get();
+  }
+
+  /// Set the reporting level for a name (and anything which inherits from it)
+  void setLevel(const std::string& name, LogLevel level)
+  {
+    boost::mutex::scoped_lock lock(levelMutex_);
+    namedLevels_[name].level = level;
+    updateLevels();
+  }
+
+  /// Remove the reporting level of a name - it inherits a level again
+  void clearLevel(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(levelMutex_);
+    std::map< std::string, NamedLevel >::iterator it = namedLevels_.find(name);
+    if(it == namedLevels_.end())
+      return;
+    it->second.level = -1;
+    updateLevels();
+  }
+
+  /// Get the reporting level in effect for a name
+  LogLevel getLevel(const std::string& name)
+  {
+    return (LogLevel)getLevelSlot(name)->load();
+  }
+
+  /** Let a name inherit the level of another one.
+  *
+  *   Engines use this so that the level of an engine applies to its components.
+  *   \param name    The inheriting name.
+  *   \param parent  The name to inherit from.
+  */
+  void setParent(const std::string& name, const std::string& parent)
+  {
+    boost::mutex::scoped_lock lock(levelMutex_);
+    namedLevels_[name].parent = parent;
+    updateLevels();
+  }
+
+private:
+  /// Find the level in effect for a name - levelMutex_ must be held
+  int resolveLevel(const NamedLevel& named) const
+  {
+    if(named.level >= 0)
+      return named.level;
+    if(!named.parent.empty())
+    {
+      std::map< std::string, NamedLevel >::const_iterator it = namedLevels_.find(named.parent);
+      if(it != namedLevels_.end() && it->second.level >= 0)
+        return it->second.level;
+    }
+    return reportingLevel.load();
+  }
+
+  /// Store the level in effect in every slot - levelMutex_ must be held
+  void updateLevels()
+  {
+    std::map< std::string, NamedLevel >::iterator it;
+    for(it = namedLevels_.begin(); it != namedLevels_.end(); ++it)
+      it->second.slot->store(resolveLevel(it->second), boost::memory_order_relaxed);
+  }
+
+  /// Write a message to the streams
+  void write(const std::string& msg, const std::string& time)
   {
     boost::mutex::scoped_lock lock(mutex_);
 
@@ -97,22 +408,87 @@ public:
     //Output to file
     if(fileStream)
     {
-      std::string tmp = NowTime() + " " + msg;
+      std::string tmp = time + " " + msg;
       fprintf(fileStream, "%s", tmp.c_str());
       fflush(fileStream);
     }
   }
 
-  void setFileStream(FILE* pFile)
+  /// Wake up the writer - it also wakes up by itself, so a lost notification only delays it
+  void wakeUpWriter()
   {
-    boost::mutex::scoped_lock lock(mutex_);
-    fileStream = pFile;
+    wakeWriter_.notify_one();
   }
 
-  /// Get and/or set the reporting level - anything below this level is ignored
-  LogLevel& ReportingLevel()
+  /// Wait until the writer has written the given number of messages
+  void waitForWriter(boost::uint64_t count)
   {
-    return reportingLevel;
+    boost::mutex::scoped_lock lock(writerMutex_);
+    while(written_.load() < count && async_.load())
+      batchWritten_.timed_wait(lock, boost::posix_time::milliseconds(10));
+  }
+
+  /// The loop of the writer thread - writes queued messages in batches
+  void writerLoop()
+  {
+    typedef boost::date_time::c_local_adjustor<boost::posix_time::ptime> LocalTime;
+    const unsigned maxBatch = 256;
+    LogRecord record;
+    std::string console, file, line;
+    std::ostringstream scratch;
+
+    while(true)
+    {
+      console.clear();
+      file.clear();
+      unsigned long dropped = dropped_.load(boost::memory_order_relaxed);
+      if(dropped != reportedDrops_)
+      {
+        std::ostringstream os;
+        os << "[WARNING] Logging: " << dropped - reportedDrops_ << " messages dropped - the log queue was full" << std::endl;
+        console += os.str();
+        file += NowTime() + " " + os.str();
+        reportedDrops_ = dropped;
+      }
+
+      unsigned n = 0;
+      for(; n < maxBatch && queue_->pop(record); ++n)
+      {
+        line.clear();
+        record.format(line, scratch);
+        record.clear();
+        console += line;
+        file += boost::posix_time::to_simple_string(LocalTime::utc_to_local(record.time));
+        file += " ";
+        file += line;
+      }
+
+      if(!console.empty())
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        if(consoleStream)
+        {
+          fwrite(console.data(), 1, console.size(), consoleStream);
+          fflush(consoleStream);
+        }
+        if(fileStream)
+        {
+          fwrite(file.data(), 1, file.size(), fileStream);
+          fflush(fileStream);
+        }
+      }
+
+      written_.store(queue_->popped());
+      boost::mutex::scoped_lock lock(writerMutex_);
+      batchWritten_.notify_all();
+      if(n == maxBatch)
+        continue;
+      if(stopping_ && queue_->popped() == queue_->pushed())
+        break;
+      writerWaiting_ = true;
+      wakeWriter_.timed_wait(lock, boost::posix_time::milliseconds(10));
+      writerWaiting_ = false;
+    }
   }
 
 };
@@ -124,23 +500,89 @@ public:
 *  The log levels are (in ascending order) LDEBUG, LINFO, LWARNING, LERROR, LFATAL.
 *   Each time the LOG macro is called, a temporary Logger object is created. The
 *   Logger objects output according to their static LoggingPolicy pointer.
-*   The LoggingPolicy output streams are flushed when the temporary Logger object
+*   The message is passed to the LoggingPolicy when the temporary Logger object
 *   is destroyed.
 *   The operation of Logger objects can be altered by resetting their LoggingPolicy pointer.
+*
+*   Strings, numbers and stream manipulators are copied into a LogRecord
+*   in binary form and only converted to text when the message is written.
+*   Other values are formatted with a std::ostringstream as before - the
+*   rest of that message is then formatted straight away too.
 */
 class Logger : boost::noncopyable
 {
 public:
   Logger();
   ~Logger();
-  std::ostringstream& Get(LogLevel level = LINFO);
+  Logger& Get(LogLevel level = LINFO);
+
+  Logger& operator<<(bool value)                { return append(LOG_ARG_BOOL, value); }
+  Logger& operator<<(char value)                { return append(LOG_ARG_CHAR, value); }
+  Logger& operator<<(signed char value)         { return append(LOG_ARG_CHAR, (char)value); }
+  Logger& operator<<(unsigned char value)       { return append(LOG_ARG_CHAR, (char)value); }
+  Logger& operator<<(short value)               { return append(LOG_ARG_INT, (int)value); }
+  Logger& operator<<(unsigned short value)      { return append(LOG_ARG_UINT, (unsigned int)value); }
+  Logger& operator<<(int value)                 { return append(LOG_ARG_INT, value); }
+  Logger& operator<<(unsigned int value)        { return append(LOG_ARG_UINT, value); }
+  Logger& operator<<(long value)                { return append(LOG_ARG_LONG, value); }
+  Logger& operator<<(unsigned long value)       { return append(LOG_ARG_ULONG, value); }
+  Logger& operator<<(long long value)           { return append(LOG_ARG_LLONG, value); }
+  Logger& operator<<(unsigned long long value)  { return append(LOG_ARG_ULLONG, value); }
+  Logger& operator<<(float value)               { return append(LOG_ARG_FLOAT, value); }
+  Logger& operator<<(double value)              { return append(LOG_ARG_DOUBLE, value); }
+  Logger& operator<<(std::ostream& (*value)(std::ostream&))       { return append(LOG_ARG_MANIPULATOR, value); }
+  Logger& operator<<(std::ios_base& (*value)(std::ios_base&))     { return append(LOG_ARG_IOS_MANIPULATOR, value); }
+
+  Logger& operator<<(const char* value)
+  {
+    if(os_ || value == NULL || !record_.appendString(value, std::strlen(value)))
+      toText() << value;
+    return *this;
+  }
+
+  Logger& operator<<(const std::string& value)
+  {
+    if(os_ || !record_.appendString(value.data(), value.size()))
+      toText() << value;
+    return *this;
+  }
+
+  /// Any other value is formatted straight away.
+  template<typename T>
+  Logger& operator<<(const T& value)
+  {
+    toText() << value;
+    return *this;
+  }
 
   static std::string ToString(LogLevel level);
   static LogLevel FromString(const std::string& level);
   static LoggingPolicy*& getPolicy();
 
 protected:
-  std::ostringstream os;
+  /// Add a value in binary form, or as text if that's how the message is held.
+  template<typename T>
+  Logger& append(LogArgType type, const T& value)
+  {
+    if(os_ || !record_.append(type, value))
+      toText() << value;
+    return *this;
+  }
+
+  /// Switch to formatting the message as text, starting with the values added so far.
+  std::ostringstream& toText()
+  {
+    if(!os_)
+    {
+      os_.reset(new std::ostringstream);
+      record_.decode(*os_);
+      record_.argsSize = 0;
+    }
+    return *os_;
+  }
+
+  LogRecord record_;
+  boost::scoped_ptr< std::ostringstream > os_;   ///< The message, once it is held as text.
 };
 
 /// Constructor sets LoggingPolicy if required
@@ -148,28 +590,22 @@ inline Logger::Logger()
 {
 }
 
-/** Get the output log stream
+/** Set the level of the message
 *
 *   \param level The log level for the message.
 */
-inline std::ostringstream& Logger::Get(LogLevel level)
+inline Logger& Logger::Get(LogLevel level)
 {
-  // put in brackets and append spaces to make sure length is 8
-  std::string tmp = "[";
-  tmp += ToString(level);
-  tmp += "]";
-  tmp += std::string(sizeof("WARNING")+1 - tmp.size(), ' ');
-
-  os << tmp << " ";
-
-  return os;
+  record_.level = level;
+  return *this;
 }
 
-/// Destructor flushes the log stream
+/// Destructor passes the message to the LoggingPolicy
 inline Logger::~Logger()
 {
-  os << std::endl;
-  getPolicy()->output(os.str());
+  if(os_)
+    record_.text = os_->str();
+  getPolicy()->output(record_);
 }
 
 /// Get ref to pointer to the current LoggingPolicy
@@ -203,6 +639,50 @@ inline LogLevel Logger::FromString(const std::string& level)
   return LINFO;
 }
 
+/** Caches the LogLevelSlot of a named object, so LOG can check its level with a single load.
+*
+*   Components, engines and controllers hold one of these and return its
+*   level from getReportingLevel(). Call reset() if the LoggingPolicy changes.
+*/
+class LogLevelCache
+{
+public:
+  LogLevelCache() : slot_(NULL) {}
+  LogLevelCache(const LogLevelCache&) : slot_(NULL) {}
+  LogLevelCache& operator=(const LogLevelCache&)
+  {
+    reset();
+    return *this;
+  }
+
+  /// Get the reporting level for a name - the slot is looked up on first use.
+  LogLevel get(const std::string& name) const
+  {
+    const LogLevelSlot* slot = slot_.load(boost::memory_order_acquire);
+    if(slot == NULL)
+    {
+      slot = Logger::getPolicy()->getLevelSlot(name);
+      slot_.store(slot, boost::memory_order_release);
+    }
+    return (LogLevel)slot->load(boost::memory_order_relaxed);
+  }
+
+  /// Forget the slot - used when the LoggingPolicy is changed.
+  void reset() const
+  {
+    slot_.store(NULL);
+  }
+
+private:
+  mutable boost::atomic< const LogLevelSlot* > slot_;
+};
+
+/// The reporting level used by LOG where no object has a level of its own - the global level
+inline LogLevel getReportingLevel()
+{
+  return Logger::getPolicy()->getReportingLevel();
+}
+
 /// The lowest log level to be reported
 #ifndef LOG_MIN_LEVEL
 #define LOG_MIN_LEVEL ::iris::LDEBUG
@@ -211,13 +691,15 @@ inline LogLevel Logger::FromString(const std::string& level)
 /**  Macro which checks the loglevel and outputs to streams
  *
  *  This is the main interface for performing logging.
+ *  The level is checked against getReportingLevel() - the level of the
+ *  component, engine or controller logging, or the global level elsewhere.
  *
  *   Usage:
  *   \code LOG(LDEBUG) << "this is a log message"; \endcode
  */
 #define LOG(level) \
   if (::iris::level < LOG_MIN_LEVEL) ;\
-  else if (::iris::level < ::iris::Logger::getPolicy()->ReportingLevel()) ; \
+  else if (::iris::level < getReportingLevel()) ; \
   else ::iris::Logger().Get(::iris::level) << getName() << ": "
 
 ///  Cross-platform time access using boost::date_time
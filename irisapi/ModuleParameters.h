@@ -38,14 +38,17 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include <boost/mpl/at.hpp>
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/size.hpp>
 #include <boost/any.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <irisapi/TypeInfo.h>
+#include <irisapi/PublishedValue.h>
 #include <irisapi/ParameterTypeInfo.h>
 #include <irisapi/Interval.h>
 #include <irisapi/Exceptions.h>
@@ -54,6 +57,37 @@
 namespace iris
 {
 
+struct Parameter;
+
+namespace internal
+{
+/// Copy the current value of a parameter to its PublishedValue
+template <typename T>
+void publishParameterValue(const Parameter& par);
+/// Read a PublishedValue as a string
+template <typename T>
+std::string readPublishedValue(const PublishedValue& value);
+}
+
+/** The published copy of a parameter, which can be kept and read from any thread.
+ *
+ *  Obtained with ModuleParameters::getPublishedParameter(). It stays valid
+ *  after the module is destroyed, but is no longer updated.
+ */
+struct PublishedParameter
+{
+  boost::shared_ptr<PublishedValue> value;
+  std::string (*read)(const PublishedValue&);   ///< Reads value as a string
+
+  PublishedParameter() : read(NULL) {}
+
+  /// Get the last published value as a string
+  std::string toString() const
+  {
+    return read(*value);
+  }
+};
+
 /** Represents a parameter of a module child class. Will be created by
  *  the registerParameter function in the ModuleParameters class.
  */
@@ -73,10 +107,20 @@ struct Parameter
   /// holds either the list<T> or the Interval<T> struct (min,max)
   boost::any allowedValues;
 
+  /// Copy of the value which can be read by other threads
+  boost::shared_ptr<PublishedValue> published;
+  /// Copies the parameter to published
+  void (*publish)(const Parameter&);
+  /// Reads published as a string
+  std::string (*readPublished)(const PublishedValue&);
+  /// Sets the parameter from a ParameterValue, checking the allowed values
+  void (*assign)(const std::string&, Parameter&, const ParameterValue&);
+
   /// default constructor - initialises all values to 0/false/empty, and identifier to -1
   Parameter() :
     parameter(), description(""), defaultValue(""), isDynamic(false), identifier(-1),
-    typeIdentifier(0), typeName(""), isList(false)
+    typeIdentifier(0), typeName(""), isList(false), publish(NULL), readPublished(NULL),
+    assign(NULL)
   {
   }
 
@@ -92,7 +136,10 @@ struct Parameter
   Parameter(T& parameter, std::string description, std::string defaultValue = "",
       bool isDynamic = false) :
     parameter(&parameter), description(description), defaultValue(defaultValue),
-    isDynamic(isDynamic), identifier(-1)
+    isDynamic(isDynamic), identifier(-1), published(new PublishedValue),
+    publish(&internal::publishParameterValue<T>),
+    readPublished(&internal::readPublishedValue<T>),
+    assign(NULL)
   {
   }
 
@@ -112,6 +159,7 @@ public:
   /// Constructs an instance of ModuleParameters
   ModuleParameters()
     : parameterMap_()
+    , generation_(0)
   {}
 
   virtual ~ModuleParameters() {}
@@ -173,6 +221,73 @@ public:
   template <typename T>
   inline void setValue(std::string name, T value);
 
+  /** Get the index of a parameter for use with setValue(int, const ParameterValue&, unsigned).
+   *
+   * \param name  The parameter name.
+   * \return The index, which stays the same for the lifetime of the module.
+   */
+  int getParameterIndex(std::string name) const
+  {
+    //Convert parameter name to lower case
+    boost::to_lower(name);
+    return getParameterReference(name).identifier;
+  }
+
+  /** Returns the ParameterTypeInfo<T>::identifier of a registered parameter.
+   *
+   * \param name  The parameter name.
+   */
+  int getParameterTypeIdentifier(std::string name) const
+  {
+    //Convert parameter name to lower case
+    boost::to_lower(name);
+    return getParameterReference(name).typeIdentifier;
+  }
+
+  /** Returns the name of the parameter with the given index.
+   *
+   * \param index  Index returned by getParameterIndex().
+   */
+  const std::string& getParameterName(int index) const
+  {
+    return getParameterIterator(index)->first;
+  }
+
+  /** Changes the value of a parameter without any string handling.
+   *
+   * The parameter is found by index rather than by name and the value is
+   * copied in binary form, so nothing is parsed or allocated. Allowed
+   * values are checked as for setValue(std::string, T).
+   *
+   * An index is only valid for the module it was taken from. A module
+   * which replaces another one is given a new generation, so indices
+   * taken from the old module are rejected.
+   *
+   * \param index       Index returned by getParameterIndex().
+   * \param value       New value - must have the type of the parameter.
+   * \param generation  getParameterGeneration() when the index was taken.
+   * \throw ParameterNotFoundException if the generation does not match.
+   */
+  void setValue(int index, const ParameterValue& value, unsigned generation)
+  {
+    if (generation != generation_)
+      throw ParameterNotFoundException("Parameter index is from a module which has been replaced.");
+    std::map<std::string, Parameter>::iterator it = getParameterIterator(index);
+    Parameter& par = it->second;
+    if (value.typeIdentifier != par.typeIdentifier || par.assign == NULL)
+      throw InvalidDataTypeException(std::string("Parameter ") + it->first
+          + ": binary value does not have the stored type " + par.typeName);
+    par.assign(it->first, par, value);
+  }
+
+  /// Get the generation of this module - see setValue(int, const ParameterValue&, unsigned).
+  unsigned getParameterGeneration() const
+  { return generation_; }
+
+  /// Set the generation of this module - done by the engine which runs it.
+  void setParameterGeneration(unsigned generation)
+  { generation_ = generation; }
+
   /** Get the description of the parameter.
    *
    * \param name Name of the parameter
@@ -221,6 +336,63 @@ public:
     return getParameterReference(name).isDynamic;
   }
 
+  /** Get the last published value of parameter 'name' in a std::string.
+   *
+   * Unlike getValue(), this may be called from any thread while the module
+   * is running. Parameters are published whenever they are set through
+   * setValue() and whenever publishParameters() is called - the engines do
+   * this after every call to a component, so values which a component
+   * changes itself are seen too. Only values which have changed are
+   * stored. Reading never blocks the module.
+   *
+   * \param name   The parameter name.
+   * \return The last published value as a string.
+   */
+  std::string getPublishedValue(std::string name) const
+  {
+    //Convert parameter name to lower case
+    boost::to_lower(name);
+    const Parameter& par = getParameterReference(name);
+    return par.readPublished(*par.published);
+  }
+
+  /** Get the published copy of parameter 'name', to read it later without looking it up.
+   *
+   * \param name   The parameter name.
+   */
+  PublishedParameter getPublishedParameter(std::string name) const
+  {
+    //Convert parameter name to lower case
+    boost::to_lower(name);
+    const Parameter& par = getParameterReference(name);
+    PublishedParameter p;
+    p.value = par.published;
+    p.read = par.readPublished;
+    return p;
+  }
+
+  /** Get the last published value of a registered parameter
+   *
+   * \param name    Parameter name
+   * \param value   Pointer to a variable where the result should be stored.
+   */
+  template<typename T>
+  inline void getPublishedValue(std::string name, T* value) const;
+
+  /** Publish the current values of all parameters which have changed.
+   *
+   * Must be called by the thread which runs the module. Unchanged values
+   * are only compared, so this neither locks nor allocates.
+   */
+  void publishParameters() const
+  {
+    std::map<std::string, Parameter>::const_iterator it;
+    for (it = parameterMap_.begin(); it != parameterMap_.end(); ++it)
+    {
+      it->second.publish(it->second);
+    }
+  }
+
   /** Called to tell a module that one of its parameters has been reconfigured.
    *
    * \param name Name of the parameter
@@ -275,6 +447,22 @@ protected:
 
 private:
 
+  /// Check that value is allowed for a parameter
+  template<typename T>
+  static void checkAllowedValue(const std::string& name, const Parameter& par, const T& value);
+
+  /// Set a parameter of type T from a ParameterValue
+  template<typename T>
+  static void assignValue(const std::string& name, Parameter& par, const ParameterValue& value);
+
+  /// Find a parameter by index
+  std::map<std::string, Parameter>::iterator getParameterIterator(int index) const
+  {
+    if (index < 0 || index >= (int)parametersByIndex_.size())
+      throw ParameterNotFoundException("Invalid parameter index.");
+    return parametersByIndex_[index];
+  }
+
   /// Helper method called by the registerParameter methods
   template<typename T>
   void registerParameterHelper(std::string name, std::string description,
@@ -309,6 +497,12 @@ private:
   /// Map holding all registered parameters. The key is the parameter name.
   std::map<std::string, Parameter> parameterMap_;
 
+  /// Entries of parameterMap_ in order of their identifier.
+  std::vector< std::map<std::string, Parameter>::iterator > parametersByIndex_;
+
+  /// Distinguishes this module from others which took the same place in an engine.
+  unsigned generation_;
+
 }; // class ModuleParameter
 
 
@@ -333,6 +527,37 @@ inline void ModuleParameters::getValue(std::string name, T* value) const
 }
 
 
+template <typename T>
+inline void ModuleParameters::getPublishedValue(std::string name, T* value) const
+{
+  //Convert parameter name to lower case
+  boost::to_lower(name);
+
+  const Parameter& par = getParameterReference(name);
+
+  if (par.typeIdentifier != ParameterTypeInfo<T>::identifier)
+    throw InvalidDataTypeException(std::string("Parameter ") + name + ": is not of type " +
+      ParameterTypeInfo<T>::name() + ", the stored type is " + par.typeName);
+  else
+    *value = par.published->load<T>();
+}
+
+template <>
+inline void ModuleParameters::getPublishedValue<std::string>(std::string name, std::string* value) const
+{
+  //Convert parameter name to lower case
+  boost::to_lower(name);
+
+  const Parameter& par = getParameterReference(name);
+
+  if (par.typeIdentifier != ParameterTypeInfo<std::string>::identifier)
+    throw InvalidDataTypeException(std::string("Parameter ") + name + ": is not of type " +
+      ParameterTypeInfo<std::string>::name() + ", the stored type is " + par.typeName);
+  else
+    *value = par.published->loadString();
+}
+
+
 template <typename T>
 inline void ModuleParameters::setValue(std::string name, T value)
 {
@@ -350,9 +575,19 @@ inline void ModuleParameters::setValue(std::string name, T value)
     throw InvalidDataTypeException(std::string("Invalid data type used. The stored value type is ")
         + par.typeName + " you requested: " + ParameterTypeInfo<T>::name());
   }
+  checkAllowedValue(name, par, value);
+
+  **x = value;
+  par.publish(par);
+}
+
+template <typename T>
+inline void ModuleParameters::checkAllowedValue(const std::string& name, const Parameter& par,
+    const T& value)
+{
   if (par.isList)
   {
-    std::list<T>* tmp = boost::any_cast< std::list<T> >(&par.allowedValues);
+    const std::list<T>* tmp = boost::any_cast< std::list<T> >(&par.allowedValues);
     if (find(tmp->begin(), tmp->end(), value) == tmp->end())  // value not allowed
     {
       std::stringstream sstr;
@@ -362,7 +597,7 @@ inline void ModuleParameters::setValue(std::string name, T value)
   }
   else
   {
-    Interval<T>* tmp = boost::any_cast< Interval<T> >(&par.allowedValues);
+    const Interval<T>* tmp = boost::any_cast< Interval<T> >(&par.allowedValues);
     if ( (value < tmp->minimum) || (value > tmp->maximum) )
     {
       std::stringstream sstr;
@@ -370,8 +605,26 @@ inline void ModuleParameters::setValue(std::string name, T value)
       throw ParameterOutOfRangeException(sstr.str());
     }
   }
+}
 
-  **x = value;
+template <typename T>
+inline void ModuleParameters::assignValue(const std::string& name, Parameter& par,
+    const ParameterValue& value)
+{
+  T v = value.get<T>();
+  checkAllowedValue(name, par, v);
+  **boost::any_cast<T*>(&par.parameter) = v;
+  par.publish(par);
+}
+
+
+/// strings cannot be held in a ParameterValue
+template <>
+inline void ModuleParameters::assignValue<std::string>(const std::string& name, Parameter&,
+    const ParameterValue&)
+{
+  throw InvalidDataTypeException(std::string("Parameter ") + name
+      + ": strings cannot be set from a binary value");
 }
 
 
@@ -482,6 +735,31 @@ inline std::string getStringParameter(const boost::any& val)
   return GetStringParTmp< boost::mpl::size<IrisParameterTypes>::value>::EXEC(val);
 }
 
+template <typename T>
+inline void publishParameterValue(const Parameter& par)
+{
+  par.published->update(**boost::any_cast<T*>(&par.parameter));
+}
+
+/// strings cannot be published as plain values
+template <>
+inline void publishParameterValue<std::string>(const Parameter& par)
+{
+  par.published->updateString(**boost::any_cast<std::string*>(&par.parameter));
+}
+
+template <typename T>
+inline std::string readPublishedValue(const PublishedValue& value)
+{
+  return TypeToString(value.load<T>());
+}
+
+template <>
+inline std::string readPublishedValue<std::string>(const PublishedValue& value)
+{
+  return value.loadString();
+}
+
 } // end of internal namespace
 
 inline std::string ModuleParameters::getValue(std::string name) const
@@ -519,9 +797,11 @@ inline void ModuleParameters::setValue< std::string >(std::string name, std::str
       *boost::any_cast<bool*>(par.parameter) = false;
     else
       throw InvalidDataTypeException(std::string("Parameter ") + name + ": " + value + " could not be converted to bool");
+    par.publish(par);
   } else if (par.typeIdentifier == ParameterTypeInfo<std::string>::identifier)
   {
     *boost::any_cast<std::string*>(par.parameter) = value;
+    par.publish(par);
   } else
   {
     const Parameter& par = getParameterReference(name);
@@ -552,10 +832,22 @@ inline void ModuleParameters::registerParameterHelper(std::string name, std::str
   BOOST_STATIC_ASSERT(ParameterTypeInfo<T>::identifier >= 0);
 
   Parameter par(parameter, description, defaultValue, isDynamic);
-  par.identifier = (int)parameterMap_.size();
   par.typeIdentifier = ParameterTypeInfo<T>::identifier;
   par.typeName = ParameterTypeInfo<T>::name();
-  parameterMap_[name] = par;
+  par.assign = &ModuleParameters::assignValue<T>;
+
+  std::map<std::string, Parameter>::iterator it = parameterMap_.find(name);
+  if (it == parameterMap_.end())
+  {
+    par.identifier = (int)parametersByIndex_.size();
+    it = parameterMap_.insert(std::make_pair(name, par)).first;
+    parametersByIndex_.push_back(it);
+  }
+  else // registered again - keep the index
+  {
+    par.identifier = it->second.identifier;
+    it->second = par;
+  }
 
 }
 
@@ -36,8 +36,11 @@
 #define IRISAPI_PARAMETERTYPEINFO_H_
 
 #include <string>
+#include <cstring>
 #include <limits.h>
 #include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/push_back.hpp>
 
@@ -134,6 +137,46 @@ typedef detail::parameter_types_tmp14 IrisParameterTypes;
 
 #undef MAKE_PARAMETER_TYPE
 
+
+/** A parameter value held in binary form together with its type.
+ *
+ *  Used to change parameters without converting values to and from
+ *  strings. Only arithmetic parameter types can be held.
+ */
+struct ParameterValue
+{
+  int typeIdentifier;       ///< ParameterTypeInfo<T>::identifier of the value
+  boost::uint64_t data[2];  ///< The value itself (large enough for long double)
+
+  ParameterValue()
+    :typeIdentifier(-1)
+  {
+    data[0] = data[1] = 0;
+  }
+
+  /// Construct from a value of any arithmetic parameter type
+  template<typename T>
+  explicit ParameterValue(T value)
+    :typeIdentifier(ParameterTypeInfo<T>::identifier)
+  {
+    BOOST_STATIC_ASSERT(ParameterTypeInfo<T>::isAllowed);
+    BOOST_STATIC_ASSERT(boost::is_arithmetic<T>::value);
+    BOOST_STATIC_ASSERT(sizeof(T) <= sizeof(data));
+    data[0] = data[1] = 0;
+    std::memcpy(data, &value, sizeof(T));
+  }
+
+  /// Get the value - T must match typeIdentifier
+  template<typename T>
+  T get() const
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) <= sizeof(data));
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+  }
+};
+
 } // namespace iris
 
 #endif // IRISAPI_PARAMETERTYPEINFO_H_
@@ -0,0 +1,144 @@
+/**
+ * \file PendingReconfigurations.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Holds ReconfigSets until the data they apply to is reached.
+ */
+
+#ifndef IRISAPI_PENDINGRECONFIGURATIONS_H_
+#define IRISAPI_PENDINGRECONFIGURATIONS_H_
+
+#include <deque>
+#include <algorithm>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "irisapi/ReconfigurationDescriptions.h"
+
+namespace iris
+{
+
+/// Statistics on the time taken from issuing a ReconfigSet to applying it.
+struct ReconfigLatency
+{
+  unsigned count;                           ///< Number of sets applied
+  boost::posix_time::time_duration total;   ///< Sum of all latencies
+  boost::posix_time::time_duration maximum; ///< Largest latency
+
+  ReconfigLatency()
+    :count(0)
+  {}
+
+  /// Record a set issued at the given time which has just been applied
+  boost::posix_time::time_duration record(const boost::posix_time::ptime& issued)
+  {
+    if(issued.is_not_a_date_time())
+      return boost::posix_time::time_duration();
+    boost::posix_time::time_duration d =
+        boost::posix_time::microsec_clock::universal_time() - issued;
+    ++count;
+    total += d;
+    maximum = std::max(maximum, d);
+    return d;
+  }
+
+  /// Average latency
+  boost::posix_time::time_duration average() const
+  {
+    return count == 0 ? boost::posix_time::time_duration() : total / count;
+  }
+};
+
+/** ReconfigSets waiting to be applied by an engine or component.
+ *
+ * Sets which are not timed are always due and are applied first, in the
+ * order they were added. Timed sets become due once the timestamp of the
+ * next data to be processed reaches their target, and are applied in order
+ * of their targets. Not thread-safe - used by a single engine thread.
+ */
+class PendingReconfigurations
+{
+public:
+  /// Add a set
+  void add(const ReconfigSet& set)
+  {
+    sets_.insert(std::upper_bound(sets_.begin(), sets_.end(), set, &comesBefore), set);
+  }
+
+  /// Are there any sets waiting?
+  bool empty() const
+  {
+    return sets_.empty();
+  }
+
+  /// Does the next set wait for a timestamp?
+  bool nextIsTimed() const
+  {
+    return !sets_.empty() && sets_.front().isTimed;
+  }
+
+  /** Get the next set which is due
+  *
+  *   \param timeKnown  Is the timestamp of the next data known?
+  *   \param dataTime   Timestamp of the next data to be processed
+  *   \param set        Set to the due ReconfigSet
+  *   \return Whether a set was due
+  */
+  bool popDue(bool timeKnown, double dataTime, ReconfigSet& set)
+  {
+    if(sets_.empty())
+      return false;
+    const ReconfigSet& next = sets_.front();
+    if(next.isTimed && !(timeKnown && dataTime >= next.timeStamp))
+      return false;
+    set = next;
+    sets_.pop_front();
+    return true;
+  }
+
+  /// Latency of the sets applied so far
+  ReconfigLatency& latency()
+  {
+    return latency_;
+  }
+
+private:
+  static bool comesBefore(const ReconfigSet& a, const ReconfigSet& b)
+  {
+    if(a.isTimed != b.isTimed)
+      return !a.isTimed;
+    return a.isTimed && a.timeStamp < b.timeStamp;
+  }
+
+  std::deque<ReconfigSet> sets_;  ///< Waiting sets, in the order they will be applied.
+  ReconfigLatency latency_;       ///< Statistics on applied sets.
+};
+
+} // namespace iris
+
+#endif // IRISAPI_PENDINGRECONFIGURATIONS_H_
@@ -69,6 +69,7 @@ public:
               std::string version )
     : ComponentBase(name, type, description, author, version)
       ,numRuns_(0)
+      ,inputTimeStamp_(0)
   {};
 
 
@@ -121,6 +122,9 @@ public:
     boost::posix_time::ptime t2(boost::posix_time::microsec_clock::local_time());
     totalTime_ += (t2-t1);
     numRuns_++;
+
+    //Let other threads see any parameters changed by process()
+    publishParameters();
   };
 
   /// \name To be implemented in derived classes.
@@ -161,8 +165,33 @@ protected:
     if( TypeInfo< T >::identifier != b->getTypeIdentifier() )
       throw InvalidDataTypeException("Data type mismatch in getInputDataSet.");
     (dynamic_cast< ReadBuffer<T>* >(b))->getReadData(data);
+    data->flatten();
+    inputTimeStamp_ = data->timeStamp;
+  }
+
+  /** Get an input DataSet which may be a view of shared data.
+   *
+   * Unlike getInputDataSet(), views are not copied into the data vector.
+   * Components which use this can pass data on without copying it, using
+   * DataSet::share() and DataSet::appendView().
+   */
+  template <class T>
+  void getInputDataSetView(std::string portName, DataSet<T>*& data)
+  {
+    ReadBufferBase* b = namedInputBuffers_[portName];
+    if( TypeInfo< T >::identifier != b->getTypeIdentifier() )
+      throw InvalidDataTypeException("Data type mismatch in getInputDataSetView.");
+    (dynamic_cast< ReadBuffer<T>* >(b))->getReadData(data);
+    inputTimeStamp_ = data->timeStamp;
   }
 
+  /** Get a DataSet to write to an output.
+   *
+   * The timestamp is set to that of the last input DataSet, or to
+   * currentTimeStamp() if the component has no inputs, so timed
+   * reconfigurations still find their data in components which do not
+   * set timestamps themselves.
+   */
   template <class T>
   void getOutputDataSet(std::string portName, DataSet<T>*& data, std::size_t size)
   {
@@ -170,6 +199,7 @@ protected:
     if( TypeInfo< T >::identifier != b->getTypeIdentifier() )
       throw InvalidDataTypeException("Data type mismatch in getOutputDataSet.");
     (dynamic_cast< WriteBuffer<T>* >(b))->getWriteData(data, size);
+    data->timeStamp = inputBuffers.empty() ? currentTimeStamp() : inputTimeStamp_;
   }
 
   template <class T>
@@ -216,6 +246,7 @@ protected:
 private:
   boost::posix_time::time_duration totalTime_; ///< Time taken in process() so far.
   int numRuns_;                                ///< Number of process() calls so far.
+  double inputTimeStamp_;                      ///< Timestamp of the last input DataSet.
 
   std::map<std::string, ReadBufferBase*> namedInputBuffers_;
   std::map<std::string, WriteBufferBase*> namedOutputBuffers_;
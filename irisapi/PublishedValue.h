@@ -0,0 +1,181 @@
+/**
+ * \file PublishedValue.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A value which is written by one thread and read by others without
+ * blocking the writer.
+ */
+
+#ifndef IRISAPI_PUBLISHEDVALUE_H_
+#define IRISAPI_PUBLISHEDVALUE_H_
+
+#include <cstring>
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace iris
+{
+
+/** A copy of a value which can be read safely by other threads.
+ *
+ * Plain values of up to MAX_SIZE bytes are published using a sequence lock:
+ * the writer makes the sequence number odd, stores the value and makes it
+ * even again. Readers never take a lock - they retry if the sequence number
+ * was odd or changed while they were copying the value. Writers never wait
+ * for readers.
+ *
+ * Strings cannot be copied this way, so they are held under a mutex.
+ */
+class PublishedValue
+  : boost::noncopyable
+{
+public:
+  /// Largest plain value which can be published
+  enum { MAX_SIZE = 2 * sizeof(boost::uint64_t) };
+
+  PublishedValue()
+    :sequence_(0)
+  {
+    words_[0].store(0, boost::memory_order_relaxed);
+    words_[1].store(0, boost::memory_order_relaxed);
+  }
+
+  /// Publish a plain value
+  template<typename T>
+  void store(const T& value)
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) <= MAX_SIZE);
+
+    boost::uint64_t w[2] = {0, 0};
+    std::memcpy(w, &value, sizeof(T));
+
+    //Claim the value by making the sequence odd, so concurrent writers are safe
+    unsigned s = sequence_.load(boost::memory_order_relaxed);
+    while((s & 1) || !sequence_.compare_exchange_weak(s, s + 1, boost::memory_order_relaxed))
+      s = sequence_.load(boost::memory_order_relaxed);
+    boost::atomic_thread_fence(boost::memory_order_release);
+
+    words_[0].store(w[0], boost::memory_order_relaxed);
+    words_[1].store(w[1], boost::memory_order_relaxed);
+
+    sequence_.store(s + 2, boost::memory_order_release);
+  }
+
+  /// Get the last published plain value
+  template<typename T>
+  T load() const
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) <= MAX_SIZE);
+
+    boost::uint64_t w[2];
+    unsigned before, after;
+    do
+    {
+      before = sequence_.load(boost::memory_order_acquire);
+      w[0] = words_[0].load(boost::memory_order_relaxed);
+      w[1] = words_[1].load(boost::memory_order_relaxed);
+      boost::atomic_thread_fence(boost::memory_order_acquire);
+      after = sequence_.load(boost::memory_order_relaxed);
+    }
+    while((before & 1) || before != after);
+
+    T value;
+    std::memcpy(&value, w, sizeof(T));
+    return value;
+  }
+
+  /** Publish a plain value if it differs from the last one
+  *
+  *   \return Whether the value was published.
+  */
+  template<typename T>
+  bool update(const T& value)
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) <= MAX_SIZE);
+
+    boost::uint64_t w[2] = {0, 0};
+    std::memcpy(w, &value, sizeof(T));
+    if(words_[0].load(boost::memory_order_relaxed) == w[0] &&
+       words_[1].load(boost::memory_order_relaxed) == w[1])
+      return false;
+    store(value);
+    return true;
+  }
+
+  /** Publish a string if it differs from the last one
+  *
+  *   The comparison is made without locking, so only the thread which
+  *   publishes the value may call this.
+  *
+  *   \return Whether the value was published.
+  */
+  bool updateString(const std::string& value)
+  {
+    if(string_ == value)
+      return false;
+    storeString(value);
+    return true;
+  }
+
+  /// How many times has a value been published?
+  unsigned version() const
+  {
+    return sequence_.load(boost::memory_order_acquire) / 2;
+  }
+
+  /// Publish a string
+  void storeString(const std::string& value)
+  {
+    boost::mutex::scoped_lock lock(stringMutex_);
+    string_ = value;
+    sequence_.fetch_add(2, boost::memory_order_release);
+  }
+
+  /// Get the last published string
+  std::string loadString() const
+  {
+    boost::mutex::scoped_lock lock(stringMutex_);
+    return string_;
+  }
+
+private:
+  boost::atomic<unsigned> sequence_;      ///< Odd while a value is being written.
+  boost::atomic<boost::uint64_t> words_[2];  ///< The value itself.
+  std::string string_;                    ///< The value if it is a string.
+  mutable boost::mutex stringMutex_;      ///< Guards string_.
+};
+
+} // namespace iris
+
+#endif // IRISAPI_PUBLISHEDVALUE_H_
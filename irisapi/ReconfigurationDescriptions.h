@@ -37,8 +37,11 @@
 
 #include <string>
 #include <vector>
+#include <utility>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include "irisapi/LinkDescription.h"
+#include "irisapi/ParameterTypeInfo.h"
 
 namespace iris
 {
@@ -52,6 +55,41 @@ struct ParametricReconfig
   std::string parameterValue;
 };
 
+/** A component parameter resolved once for fast reconfiguration.
+*
+*   A handle stays valid as long as the radio it was resolved in is loaded
+*   and the component is not replaced. Reconfigurations using the handle of
+*   a replaced component are rejected - resolve the parameter again.
+*/
+struct ParameterHandle
+{
+  int engineIndex;      ///< Position of the engine within the EngineManager
+  int componentIndex;   ///< Position of the component within its engine
+  int parameterIndex;   ///< Index of the parameter within its component
+  int typeIdentifier;   ///< ParameterTypeInfo<T>::identifier of the parameter
+  unsigned generation;  ///< getParameterGeneration() of the component
+
+  ParameterHandle()
+    :engineIndex(-1), componentIndex(-1), parameterIndex(-1), typeIdentifier(-1), generation(0)
+  {}
+
+  /// Was the handle resolved?
+  bool isValid() const
+  {
+    return engineIndex >= 0 && componentIndex >= 0 && parameterIndex >= 0;
+  }
+};
+
+/** A parametric reconfiguration using a resolved handle and a binary value
+*
+*   Avoids the name lookups and string conversions of a ParametricReconfig.
+*/
+struct TypedParametricReconfig
+{
+  ParameterHandle handle;
+  ParameterValue value;
+};
+
 /// An altered link
 struct AlteredLink
 {
@@ -59,21 +97,48 @@ struct AlteredLink
   LinkDescription newLink;
 };
 
+/** A component to be loaded by a structural reconfiguration.
+*
+*   Carries what an engine needs to load the component - its name, its type
+*   and the values of its parameters.
+*/
+struct NewComponent
+{
+  std::string name;
+  std::string type;
+  std::vector< std::pair< std::string, std::string > > parameters;  ///< Parameter names and values
+};
+
 /// A structural reconfiguration
 struct StructuralReconfig
 {
   std::string engineName;
   std::vector< std::string > removedComponents;
   std::vector< LinkDescription > removedLinks;
-  //std::vector< ComponentDescription > newComponents;
+  std::vector< NewComponent > newComponents;
   std::vector< LinkDescription > newLinks;
   std::vector< AlteredLink > alteredLinks;
+
+  /// Components which take the place of a running component with the same name and links
+  std::vector< NewComponent > replacedComponents;
+
+  /// Does the reconfiguration do anything other than replace components?
+  bool changesGraph() const
+  {
+    return !(removedComponents.empty() && removedLinks.empty() && newComponents.empty()
+             && newLinks.empty() && alteredLinks.empty());
+  }
 };
 
 /** A set of radio reconfigurations.
 *
 *   A ReconfigSet contains a number of reconfigurations which must be carried
 *   out atomically by an engine with respect to the data flow.
+*
+*   By default a set is applied at the next data boundary of each engine. A
+*   timed set is held back until the first DataSet whose timestamp is at least
+*   timeStamp, so that every engine and component applies it to the same data.
+*   Engines without inputs compare timeStamp with currentTimeStamp().
 */
 struct ReconfigSet
 {
@@ -82,6 +147,19 @@ struct ReconfigSet
 
   /// The set of structural reconfigurations
   std::vector< StructuralReconfig > structReconfigs;
+
+  /// Should the set wait for data with the given timestamp?
+  bool isTimed;
+
+  /// Timestamp of the first data which the set applies to (if isTimed)
+  double timeStamp;
+
+  /// When the set was issued - used to measure reconfiguration latency
+  boost::posix_time::ptime issueTime;
+
+  ReconfigSet()
+    :isTimed(false), timeStamp(0)
+  {}
 };
 
 } /* namespace iris */
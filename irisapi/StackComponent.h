@@ -43,8 +43,10 @@
 #include <irisapi/ComponentBase.h>
 #include <irisapi/StackDataBuffer.h>
 #include <irisapi/ReconfigurationDescriptions.h>
+#include <irisapi/PendingReconfigurations.h>
 #include <irisapi/MessageQueue.h>
 #include <irisapi/CommandPrison.h>
+#include <irisapi/TimerWheel.h>
 
 
 namespace iris
@@ -78,8 +80,11 @@ struct StackLink
  * depending upon whether the message came from above or below. Data flow
  * between StackComponents is bidirectional. StackComponents can generate new
  * messages and send them up or down at any time.
+ *
+ * StackComponents can also schedule timers using scheduleTimer(). Timer
+ * callbacks are run on the component's own thread, between messages.
  */
-class StackComponent: public ComponentBase
+class StackComponent: public ComponentBase, public TimerListener
 {
 public:
   /** Constructor
@@ -92,6 +97,7 @@ public:
   */
   StackComponent(std::string name, std::string type, std::string description, std::string author, std::string version )
     :ComponentBase(name, type, description, author, version)
+    ,timerWheel_(NULL)
   {}
 
   /// Destructor
@@ -138,7 +144,39 @@ public:
   */
   void addReconfiguration(ParametricReconfig reconfig)
   {
-    reconfigQueue_.push(reconfig);
+    ReconfigSet set;
+    set.paramReconfigs.push_back(reconfig);
+    addReconfiguration(set);
+  }
+
+  /** Add a set of reconfigurations for this component to the queue
+  *
+  *   All reconfigurations in the set are applied together, before the
+  *   component processes its next message or, for a timed set, before the
+  *   first message with a timestamp of at least set.timeStamp.
+  *
+  *   \param  set  The reconfigurations to be carried out
+  */
+  void addReconfiguration(const ReconfigSet& set)
+  {
+    reconfigQueue_.push(set);
+    buffer_.wakeUp();
+  }
+
+  /// Latency of the reconfigurations applied so far - only valid once stopped
+  ReconfigLatency getReconfigLatency()
+  {
+    return pendingReconfigs_.latency();
+  }
+
+  /** Add a typed reconfiguration to the queue
+  *
+  *   \param  reconfig  The typed parametric reconfiguration to be carried out
+  */
+  void addReconfiguration(const TypedParametricReconfig& reconfig)
+  {
+    typedReconfigQueue_.push(reconfig);
+    buffer_.wakeUp();
   }
 
   /** Post a command to this component
@@ -150,6 +188,25 @@ public:
     prison_.release(command);
   }
 
+  /** Set the TimerWheel used to schedule timers for this component
+  *
+  *   \param wheel  The TimerWheel of the owning engine
+  */
+  void setTimerWheel(TimerWheel* wheel)
+  {
+    timerWheel_ = wheel;
+  }
+
+  /** Called by the TimerWheel when a timer has expired
+  *
+  *   \param id  The id of the expired timer
+  */
+  void timerExpired(TimerId id)
+  {
+    expiredTimers_.push(id);
+    buffer_.wakeUp();
+  }
+
   /// Create and start the thread for this stack component.
   virtual void startComponent()
   {
@@ -265,11 +322,88 @@ protected:
     return prison_.trap(command);
   }
 
+  /// Wait for any one of a number of named commands
+  Command waitForCommand(const std::vector<std::string>& commands)
+  {
+    return prison_.trap(commands);
+  }
+
+  /** Wait for a named command, giving up after a timeout
+  *
+  *   \param command   Name of the command to wait for.
+  *   \param timeout   Maximum time to wait.
+  *   \param result    Set to the command which was issued.
+  *   \return True if the command was issued, false if the timeout expired.
+  */
+  bool waitForCommand(std::string command,
+                      boost::posix_time::time_duration timeout,
+                      Command& result)
+  {
+    return prison_.trapFor(command, timeout, result);
+  }
+
+  /** Wait for any one of a number of named commands, giving up after a timeout
+  *
+  *   \param commands  Names of the commands to wait for.
+  *   \param timeout   Maximum time to wait.
+  *   \param result    Set to the command which was issued.
+  *   \return True if a command was issued, false if the timeout expired.
+  */
+  bool waitForCommand(const std::vector<std::string>& commands,
+                      boost::posix_time::time_duration timeout,
+                      Command& result)
+  {
+    return prison_.trapFor(commands, timeout, result);
+  }
+
+  /** Schedule a function to be called on this component's thread after a delay
+  *
+  *   \param delay     Time to wait before calling the function.
+  *   \param callback  The function to call.
+  *   \return The id of the timer, or 0 if no TimerWheel is available.
+  */
+  TimerId scheduleTimer(boost::posix_time::time_duration delay, TimerCallback callback)
+  {
+    if(timerWheel_ == NULL)
+    {
+      LOG(LERROR) << "scheduleTimer() failed. No TimerWheel available.";
+      return 0;
+    }
+    return timerWheel_->schedule(this, delay, callback);
+  }
+
+  /** Cancel a timer
+  *
+  *   \param id   The id returned by scheduleTimer().
+  *   \return True if the timer was cancelled before it ran.
+  */
+  bool cancelTimer(TimerId id)
+  {
+    if(timerWheel_ == NULL)
+      return false;
+    return timerWheel_->cancel(id);
+  }
+
   /// Protects the parameters of this component when using multiple threads
   mutable boost::mutex parameterMutex_;
 
 private:
 
+  /// Apply all reconfigurations in a set
+  void applyReconfigSet(const ReconfigSet& set)
+  {
+    boost::mutex::scoped_lock lock(parameterMutex_);
+    std::vector<ParametricReconfig>::const_iterator it;
+    for(it = set.paramReconfigs.begin(); it != set.paramReconfigs.end(); ++it)
+    {
+      setValue(it->parameterName, it->parameterValue);
+      parameterHasChanged(it->parameterName);
+      LOG(LINFO) << "Reconfigured parameter " << it->parameterName << " : " << it->parameterValue;
+    }
+    boost::posix_time::time_duration latency = pendingReconfigs_.latency().record(set.issueTime);
+    LOG(LDEBUG) << "Applied " << set.paramReconfigs.size() << " reconfigurations after " << latency;
+  }
+
   /// The main thread loop for this stack component
   virtual void threadLoop()
   {
@@ -282,28 +416,58 @@ private:
         //Get a DataSet
         boost::shared_ptr<StackDataSet> p = buffer_.popDataSet();
 
-        //Check message queue for ParametricReconfigs
-        ParametricReconfig currentReconfig;
-        while(reconfigQueue_.tryPop(currentReconfig))
+        //Check message queue for ReconfigSets and apply those due before this message
+        ReconfigSet currentSet;
+        while(reconfigQueue_.tryPop(currentSet))
+        {
+          pendingReconfigs_.add(currentSet);
+        }
+        while(pendingReconfigs_.popDue(p.get() != NULL, p ? p->timeStamp : 0, currentSet))
+        {
+          applyReconfigSet(currentSet);
+        }
+        TypedParametricReconfig typedReconfig;
+        while(typedReconfigQueue_.tryPop(typedReconfig))
         {
           boost::mutex::scoped_lock lock(parameterMutex_);
-          setValue(currentReconfig.parameterName, currentReconfig.parameterValue);
-          parameterHasChanged(currentReconfig.parameterName);
-          LOG(LINFO) << "Reconfigured parameter " << currentReconfig.parameterName << " : " << currentReconfig.parameterValue;
+          try
+          {
+            setValue(typedReconfig.handle.parameterIndex, typedReconfig.value,
+                     typedReconfig.handle.generation);
+            parameterHasChanged(getParameterName(typedReconfig.handle.parameterIndex));
+          }
+          catch(IrisException& ex)
+          {
+            LOG(LERROR) << "Parametric reconfiguration failed: " << ex.what();
+          }
         }
 
-        //Call the appropriate function for the DataSet
-        switch(p->source)
+        //Run the callbacks of any expired timers
+        TimerId expired;
+        while(expiredTimers_.tryPop(expired))
         {
-        case ABOVE:
-          processMessageFromAbove(p);
-          break;
-        case BELOW:
-          processMessageFromBelow(p);
-          break;
-        default:
-          break;
+          timerWheel_->dispatch(expired);
         }
+
+        //We may have been woken up just to run timers
+        if(p)
+        {
+          //Call the appropriate function for the DataSet
+          switch(p->source)
+          {
+          case ABOVE:
+            processMessageFromAbove(p);
+            break;
+          case BELOW:
+            processMessageFromBelow(p);
+            break;
+          default:
+            break;
+          }
+        }
+
+        //Let other threads see any parameters changed by the component
+        publishParameters();
       }
     }
     catch(IrisException& ex)
@@ -320,7 +484,11 @@ private:
   std::map<std::string, StackLink> belowBuffers_;  ///< Pointers to neighbours below.
 
   boost::scoped_ptr< boost::thread > thread_;         ///< This component's thread.
-  MessageQueue< ParametricReconfig > reconfigQueue_;  ///< Reconfigs for this component.
+  MessageQueue< ReconfigSet > reconfigQueue_;         ///< Reconfigs for this component.
+  PendingReconfigurations pendingReconfigs_;          ///< Reconfigs waiting for their data.
+  MessageQueue< TypedParametricReconfig > typedReconfigQueue_;  ///< Typed reconfigs for this component.
+  MessageQueue< TimerId > expiredTimers_;             ///< Timers waiting to be dispatched.
+  TimerWheel* timerWheel_;                            ///< Timer service of our engine.
 
   CommandPrison prison_;      ///< Used to wait for commands issued by a controller.
   StackDataBuffer buffer_;    ///< Buffer containing data messages for this component.
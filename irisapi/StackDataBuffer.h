@@ -90,6 +90,7 @@ public:
   */
   explicit StackDataBuffer(unsigned maxSize = 10)
     :maxBufferSize_(maxSize)
+    ,wakeUp_(false)
   {};
 
   virtual ~StackDataBuffer(){};
@@ -124,15 +125,22 @@ public:
   
   /** Get a StackDataSet from the queue
   *
+  *  If the buffer is empty and wakeUp() is called, an empty pointer is returned.
+  *
   *  \return A boost::shared_ptr to a StackDataSet
   */
   boost::shared_ptr<StackDataSet> popDataSet()
   {
     boost::mutex::scoped_lock lock(mutex_);
-    while(buffer_.empty())
+    while(buffer_.empty() && !wakeUp_)
     {
       notEmptyVariable_.wait(lock);
     }
+    wakeUp_ = false;
+    if(buffer_.empty())
+    {
+      return boost::shared_ptr<StackDataSet>();
+    }
     boost::shared_ptr<StackDataSet> p = buffer_.front();
     buffer_.pop();
     lock.unlock();
@@ -156,11 +164,21 @@ public:
     notEmptyVariable_.notify_one();
   }
 
+  /// Wake up a thread blocked in popDataSet() without adding any data.
+  void wakeUp()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    wakeUp_ = true;
+    lock.unlock();
+    notEmptyVariable_.notify_one();
+  }
+
 private:
   /// The queue of StackDataSet pointers
   std::queue< boost::shared_ptr<StackDataSet> > buffer_;
 
   unsigned maxBufferSize_;        ///< Max number of items in the queue.
+  bool wakeUp_;                   ///< Has wakeUp() been called?
   mutable boost::mutex mutex_;    ///< Provide thread safety.
   boost::condition_variable notEmptyVariable_;  ///< Used to block if queue is empty.
   boost::condition_variable notFullVariable_;   ///< Used to block if queue is full.
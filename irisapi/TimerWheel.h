@@ -0,0 +1,453 @@
+/**
+ * \file TimerWheel.h
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A hierarchical timing wheel used to provide timers to components.
+ */
+
+#ifndef IRISAPI_TIMERWHEEL_H_
+#define IRISAPI_TIMERWHEEL_H_
+
+#include <vector>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/utility.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace iris
+{
+
+/// Identifies a timer scheduled in a TimerWheel. 0 is never a valid id.
+typedef boost::uint64_t TimerId;
+
+/// The function called when a timer expires.
+typedef boost::function< void () > TimerCallback;
+
+/** Interface implemented by the owners of timers.
+ *
+ * When a timer expires, the TimerWheel passes its id to the owner. The owner
+ * should then call TimerWheel::dispatch() with that id on its own thread, so
+ * that timer callbacks are serialized with everything else the owner does.
+ */
+class TimerListener
+{
+public:
+  virtual ~TimerListener(){};
+  virtual void timerExpired(TimerId id) = 0;
+};
+
+/** The TimerWheel class provides cheap one-shot timers.
+ *
+ * Timers are kept in four wheels of 256 slots. The first wheel holds the
+ * timers which expire within the next 256 ticks and each further wheel
+ * covers a range 256 times larger. Timers in the outer wheels are cascaded
+ * inwards as time advances. Timer nodes are kept in a pool and linked into
+ * their slots by index, so scheduling and cancelling are O(1) and do not
+ * allocate once the pool has grown to its working size.
+ *
+ * The wheel runs its own thread which advances time using a monotonic clock.
+ * Expired timers are handed to their TimerListener rather than being called
+ * on the wheel's thread. A timer which is cancelled before it is dispatched
+ * will never run.
+ */
+class TimerWheel : boost::noncopyable
+{
+public:
+  /** Construct a TimerWheel
+  *
+  *   \param resolution   The length of one tick of the wheel.
+  */
+  explicit TimerWheel(boost::posix_time::time_duration resolution = boost::posix_time::milliseconds(1))
+    :freeList_(-1)
+    ,currentTick_(0)
+    ,numTimers_(0)
+    ,numPending_(0)
+    ,resolution_(resolution.total_microseconds() * 1000)
+  {
+    if(resolution_.count() <= 0)
+      resolution_ = boost::chrono::milliseconds(1);
+    for(int w = 0; w < NUM_WHEELS; ++w)
+      for(int s = 0; s < WHEEL_SIZE; ++s)
+        slots_[w][s] = -1;
+  }
+
+  virtual ~TimerWheel()
+  {
+    stop();
+  }
+
+  /// Start the thread which advances the wheel.
+  void start()
+  {
+    if(!thread_)
+      thread_.reset( new boost::thread( boost::bind( &TimerWheel::threadLoop, this ) ) );
+  }
+
+  /// Stop the thread which advances the wheel. Pending timers are kept.
+  void stop()
+  {
+    if(thread_)
+    {
+      thread_->interrupt();
+      thread_->join();
+      thread_.reset();
+    }
+  }
+
+  /** Schedule a timer
+  *
+  *   \param owner      The listener to notify when the timer expires.
+  *   \param delay      Time until the timer expires - rounded up to whole ticks.
+  *   \param callback   The function to run when the timer is dispatched.
+  *   \return The id of the new timer.
+  */
+  TimerId schedule(TimerListener* owner,
+                   boost::posix_time::time_duration delay,
+                   TimerCallback callback)
+  {
+    boost::uint64_t ticks = toTicks(delay);
+
+    boost::mutex::scoped_lock lock(mutex_);
+    int i = allocateNode();
+    TimerNode& n = nodes_[i];
+    n.owner = owner;
+    n.callback = callback;
+    n.state = PENDING;
+    n.expiry = currentTick_ + ticks - 1;
+    link(i);
+    ++numTimers_;
+    ++numPending_;
+    return makeId(i, n.generation);
+  }
+
+  /** Cancel a timer
+  *
+  *   \param id   The id of the timer.
+  *   \return True if the timer was cancelled, false if it had already run
+  *           or been cancelled.
+  */
+  bool cancel(TimerId id)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    int i = findNode(id);
+    if(i < 0)
+      return false;
+    if(nodes_[i].state == PENDING)
+    {
+      unlink(i);
+      --numPending_;
+    }
+    releaseNode(i);
+    return true;
+  }
+
+  /** Run the callback of an expired timer
+  *
+  *   Called by the TimerListener on its own thread after being notified
+  *   through TimerListener::timerExpired().
+  *
+  *   \param id   The id of the expired timer.
+  *   \return True if the callback was run, false if the timer was cancelled.
+  */
+  bool dispatch(TimerId id)
+  {
+    TimerCallback callback;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      int i = findNode(id);
+      if(i < 0 || nodes_[i].state != EXPIRED)
+        return false;
+      callback.swap(nodes_[i].callback);
+      releaseNode(i);
+    }
+    if(callback)
+      callback();
+    return true;
+  }
+
+  /** Advance the wheel, notifying the owners of any timers which expire
+  *
+  *   This is called by the wheel's own thread. It may be called directly
+  *   when the thread has not been started.
+  *
+  *   \param ticks  The number of ticks to advance by.
+  */
+  void advance(boost::uint64_t ticks)
+  {
+    expired_.clear();
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while(ticks > 0)
+      {
+        //Nothing to cascade or expire if there are no pending timers
+        if(numPending_ == 0)
+        {
+          currentTick_ += ticks;
+          break;
+        }
+        runTick();
+        --ticks;
+      }
+    }
+
+    //Notify owners without holding the lock - they may reschedule
+    for(std::size_t i = 0; i < expired_.size(); ++i)
+      expired_[i].first->timerExpired(expired_[i].second);
+  }
+
+  /// Remove all timers from the wheel.
+  void clear()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    for(std::size_t i = 0; i < nodes_.size(); ++i)
+    {
+      if(nodes_[i].state != FREE)
+        releaseNode(i);
+    }
+    for(int w = 0; w < NUM_WHEELS; ++w)
+      for(int s = 0; s < WHEEL_SIZE; ++s)
+        slots_[w][s] = -1;
+    numPending_ = 0;
+  }
+
+  /// Get the number of timers which have not yet been dispatched or cancelled.
+  std::size_t size() const
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return numTimers_;
+  }
+
+  /// Get the number of ticks the wheel has advanced by.
+  boost::uint64_t currentTick() const
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return currentTick_;
+  }
+
+private:
+  enum { WHEEL_BITS = 8, WHEEL_SIZE = 1 << WHEEL_BITS, WHEEL_MASK = WHEEL_SIZE - 1, NUM_WHEELS = 4 };
+  enum NodeState { FREE, PENDING, EXPIRED };
+
+  /// A timer in the pool. Nodes are linked into slots (or the free list) by index.
+  struct TimerNode
+  {
+    int prev;
+    int next;
+    int slot;                     ///< Index of the slot this node is linked into.
+    boost::uint64_t expiry;       ///< Tick at which this timer expires.
+    boost::uint32_t generation;   ///< Incremented each time the node is reused.
+    NodeState state;
+    TimerListener* owner;
+    TimerCallback callback;
+
+    TimerNode()
+      :prev(-1), next(-1), slot(-1), expiry(0), generation(1), state(FREE), owner(NULL)
+    {}
+  };
+
+  typedef boost::chrono::steady_clock Clock;
+
+  static TimerId makeId(int index, boost::uint32_t generation)
+  {
+    return (TimerId(generation) << 32) | TimerId(boost::uint32_t(index));
+  }
+
+  boost::uint64_t toTicks(boost::posix_time::time_duration delay) const
+  {
+    boost::int64_t ns = delay.total_microseconds() * 1000;
+    boost::int64_t res = resolution_.count();
+    boost::int64_t ticks = (ns + res - 1) / res;
+    if(ticks < 1)
+      ticks = 1;
+    if(ticks > 0xffffffffLL)
+      ticks = 0xffffffffLL;
+    return boost::uint64_t(ticks);
+  }
+
+  /// Get the index of a live node from a timer id, or -1.
+  int findNode(TimerId id) const
+  {
+    boost::uint32_t index = boost::uint32_t(id & 0xffffffff);
+    boost::uint32_t generation = boost::uint32_t(id >> 32);
+    if(index >= nodes_.size())
+      return -1;
+    const TimerNode& n = nodes_[index];
+    if(n.state == FREE || n.generation != generation)
+      return -1;
+    return int(index);
+  }
+
+  int allocateNode()
+  {
+    if(freeList_ < 0)
+    {
+      nodes_.push_back(TimerNode());
+      return int(nodes_.size() - 1);
+    }
+    int i = freeList_;
+    freeList_ = nodes_[i].next;
+    nodes_[i].next = -1;
+    return i;
+  }
+
+  void releaseNode(int i)
+  {
+    TimerNode& n = nodes_[i];
+    n.state = FREE;
+    n.slot = -1;
+    n.owner = NULL;
+    n.callback.clear();
+    n.prev = -1;
+    n.next = freeList_;
+    ++n.generation;
+    if(n.generation == 0)
+      n.generation = 1;
+    freeList_ = i;
+    --numTimers_;
+  }
+
+  /// Link a pending node into the slot for its expiry time.
+  void link(int i)
+  {
+    TimerNode& n = nodes_[i];
+    boost::uint64_t delta = n.expiry - currentTick_;
+    int w = 0;
+    while(w < NUM_WHEELS - 1 && delta >= (boost::uint64_t(1) << ((w + 1) * WHEEL_BITS)))
+      ++w;
+    int s = int((n.expiry >> (w * WHEEL_BITS)) & WHEEL_MASK);
+
+    n.slot = w * WHEEL_SIZE + s;
+    n.prev = -1;
+    n.next = slots_[w][s];
+    if(n.next >= 0)
+      nodes_[n.next].prev = i;
+    slots_[w][s] = i;
+  }
+
+  /// Unlink a pending node from its slot.
+  void unlink(int i)
+  {
+    TimerNode& n = nodes_[i];
+    if(n.prev >= 0)
+      nodes_[n.prev].next = n.next;
+    else
+      slots_[n.slot / WHEEL_SIZE][n.slot % WHEEL_SIZE] = n.next;
+    if(n.next >= 0)
+      nodes_[n.next].prev = n.prev;
+    n.prev = n.next = n.slot = -1;
+  }
+
+  /// Move all timers in a slot of an outer wheel to the inner wheels.
+  void cascade(int wheel, int slot)
+  {
+    int i = slots_[wheel][slot];
+    slots_[wheel][slot] = -1;
+    while(i >= 0)
+    {
+      int next = nodes_[i].next;
+      link(i);
+      i = next;
+    }
+  }
+
+  /// Process the current tick and move on to the next.
+  void runTick()
+  {
+    int index = int(currentTick_ & WHEEL_MASK);
+    if(index == 0)
+    {
+      for(int w = 1; w < NUM_WHEELS; ++w)
+      {
+        int outer = int((currentTick_ >> (w * WHEEL_BITS)) & WHEEL_MASK);
+        cascade(w, outer);
+        if(outer != 0)
+          break;
+      }
+    }
+
+    int i = slots_[0][index];
+    slots_[0][index] = -1;
+    while(i >= 0)
+    {
+      TimerNode& n = nodes_[i];
+      int next = n.next;
+      n.prev = n.next = n.slot = -1;
+      n.state = EXPIRED;
+      --numPending_;
+      expired_.push_back(std::make_pair(n.owner, makeId(i, n.generation)));
+      i = next;
+    }
+    ++currentTick_;
+  }
+
+  /// The loop of the wheel thread.
+  void threadLoop()
+  {
+    Clock::time_point startTime = Clock::now();
+    boost::int64_t ticksRun = 0;
+    try{
+      while(true)
+      {
+        boost::this_thread::sleep_until(startTime + resolution_ * (ticksRun + 1));
+        boost::int64_t elapsed = (Clock::now() - startTime) / resolution_;
+        if(elapsed > ticksRun)
+        {
+          advance(elapsed - ticksRun);
+          ticksRun = elapsed;
+        }
+      }
+    }
+    catch(boost::thread_interrupted&)
+    {}
+  }
+
+  std::vector< TimerNode > nodes_;    ///< The pool of timer nodes.
+  int freeList_;                      ///< Head of the list of free nodes.
+  int slots_[NUM_WHEELS][WHEEL_SIZE]; ///< Head of the list of nodes in each slot.
+  boost::uint64_t currentTick_;       ///< The next tick to be processed.
+  std::size_t numTimers_;             ///< Timers not yet dispatched or cancelled.
+  std::size_t numPending_;            ///< Timers still in the wheels.
+  boost::chrono::nanoseconds resolution_;   ///< Length of a tick.
+
+  /// Timers expired during the last call to advance().
+  std::vector< std::pair< TimerListener*, TimerId > > expired_;
+
+  mutable boost::mutex mutex_;                ///< Provide thread safety.
+  boost::scoped_ptr< boost::thread > thread_; ///< Thread which advances the wheel.
+};
+
+} /* namespace iris */
+
+#endif /* IRISAPI_TIMERWHEEL_H_ */
@@ -50,7 +50,7 @@ class Version
 public:
   static const char* getApiVersion()
   {
-    return "1.1.1";
+    return "1.2.0";
   };
 };
 
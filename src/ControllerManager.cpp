@@ -33,6 +33,7 @@
  */
 
 #include "iris/ControllerManager.h"
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 #include "irisapi/Version.h"
@@ -45,6 +46,7 @@ namespace iris
 {
 
     ControllerManager::ControllerManager()
+        :subscriptions_(new SubscriptionTable)
     {
     }
 
@@ -55,57 +57,12 @@ namespace iris
 
     void ControllerManager::addRepository(std::string repoPath)
     {
-        while(!repoPath.empty())
+        //Repositories are indexed once and shared - add the ones we don't have yet
+        vector< b::shared_ptr<RepositoryIndex> > indices = RepositoryIndex::getAll(repoPath);
+        for(vector< b::shared_ptr<RepositoryIndex> >::iterator i = indices.begin(); i != indices.end(); ++i)
         {
-            //Extract paths from the repository string
-            size_t pos = repoPath.find_first_of(';');
-            string str(repoPath, 0, pos);
-            repoPath.erase(0, pos);
-            // break out of the while if str is empty (e.g. with a repos="/path/to/1;")
-            if (str.empty())
-                break;
-
-            bfs::path currentPath(str);
-
-            //Check that the path exists and is a directory
-            if(!bfs::exists(currentPath) || !bfs::is_directory(currentPath))
-            {
-                throw ResourceNotFoundException("Could not add controller repository - path does not exist or is not a directory.");
-            }
-
-            //Create a repository object
-            ControllerRepository tmp;
-            tmp.path = currentPath;
-
-            //Go through files in the repository and add to the repository vector of component libraries
-            bfs::directory_iterator dir_iter(currentPath), dir_end;
-            for(;dir_iter != dir_end; ++dir_iter)
-            {
-                //Check that the file path contains the system library extension
-#if BOOST_FILESYSTEM_VERSION == 2
-              string filename = dir_iter->path().leaf();
-#else
-              string filename = dir_iter->path().filename().string();
-#endif
-                size_t pos = filename.find_last_of('.');
-                if(pos != string::npos)
-                {
-                    string extension = filename.substr(pos);
-                    if(extension == SharedLibrary::getSystemExtension())
-                    {
-                        size_t pre = SharedLibrary::getSystemPrefix().length();
-                        string stem = filename.substr(pre,pos-pre); //Remove library prefix and postfix
-                        ControllerLibrary current;
-                        current.path = dir_iter->path();
-                        current.name = stem;
-                        boost::to_lower(current.name);
-                        tmp.controllerLibs.push_back(current);
-                    }
-                }
-            }
-
-            //Add to vector of repository paths
-            repositories_.push_back(tmp);
+            if(find(repositories_.begin(), repositories_.end(), *i) == repositories_.end())
+                repositories_.push_back(*i);
         }
     }
 
@@ -114,49 +71,26 @@ namespace iris
         ControllerLibrary temp;
 
         //Check if the library has already been loaded
-        vector< ControllerLibrary >::iterator libIt;
-        for(libIt=loadedLibraries_.begin();libIt!=loadedLibraries_.end();++libIt)
+        LibraryMap::iterator libIt = loadedLibraries_.find(desc.type);
+        if(libIt != loadedLibraries_.end())
         {
-            if(libIt->name == desc.type)
-                temp = *(libIt);
+            temp = libIt->second;
         }
-
-        //If the library hasn't already been loaded, look for it in our repositories
-        if(temp.name == "")
-        {
-          vector< ControllerRepository >::iterator repIt;
-          for(repIt=repositories_.begin();repIt!=repositories_.end();++repIt)
-          {
-              vector< ControllerLibrary >::iterator compIt;
-              for(compIt=repIt->controllerLibs.begin();compIt!=repIt->controllerLibs.end();++compIt)
-              {
-                  if(compIt->name == desc.type)
-                  {
-                    if(temp.name == "")
-                    {   //First component found which matches
-                        temp = *compIt;
-                    }
-                    else if(bfs::last_write_time(compIt->path) > bfs::last_write_time(temp.path))
-                    {   //Found more than one component which matches - choose the more recent one
-                        temp = *compIt;
-                    }
-                  }
-              }
-          }
-        }
-
-        //Check that we found it
-        if(temp.name == "")
+        else
         {
-          LOG(LFATAL) << "Could not find controller " << desc.name << " in repositories.";
-          throw ResourceNotFoundException("Could not find controller " + desc.type + " in repositories.");
-        }
+            //Look for the library in our repositories
+            LibraryLocation location;
+            if(!RepositoryIndex::findLibrary(repositories_, desc.type, location))
+            {
+                LOG(LFATAL) << "Could not find controller " << desc.type << " in repositories.";
+                throw ResourceNotFoundException("Could not find controller " + desc.type + " in repositories.");
+            }
 
-        //Load if necessary
-        if(temp.libPtr == NULL)
-        {
-          temp.libPtr.reset(new SharedLibrary(temp.path));
-          loadedLibraries_.push_back(temp);
+            //Get the library from the cache, opening it if necessary, and add to map of loaded libraries
+            temp.name = desc.type;
+            temp.path = location.path;
+            temp.libPtr = LibraryCache::get(location.path, location.loadFlags);
+            loadedLibraries_[temp.name] = temp;
         }
 
         //Pull a Controller class out of the library
@@ -182,6 +116,7 @@ namespace iris
         //Set the LoggingPolicy and EngineManagerControllerInterface
         cont->setLoggingPolicy(Logger::getPolicy());
         cont->setCallbackInterface(this);
+        cont->setTimerWheel(&timerWheel_);    //Provide the timer service to the controller
 
         //Set the parameter values here
         vector<ParameterDescription>::iterator i = desc.parameters.begin();
@@ -190,8 +125,11 @@ namespace iris
           cont->setValue(i->name, i->value);
         }
 
-        //Call load on the controller
-        cont->load();
+        //Call load on the controller - it runs on the shared executor if there is one
+        unsigned sharedThreads = ControllerExecutor::getDefaultThreads();
+        if(sharedThreads > 0 && !executor_)
+            executor_.reset(new ControllerExecutor(sharedThreads));
+        cont->load(!executor_);
 
         //Add to loadedControllers_
         LoadedController l(temp.name, cont);
@@ -203,23 +141,19 @@ namespace iris
     bool ControllerManager::controllerExists(std::string name)
     {
         //Look for the controller in our repositories
-        vector< ControllerRepository >::iterator repIt;
+        vector< b::shared_ptr<RepositoryIndex> >::iterator repIt;
         for(repIt=repositories_.begin();repIt!=repositories_.end();++repIt)
         {
-            vector< ControllerLibrary >::iterator compIt;
-            for(compIt=repIt->controllerLibs.begin();compIt!=repIt->controllerLibs.end();++compIt)
-            {
-                if(compIt->name == name)
-                {
-                    return true;
-                }
-            }
+            if((*repIt)->contains(name))
+                return true;
         }
         return false;
     }
 
     void ControllerManager::startControllers()
     {
+        timerWheel_.start();
+
         //Go through the loaded Controllers and start each one
         vector< LoadedController>::iterator it;
         for(it = loadedControllers_.begin(); it != loadedControllers_.end(); ++it)
@@ -238,32 +172,52 @@ namespace iris
             it->contPtr->stop();
             LOG(LINFO) << "Controller " + it->name + " stopped.";
         }
+
+        //Pending timers are kept until the controllers are started again
+        timerWheel_.stop();
     }
 
     void ControllerManager::unloadControllers()
     {
-        //Clear the event-controller map
-        eventMap_.clear();
+        //Remove all subscriptions - the events keep their ids
+        b::mutex::scoped_lock lock(subscriptionMutex_);
+        //Queued events may point to channels - keep them until the controllers are unloaded
+        vector< b::shared_ptr<const ControllerList> > oldLists;
+        b::shared_ptr<const ControllerList> empty(new ControllerList);
+        SubscriptionTable::const_iterator subIt;
+        for(subIt = subscriptions_->begin(); subIt != subscriptions_->end(); ++subIt)
+        {
+            oldLists.push_back(b::atomic_exchange(&(*subIt)->controllers, empty));
+        }
+        lock.unlock();
+        timerWheel_.stop();
 
         //Go through the loaded Controllers and unload each one
         vector< LoadedController>::iterator it;
         for(it = loadedControllers_.begin(); it != loadedControllers_.end(); ++it)
         {
             it->contPtr->unload();
+            ControllerMetrics metrics = it->contPtr->getMetrics();
             LOG(LINFO) << "Controller " + it->name + " unloaded.";
+            LOG(LDEBUG) << "Controller " << it->name << " processed " << metrics.eventsProcessed
+                << " events - mean handling time " << metrics.meanHandlingTime
+                << "s, max " << metrics.maxHandlingTime
+                << "s, max queue depth " << metrics.maxQueueDepth;
         }
 
         //Just clear the vector, boost::shared_ptr will automatically call the custom deallocator
         loadedControllers_.clear();
+        executor_.reset();
+        timerWheel_.clear();
     }
 
     vector<bfs::path> ControllerManager::getRepositories()
     {
         vector<bfs::path> paths;
-        vector<ControllerRepository>::iterator it;
+        vector< b::shared_ptr<RepositoryIndex> >::iterator it;
         for(it=repositories_.begin();it!=repositories_.end();++it)
         {
-            paths.push_back(it->path);
+            paths.push_back((*it)->getPath());
         }
         return paths;
     }
@@ -271,12 +225,52 @@ namespace iris
     //! Inform controllers that an event has been activated
     void ControllerManager::activateEvent(Event &e)
     {
-        vector<Controller*> controllers = eventMap_[e.eventName + e.componentName];
-        vector<Controller*>::iterator contIt;
-        for(contIt=controllers.begin();contIt!=controllers.end();++contIt)
+        b::shared_ptr<const SubscriptionTable> table = b::atomic_load(&subscriptions_);
+        if(e.eventId < 0 || e.eventId >= (int)table->size())
         {
-            (*contIt)->postEvent(e);
+            //The event was activated by name - look up its id
+            e.eventId = resolveEvent(e.eventName, e.componentName);
+            table = b::atomic_load(&subscriptions_);
         }
+
+        const EventSubscription& subscription = *(*table)[e.eventId];
+        b::shared_ptr<const ControllerList> controllers = b::atomic_load(&subscription.controllers);
+        ControllerList::const_iterator contIt;
+        for(contIt=controllers->begin();contIt!=controllers->end();++contIt)
+        {
+            if(contIt->channel)
+                contIt->controller->postEvent(e, *contIt->channel);
+            else
+                contIt->controller->postEvent(e, &subscription.source);
+        }
+    }
+
+    int ControllerManager::resolveEvent(std::string eventName, std::string componentName)
+    {
+        b::mutex::scoped_lock lock(subscriptionMutex_);
+        return registerEvent(eventName, componentName);
+    }
+
+    int ControllerManager::registerEvent(const std::string& eventName, const std::string& componentName)
+    {
+        pair<string, string> key(eventName, componentName);
+        map< pair<string, string>, int >::iterator it = eventIds_.find(key);
+        if(it != eventIds_.end())
+            return it->second;
+
+        //Add the event to a copy of the table and swap it in
+        b::shared_ptr<EventSubscription> subscription(new EventSubscription);
+        subscription->source.id = subscriptions_->size();
+        subscription->source.eventName = eventName;
+        subscription->source.componentName = componentName;
+        subscription->controllers.reset(new ControllerList);
+
+        b::shared_ptr<SubscriptionTable> table(new SubscriptionTable(*subscriptions_));
+        table->push_back(subscription);
+        b::atomic_store(&subscriptions_, b::shared_ptr<const SubscriptionTable>(table));
+
+        eventIds_[key] = subscription->source.id;
+        return subscription->source.id;
     }
 
     //! Reconfigure the radio
@@ -303,11 +297,48 @@ namespace iris
         return engineManager_->getParameterValue(paramName, componentName);
     }
 
+    //! Resolve a parameter for fast reconfiguration
+    ParameterHandle ControllerManager::resolveParameter(std::string paramName, std::string componentName)
+    {
+        if(engineManager_ == NULL)
+            return ParameterHandle();
+
+        return engineManager_->resolveParameter(paramName, componentName);
+    }
+
+    //! Reconfigure a resolved parameter
+    void ControllerManager::reconfigureParameter(const TypedParametricReconfig& reconfig)
+    {
+        if(engineManager_ == NULL)
+            return;
+
+        engineManager_->reconfigureParameter(reconfig);
+    }
+
     //! Subscribe to an event
-    void ControllerManager::subscribeToEvent(std::string eventName, std::string componentName, Controller* cont)
+    void ControllerManager::subscribeToEvent(std::string eventName, std::string componentName, Controller* cont,
+        const EventPolicy& policy)
     {
-        eventMap_[eventName + componentName].push_back(cont); 
+        b::mutex::scoped_lock lock(subscriptionMutex_);
+        int id = registerEvent(eventName, componentName);
+        EventSubscription& subscription = *(*subscriptions_)[id];
+
+        Subscriber subscriber;
+        subscriber.controller = cont;
+        if(!policy.isDefault())
+            subscriber.channel.reset(new EventChannel(&subscription.source, policy));
+
+        //Add the controller to a copy of the list and swap it in
+        b::shared_ptr<ControllerList> controllers(new ControllerList(*subscription.controllers));
+        controllers->push_back(subscriber);
+        b::atomic_store(&subscription.controllers, b::shared_ptr<const ControllerList>(controllers));
     }
 
+    //! Run a controller on the shared executor
+    void ControllerManager::scheduleController(Controller* cont)
+    {
+        if(executor_)
+            executor_->schedule(cont);
+    }
 
 } /* namespace iris */
@@ -35,6 +35,8 @@
 #include "iris/EngineManager.h"
 #include "iris/PhyEngine.h"
 #include "iris/StackEngine.h"
+#include "iris/SdfEngine.h"
+#include "iris/TaskGroup.h"
 
 using namespace std;
 namespace b = boost;
@@ -43,13 +45,15 @@ namespace iris
 {
 
     EngineManager::EngineManager()
+        :published_(new PublishedParameterMap),
+        publishedStale_(false)
     {
         controllerManager_.setCallbackInterface(this);
     }
 
-    void EngineManager::loadRadio(RadioRepresentation rad)
+    void EngineManager::loadRadio(const RadioRepresentation& rad)
     {
-        //Set the current radio representation
+        //Set the current radio representation - shares the contents of rad
         radioRep_ = rad;
 
         //Set the controller repositories in the ControllerManager
@@ -69,47 +73,78 @@ namespace iris
         EngVertexIterator i, iend;
         for(b::tie(i,iend) = vertices(engineGraph_); i != iend; ++i)
         {
-            //Get the engine description
-            EngineDescription current = engineGraph_[*i];
-
             //Add the engine to our vector
-            engines_.push_back(createEngine(current));
+            engines_.push_back(createEngine(engineGraph_[*i]));
         }
 
-        //Do a topological sort of the graph
-        deque<unsigned> topoOrder;
-        topological_sort(engineGraph_, front_inserter(topoOrder), b::vertex_index_map(b::identity_property_map()));
+        //Load the engines in waves - an engine can be loaded once all engines feeding it
+        //have been loaded, and the engines in a wave are loaded concurrently
+        vector<unsigned> waiting(num_vertices(engineGraph_));
+        vector<unsigned> wave;
+        EngVertexIterator v, vend;
+        for(b::tie(v,vend) = vertices(engineGraph_); v != vend; ++v)
+        {
+            waiting[*v] = in_degree(*v, engineGraph_);
+            if(waiting[*v] == 0)
+                wave.push_back(*v);
+        }
 
-        //Go through graph in topological order and set buffers
-        for(deque<unsigned>::iterator i = topoOrder.begin(); i != topoOrder.end(); ++i)
+        size_t numLoaded = 0;
+        while(!wave.empty())
         {
-            //Get input buffers
-            vector< b::shared_ptr< DataBufferBase > > inputBuffers, outputBuffers;
-            EngInEdgeIterator edgeIt, edgeItEnd;
-            for(b::tie(edgeIt, edgeItEnd) = in_edges(*i, engineGraph_); edgeIt != edgeItEnd; ++edgeIt)
+            vector< vector< b::shared_ptr< DataBufferBase > > > outputs(wave.size());
+            TaskGroup loaders;
+            for(size_t i = 0; i < wave.size(); ++i)
             {
-                inputBuffers.push_back(engineGraph_[*edgeIt].theBuffer);
+                loaders.add(b::bind(&EngineManager::loadEngine, this, wave[i], b::ref(outputs[i])));
             }
+            loaders.run();
+            numLoaded += wave.size();
 
-            //Load the engine, passing in the input buffers
-            outputBuffers = engines_[*i].loadEngine(engineGraph_[*i], inputBuffers);
-
-            //Set the ouput buffers in the graph edges
-            EngOutEdgeIterator outEdgeIt, outEdgeItEnd;
-            for(b::tie(outEdgeIt, outEdgeItEnd) = out_edges(*i, engineGraph_); outEdgeIt != outEdgeItEnd; ++outEdgeIt)
+            //Set the output buffers in the graph edges, in a fixed order
+            vector<unsigned> nextWave;
+            for(size_t i = 0; i < wave.size(); ++i)
             {
-                for(vector< b::shared_ptr< DataBufferBase > >::iterator it = outputBuffers.begin(); it != outputBuffers.end(); ++it)
+                EngOutEdgeIterator outEdgeIt, outEdgeItEnd;
+                for(b::tie(outEdgeIt, outEdgeItEnd) = out_edges(wave[i], engineGraph_); outEdgeIt != outEdgeItEnd; ++outEdgeIt)
                 {
-                    LinkDescription first = (*it)->getLinkDescription();
-                    LinkDescription second = engineGraph_[*outEdgeIt];
-                    if(sameLink(first, second))
+                    for(vector< b::shared_ptr< DataBufferBase > >::iterator it = outputs[i].begin(); it != outputs[i].end(); ++it)
                     {
-                        engineGraph_[*outEdgeIt].theBuffer = *it;
-                        engineGraph_[*outEdgeIt].theBuffer->setLinkDescription( second );
+                        LinkDescription first = (*it)->getLinkDescription();
+                        LinkDescription second = engineGraph_[*outEdgeIt];
+                        if(sameLink(first, second))
+                        {
+                            engineGraph_[*outEdgeIt].theBuffer = *it;
+                            engineGraph_[*outEdgeIt].theBuffer->setLinkDescription( second );
+                        }
                     }
+
+                    unsigned sink = target(*outEdgeIt, engineGraph_);
+                    if(--waiting[sink] == 0)
+                        nextWave.push_back(sink);
                 }
             }
+            wave.swap(nextWave);
         }
+
+        if(numLoaded != num_vertices(engineGraph_))
+            throw GraphStructureErrorException("The links between engines form a cycle");
+
+        updatePublishedParameters();
+    }
+
+    void EngineManager::loadEngine(unsigned engine, vector< b::shared_ptr< DataBufferBase > >& outputs)
+    {
+        //Get input buffers
+        vector< b::shared_ptr< DataBufferBase > > inputBuffers;
+        EngInEdgeIterator edgeIt, edgeItEnd;
+        for(b::tie(edgeIt, edgeItEnd) = in_edges(engine, engineGraph_); edgeIt != edgeItEnd; ++edgeIt)
+        {
+            inputBuffers.push_back(engineGraph_[*edgeIt].theBuffer);
+        }
+
+        //Load the engine, passing in the input buffers
+        outputs = engines_[engine].loadEngine(engineGraph_[engine], inputBuffers);
     }
 
     void EngineManager::startRadio()
@@ -147,6 +182,9 @@ namespace iris
             i->unloadEngine();
         }
         engines_.clear();  //Automatic deletion of pointers due to boost::ptr_vector
+
+        b::mutex::scoped_lock lock(publishedMutex_);
+        published_.reset(new PublishedParameterMap);
     }
 
     RadioRepresentation& EngineManager::getCurrentRadio()
@@ -156,12 +194,19 @@ namespace iris
 
     void EngineManager::reconfigureRadio(ReconfigSet reconfigs)
     {
+        //Measure latency from here unless the caller already started the clock
+        if(reconfigs.issueTime.is_not_a_date_time())
+            reconfigs.issueTime = b::posix_time::microsec_clock::universal_time();
+
         //Separate out reconfigurations for each engine
         b::ptr_vector<EngineInterface>::iterator engIt;
         for(engIt = engines_.begin(); engIt != engines_.end(); ++engIt)
         {
             string current = engIt->getName();
             ReconfigSet currentReconfigs;
+            currentReconfigs.isTimed = reconfigs.isTimed;
+            currentReconfigs.timeStamp = reconfigs.timeStamp;
+            currentReconfigs.issueTime = reconfigs.issueTime;
 
             //Find parametric reconfigs for this engine
             vector<ParametricReconfig>::iterator parmIt;
@@ -180,9 +225,13 @@ namespace iris
 
             //Apply reconfigurations to the relevent engine if non-empty
             if(!(currentReconfigs.paramReconfigs.empty() && currentReconfigs.structReconfigs.empty()))
-                engIt->addReconfiguration(currentReconfigs);
+            {
+                if(!engIt->addReconfiguration(currentReconfigs))
+                    LOG(LERROR) << "Engine " << current << " rejected part of a reconfiguration - "
+                        << "the radio representation only reflects the accepted part";
+            }
 
-            //Apply reconfigurations to the radio representation
+            //Apply the accepted reconfigurations to the radio representation
             radioRep_.reconfigureRepresentation(currentReconfigs);
         }
     }
@@ -202,16 +251,75 @@ namespace iris
 
     std::string EngineManager::getParameterValue(std::string paramName, std::string componentName)
     {
+        if(publishedStale_.exchange(false))
+            updatePublishedParameters();
+
+        b::shared_ptr<const PublishedParameterMap> published;
+        {
+            b::mutex::scoped_lock lock(publishedMutex_);
+            published = published_;
+        }
+
+        //Prefer the live value of a running component
+        PublishedParameterMap::const_iterator it = published->find(make_pair(componentName, b::to_lower_copy(paramName)));
+        if(it != published->end())
+            return it->second.toString();
+
+        //Fall back to the radio representation
         return radioRep_.getParameterValue(paramName, componentName);
     }
 
+    void EngineManager::updatePublishedParameters()
+    {
+        b::shared_ptr<PublishedParameterMap> published(new PublishedParameterMap);
+        for(b::ptr_vector<EngineInterface>::iterator engIt = engines_.begin(); engIt != engines_.end(); ++engIt)
+        {
+            engIt->getPublishedParameters(*published);
+        }
+        b::mutex::scoped_lock lock(publishedMutex_);
+        published_ = published;
+    }
+
+    ParameterHandle EngineManager::resolveParameter(std::string paramName, std::string componentName)
+    {
+        ParameterHandle handle;
+        for(unsigned i = 0; i < engines_.size(); ++i)
+        {
+            if(engines_[i].resolveParameter(paramName, componentName, handle))
+            {
+                handle.engineIndex = i;
+                return handle;
+            }
+        }
+        throw ParameterNotFoundException("Could not find parameter " + paramName + " of component " + componentName);
+    }
+
+    void EngineManager::reconfigureParameter(const TypedParametricReconfig& reconfig)
+    {
+        int index = reconfig.handle.engineIndex;
+        if(index < 0 || index >= (int)engines_.size())
+            throw ResourceNotFoundException("Parametric reconfiguration failed: invalid parameter handle");
+        engines_[index].addReconfiguration(reconfig);
+    }
+
     void EngineManager::activateEvent(Event &e)
     {
         //Pass the event to the controller manager
         controllerManager_.activateEvent(e);
     }
 
-    EngineInterface* EngineManager::createEngine(EngineDescription& d)
+    int EngineManager::resolveEvent(std::string eventName, std::string componentName)
+    {
+        return controllerManager_.resolveEvent(eventName, componentName);
+    }
+
+    void EngineManager::componentsReplaced(std::string engineName)
+    {
+        //Rebuilt by the next reader, away from the engine thread
+        publishedStale_.store(true);
+    }
+
+    EngineInterface* EngineManager::createEngine(const EngineDescription& d)
     {
         EngineInterface* current = NULL;
 
@@ -223,6 +331,10 @@ namespace iris
         {
             current = new StackEngine(d.name, reps_.stackRepository); 
         }
+        else if(d.type == "sdfengine")
+        {
+            current = new SdfEngine(d.name, reps_.sdfRepository);
+        }
         else
         {
             throw ResourceNotFoundException("Engine type \"" + d.type + "\" does not exist.");
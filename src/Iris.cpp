@@ -119,6 +119,78 @@ bool IRISSetLogLevel(std::string level)
     }
 }
 
+bool IRISSetLogLevel(std::string name, std::string level)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setLogLevel(name, level);
+        return true;
+    }
+}
+
+bool IRISSetCacheDirectory(std::string dir)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setCacheDirectory(dir);
+        return true;
+    }
+}
+
+bool IRISSetXmlParser(std::string parser)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setXmlParser(parser);
+        return true;
+    }
+}
+
+bool IRISSetLoadThreads(unsigned threads)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setLoadThreads(threads);
+        return true;
+    }
+}
+
+bool IRISSetControllerThreads(unsigned threads)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setControllerThreads(threads);
+        return true;
+    }
+}
+
+bool IRISSetParallelInit(bool parallel)
+{
+    if(theSystem == NULL)
+    {
+        LOG(LERROR) << "System has not been initialized.";
+        return false;
+    }else{
+        theSystem->setParallelInit(parallel);
+        return true;
+    }
+}
+
 bool IRISLoadRadio(std::string radioConfig)
 {
     if(theSystem == NULL)
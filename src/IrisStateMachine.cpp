@@ -44,12 +44,22 @@ Active::Active(my_context ctx) : my_base(ctx)
     std::string sdfRadioRepository = context<IrisStateMachine>().getSdfRadioRepository();
     std::string contRadioRepository = context<IrisStateMachine>().getContRadioRepository();
     std::string logLevel = context<IrisStateMachine>().getLogLevel();
+    std::string cacheDirectory = context<IrisStateMachine>().getCacheDirectory();
+    std::string xmlParser = context<IrisStateMachine>().getXmlParser();
+    unsigned loadThreads = context<IrisStateMachine>().getLoadThreads();
+    unsigned controllerThreads = context<IrisStateMachine>().getControllerThreads();
+    bool parallelInit = context<IrisStateMachine>().getParallelInit();
     IRISInitSystem();
     IRISSetStackRepository(stackRadioRepository);
     IRISSetPhyRepository(phyRadioRepository);
     IRISSetSdfRepository(sdfRadioRepository);
     IRISSetContRepository(contRadioRepository);
     IRISSetLogLevel(logLevel);
+    IRISSetCacheDirectory(cacheDirectory);
+    IRISSetXmlParser(xmlParser);
+    IRISSetLoadThreads(loadThreads);
+    IRISSetControllerThreads(controllerThreads);
+    IRISSetParallelInit(parallelInit);
 }
 
 Loaded::Loaded(my_context ctx)
@@ -106,6 +106,7 @@ struct Running;   //!< radio is running, state within Loaded
 //! The state machine itself, start state is Active
 struct IrisStateMachine : boost::statechart::state_machine< IrisStateMachine, Active >
 {
+  IrisStateMachine() : loadThreads_(0), controllerThreads_(0), parallelInit_(false) {}
   //! set XML radio configuration
   void setRadioConfig(std::string radioConfig) { radioConfig_ = radioConfig; }
   //! return XML radio configuration
@@ -130,6 +131,26 @@ struct IrisStateMachine : boost::statechart::state_machine< IrisStateMachine, Ac
   void setLogLevel(std::string level) { logLevel_ = level; }
   //! return log level
   std::string getLogLevel() const { return logLevel_; }
+  //! set xml parser
+  void setXmlParser(std::string parser) { xmlParser_ = parser; }
+  //! return xml parser
+  std::string getXmlParser() const { return xmlParser_; }
+  //! set number of threads used to load radios
+  void setLoadThreads(unsigned threads) { loadThreads_ = threads; }
+  //! return number of threads used to load radios
+  unsigned getLoadThreads() const { return loadThreads_; }
+  //! set number of threads shared by controllers
+  void setControllerThreads(unsigned threads) { controllerThreads_ = threads; }
+  //! return number of threads shared by controllers
+  unsigned getControllerThreads() const { return controllerThreads_; }
+  //! set whether components may be initialized concurrently
+  void setParallelInit(bool parallel) { parallelInit_ = parallel; }
+  //! return whether components may be initialized concurrently
+  bool getParallelInit() const { return parallelInit_; }
+  //! set radio cache directory
+  void setCacheDirectory(std::string dir) { cacheDirectory_ = dir; }
+  //! return radio cache directory
+  std::string getCacheDirectory() const { return cacheDirectory_; }
   //! Reconfigure the radio
   void reconfigureRadio();
 private:
@@ -145,6 +166,16 @@ private:
   std::string contRadioRepository_;
   //! stores the log level
   std::string logLevel_;
+  //! stores the xml parser
+  std::string xmlParser_;
+  //! stores the number of threads used to load radios
+  unsigned loadThreads_;
+  //! stores the number of threads shared by controllers
+  unsigned controllerThreads_;
+  //! stores whether components may be initialized concurrently
+  bool parallelInit_;
+  //! stores the radio cache directory
+  std::string cacheDirectory_;
 };
 
 //! Active is the parent of all other states, destruction means termination
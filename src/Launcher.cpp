@@ -85,6 +85,16 @@ private:
     string contRepoPath_;
     //! log level
     string logLevel_;
+    //! directory for cached radio configurations
+    string cacheDir_;
+    //! xml parser
+    string xmlParser_;
+    //! number of threads used to load radios
+    unsigned loadThreads_;
+    //! number of threads shared by controllers
+    unsigned controllerThreads_;
+    //! whether components may be initialized concurrently
+    bool parallelInit_;
     //! whether to load the radio automatically at startup
     bool autoLoad_;
     //! whether to start the radio automatically at startup
@@ -144,7 +154,7 @@ int main(int argc, char* argv[])
 
 Launcher::Launcher()
     :radioConfig_(""), phyRepoPath_(""), sdfRepoPath_(""), contRepoPath_(""),
-    logLevel_("debug"), autoLoad_(true), autoStart_(true), stateMachine_(),
+    logLevel_("debug"), cacheDir_(""), xmlParser_("dom"), loadThreads_(0), controllerThreads_(0), parallelInit_(false), autoLoad_(true), autoStart_(true), stateMachine_(),
     isRunning_(true)
 {
     printBanner();
@@ -179,6 +189,11 @@ void Launcher::parseOptions(int argc, char* argv[])
         ("sdfrepository,s", po::value<string>(&sdfRepoPath_), "Repository of Iris SDF components")
         ("controllerrepository,c", po::value<string>(&contRepoPath_), "Repository of Iris controllers")
         ("loglevel,l", po::value<string>(&logLevel_), "Log level (options are debug, info, warning, error & fatal)")
+        ("xmlparser", po::value<string>(&xmlParser_), "Xml parser (options are dom & streaming)")
+        ("loadthreads", po::value<unsigned>(&loadThreads_), "Number of threads used to load radios (0 for one per processor, 1 to load sequentially)")
+        ("controllerthreads", po::value<unsigned>(&controllerThreads_), "Number of threads shared by controllers (0 for one thread per controller)")
+        ("cachedirectory", po::value<string>(&cacheDir_), "Directory for cached radio configurations (disabled if not set)")
+        ("parallelinit", "Initialize components concurrently (only if all of them allow it)")
         ("no-load",  "Do not automatically load radio (implies --no-start)")
         ("no-start", "Do not automatically start radio")
     ;
@@ -247,6 +262,9 @@ void Launcher::parseOptions(int argc, char* argv[])
 
     if (vm.count("no-start"))
         autoStart_ = false;
+
+    if (vm.count("parallelinit"))
+        parallelInit_ = true;
 }
 
 void Launcher::menuLoop()
@@ -260,6 +278,11 @@ void Launcher::menuLoop()
     stateMachine_.setSdfRadioRepository(sdfRepoPath_);
     stateMachine_.setContRadioRepository(contRepoPath_);
     stateMachine_.setLogLevel(logLevel_);
+    stateMachine_.setCacheDirectory(cacheDir_);
+    stateMachine_.setXmlParser(xmlParser_);
+    stateMachine_.setLoadThreads(loadThreads_);
+    stateMachine_.setControllerThreads(controllerThreads_);
+    stateMachine_.setParallelInit(parallelInit_);
     stateMachine_.initiate();
 
     if (autoLoad_)
@@ -310,6 +333,11 @@ void Launcher::printStatus()
     cout << "SDF Repository  : " << sdfRepoPath_ << endl;
     cout << "Controller Repository  : " << contRepoPath_ << endl;
     cout << "Log level : " << logLevel_ << endl;
+    cout << "Xml parser : " << xmlParser_ << endl;
+    cout << "Load threads : " << loadThreads_ << endl;
+    cout << "Controller threads : " << controllerThreads_ << endl;
+    cout << "Parallel init : " << (parallelInit_ ? "on" : "off") << endl;
+    cout << "Cache directory : " << cacheDir_ << endl;
     cout << "Radio Config: " << radioConfig_ << endl;
 }
 
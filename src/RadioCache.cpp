@@ -0,0 +1,376 @@
+/**
+ * \file RadioCache.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Implementation of RadioCache class - stores parsed radio configurations
+ * in a binary form.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "iris/RadioCache.h"
+#include "iris/RepositoryIndex.h"
+
+using namespace std;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace iris
+{
+
+    // Internal namespace for the cache file format
+    namespace internal{
+    //! Identifies a cache file - "IRCF"
+    const b::uint32_t cacheMagic = 0x46435249;
+    //! Changed whenever the layout of the file changes
+    const b::uint32_t cacheVersion = 1;
+
+    //! 64-bit FNV-1a hash - stable across platforms and Boost versions
+    class Fnv1a
+    {
+    public:
+        Fnv1a() : hash_(14695981039346656037ULL) {}
+        void add(const void* data, size_t length)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            for(size_t i = 0; i < length; ++i)
+            {
+                hash_ ^= p[i];
+                hash_ *= 1099511628211ULL;
+            }
+        }
+        void add(const string& s)
+        {
+            b::uint64_t length = s.size();
+            add(&length, sizeof(length));
+            add(s.data(), s.size());
+        }
+        void add(b::uint64_t value) { add(&value, sizeof(value)); }
+        b::uint64_t value() const { return hash_; }
+    private:
+        b::uint64_t hash_;
+    };
+
+    //! Appends values to a cache file image
+    class CacheWriter
+    {
+    public:
+        template <typename T>
+        void write(T value) { data_.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+        void write(const string& s)
+        {
+            write<b::uint32_t>(s.size());
+            data_.append(s);
+        }
+        const string& data() const { return data_; }
+    private:
+        string data_;
+    };
+
+    //! Reads values from a mapped cache file, checking every access
+    class CacheReader
+    {
+    public:
+        CacheReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+        template <typename T>
+        T read()
+        {
+            T value;
+            memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+        string readString()
+        {
+            b::uint32_t length = read<b::uint32_t>();
+            return string(take(length), length);
+        }
+        bool atEnd() const { return pos_ == end_; }
+    private:
+        const char* take(size_t n)
+        {
+            if((size_t)(end_ - pos_) < n)
+                throw InvalidDataException("Cache file is truncated");
+            const char* p = pos_;
+            pos_ += n;
+            return p;
+        }
+        const char* pos_;
+        const char* end_;
+    };
+
+    void writeParameters(CacheWriter& w, const vector<ParameterDescription>& params)
+    {
+        w.write<b::uint32_t>(params.size());
+        for(vector<ParameterDescription>::const_iterator i = params.begin(); i != params.end(); ++i)
+        {
+            w.write(i->name);
+            w.write(i->value);
+        }
+    }
+
+    void readParameters(CacheReader& r, vector<ParameterDescription>& params)
+    {
+        b::uint32_t count = r.read<b::uint32_t>();
+        for(b::uint32_t i = 0; i < count; ++i)
+        {
+            ParameterDescription p;
+            p.name = r.readString();
+            p.value = r.readString();
+            params.push_back(p);
+        }
+    }
+    } /* namespace internal */
+
+    b::uint64_t RadioCache::computeKey(const string& xml, const vector<string>& repositories)
+    {
+        internal::Fnv1a h;
+        h.add(internal::cacheVersion);
+        h.add(xml);
+
+        //Any library added to or removed from a repository changes the key. The
+        //indices only read a directory again when its modification time changes,
+        //so no library file is looked at here.
+        for(vector<string>::const_iterator repIt = repositories.begin(); repIt != repositories.end(); ++repIt)
+        {
+            string repoPath = *repIt;
+            h.add(repoPath);
+            while(!repoPath.empty())
+            {
+                size_t pos = repoPath.find_first_of(';');
+                string str(repoPath, 0, pos);
+                repoPath.erase(0, pos == string::npos ? pos : pos + 1);
+
+                //Binding modes follow the path, e.g. "/path/to/1?lazy,local"
+                int flags = SharedLibrary::LOAD_DEFAULT;
+                size_t modes = str.find_last_of('?');
+                b::system::error_code ec;
+                try
+                {
+                    if(modes != string::npos)
+                    {
+                        flags = RepositoryIndex::parseLoadFlags(str.substr(modes + 1));
+                        str.erase(modes);
+                    }
+                    if(str.empty() || !bfs::is_directory(str, ec))
+                        continue;
+                }
+                catch(IrisException&)
+                {
+                    continue;   //Reported when the radio is loaded
+                }
+
+                b::shared_ptr<RepositoryIndex> index = RepositoryIndex::get(str, flags);
+                h.add(index->getPath().string());
+                h.add((b::uint64_t)index->getDirectoryTime());
+                vector<string> types = index->getTypes();
+                for(size_t i = 0; i < types.size(); ++i)
+                    h.add(types[i]);
+            }
+        }
+        return h.value();
+    }
+
+    string RadioCache::getCacheFile(string directory, string radioConfig)
+    {
+        //One cache file per configuration path - its key tells whether it is current
+        internal::Fnv1a h;
+        h.add(bfs::system_complete(radioConfig).string());
+        stringstream name;
+        name << hex << h.value() << ".radiocache";
+        return (bfs::path(directory) / name.str()).string();
+    }
+
+    void RadioCache::save(const RadioRepresentation& radio, b::uint64_t key, string filename)
+    {
+        internal::CacheWriter w;
+        w.write(internal::cacheMagic);
+        w.write(internal::cacheVersion);
+        w.write(key);
+
+        vector<ControllerDescription> controllers = radio.getControllers();
+        w.write<b::uint32_t>(controllers.size());
+        for(vector<ControllerDescription>::const_iterator i = controllers.begin(); i != controllers.end(); ++i)
+        {
+            w.write(i->name);
+            w.write(i->type);
+            internal::writeParameters(w, i->parameters);
+        }
+
+        b::shared_ptr< const vector<EngineDescription> > snapshot = radio.getEngineDescriptions();
+        const vector<EngineDescription>& engines = *snapshot;
+        w.write<b::uint32_t>(engines.size());
+        for(vector<EngineDescription>::const_iterator i = engines.begin(); i != engines.end(); ++i)
+        {
+            w.write(i->name);
+            w.write(i->type);
+            w.write<b::uint32_t>(i->components.size());
+            vector<ComponentDescription>::const_iterator compIt;
+            for(compIt = i->components.begin(); compIt != i->components.end(); ++compIt)
+            {
+                w.write(compIt->name);
+                w.write(compIt->type);
+                w.write(compIt->engineName);
+                internal::writeParameters(w, compIt->parameters);
+                w.write<b::uint32_t>(compIt->ports.size());
+                vector<PortDescription>::const_iterator portIt;
+                for(portIt = compIt->ports.begin(); portIt != compIt->ports.end(); ++portIt)
+                {
+                    w.write(portIt->name);
+                    w.write(portIt->type);
+                }
+            }
+        }
+
+        vector<LinkDescription> links = radio.getLinks();
+        w.write<b::uint32_t>(links.size());
+        for(vector<LinkDescription>::const_iterator i = links.begin(); i != links.end(); ++i)
+        {
+            w.write(i->sourceComponent);
+            w.write(i->sourcePort);
+            w.write(i->sinkComponent);
+            w.write(i->sinkPort);
+            w.write<b::uint64_t>(i->bufferCapacity);
+            w.write<b::uint32_t>(i->bufferPolicy);
+        }
+
+        //Write a temporary file and rename it so readers never see a partial cache
+        string tmpName = filename + ".tmp";
+        b::system::error_code ec;
+        bfs::path parent = bfs::path(filename).parent_path();
+        if(!parent.empty())
+            bfs::create_directories(parent, ec);
+        {
+            ofstream out(tmpName.c_str(), ios::binary | ios::trunc);
+            out.write(w.data().data(), w.data().size());
+            if(!out)
+                throw ResourceNotFoundException("Could not write radio cache file " + tmpName);
+        }
+        bfs::rename(tmpName, filename, ec);
+        if(ec)
+        {
+            bfs::remove(tmpName, ec);
+            throw ResourceNotFoundException("Could not write radio cache file " + filename);
+        }
+    }
+
+    bool RadioCache::load(string filename, b::uint64_t key, RadioRepresentation& radio)
+    {
+        b::system::error_code ec;
+        if(!bfs::is_regular_file(filename, ec) || bfs::file_size(filename, ec) == 0)
+            return false;
+
+        try
+        {
+            bip::file_mapping file(filename.c_str(), bip::read_only);
+            bip::mapped_region region(file, bip::read_only);
+            internal::CacheReader r(static_cast<const char*>(region.get_address()), region.get_size());
+
+            if(r.read<b::uint32_t>() != internal::cacheMagic || r.read<b::uint32_t>() != internal::cacheVersion)
+            {
+                LOG(LINFO) << "Ignoring radio cache " << filename << " - unknown format";
+                return false;
+            }
+            if(r.read<b::uint64_t>() != key)
+            {
+                LOG(LINFO) << "Radio cache " << filename << " is out of date";
+                return false;
+            }
+
+            RadioRepresentation cached;
+            b::uint32_t count = r.read<b::uint32_t>();
+            for(b::uint32_t i = 0; i < count; ++i)
+            {
+                ControllerDescription con;
+                con.name = r.readString();
+                con.type = r.readString();
+                internal::readParameters(r, con.parameters);
+                cached.addControllerDescription(con);
+            }
+
+            count = r.read<b::uint32_t>();
+            for(b::uint32_t i = 0; i < count; ++i)
+            {
+                EngineDescription eng;
+                eng.name = r.readString();
+                eng.type = r.readString();
+                b::uint32_t numComps = r.read<b::uint32_t>();
+                for(b::uint32_t j = 0; j < numComps; ++j)
+                {
+                    ComponentDescription comp;
+                    comp.name = r.readString();
+                    comp.type = r.readString();
+                    comp.engineName = r.readString();
+                    internal::readParameters(r, comp.parameters);
+                    b::uint32_t numPorts = r.read<b::uint32_t>();
+                    for(b::uint32_t k = 0; k < numPorts; ++k)
+                    {
+                        PortDescription port;
+                        port.name = r.readString();
+                        port.type = r.readString();
+                        comp.ports.push_back(port);
+                    }
+                    eng.components.push_back(comp);
+                }
+                cached.addEngineDescription(eng);
+            }
+
+            count = r.read<b::uint32_t>();
+            for(b::uint32_t i = 0; i < count; ++i)
+            {
+                LinkDescription link;
+                link.sourceComponent = r.readString();
+                link.sourcePort = r.readString();
+                link.sinkComponent = r.readString();
+                link.sinkPort = r.readString();
+                link.bufferCapacity = r.read<b::uint64_t>();
+                link.bufferPolicy = static_cast<BufferPolicy>(r.read<b::uint32_t>());
+                cached.addLinkDescription(link);
+            }
+            if(!r.atEnd())
+                throw InvalidDataException("Unexpected data at the end of the cache file");
+
+            cached.buildGraphs();
+            radio = cached;
+            return true;
+        }
+        catch(std::exception& ex)
+        {
+            LOG(LWARNING) << "Ignoring radio cache " << filename << ": " << ex.what();
+            return false;
+        }
+    }
+
+} /* namespace iris */
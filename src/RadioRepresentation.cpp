@@ -36,6 +36,7 @@
 #include "irisapi/ReconfigurationDescriptions.h"
 
 #include <boost/graph/graph_utility.hpp>
+#include <boost/functional/hash.hpp>
 
 using std::vector;
 using std::string;
@@ -47,10 +48,12 @@ namespace iris
 {
 
     RadioRepresentation::RadioRepresentation()
-        :isBuilt_(false)
+        :contents_(new Contents)
+        ,paramIndex_(new ParameterIndex)
     {}
 
     RadioRepresentation::RadioRepresentation(const RadioRepresentation& r)
+        :contents_(new Contents)
     {
         copy(r);
     }
@@ -63,29 +66,40 @@ namespace iris
 
     void RadioRepresentation::copy(const RadioRepresentation& r)
     {
-        isBuilt_ = r.isBuilt_;
-        controllers_ = r.controllers_;
-        links_ = r.links_;
-        engines_ = r.engines_;
-        externalLinks_ = r.externalLinks_;
-        radioGraph_ = r.radioGraph_;
-        engineGraph_ = r.engineGraph_;
+        if(&r == this)
+            return;
+
+        //Contents and index snapshots are shared - whichever side changes first copies them
+        b::shared_ptr<Contents> contents = r.getContents();
+        {
+            b::mutex::scoped_lock lock(mutex_);
+            contents_.swap(contents);
+        }
+        setParameterIndex(r.getParameterIndex());
+    }
+
+    bool RadioRepresentation::sharesContents(const RadioRepresentation& r) const
+    {
+        return getContents() == r.getContents();
     }
 
     void RadioRepresentation::addControllerDescription(ControllerDescription con)
     {
-        controllers_.push_back(con);
+        b::mutex::scoped_lock lock(mutex_);
+        mutableContents().controllers.push_back(con);
     }
 
     void RadioRepresentation::addEngineDescription(EngineDescription eng)
     {
-        engines_.push_back(eng);
+        b::mutex::scoped_lock lock(mutex_);
+        mutableContents().engines.push_back(eng);
     }
 
 
     void RadioRepresentation::addLinkDescription(LinkDescription link)
     {
-        links_.push_back(link);
+        b::mutex::scoped_lock lock(mutex_);
+        mutableContents().links.push_back(link);
     }
 
     //Use the link descriptions and engine descriptions to build the radio graph, the engine graph and the
@@ -93,73 +107,75 @@ namespace iris
     void RadioRepresentation::buildGraphs()
     {
         b::mutex::scoped_lock lock(mutex_);
+        Contents& c = mutableContents();
 
         //Add component descriptions as vertices to radio graph
         vector<EngineDescription>::iterator engIt;
-        for(engIt = engines_.begin(); engIt != engines_.end(); engIt++)
+        for(engIt = c.engines.begin(); engIt != c.engines.end(); engIt++)
         {
             vector<ComponentDescription>::iterator compIt;
             for(compIt = engIt->components.begin(); compIt != engIt->components.end(); compIt++)
             {
                 //Add the component description to the component graph
-                Vertex v = add_vertex(radioGraph_);
-                radioGraph_[v] = *compIt;
+                compIt->fingerprint = fingerprint(*compIt);
+                Vertex v = add_vertex(c.radioGraph);
+                c.radioGraph[v] = *compIt;
             }
         }
 
         //Add all the links as edges of the radio graph
         vector<LinkDescription>::iterator linkIt;
-        for(linkIt = links_.begin(); linkIt != links_.end(); linkIt++)
+        for(linkIt = c.links.begin(); linkIt != c.links.end(); linkIt++)
         {
             Vertex src, snk;
-            if(!findComponent(linkIt->sourceComponent, radioGraph_, src))
+            if(!findComponent(linkIt->sourceComponent, c.radioGraph, src))
                 throw GraphStructureErrorException("Could not find component " + linkIt->sourceComponent + " referenced by link");
-            if(!findComponent(linkIt->sinkComponent, radioGraph_, snk))
+            if(!findComponent(linkIt->sinkComponent, c.radioGraph, snk))
                 throw GraphStructureErrorException("Could not find component " + linkIt->sinkComponent + " referenced by link");
             bool inserted;
             Edge e;
-            b::tie(e, inserted) = add_edge(src, snk, radioGraph_);
-            radioGraph_[e] = *linkIt;
+            b::tie(e, inserted) = add_edge(src, snk, c.radioGraph);
+            c.radioGraph[e] = *linkIt;
         }
 
         //Find all the internal and external (ones that cross engine boundaries) edges
         EdgeIterator ei, eiend;
-        for(b::tie(ei,eiend) = edges(radioGraph_); ei != eiend; ++ei)
+        for(b::tie(ei,eiend) = edges(c.radioGraph); ei != eiend; ++ei)
         {
             string srcEng, snkEng;
-            srcEng = radioGraph_[source(*ei, radioGraph_)].engineName;
-            snkEng = radioGraph_[target(*ei, radioGraph_)].engineName;
+            srcEng = c.radioGraph[source(*ei, c.radioGraph)].engineName;
+            snkEng = c.radioGraph[target(*ei, c.radioGraph)].engineName;
 
             //Set the source and sink engines
-            radioGraph_[*ei].sourceEngine = srcEng;
-            radioGraph_[*ei].sinkEngine = snkEng;
+            c.radioGraph[*ei].sourceEngine = srcEng;
+            c.radioGraph[*ei].sinkEngine = snkEng;
 
             if(srcEng != snkEng) //External link
             {
                 //Add to the vector of external links
-                externalLinks_.push_back(radioGraph_[*ei]);
+                c.externalLinks.push_back(c.radioGraph[*ei]);
             }
             else //Internal link
             {
                 //Find the engine which the link belongs to and add it
-                for(engIt = engines_.begin(); engIt != engines_.end(); engIt++)
+                for(engIt = c.engines.begin(); engIt != c.engines.end(); engIt++)
                 {
                     if(engIt->name == srcEng)
-                        engIt->links.push_back(radioGraph_[*ei]);
+                        engIt->links.push_back(c.radioGraph[*ei]);
                 }
             }
         }
 
         //Build all the individual engine graphs
-        for(engIt = engines_.begin(); engIt != engines_.end(); engIt++)
+        for(engIt = c.engines.begin(); engIt != c.engines.end(); engIt++)
         {
             buildEngineDescriptionGraph(*engIt);
         }
 
         //Add external links to the engine descriptions
-        for(linkIt = externalLinks_.begin(); linkIt != externalLinks_.end(); linkIt++)
+        for(linkIt = c.externalLinks.begin(); linkIt != c.externalLinks.end(); linkIt++)
         {
-            for(engIt = engines_.begin(); engIt != engines_.end(); engIt++)
+            for(engIt = c.engines.begin(); engIt != c.engines.end(); engIt++)
             {
                 if(engIt->name == linkIt->sourceEngine || engIt->name == linkIt->sinkEngine)
                 {
@@ -169,110 +185,224 @@ namespace iris
         }
 
         //Build the overall engine graph
-        for(engIt = engines_.begin(); engIt != engines_.end(); engIt++)
+        for(engIt = c.engines.begin(); engIt != c.engines.end(); engIt++)
         {
+            engIt->fingerprint = fingerprint(*engIt);
+
             //Add the engine description to the engine graph
-            EngVertex engV = add_vertex(engineGraph_);
-            engineGraph_[engV] = *engIt;
+            EngVertex engV = add_vertex(c.engineGraph);
+            c.engineGraph[engV] = *engIt;
         }
         vector<LinkDescription>::iterator exLinkIt;
-        for(exLinkIt = externalLinks_.begin(); exLinkIt != externalLinks_.end(); ++exLinkIt)
+        for(exLinkIt = c.externalLinks.begin(); exLinkIt != c.externalLinks.end(); ++exLinkIt)
         {
             LinkDescription el = *exLinkIt;
             //Add link to the engine graph
             EngVertex engSrc, engSnk;
-            if(!findEngine(el.sourceEngine, engineGraph_, engSrc))
+            if(!findEngine(el.sourceEngine, c.engineGraph, engSrc))
                 throw GraphStructureErrorException("Could not find engine " + el.sourceEngine);
-            if(!findEngine(el.sinkEngine, engineGraph_, engSnk))
+            if(!findEngine(el.sinkEngine, c.engineGraph, engSnk))
                 throw GraphStructureErrorException("Could not find engine " + el.sinkEngine);
 
             bool inserted;
             EngEdge engE;
-            b::tie(engE, inserted) = add_edge(engSrc, engSnk, engineGraph_);
-            engineGraph_[engE] = el;
+            b::tie(engE, inserted) = add_edge(engSrc, engSnk, c.engineGraph);
+            c.engineGraph[engE] = el;
         }
 
-        isBuilt_ = true;
+        rebuildParameterIndex(c.radioGraph);
+
+        c.isBuilt = true;
     }
 
     void RadioRepresentation::reconfigureRepresentation(ReconfigSet reconfigs)
     {
+        b::mutex::scoped_lock lock(mutex_);
+        Contents& c = mutableContents();
+
+        //Work on a private copy of the index and publish it once at the end
+        b::shared_ptr<ParameterIndex> index(new ParameterIndex(*getParameterIndex()));
+
         //Find all the parametric reconfigurations and apply them
         vector< ParametricReconfig >::iterator paramIt;
-        for(paramIt = reconfigs.paramReconfigs.begin();
-            paramIt != reconfigs.paramReconfigs.end();
-            ++paramIt)
+        try
+        {
+            for(paramIt = reconfigs.paramReconfigs.begin();
+                paramIt != reconfigs.paramReconfigs.end();
+                ++paramIt)
+            {
+                reconfigureParameter(*paramIt, c, *index);
+            }
+
+            //Replaced components are the only structural changes engines make while running
+            vector< StructuralReconfig >::iterator structIt;
+            for(structIt = reconfigs.structReconfigs.begin();
+                structIt != reconfigs.structReconfigs.end();
+                ++structIt)
+            {
+                vector< NewComponent >::iterator compIt;
+                for(compIt = structIt->replacedComponents.begin();
+                    compIt != structIt->replacedComponents.end();
+                    ++compIt)
+                {
+                    replaceComponent(structIt->engineName, *compIt, c, *index);
+                }
+            }
+        }
+        catch(...)
         {
-            reconfigureParameter(*paramIt);
+            //Keep the index consistent with the reconfigurations already applied
+            setParameterIndex(index);
+            throw;
         }
+        setParameterIndex(index);
     }
 
-    void RadioRepresentation::reconfigureParameter(ParametricReconfig reconfig)
+    void RadioRepresentation::reconfigureParameter(const ParametricReconfig& reconfig,
+                                                   Contents& c, ParameterIndex& index)
     {
-        b::mutex::scoped_lock lock(mutex_);
-
         //Apply change to the RadioGraph
         Vertex v;
-        ComponentDescription newComp;
-        if(!findComponent(reconfig.componentName, radioGraph_, v))
+        if(!findComponent(reconfig.componentName, c.radioGraph, v))
         {
             throw ResourceNotFoundException("Could not find component " + reconfig.componentName + " when reconfiguring RadioRepresentation");
-            return;
         }
+        ComponentDescription& desc = c.radioGraph[v];
         vector<ParameterDescription>::iterator paramIt;
-        for(paramIt = radioGraph_[v].parameters.begin(); paramIt != radioGraph_[v].parameters.end(); ++paramIt)
+        for(paramIt = desc.parameters.begin(); paramIt != desc.parameters.end(); ++paramIt)
         {
             if(paramIt->name == reconfig.parameterName)
+            {
                 paramIt->value = reconfig.parameterValue;
+                index[std::make_pair(reconfig.componentName, paramIt->name)] = paramIt->value;
+            }
+        }
+        desc.fingerprint = fingerprint(desc);
+
+        updateEngineComponent(c, reconfig.engineName, desc);
+    }
+
+    void RadioRepresentation::replaceComponent(string engineName, const NewComponent& comp,
+                                               Contents& c, ParameterIndex& index)
+    {
+        //Apply change to the RadioGraph - the name, engine and ports stay the same
+        Vertex v;
+        if(!findComponent(comp.name, c.radioGraph, v))
+        {
+            throw ResourceNotFoundException("Could not find component " + comp.name + " when reconfiguring RadioRepresentation");
         }
-        newComp = radioGraph_[v];
+        ComponentDescription& desc = c.radioGraph[v];
+        vector<ParameterDescription>::iterator paramIt;
+        for(paramIt = desc.parameters.begin(); paramIt != desc.parameters.end(); ++paramIt)
+        {
+            index.erase(std::make_pair(comp.name, paramIt->name));
+        }
+        desc.type = comp.type;
+        desc.parameters.clear();
+        vector< std::pair<string, string> >::const_iterator i;
+        for(i = comp.parameters.begin(); i != comp.parameters.end(); ++i)
+        {
+            ParameterDescription p;
+            p.name = i->first;
+            p.value = i->second;
+            desc.parameters.push_back(p);
+            index[std::make_pair(comp.name, p.name)] = p.value;
+        }
+        desc.fingerprint = fingerprint(desc);
+
+        updateEngineComponent(c, engineName, desc);
+    }
 
-        //Apply change to the EngineDescription
-        EngineDescription engD;
+    void RadioRepresentation::updateEngineComponent(Contents& c, string engineName,
+                                                    const ComponentDescription& comp)
+    {
+        //The EngineGraph holds its own copy of each EngineDescription
+        EngVertex ver;
+        if(!findEngine(engineName, c.engineGraph, ver))
+        {
+            throw ResourceNotFoundException("Could not find engine " + engineName + " when reconfiguring RadioRepresentation");
+        }
+        EngineDescription* descs[] = { NULL, &c.engineGraph[ver] };
         vector<EngineDescription>::iterator engIt;
-        for(engIt = engines_.begin(); engIt != engines_.end(); ++engIt)
+        for(engIt = c.engines.begin(); engIt != c.engines.end(); ++engIt)
         {
-            if(engIt->name == reconfig.engineName)
+            if(engIt->name == engineName)
+                descs[0] = &*engIt;
+        }
+
+        //Update each copy in place rather than copying whole engines
+        for(int d = 0; d < 2; ++d)
+        {
+            EngineDescription* eng = descs[d];
+            if(eng == NULL)
+                continue;
+            vector<ComponentDescription>::iterator compIt;
+            for(compIt = eng->components.begin(); compIt != eng->components.end(); ++compIt)
             {
-                vector<ComponentDescription>::iterator compIt;
-                for(compIt = engIt->components.begin(); compIt != engIt->components.end(); ++compIt)
+                if(compIt->name == comp.name)
                 {
-                    if(compIt->name == reconfig.componentName)
-                    {
-                        *compIt = newComp;
-                        engD = *engIt;
-                        break;
-                    }
+                    *compIt = comp;
+                    break;
                 }
             }
+            Vertex v;
+            if(findComponent(comp.name, eng->engineGraph, v))
+                eng->engineGraph[v] = comp;
+            eng->fingerprint = fingerprint(*eng);
         }
+    }
 
-        //Apply change to the EngineGraph
-        EngVertex ver;
-        if(!findEngine(reconfig.engineName, engineGraph_, ver))
-        {
-            throw ResourceNotFoundException("Could not find engine " + reconfig.engineName + " when reconfiguring RadioRepresentation");
-            return;
-        }
-        engineGraph_[ver] = engD;
+    RadioRepresentation::Contents& RadioRepresentation::mutableContents()
+    {
+        //Called with mutex_ held, so nobody can start sharing the contents meanwhile
+        if(!contents_.unique())
+            contents_.reset(new Contents(*contents_));
+        return *contents_;
     }
 
-    std::string RadioRepresentation::getParameterValue(std::string paramName, std::string componentName)
+    b::shared_ptr<RadioRepresentation::Contents> RadioRepresentation::getContents() const
     {
         b::mutex::scoped_lock lock(mutex_);
+        return contents_;
+    }
 
-        Vertex v;
-        if(!findComponent(componentName, radioGraph_, v))
-        {
+    std::string RadioRepresentation::getParameterValue(std::string paramName, std::string componentName)
+    {
+        b::shared_ptr<const ParameterIndex> index = getParameterIndex();
+        ParameterIndex::const_iterator it = index->find(std::make_pair(componentName, paramName));
+        if(it == index->end())
             return "";
-        }
-        vector<ParameterDescription>::iterator paramIt;
-        for(paramIt = radioGraph_[v].parameters.begin(); paramIt != radioGraph_[v].parameters.end(); ++paramIt)
+        return it->second;
+    }
+
+    void RadioRepresentation::rebuildParameterIndex(const RadioGraph& graph)
+    {
+        b::shared_ptr<ParameterIndex> index(new ParameterIndex);
+        VertexIterator i, iend;
+        for(b::tie(i, iend) = vertices(graph); i != iend; ++i)
         {
-            if(paramIt->name == paramName)
-                return paramIt->value;
+            const ComponentDescription& comp = graph[*i];
+            vector<ParameterDescription>::const_iterator paramIt;
+            for(paramIt = comp.parameters.begin(); paramIt != comp.parameters.end(); ++paramIt)
+            {
+                //Keep the first value if a parameter is listed twice, as the linear search did
+                index->insert(std::make_pair(std::make_pair(comp.name, paramIt->name), paramIt->value));
+            }
         }
-        return "";
+        setParameterIndex(index);
+    }
+
+    b::shared_ptr<const RadioRepresentation::ParameterIndex> RadioRepresentation::getParameterIndex() const
+    {
+        b::mutex::scoped_lock lock(indexMutex_);
+        return paramIndex_;
+    }
+
+    void RadioRepresentation::setParameterIndex(b::shared_ptr<const ParameterIndex> index)
+    {
+        b::mutex::scoped_lock lock(indexMutex_);
+        paramIndex_.swap(index);
+        //The old snapshot is released outside the lock when index goes out of scope
     }
 
     void RadioRepresentation::buildEngineDescriptionGraph(EngineDescription& eng) const
@@ -332,21 +462,22 @@ namespace iris
 
     string RadioRepresentation::printRadioGraph() const
     {
+        b::shared_ptr<Contents> c = getContents();
         string result;
-        if(!isGraphBuilt())
+        if(!c->isBuilt)
         {
             result += "Graph has not yet been built";
             return result;
         }
         VertexIterator i, iend;
         OutEdgeIterator ei, eiend;
-        for(b::tie(i, iend) = vertices(radioGraph_); i != iend; ++i)
+        for(b::tie(i, iend) = vertices(c->radioGraph); i != iend; ++i)
         {
-            result += radioGraph_[*i].name + "\n";
-            for(b::tie(ei,eiend) = out_edges(*i,radioGraph_); ei != eiend; ++ei)
+            result += c->radioGraph[*i].name + "\n";
+            for(b::tie(ei,eiend) = out_edges(*i,c->radioGraph); ei != eiend; ++ei)
             {
-                result += radioGraph_[*i].name + "." + radioGraph_[*ei].sourcePort + " --> " \
-                    + radioGraph_[target(*ei, radioGraph_)].name + "." + radioGraph_[*ei].sinkPort + "\n";
+                result += c->radioGraph[*i].name + "." + c->radioGraph[*ei].sourcePort + " --> " \
+                    + c->radioGraph[target(*ei, c->radioGraph)].name + "." + c->radioGraph[*ei].sinkPort + "\n";
             }
         }
         return result;
@@ -354,21 +485,22 @@ namespace iris
 
     string RadioRepresentation::printEngineGraph() const
     {
+        b::shared_ptr<Contents> c = getContents();
         string result;
-        if(!isGraphBuilt())
+        if(!c->isBuilt)
         {
             result += "Graph has not yet been built";
             return result;
         }
         EngVertexIterator i, iend;
         EngOutEdgeIterator ei, eiend;
-        for(b::tie(i, iend) = vertices(engineGraph_); i != iend; ++i)
+        for(b::tie(i, iend) = vertices(c->engineGraph); i != iend; ++i)
         {
-            result += engineGraph_[*i].name + "\n";
-            for(b::tie(ei,eiend) = out_edges(*i,engineGraph_); ei != eiend; ++ei)
+            result += c->engineGraph[*i].name + "\n";
+            for(b::tie(ei,eiend) = out_edges(*i,c->engineGraph); ei != eiend; ++ei)
             {
-                result += engineGraph_[*i].name + "." + engineGraph_[*ei].sourcePort + " --> " \
-                    + engineGraph_[target(*ei, engineGraph_)].name + "." += engineGraph_[*ei].sinkPort + "\n";
+                result += c->engineGraph[*i].name + "." + c->engineGraph[*ei].sourcePort + " --> " \
+                    + c->engineGraph[target(*ei, c->engineGraph)].name + "." += c->engineGraph[*ei].sinkPort + "\n";
             }
         }
         return result;
@@ -376,37 +508,91 @@ namespace iris
 
     bool RadioRepresentation::isGraphBuilt() const
     {
-        return isBuilt_;
+        return getContents()->isBuilt;
     }
 
     vector<ControllerDescription> RadioRepresentation::getControllers() const
     {
-        return controllers_;
+        return getContents()->controllers;
     }
 
     vector<EngineDescription> RadioRepresentation::getEngines() const
     {
-        return engines_;
+        return getContents()->engines;
+    }
+
+    b::shared_ptr< const vector<EngineDescription> > RadioRepresentation::getEngineDescriptions() const
+    {
+        //Share ownership of the contents, so changes are made to a copy while this is held
+        b::shared_ptr<Contents> c = getContents();
+        return b::shared_ptr< const vector<EngineDescription> >(c, &c->engines);
     }
 
     vector<LinkDescription> RadioRepresentation::getLinks() const
     {
-        return links_;
+        return getContents()->links;
     }
 
     vector<LinkDescription> RadioRepresentation::getExternalLinks() const
     {
-        return externalLinks_;
+        return getContents()->externalLinks;
     }
 
     RadioGraph RadioRepresentation::getRadioGraph() const
     {
-        return radioGraph_;
+        return getContents()->radioGraph;
     }
 
     EngineGraph RadioRepresentation::getEngineGraph() const
     {
-        return engineGraph_;
+        return getContents()->engineGraph;
+    }
+
+    std::size_t RadioRepresentation::fingerprint(const ComponentDescription& comp)
+    {
+        std::size_t seed = 0;
+        b::hash_combine(seed, comp.name);
+        b::hash_combine(seed, comp.type);
+        b::hash_combine(seed, comp.engineName);
+        vector<ParameterDescription>::const_iterator paramIt;
+        for(paramIt = comp.parameters.begin(); paramIt != comp.parameters.end(); ++paramIt)
+        {
+            b::hash_combine(seed, paramIt->name);
+            b::hash_combine(seed, paramIt->value);
+        }
+        vector<PortDescription>::const_iterator portIt;
+        for(portIt = comp.ports.begin(); portIt != comp.ports.end(); ++portIt)
+        {
+            b::hash_combine(seed, portIt->name);
+            b::hash_combine(seed, portIt->type);
+        }
+        //Zero is kept to mean "not computed"
+        return seed == 0 ? 1 : seed;
+    }
+
+    std::size_t RadioRepresentation::fingerprint(const EngineDescription& eng)
+    {
+        std::size_t seed = 0;
+        b::hash_combine(seed, eng.name);
+        b::hash_combine(seed, eng.type);
+        vector<ComponentDescription>::const_iterator compIt;
+        for(compIt = eng.components.begin(); compIt != eng.components.end(); ++compIt)
+        {
+            b::hash_combine(seed, compIt->fingerprint == 0 ? fingerprint(*compIt) : compIt->fingerprint);
+        }
+        vector<LinkDescription>::const_iterator linkIt;
+        for(linkIt = eng.links.begin(); linkIt != eng.links.end(); ++linkIt)
+        {
+            b::hash_combine(seed, linkIt->sourceEngine);
+            b::hash_combine(seed, linkIt->sourceComponent);
+            b::hash_combine(seed, linkIt->sourcePort);
+            b::hash_combine(seed, linkIt->sinkEngine);
+            b::hash_combine(seed, linkIt->sinkComponent);
+            b::hash_combine(seed, linkIt->sinkPort);
+            b::hash_combine(seed, linkIt->bufferCapacity);
+            b::hash_combine(seed, (int)linkIt->bufferPolicy);
+        }
+        return seed == 0 ? 1 : seed;
     }
 
 }
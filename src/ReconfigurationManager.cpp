@@ -32,13 +32,34 @@
  * all reconfigurations in Iris.
  */
 
+#include <boost/unordered_set.hpp>
+#include <boost/lexical_cast.hpp>
+
 #include "iris/ReconfigurationManager.h"
 
 using namespace std;
+namespace b = boost;
 
 namespace iris
 {
 
+    // Internal namespace for helper functions
+    namespace internal{
+    //! A key which identifies a link by all of its endpoints and its buffer settings
+    string linkKey(const LinkDescription& l)
+    {
+        return l.sourceEngine + "." + l.sourceComponent + "." + l.sourcePort + ">" +
+            l.sinkEngine + "." + l.sinkComponent + "." + l.sinkPort + "#" +
+            b::lexical_cast<string>(l.bufferCapacity) + "/" + b::lexical_cast<string>(l.bufferPolicy);
+    }
+
+    //! Do two fingerprints show that the descriptions are the same?
+    bool sameFingerprint(size_t first, size_t second)
+    {
+        return first != 0 && first == second;
+    }
+    } /* namespace internal */
+
     ReconfigurationManager::ReconfigurationManager()
     {}
 
@@ -46,68 +67,114 @@ namespace iris
         const RadioRepresentation& newRadio)
     {
         ReconfigSet theReconfigs;
-        checkParameters(currentRadio, newRadio, theReconfigs);
+        b::shared_ptr< const vector< EngineDescription > > firstSnapshot = currentRadio.getEngineDescriptions();
+        b::shared_ptr< const vector< EngineDescription > > secondSnapshot = newRadio.getEngineDescriptions();
+        const vector< EngineDescription >& first = *firstSnapshot;
+        const vector< EngineDescription >& second = *secondSnapshot;
+
+        //Index the new engines by name
+        EngineIndex secondEngines;
+        vector< EngineDescription >::const_iterator engIt;
+        for(engIt = second.begin(); engIt != second.end(); ++engIt)
+            secondEngines[engIt->name] = &*engIt;
+
+        //Compare engines with the same name and type - unchanged engines are skipped
+        for(engIt = first.begin(); engIt != first.end(); ++engIt)
+        {
+            EngineIndex::const_iterator it = secondEngines.find(engIt->name);
+            if(it == secondEngines.end() || !(*engIt == *it->second))
+                continue;
+            if(internal::sameFingerprint(engIt->fingerprint, it->second->fingerprint))
+                continue;
+            compareEngines(*engIt, *it->second, theReconfigs);
+        }
         return theReconfigs;
     }
 
-    void ReconfigurationManager::checkParameters(const RadioRepresentation& first, const RadioRepresentation& second, ReconfigSet& reconfigs)
+    void ReconfigurationManager::compareEngines(const EngineDescription& first, const EngineDescription& second, ReconfigSet& reconfigs)
     {
-        //Go through engines and compare each
-        vector< EngineDescription > firstEngines = first.getEngines();
-        vector< EngineDescription > secondEngines = second.getEngines();
-        vector< EngineDescription >::iterator it1, it2;
-        for(it1 = firstEngines.begin(); it1 != firstEngines.end(); ++it1)
+        StructuralReconfig r;
+        r.engineName = first.name;
+
+        //Components are matched by name - a new type under the same name is a replacement
+        ComponentIndex secondComps;
+        vector< ComponentDescription >::const_iterator compIt;
+        for(compIt = second.components.begin(); compIt != second.components.end(); ++compIt)
+            secondComps[compIt->name] = &*compIt;
+
+        b::unordered_set< string > firstNames;
+        for(compIt = first.components.begin(); compIt != first.components.end(); ++compIt)
         {
-            for(it2 = secondEngines.begin(); it2 != secondEngines.end(); ++it2)
-            {
-                if(*it1 == *it2)
-                {
-                    checkParameters(*it1, *it2, reconfigs);
-                    break;
-                }
-            }
+            firstNames.insert(compIt->name);
+            ComponentIndex::const_iterator it = secondComps.find(compIt->name);
+            if(it == secondComps.end())
+                r.removedComponents.push_back(compIt->name);
+            else if(compIt->type != it->second->type)
+                r.replacedComponents.push_back(describeComponent(*it->second));
+            else if(!internal::sameFingerprint(compIt->fingerprint, it->second->fingerprint))
+                compareParameters(*compIt, *it->second, reconfigs);
+        }
+        for(compIt = second.components.begin(); compIt != second.components.end(); ++compIt)
+        {
+            if(firstNames.find(compIt->name) == firstNames.end())
+                r.newComponents.push_back(describeComponent(*compIt));
+        }
+
+        //Compare the links of the engines
+        b::unordered_set< string > firstLinks, secondLinks;
+        vector< LinkDescription >::const_iterator linkIt;
+        for(linkIt = first.links.begin(); linkIt != first.links.end(); ++linkIt)
+            firstLinks.insert(internal::linkKey(*linkIt));
+        for(linkIt = second.links.begin(); linkIt != second.links.end(); ++linkIt)
+        {
+            secondLinks.insert(internal::linkKey(*linkIt));
+            if(firstLinks.find(internal::linkKey(*linkIt)) == firstLinks.end())
+                r.newLinks.push_back(*linkIt);
         }
+        for(linkIt = first.links.begin(); linkIt != first.links.end(); ++linkIt)
+        {
+            if(secondLinks.find(internal::linkKey(*linkIt)) == secondLinks.end())
+                r.removedLinks.push_back(*linkIt);
+        }
+
+        if(r.changesGraph() || !r.replacedComponents.empty())
+            reconfigs.structReconfigs.push_back(r);
     }
 
-    void ReconfigurationManager::checkParameters(EngineDescription& first, EngineDescription& second, ReconfigSet& reconfigs)
+    void ReconfigurationManager::compareParameters(const ComponentDescription& first, const ComponentDescription& second, ReconfigSet& reconfigs)
     {
-        //Go through components and compare each
-        vector< ComponentDescription >::iterator it1, it2;
-        for(it1 = first.components.begin(); it1 != first.components.end(); ++it1)
+        //Index the new values by parameter name
+        b::unordered_map< string, const string* > secondValues;
+        vector< ParameterDescription >::const_iterator paramIt;
+        for(paramIt = second.parameters.begin(); paramIt != second.parameters.end(); ++paramIt)
+            secondValues[paramIt->name] = &paramIt->value;
+
+        for(paramIt = first.parameters.begin(); paramIt != first.parameters.end(); ++paramIt)
         {
-            for(it2 = second.components.begin(); it2 != second.components.end(); ++it2)
+            b::unordered_map< string, const string* >::const_iterator it = secondValues.find(paramIt->name);
+            if(it != secondValues.end() && paramIt->value != *it->second)
             {
-                if(*it1 == *it2)
-                {
-                    checkParameters(*it1, *it2, reconfigs);
-                    break;
-                }
+                ParametricReconfig r;
+                r.engineName = first.engineName;
+                r.componentName = first.name;
+                r.parameterName = paramIt->name;
+                r.parameterValue = *it->second;
+                reconfigs.paramReconfigs.push_back(r);
             }
         }
     }
 
-    void ReconfigurationManager::checkParameters(ComponentDescription& first, ComponentDescription& second, ReconfigSet& reconfigs)
+    NewComponent ReconfigurationManager::describeComponent(const ComponentDescription& comp)
     {
-        //Go through parameters and compare each
-        vector< ParameterDescription >::iterator it1, it2;
-        for(it1 = first.parameters.begin(); it1 != first.parameters.end(); ++it1)
+        NewComponent c;
+        c.name = comp.name;
+        c.type = comp.type;
+        vector< ParameterDescription >::const_iterator paramIt;
+        for(paramIt = comp.parameters.begin(); paramIt != comp.parameters.end(); ++paramIt)
         {
-            for(it2 = second.parameters.begin(); it2 != second.parameters.end(); ++it2)
-            {
-                if(it1->name == it2->name)
-                {
-                    if(it1->value != it2->value)
-                    {
-                        ParametricReconfig r;
-                        r.engineName = first.engineName;
-                        r.componentName = first.name;
-                        r.parameterName = it1->name;
-                        r.parameterValue = it2->value;
-                        reconfigs.paramReconfigs.push_back(r);
-                    }
-                }
-            }
+            c.parameters.push_back(make_pair(paramIt->name, paramIt->value));
         }
+        return c;
     }
 
 } /* namespace iris */
@@ -32,12 +32,19 @@
  * the Iris architecture.
  */
 
+#include <fstream>
+#include <sstream>
+
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include "irisapi/Logging.h"
 #include "iris/System.h"
 #include "iris/XmlParser.h"
+#include "iris/RadioCache.h"
+#include "iris/TaskGroup.h"
+#include "iris/ControllerExecutor.h"
+#include "iris/PhyEngine.h"
 #include "iris/ReconfigurationManager.h"
 
 using namespace std;
@@ -55,11 +62,16 @@ namespace iris
         if(pFile_ != NULL)
             LoggingPolicy::getPolicyInstance()->setFileStream(pFile_);
 
-        LoggingPolicy::getPolicyInstance()->ReportingLevel() = LDEBUG;
+        //Write log messages from a background thread so that logging never waits for I/O
+        LoggingPolicy::getPolicyInstance()->setAsynchronous(true);
+        LoggingPolicy::getPolicyInstance()->ReportingLevel() = LINFO;
     }
 
     System::~System()
     {
+        //Write any queued messages before closing the log file
+        LoggingPolicy::getPolicyInstance()->setAsynchronous(false);
+        LoggingPolicy::getPolicyInstance()->setFileStream(NULL);
         if(pFile_ != NULL)
             fclose(pFile_);
     }
@@ -84,29 +96,93 @@ namespace iris
         reps_.contRepository = rep;
     }
 
+    void System::setCacheDirectory(std::string dir)
+    {
+        cacheDirectory_ = dir;
+    }
+
+    void System::setXmlParser(std::string parser)
+    {
+        boost::to_lower(parser);
+        if(parser == "dom")
+        {
+            XmlParser::setParserType(XmlParser::DOM_PARSER);
+        }
+        else if(parser == "streaming")
+        {
+            XmlParser::setParserType(XmlParser::STREAMING_PARSER);
+        }
+        else
+        {
+            LOG(LWARNING) << "Unknown xml parser " << parser << " - options are dom & streaming";
+        }
+    }
+
+    void System::setLoadThreads(unsigned threads)
+    {
+        TaskGroup::setDefaultThreads(threads);
+    }
+
+    void System::setControllerThreads(unsigned threads)
+    {
+        ControllerExecutor::setDefaultThreads(threads);
+    }
+
+    void System::setParallelInit(bool parallel)
+    {
+        PhyEngine::setParallelInitialize(parallel);
+    }
+
     void System::setLogLevel(std::string level)
+    {
+        LogLevel l;
+        if(parseLogLevel(level, l))
+        {
+            LoggingPolicy::getPolicyInstance()->ReportingLevel() = l;
+        }
+    }
+
+    void System::setLogLevel(std::string name, std::string level)
+    {
+        LogLevel l;
+        if(parseLogLevel(level, l))
+        {
+            LoggingPolicy::getPolicyInstance()->setLevel(name, l);
+        }
+        else
+        {
+            LOG(LWARNING) << "Unknown log level " << level << " for " << name;
+        }
+    }
+
+    bool System::parseLogLevel(std::string level, LogLevel& l)
     {
         boost::to_lower(level);
         if(level == "debug")
         {
-            LoggingPolicy::getPolicyInstance()->ReportingLevel() = LDEBUG;
+            l = LDEBUG;
         }
         else if(level == "info")
         {
-            LoggingPolicy::getPolicyInstance()->ReportingLevel() = LINFO;
+            l = LINFO;
         }
         else if(level == "warning")
         {
-            LoggingPolicy::getPolicyInstance()->ReportingLevel() = LWARNING;
+            l = LWARNING;
         }
         else if(level == "error")
         {
-            LoggingPolicy::getPolicyInstance()->ReportingLevel() = LERROR;
+            l = LERROR;
         }
         else if(level == "fatal")
         {
-            LoggingPolicy::getPolicyInstance()->ReportingLevel() = LFATAL;
+            l = LFATAL;
+        }
+        else
+        {
+            return false;
         }
+        return true;
     }
 
     bool System::loadRadio(std::string radioConfig)
@@ -121,7 +197,7 @@ namespace iris
             LOG(LINFO) << "Loading radio: " << radioConfig;
 
             try{
-                XmlParser::parseXmlFile(radioConfig, rad);
+                readRadio(radioConfig, rad);
                 engineManager_.setRepositories(reps_);
                 engineManager_.loadRadio(rad);
                 status_ = RADIOLOADED;
@@ -140,6 +216,46 @@ namespace iris
         return result;
     }
 
+    void System::readRadio(std::string radioConfig, RadioRepresentation& rad)
+    {
+        if(cacheDirectory_.empty())
+        {
+            XmlParser::parseXmlFile(radioConfig, rad);
+            return;
+        }
+
+        std::ifstream in(radioConfig.c_str(), ios::binary);
+        if(!in)
+            throw ResourceNotFoundException("Could not open radio configuration " + radioConfig);
+        stringstream buffer;
+        buffer << in.rdbuf();
+        string xml = buffer.str();
+
+        //The key covers the configuration and the libraries it may load
+        vector<string> repositories;
+        repositories.push_back(reps_.stackRepository);
+        repositories.push_back(reps_.phyRepository);
+        repositories.push_back(reps_.sdfRepository);
+        repositories.push_back(reps_.contRepository);
+        boost::uint64_t key = RadioCache::computeKey(xml, repositories);
+        string cacheFile = RadioCache::getCacheFile(cacheDirectory_, radioConfig);
+
+        if(RadioCache::load(cacheFile, key, rad))
+        {
+            LOG(LINFO) << "Loaded radio configuration from cache " << cacheFile;
+            return;
+        }
+
+        XmlParser::parseXmlString(xml, rad);
+        try{
+            RadioCache::save(rad, key, cacheFile);
+        }
+        catch(std::exception& ex)
+        {
+            LOG(LWARNING) << "Could not cache radio configuration: " << ex.what();
+        }
+    }
+
     bool System::startRadio()
     {
         bool result = false;
@@ -238,6 +354,8 @@ namespace iris
 
     bool System::reconfigureRadio(std::string radioConfig)
     {
+        //Reconfiguration latency is measured from here
+        boost::posix_time::ptime issueTime = boost::posix_time::microsec_clock::universal_time();
         RadioRepresentation rad;
         bool result = false;
 
@@ -252,8 +370,9 @@ namespace iris
             LOG(LINFO) << "Reconfiguring radio: " << radioConfig;
 
             try{
-                XmlParser::parseXmlFile(radioConfig, rad);
+                readRadio(radioConfig, rad);
                 ReconfigSet reconfigs = ReconfigurationManager::compareRadios(engineManager_.getCurrentRadio(), rad);
+                reconfigs.issueTime = issueTime;
                 engineManager_.reconfigureRadio(reconfigs);
                 result = true;
             }
@@ -34,10 +34,12 @@
 #define TIXML_USE_TICPP
 
 #include "iris/XmlParser.h"
+#include "iris/XmlStreamReader.h"
 
 #include "ticpp.h"
-#include <boost/tokenizer.hpp>
+#include <fstream>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 using namespace std;
 using namespace ticpp;
@@ -45,12 +47,67 @@ using namespace ticpp;
 namespace iris
 {
 
+XmlParser::ParserType XmlParser::parserType_ = XmlParser::DOM_PARSER;
+
 /******************* Helper functions ******************************/
 std::string getName()
 {
     return "XmlParser";
 }
 
+//Split a link end ("component.port") and convert to lower case
+void readLinkEnd(const string& end, string& component, string& port)
+{
+    //Empty parts are skipped, as in "component..port"
+    size_t compStart = end.find_first_not_of('.');
+    size_t compEnd = end.find('.', compStart);
+    size_t portStart = end.find_first_not_of('.', compEnd);
+    if(portStart == string::npos)
+        throw XmlParsingException("Invalid link end in xml file: " + end);
+    size_t portEnd = end.find('.', portStart);
+    component.assign(end, compStart, compEnd - compStart);
+    port.assign(end, portStart, portEnd == string::npos ? string::npos : portEnd - portStart);
+    boost::to_lower(component);
+    boost::to_lower(port);
+}
+
+size_t readLinkCapacity(const string& capacity)
+{
+    try
+    {
+        return boost::lexical_cast<size_t>(capacity);
+    }
+    catch(boost::bad_lexical_cast&)
+    {
+        throw XmlParsingException("Invalid link capacity in xml file: " + capacity);
+    }
+}
+
+BufferPolicy readLinkPolicy(string policy)
+{
+    boost::to_lower(policy);
+    if(policy == "grow")
+        return POLICY_GROW;
+    else if(policy == "backpressure")
+        return POLICY_BACKPRESSURE;
+    else if(policy == "drop")
+        return POLICY_DROP;
+    else
+        throw XmlParsingException("Invalid link policy in xml file: " + policy);
+}
+
+void logLink(const LinkDescription& theLink)
+{
+    LOG(LINFO) << "Parsed link: " << theLink.sourceComponent << " . " << theLink.sourcePort \
+        << " -> " << theLink.sinkComponent << " . " << theLink.sinkPort;
+}
+
+void illegalElement(const string& s)
+{
+    LOG(LFATAL) << "Illegal element in xml file: " << s;
+    throw XmlParsingException("Illegal element in xml file: " + s);
+}
+
 LinkDescription readLink(Element &linkElem)
 {
     //Check for illegal nodes here
@@ -59,9 +116,7 @@ LinkDescription readLink(Element &linkElem)
     {
         if(c->Type() == TiXmlNode::ELEMENT)
         {
-            string s = c->Value();
-            LOG(LFATAL) << "Illegal element in xml file: " << s;
-            throw XmlParsingException("Illegal element in xml file: " + s);
+            illegalElement(c->Value());
         }
     }
 
@@ -76,29 +131,17 @@ LinkDescription readLink(Element &linkElem)
     else
         source = linkElem.GetAttribute("above");
 
-    //Create tokenizers
-    typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-    boost::char_separator<char> sep(".");
-    tokenizer sourceTokens(source, sep);
-    tokenizer sinkTokens(sink, sep);
-
-    //Pull out source component and port
-    tokenizer::iterator tok_iter = sourceTokens.begin();
-    theLink.sourceComponent = (*tok_iter++);
-    theLink.sourcePort = (*tok_iter);
-
-    //Pull out sink component and port
-    tok_iter = sinkTokens.begin();
-    theLink.sinkComponent = (*tok_iter++);
-    theLink.sinkPort = (*tok_iter);
+    //Pull out the components and ports
+    readLinkEnd(source, theLink.sourceComponent, theLink.sourcePort);
+    readLinkEnd(sink, theLink.sinkComponent, theLink.sinkPort);
 
-    boost::to_lower(theLink.sourceComponent);
-    boost::to_lower(theLink.sourcePort);
-    boost::to_lower(theLink.sinkComponent);
-    boost::to_lower(theLink.sinkPort);
+    //Optional buffer settings for links within an engine
+    if(linkElem.HasAttribute("capacity"))
+        theLink.bufferCapacity = readLinkCapacity(linkElem.GetAttribute("capacity"));
+    if(linkElem.HasAttribute("policy"))
+        theLink.bufferPolicy = readLinkPolicy(linkElem.GetAttribute("policy"));
 
-    LOG(LINFO) << "Parsed link: " << theLink.sourceComponent << " . " << theLink.sourcePort \
-        << " -> " << theLink.sinkComponent << " . " << theLink.sinkPort;
+    logLink(theLink);
 
     return theLink;
 }
@@ -113,10 +156,7 @@ ControllerDescription readController(Element &controllerElem)
         {
             string s = c->Value();
             if(s != "parameter")
-            {
-              LOG(LFATAL) << "Illegal element in xml file: " << s;
-              throw XmlParsingException("Illegal element in xml file: " + s);
-            }
+                illegalElement(s);
         }
     }
 
@@ -158,10 +198,7 @@ ComponentDescription readComponent(Element &componentElem)
         {
             string s = c->Value();
             if(s != "port" && s != "parameter")
-            {
-                LOG(LFATAL) << "Illegal element in xml file: " << s;
-                throw XmlParsingException("Illegal element in xml file: " + s);
-            }
+                illegalElement(s);
         }
     }
 
@@ -211,10 +248,7 @@ EngineDescription readEngine(Element &engineElem)
         {
             string s = c->Value();
             if(s != "component")
-            {
-                LOG(LFATAL) << "Illegal element in xml file: " << s;
-                throw XmlParsingException("Illegal element in xml file: " + s);
-            }
+                illegalElement(s);
         }
     }
 
@@ -247,10 +281,7 @@ void readSoftwareRadio(Element &headElem, RadioRepresentation& theRadio)
         {
             string s = c->Value();
             if(s != "controller" && s != "engine" && s!= "link")
-            {
-                LOG(LFATAL) << "Illegal element in xml file: " << s;
-                throw XmlParsingException("Illegal element in xml file: " + s);
-            }
+                illegalElement(s);
         }
     }
 
@@ -316,6 +347,12 @@ Element writeLink( LinkDescription &linkDesc)
 
     e.SetAttribute("source", linkDesc.sourceComponent + "." + linkDesc.sourcePort);
     e.SetAttribute("sink", linkDesc.sinkComponent + "." + linkDesc.sinkPort);
+    if(linkDesc.bufferCapacity != 0)
+        e.SetAttribute("capacity", linkDesc.bufferCapacity);
+    if(linkDesc.bufferPolicy == POLICY_BACKPRESSURE)
+        e.SetAttribute("policy", "backpressure");
+    else if(linkDesc.bufferPolicy == POLICY_DROP)
+        e.SetAttribute("policy", "drop");
 
     return e;
 }
@@ -391,12 +428,225 @@ Element writeSoftwareRadio( RadioRepresentation &swrDesc)
     return e;
 }
 
+/** Fills in a RadioRepresentation from the elements of a streamed configuration.
+ *
+ *  Descriptions are built in place and the same checks are made as when
+ *  reading a document tree.
+ */
+class RadioBuilder : public XmlStreamHandler
+{
+public:
+    RadioBuilder(RadioRepresentation& radio, const string& rootError)
+        :radio_(radio), rootError_(rootError), state_(DOCUMENT), ignoredDepth_(0)
+    {}
+
+    void startElement(const XmlStreamElement& elem)
+    {
+        //Children of parameters and ports are not read
+        if(ignoredDepth_ > 0)
+        {
+            ++ignoredDepth_;
+            return;
+        }
+
+        const string& s = elem.getName();
+        switch(state_)
+        {
+        case DOCUMENT:
+            if(s != "softwareradio")
+                throw XmlParsingException(rootError_);
+            state_ = RADIO;
+            break;
+        case RADIO:
+            if(s == "controller")
+                startController(elem);
+            else if(s == "engine")
+                startEngine(elem);
+            else if(s == "link")
+                startLink(elem);
+            else
+                illegalElement(s);
+            break;
+        case CONTROLLER:
+            if(s != "parameter")
+                illegalElement(s);
+            readParameter(elem, controller_.parameters);
+            ignoredDepth_ = 1;
+            break;
+        case ENGINE:
+            if(s != "component")
+                illegalElement(s);
+            startComponent(elem);
+            break;
+        case COMPONENT:
+            if(s == "parameter")
+                readParameter(elem, engine_.components.back().parameters);
+            else if(s == "port")
+                readPort(elem, engine_.components.back().ports);
+            else
+                illegalElement(s);
+            ignoredDepth_ = 1;
+            break;
+        case LINK:
+            illegalElement(s);
+            break;
+        }
+    }
+
+    void endElement(const string&)
+    {
+        if(ignoredDepth_ > 0)
+        {
+            --ignoredDepth_;
+            return;
+        }
+
+        switch(state_)
+        {
+        case CONTROLLER:
+            LOG(LINFO) << "Parsed controller: " << controller_.name;
+            radio_.addControllerDescription(controller_);
+            state_ = RADIO;
+            break;
+        case ENGINE:
+            radio_.addEngineDescription(engine_);
+            state_ = RADIO;
+            break;
+        case COMPONENT:
+            state_ = ENGINE;
+            break;
+        case LINK:
+            logLink(link_);
+            radio_.addLinkDescription(link_);
+            state_ = RADIO;
+            break;
+        default:
+            state_ = DOCUMENT;
+            break;
+        }
+    }
+
+private:
+    enum State { DOCUMENT, RADIO, CONTROLLER, ENGINE, COMPONENT, LINK };
+
+    void startController(const XmlStreamElement& elem)
+    {
+        controller_ = ControllerDescription();
+        elem.getAttribute("name", controller_.name);
+        elem.getAttribute("class", controller_.type);
+        if(controller_.name.empty())
+            controller_.name = controller_.type;
+        boost::to_lower(controller_.name);
+        boost::to_lower(controller_.type);
+        state_ = CONTROLLER;
+    }
+
+    void startEngine(const XmlStreamElement& elem)
+    {
+        engine_ = EngineDescription();
+        elem.getAttribute("name", engine_.name);
+        elem.getAttribute("class", engine_.type);
+        boost::to_lower(engine_.name);
+        boost::to_lower(engine_.type);
+        LOG(LINFO) << "Parsed engine: " << engine_.name;
+        state_ = ENGINE;
+    }
+
+    void startComponent(const XmlStreamElement& elem)
+    {
+        engine_.components.push_back(ComponentDescription());
+        ComponentDescription& comp = engine_.components.back();
+        elem.getAttribute("name", comp.name);
+        elem.getAttribute("class", comp.type);
+        boost::to_lower(comp.name);
+        boost::to_lower(comp.type);
+        comp.engineName = engine_.name;
+        LOG(LINFO) << "Parsed component: " << comp.name;
+        state_ = COMPONENT;
+    }
+
+    void startLink(const XmlStreamElement& elem)
+    {
+        link_ = LinkDescription();
+        if(!elem.getAttribute("source", scratch_))
+            elem.getAttribute("above", scratch_);
+        readLinkEnd(scratch_, link_.sourceComponent, link_.sourcePort);
+        if(!elem.getAttribute("sink", scratch_))
+            elem.getAttribute("below", scratch_);
+        readLinkEnd(scratch_, link_.sinkComponent, link_.sinkPort);
+        if(elem.getAttribute("capacity", scratch_))
+            link_.bufferCapacity = readLinkCapacity(scratch_);
+        if(elem.getAttribute("policy", scratch_))
+            link_.bufferPolicy = readLinkPolicy(scratch_);
+        state_ = LINK;
+    }
+
+    void readParameter(const XmlStreamElement& elem, vector<ParameterDescription>& params)
+    {
+        params.push_back(ParameterDescription());
+        ParameterDescription& param = params.back();
+        elem.getAttribute("name", param.name);
+        elem.getAttribute("value", param.value);
+        boost::to_lower(param.name);
+        boost::to_lower(param.value);
+    }
+
+    void readPort(const XmlStreamElement& elem, vector<PortDescription>& ports)
+    {
+        ports.push_back(PortDescription());
+        PortDescription& port = ports.back();
+        elem.getAttribute("name", port.name);
+        elem.getAttribute("class", port.type);
+        boost::to_lower(port.name);
+        boost::to_lower(port.type);
+    }
+
+    RadioRepresentation& radio_;
+    string rootError_;
+    State state_;
+    int ignoredDepth_;        ///< Depth within an element whose children are not read.
+    ControllerDescription controller_;
+    EngineDescription engine_;
+    LinkDescription link_;
+    string scratch_;          ///< Reused for attribute values.
+};
+
 /***********************End of Helper functions******************************/
 
+void XmlParser::setParserType(ParserType type)
+{
+    parserType_ = type;
+}
+
+XmlParser::ParserType XmlParser::getParserType()
+{
+    return parserType_;
+}
+
+void XmlParser::parseXmlStream(const std::string &xml, RadioRepresentation &radio, std::string rootError)
+{
+    RadioBuilder builder(radio, rootError);
+    XmlStreamReader reader(xml.data(), xml.size());
+    reader.parse(builder);
+
+    //Instruct the radio description to build a graph of the radio
+    radio.buildGraphs();
+}
+
 
 //Parses the specified Xml file into a radio description
 void XmlParser::parseXmlFile(std::string filename, RadioRepresentation &radio)
 {
+    if(parserType_ == STREAMING_PARSER)
+    {
+        ifstream in(filename.c_str(), ios::binary);
+        if(!in)
+            throw XmlParsingException("Error parsing xml. Description: Failed to open file " + filename);
+        string xml((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        parseXmlStream(xml, radio, "The root element of the xml configuration must be \"softwareradio\".");
+        return;
+    }
+
     try{
         Document doc(filename);
         doc.LoadFile();
@@ -422,6 +672,12 @@ void XmlParser::parseXmlFile(std::string filename, RadioRepresentation &radio)
 
 void XmlParser::parseXmlString( std::string &xml, RadioRepresentation &radio)
 {
+    if(parserType_ == STREAMING_PARSER)
+    {
+        parseXmlStream(xml, radio, "The top element of the xml configuration must be softwareradio.");
+        return;
+    }
+
     try{
         Document doc;
         doc.Parse(xml);
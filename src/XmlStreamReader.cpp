@@ -0,0 +1,334 @@
+/**
+ * \file XmlStreamReader.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Implementation of XmlStreamReader class - a single pass xml reader.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "iris/XmlStreamReader.h"
+
+using namespace std;
+
+namespace iris
+{
+
+    // Internal namespace for character handling
+    namespace internal{
+    inline bool isXmlSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    //! Append a character reference to a string as utf-8
+    void appendUtf8(unsigned long code, string& out)
+    {
+        if(code < 0x80)
+        {
+            out += (char)code;
+        }
+        else if(code < 0x800)
+        {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else if(code < 0x10000)
+        {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+
+    //! Copy an attribute value, replacing entities - unknown entities are kept as they are
+    void decodeValue(const char* p, size_t length, string& out)
+    {
+        const char* end = p + length;
+        const char* amp = static_cast<const char*>(memchr(p, '&', length));
+        if(amp == NULL)
+        {
+            out.assign(p, length);
+            return;
+        }
+
+        out.assign(p, amp);
+        p = amp;
+        while(p < end)
+        {
+            const char* semi = (*p == '&') ? static_cast<const char*>(memchr(p, ';', end - p)) : NULL;
+            if(semi == NULL)
+            {
+                out += *p++;
+                continue;
+            }
+            string entity(p + 1, semi);
+            if(entity == "amp")
+                out += '&';
+            else if(entity == "lt")
+                out += '<';
+            else if(entity == "gt")
+                out += '>';
+            else if(entity == "quot")
+                out += '"';
+            else if(entity == "apos")
+                out += '\'';
+            else if(entity.size() > 1 && entity[0] == '#')
+            {
+                bool hex = (entity[1] == 'x');
+                appendUtf8(strtoul(entity.c_str() + (hex ? 2 : 1), NULL, hex ? 16 : 10), out);
+            }
+            else
+            {
+                out += *p++;
+                continue;
+            }
+            p = semi + 1;
+        }
+    }
+    } /* namespace internal */
+
+    const XmlStreamElement::Attribute* XmlStreamElement::findAttribute(const char* name) const
+    {
+        size_t length = strlen(name);
+        vector<Attribute>::const_iterator it;
+        for(it = attributes_.begin(); it != attributes_.end(); ++it)
+        {
+            if(it->nameLength == length && memcmp(it->name, name, length) == 0)
+                return &(*it);
+        }
+        return NULL;
+    }
+
+    bool XmlStreamElement::hasAttribute(const char* name) const
+    {
+        return findAttribute(name) != NULL;
+    }
+
+    bool XmlStreamElement::getAttribute(const char* name, string& value) const
+    {
+        const Attribute* a = findAttribute(name);
+        if(a == NULL)
+        {
+            value.clear();
+            return false;
+        }
+        internal::decodeValue(a->value, a->valueLength, value);
+        return true;
+    }
+
+    XmlStreamReader::XmlStreamReader(const char* data, size_t length)
+        :begin_(data), pos_(data), end_(data + length), depth_(0)
+    {}
+
+    void XmlStreamReader::parse(XmlStreamHandler& handler)
+    {
+        pos_ = begin_;
+        depth_ = 0;
+        bool rootRead = false;
+
+        //Skip a utf-8 byte order mark
+        if(startsWith("\xEF\xBB\xBF"))
+            pos_ += 3;
+
+        while(!rootRead || depth_ > 0)
+        {
+            if(depth_ == 0)
+            {
+                skipWhitespace();
+                if(pos_ == end_)
+                    fail("Error document empty.");
+                if(*pos_ != '<')
+                    fail("Error parsing Element.");
+            }
+            else
+            {
+                //Skip text content
+                const char* next = static_cast<const char*>(memchr(pos_, '<', end_ - pos_));
+                if(next == NULL)
+                {
+                    pos_ = end_;
+                    fail("Error reading end tag.");
+                }
+                pos_ = next;
+            }
+
+            if(startsWith("<?"))
+                skipPast("?>", "Error parsing Declaration.");
+            else if(startsWith("<!--"))
+                skipPast("-->", "Error parsing Comment.");
+            else if(startsWith("<![CDATA["))
+                skipPast("]]>", "Error parsing CDATA.");
+            else if(startsWith("<!"))
+                skipPast(">", "Error parsing Unknown.");
+            else if(startsWith("</"))
+                readEndTag(handler);
+            else
+            {
+                readStartTag(handler);
+                rootRead = true;
+            }
+        }
+    }
+
+    void XmlStreamReader::readStartTag(XmlStreamHandler& handler)
+    {
+        ++pos_;
+        const char* name = pos_;
+        size_t nameLength = readName();
+        if(nameLength == 0)
+            fail("Failed to read Element name");
+        element_.name_.assign(name, nameLength);
+        element_.attributes_.clear();
+
+        while(true)
+        {
+            skipWhitespace();
+            if(pos_ == end_)
+                fail("Error parsing Element.");
+            if(*pos_ == '>')
+            {
+                ++pos_;
+                if(open_.size() <= depth_)
+                    open_.resize(depth_ + 1);
+                open_[depth_++].assign(name, nameLength);
+                handler.startElement(element_);
+                return;
+            }
+            if(startsWith("/>"))
+            {
+                pos_ += 2;
+                handler.startElement(element_);
+                handler.endElement(element_.name_);
+                return;
+            }
+
+            XmlStreamElement::Attribute a;
+            a.name = pos_;
+            a.nameLength = readName();
+            skipWhitespace();
+            if(a.nameLength == 0 || pos_ == end_ || *pos_ != '=')
+                fail("Error reading Attributes.");
+            ++pos_;
+            skipWhitespace();
+            if(pos_ == end_ || (*pos_ != '"' && *pos_ != '\''))
+                fail("Error reading Attributes.");
+            char quote = *pos_++;
+            const char* close = static_cast<const char*>(memchr(pos_, quote, end_ - pos_));
+            if(close == NULL)
+                fail("Error reading Attributes.");
+            a.value = pos_;
+            a.valueLength = close - pos_;
+            element_.attributes_.push_back(a);
+            pos_ = close + 1;
+        }
+    }
+
+    void XmlStreamReader::readEndTag(XmlStreamHandler& handler)
+    {
+        pos_ += 2;
+        const char* name = pos_;
+        size_t nameLength = readName();
+        skipWhitespace();
+        if(depth_ == 0 || pos_ == end_ || *pos_ != '>')
+            fail("Error reading end tag.");
+        const string& open = open_[depth_ - 1];
+        if(open.size() != nameLength || memcmp(open.data(), name, nameLength) != 0)
+            fail("Error reading end tag.");
+        ++pos_;
+        --depth_;
+        handler.endElement(open);
+    }
+
+    void XmlStreamReader::skipPast(const char* terminator, const char* error)
+    {
+        size_t length = strlen(terminator);
+        for(const char* p = pos_; end_ - p >= (ptrdiff_t)length; ++p)
+        {
+            if(memcmp(p, terminator, length) == 0)
+            {
+                pos_ = p + length;
+                return;
+            }
+        }
+        fail(error);
+    }
+
+    void XmlStreamReader::skipWhitespace()
+    {
+        while(pos_ != end_ && internal::isXmlSpace(*pos_))
+            ++pos_;
+    }
+
+    bool XmlStreamReader::startsWith(const char* s) const
+    {
+        size_t length = strlen(s);
+        return (size_t)(end_ - pos_) >= length && memcmp(pos_, s, length) == 0;
+    }
+
+    size_t XmlStreamReader::readName()
+    {
+        const char* start = pos_;
+        while(pos_ != end_ && !internal::isXmlSpace(*pos_) && *pos_ != '>'
+              && *pos_ != '/' && *pos_ != '=' && *pos_ != '<')
+            ++pos_;
+        return pos_ - start;
+    }
+
+    void XmlStreamReader::fail(const char* description) const
+    {
+        int line = 1, column = 1;
+        for(const char* p = begin_; p < pos_; ++p)
+        {
+            if(*p == '\n')
+            {
+                ++line;
+                column = 1;
+            }
+            else
+            {
+                ++column;
+            }
+        }
+        stringstream message;
+        message << "Error parsing xml. Description: " << description
+                << " Line: " << line << " Column: " << column;
+        throw XmlParsingException(message.str());
+    }
+
+} /* namespace iris */
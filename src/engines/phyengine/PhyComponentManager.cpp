@@ -33,6 +33,7 @@
  */
 
 #include <sstream>
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 #include "irisapi/Version.h"
@@ -51,58 +52,12 @@ PhyComponentManager::PhyComponentManager()
 
 void PhyComponentManager::addRepository(std::string repoPath)
 {
-    while(!repoPath.empty())
+    //Repositories are indexed once and shared - add the ones we don't have yet
+    vector< b::shared_ptr<RepositoryIndex> > indices = RepositoryIndex::getAll(repoPath);
+    for(vector< b::shared_ptr<RepositoryIndex> >::iterator i = indices.begin(); i != indices.end(); ++i)
     {
-        //Extract paths from the repository string
-        size_t pos = repoPath.find_first_of(';');
-        string str(repoPath, 0, pos);
-        repoPath.erase(0, pos);
-        // break out of the while if str is empty (e.g. with a repos="/path/to/1;")
-        if (str.empty())
-            break;
-
-        bfs::path currentPath(str);
-
-        //Check that the path exists and is a directory
-        if(!bfs::exists(currentPath) || !bfs::is_directory(currentPath))
-        {
-            LOG(LFATAL) << "Could not add repository " << str << " path does not exist or is not a directory.";
-            throw ResourceNotFoundException("Could not add repository " + str + " path does not exist or is not a directory.");
-        }
-
-        //Create a repository object
-        Repository tmp;
-        tmp.path = currentPath;
-
-        //Go through files in the repository and add to the repository vector of component libraries
-        bfs::directory_iterator dir_iter(currentPath), dir_end;
-        for(;dir_iter != dir_end; ++dir_iter)
-        {
-            //Check that the file path contains the system library extension
-#if BOOST_FILESYSTEM_VERSION == 2
-            string filename = dir_iter->path().leaf();
-#else
-            string filename = dir_iter->path().filename().string();
-#endif
-            size_t pos = filename.find_last_of('.');
-            if(pos != string::npos)
-            {
-                string extension = filename.substr(pos);
-                if(extension == SharedLibrary::getSystemExtension())
-                {
-                    size_t pre = SharedLibrary::getSystemPrefix().length();
-                    string stem = filename.substr(pre,pos-pre); //Remove library prefix and postfix
-                    ComponentLibrary current;
-                    current.path = dir_iter->path();
-                    current.name = stem;
-                    boost::to_lower(current.name);
-                    tmp.componentLibs.push_back(current);
-                }
-            }
-        }
-
-        //Add to vector of repository paths
-        repositories_.push_back(tmp);
+        if(find(repositories_.begin(), repositories_.end(), *i) == repositories_.end())
+            repositories_.push_back(*i);
     }
 }
 
@@ -110,59 +65,36 @@ b::shared_ptr<PhyComponent> PhyComponentManager::loadComponent(ComponentDescript
 {
     ComponentLibrary temp;
 
+    //Components may be loaded concurrently - guard the library list
+    b::mutex::scoped_lock lock(librariesMutex_);
+
     //Check if the library has already been loaded
-    vector< ComponentLibrary >::iterator libIt;
-    for(libIt=loadedLibraries_.begin();libIt!=loadedLibraries_.end();++libIt)
+    LibraryMap::iterator libIt = loadedLibraries_.find(desc.type);
+    if(libIt != loadedLibraries_.end())
     {
-        if(libIt->name == desc.type)
-            temp = *libIt;
+        temp = libIt->second;
     }
-
-    //If the library hasn't already been loaded, look for it in our repositories
-    if(temp.name == "")
+    else
     {
-        vector< Repository >::iterator repIt;
-        for(repIt=repositories_.begin();repIt!=repositories_.end();++repIt)
+        //Look for the library in our repositories
+        LibraryLocation location;
+        if(!RepositoryIndex::findLibrary(repositories_, desc.type, location))
         {
-            vector< ComponentLibrary >::iterator compIt;
-            for(compIt=repIt->componentLibs.begin();compIt!=repIt->componentLibs.end();++compIt)
-            {
-                if(compIt->name == desc.type)
-                {
-                    if(temp.name == "")
-                    {   //First component found which matches
-                        temp = *compIt;
-                    }
-                    else if(bfs::last_write_time(compIt->path) > bfs::last_write_time(temp.path))
-                    {   //Found more than one component which matches - choose the more recent one
-                        temp = *compIt;
-                    }
-                }
-            }
+            LOG(LFATAL) << "Could not find component " << desc.type << " in repositories.";
+            throw ResourceNotFoundException("Could not find component " + desc.type + " in repositories.");
         }
-    }
 
-    //Check that we found the library
-    if(temp.name == "")
-    {
-        LOG(LFATAL) << "Could not find component " << desc.type << " in repositories.";
-        throw ResourceNotFoundException("Could not find component " + desc.type + " in repositories.");
-    }
-
-    //Load it if necessary
-    if(temp.libPtr == NULL)
-    {
-        //Load the component library and set the pointer, add to vector of loaded libraries
-        temp.libPtr.reset(new SharedLibrary(temp.path));
-        loadedLibraries_.push_back(temp);
+        //Get the library from the cache, opening it if necessary, and add to map of loaded libraries
+        temp.name = desc.type;
+        temp.path = location.path;
+        temp.bundled = location.bundled;
+        temp.libPtr = LibraryCache::get(location.path, location.loadFlags);
+        loadedLibraries_[temp.name] = temp;
     }
-
-    //Pull a PhyComponent class out of the library
-    CREATEFUNCTION createFunction = (CREATEFUNCTION)temp.libPtr->getSymbol("CreateComponent");
-    DESTROYFUNCTION destroyFunction = (DESTROYFUNCTION)temp.libPtr->getSymbol("ReleaseComponent");
-    GETAPIVERSIONFUNCTION getApiFunction = (GETAPIVERSIONFUNCTION)temp.libPtr->getSymbol("GetApiVersion");
+    lock.unlock();
 
     //Check API version numbers match
+    GETAPIVERSIONFUNCTION getApiFunction = (GETAPIVERSIONFUNCTION)temp.libPtr->getSymbol("GetApiVersion");
     string coreVer, moduleVer;
     coreVer = Version::getApiVersion();
     moduleVer = getApiFunction();
@@ -175,6 +107,28 @@ b::shared_ptr<PhyComponent> PhyComponentManager::loadComponent(ComponentDescript
         throw ApiVersionException(message.str());
     }
 
+    //Pull a PhyComponent class out of the library
+    CREATEFUNCTION createFunction;
+    DESTROYFUNCTION destroyFunction;
+    if(temp.bundled)
+    {
+        //Find the component in the table of the bundle
+        GETBUNDLEFUNCTION getBundleFunction = (GETBUNDLEFUNCTION)temp.libPtr->getSymbol("GetComponentBundle");
+        const ComponentBundleEntry<PhyComponent>* entry = findBundledComponent(getBundleFunction(), desc.type);
+        if(entry == NULL)
+        {
+            LOG(LFATAL) << "Could not find component " << desc.type << " in bundle " << temp.path.string() << ".";
+            throw ResourceNotFoundException("Could not find component " + desc.type + " in bundle " + temp.path.string() + ".");
+        }
+        createFunction = entry->create;
+        destroyFunction = entry->release;
+    }
+    else
+    {
+        createFunction = (CREATEFUNCTION)temp.libPtr->getSymbol("CreateComponent");
+        destroyFunction = (DESTROYFUNCTION)temp.libPtr->getSymbol("ReleaseComponent");
+    }
+
     //Create a shared_ptr and use a custom deallocator so the component is destroyed from the library
     boost::shared_ptr<PhyComponent> comp(createFunction(desc.name), destroyFunction);
 
@@ -197,17 +151,11 @@ b::shared_ptr<PhyComponent> PhyComponentManager::loadComponent(ComponentDescript
 bool PhyComponentManager::componentExists(std::string name)
 {
     //Look for the component in our repositories
-    vector< Repository >::iterator repIt;
+    vector< b::shared_ptr<RepositoryIndex> >::iterator repIt;
     for(repIt=repositories_.begin();repIt!=repositories_.end();++repIt)
     {
-        vector< ComponentLibrary >::iterator compIt;
-        for(compIt=repIt->componentLibs.begin();compIt!=repIt->componentLibs.end();++compIt)
-        {
-            if(compIt->name == name)
-            {
-                return true;
-            }
-        }
+        if((*repIt)->contains(name))
+            return true;
     }
     return false;
 }
@@ -215,10 +163,10 @@ bool PhyComponentManager::componentExists(std::string name)
 vector<bfs::path> PhyComponentManager::getRepositories()
 {
     vector<bfs::path> paths;
-    vector<Repository>::iterator it;
+    vector< b::shared_ptr<RepositoryIndex> >::iterator it;
     for(it=repositories_.begin();it!=repositories_.end();++it)
     {
-        paths.push_back(it->path);
+        paths.push_back((*it)->getPath());
     }
     return paths;
 }
@@ -34,13 +34,46 @@
 #ifndef PHYDATABUFFER_H_
 #define PHYDATABUFFER_H_
 
+#include <boost/ptr_container/ptr_vector.hpp>
+
 #include "irisapi/DataBufferInterfaces.h"
+#include "irisapi/LinkDescription.h"
 #include "irisapi/Exceptions.h"
 #include "irisapi/TypeInfo.h"
+#include "irisapi/Logging.h"
 
 namespace iris
 {
 
+//! Statistics kept by a PhyDataBuffer
+struct PhyBufferStatistics
+{
+  std::size_t length;         //!< Current number of DataSets in the buffer
+  std::size_t capacity;       //!< Maximum number of DataSets in the buffer
+  std::size_t highWaterMark;  //!< Largest number of unread DataSets seen
+  std::size_t growths;        //!< Number of times a DataSet was added to the buffer
+  std::size_t drops;          //!< Number of unread DataSets which were overwritten
+
+  PhyBufferStatistics()
+    :length(0), capacity(0), highWaterMark(0), growths(0), drops(0)
+  {}
+};
+
+/*!
+*   \brief Type-independent interface used by the PhyEngine to manage its PhyDataBuffers.
+*/
+class PhyDataBufferBase
+{
+public:
+  virtual ~PhyDataBufferBase(){};
+
+  //! Should the writer be held back because the buffer is full?
+  virtual bool isFull() const = 0;
+
+  //! Get the statistics for this buffer
+  virtual PhyBufferStatistics getStatistics() const = 0;
+};
+
 /*!
 *   \brief The PhyDataBuffer class implements a buffer which exists between two IRIS components within a single
 *  PhyEngine.
@@ -51,31 +84,61 @@ namespace iris
 *  Components can get a DataSet to read from by calling GetReadSet(). When finished reading, the component
 *  releases the DataSet by calling ReleaseReadSet().
 *  The PhyDataBuffer is NOT thread-safe. It should only be used within a single PhyEngine. It is non-blocking.
-*  If a component wishes to write more data sets than are available, the PhyDataBuffer will grow.
+*
+*  The buffer holds at most capacity DataSets. What happens when a component writes to a full buffer
+*  depends on the BufferPolicy:
+*  POLICY_GROW - a new DataSet is added, up to the capacity. At capacity, isFull() tells the engine to
+*  stop running the writer until data has been read.
+*  POLICY_BACKPRESSURE - the full capacity is allocated up front and isFull() is set when it is used.
+*  POLICY_DROP - the full capacity is allocated up front and the oldest unread DataSet is overwritten.
+*  If the oldest DataSet is being read at the time, the newest one is overwritten instead.
+*  If a writer ignores isFull(), the buffer grows beyond its capacity rather than losing data, and a
+*  warning is logged.
+*  DataSets are allocated individually and never move, so growing the buffer never copies sample data.
 */
 template <typename T>
-class PhyDataBuffer : public ReadBuffer<T>, public WriteBuffer<T>
+class PhyDataBuffer : public ReadBuffer<T>, public WriteBuffer<T>, public PhyDataBufferBase
 {
 public:
 
+  //! Default maximum number of DataSets in a buffer
+  enum { DEFAULT_CAPACITY = 256 };
+
   /*!
   *   \brief Constructor
   *
   *   \param dataBufferLength   number of DataSets in the buffer
+  *   \param capacity           maximum number of DataSets in the buffer (0 for the default)
+  *   \param policy             what to do when the buffer is full
   */
-  explicit PhyDataBuffer(int dataBufferLength = 2)
-    :buffer_(dataBufferLength, DataSet<T>()),
-    isReadLocked_(false),
+  explicit PhyDataBuffer(int dataBufferLength = 2,
+                         std::size_t capacity = 0,
+                         BufferPolicy policy = POLICY_GROW)
+    :isReadLocked_(false),
     isWriteLocked_(false),
     readIndex_(0),
     writeIndex_(0),
     notEmpty_(false),
-    notFull_(true)
+    notFull_(true),
+    policy_(policy),
+    numUnread_(0)
   {
     //Set the type identifier for this buffer
     typeIdentifier = TypeInfo<T>::identifier;
     if( typeIdentifier == -1)
       throw InvalidDataTypeException("Data type not supported");
+
+    std::size_t length = dataBufferLength > 0 ? dataBufferLength : 1;
+    if(capacity > 0)
+      stats_.capacity = capacity;
+    else
+      stats_.capacity = DEFAULT_CAPACITY;
+    if(stats_.capacity < length)
+      stats_.capacity = length;
+    if(policy_ != POLICY_GROW)
+      length = stats_.capacity;
+    for(std::size_t i = 0; i < length; ++i)
+      buffer_.push_back(new DataSet<T>());
   };
 
   virtual ~PhyDataBuffer(){};
@@ -106,6 +169,40 @@ public:
     return is_not_empty();
   }
 
+  //! Get the timestamp of the next DataSet to read - reader and writer share a thread, so waiting for data throws
+  bool getNextTimeStamp(double& timeStamp, bool wait)
+  {
+    if(!is_not_empty())
+    {
+      if(wait)
+        throw DataBufferReleaseException("getNextTimeStamp() would wait forever - the buffer is written by the reading thread");
+      return false;
+    }
+    timeStamp = buffer_[readIndex_].timeStamp;
+    return true;
+  }
+
+  //! Should the writer be held back because the buffer is full?
+  bool isFull() const
+  {
+    return !notFull_ && policy_ != POLICY_DROP && buffer_.size() >= stats_.capacity;
+  }
+
+  //! Get the statistics for this buffer
+  PhyBufferStatistics getStatistics() const
+  {
+    PhyBufferStatistics s = stats_;
+    s.length = buffer_.size();
+    return s;
+  }
+
+  //! Name used when logging
+  std::string getName() const
+  {
+    return "PhyDataBuffer " + linkDesc.sourceComponent + "." + linkDesc.sourcePort +
+        " -> " + linkDesc.sinkComponent + "." + linkDesc.sinkPort;
+  }
+
   /*!
   *   \brief Get the next DataSet to read
   *
@@ -131,15 +228,43 @@ public:
       throw DataBufferReleaseException("getWriteData() called before previous DataSet was released");
     if(!notFull_)
     {
-      //If buffer is full, add a new DataSet
-      buffer_.push_back(DataSet<T>());
-      writeIndex_ = buffer_.size()-1;
+      if(policy_ == POLICY_DROP && (!isReadLocked_ || numUnread_ > 1))
+      {
+        if(!isReadLocked_)
+        {
+          //Overwrite the oldest unread DataSet
+          if(++readIndex_ == buffer_.size())
+            readIndex_ = 0;
+        }
+        else
+        {
+          //The oldest DataSet is being read - overwrite the newest instead
+          writeIndex_ = (writeIndex_ == 0 ? buffer_.size() : writeIndex_) - 1;
+        }
+        --numUnread_;
+        notFull_ = true;
+        ++stats_.drops;
+        if((stats_.drops & (stats_.drops - 1)) == 0)
+        {
+          LOG(LWARNING) << "Buffer full - " << stats_.drops << " DataSets dropped";
+        }
+      }
+      else
+      {
+        if(buffer_.size() >= stats_.capacity)
+        {
+          LOG(LWARNING) << "Writer ignored full buffer - growing beyond capacity of " << stats_.capacity;
+        }
+        grow();
+      }
     }
     isWriteLocked_ = true;
-    if(buffer_[writeIndex_].data.size() != size)
-      buffer_[writeIndex_].data.resize(size);
-    buffer_[writeIndex_].timeStamp = 0;
-    setPtr = &buffer_[writeIndex_];
+    DataSet<T>& set = buffer_[writeIndex_];
+    set.segments.clear();
+    if(set.data.size() != size)
+      set.data.resize(size);
+    set.timeStamp = 0;
+    setPtr = &set;
   };
 
   /*!
@@ -154,6 +279,7 @@ public:
     if(readIndex_ == writeIndex_)
       notEmpty_ = false;
     notFull_ = true;
+    --numUnread_;
     isReadLocked_ = false;
     setPtr = NULL;
   };
@@ -170,6 +296,8 @@ public:
     if(readIndex_ == writeIndex_)
       notFull_ = false;
     notEmpty_ = true;
+    if(++numUnread_ > stats_.highWaterMark)
+      stats_.highWaterMark = numUnread_;
     isWriteLocked_ = false;
     setPtr = NULL;
   };
@@ -181,8 +309,8 @@ private:
   //! The data type of this buffer
   int typeIdentifier;
 
-  //! The vector of DataSets
-  std::vector< DataSet<T> > buffer_;
+  //! The DataSets - held by pointer so they never move when the buffer grows
+  boost::ptr_vector< DataSet<T> > buffer_;
 
   bool isReadLocked_;
   bool isWriteLocked_;
@@ -193,9 +321,24 @@ private:
   bool notEmpty_;
   bool notFull_;
 
+  BufferPolicy policy_;
+  std::size_t numUnread_;
+  PhyBufferStatistics stats_;
+
   bool is_not_empty() const { return notEmpty_; }
   bool is_not_full() const { return notFull_; }
 
+  //! Add a DataSet at the write position, keeping unread DataSets in order
+  void grow()
+  {
+    buffer_.insert(buffer_.begin() + writeIndex_, new DataSet<T>());
+    //The unread DataSets from readIndex_ onwards have moved up one place
+    ++readIndex_;
+    notFull_ = true;
+    ++stats_.growths;
+    LOG(LINFO) << "Buffer grew to " << buffer_.size() << " DataSets";
+  }
+
 };
 
 } /* namespace iris */
@@ -38,7 +38,10 @@
 #include <boost/progress.hpp>
 #include <boost/bind.hpp>
 
+#include <algorithm>
+
 #include "iris/PhyEngine.h"
+#include "iris/TaskGroup.h"
 
 #include "irisapi/PhyComponent.h"
 #include "PhyComponentManager.h"
@@ -53,6 +56,7 @@ namespace iris
     PhyEngine::PhyEngine(std::string name, std::string repository)
         :engineName_(name)
         ,engineManager_(NULL)
+        ,generations_(0)
     {
         compManager_.reset(new PhyComponentManager());
         compManager_->addRepository(repository);
@@ -73,7 +77,7 @@ namespace iris
     }
 
     std::vector< boost::shared_ptr< DataBufferBase > >
-    PhyEngine::loadEngine(EngineDescription eng,
+    PhyEngine::loadEngine(const EngineDescription& eng,
                           std::vector< boost::shared_ptr< DataBufferBase > > inputLinks)
     {
         //Set the external input buffer
@@ -93,10 +97,36 @@ namespace iris
 
     void PhyEngine::unloadEngine()
     {
+        //Report on any internal buffers which grew or dropped data
+        for( vector< b::shared_ptr< DataBufferBase > >::iterator i = internalBuffers_.begin(); i != internalBuffers_.end(); ++i)
+        {
+            PhyDataBufferBase* buf = dynamic_cast<PhyDataBufferBase*>(i->get());
+            if(buf == NULL)
+                continue;
+            PhyBufferStatistics stats = buf->getStatistics();
+            if(stats.growths > 0 || stats.drops > 0)
+            {
+                LinkDescription l = (*i)->getLinkDescription();
+                LOG(LINFO) << "Link " << l.sourceComponent << "." << l.sourcePort << " -> " << l.sinkComponent << "." << l.sinkPort
+                    << ": length " << stats.length << ", capacity " << stats.capacity << ", high water mark " << stats.highWaterMark
+                    << ", growths " << stats.growths << ", drops " << stats.drops;
+            }
+        }
+
+        ReconfigLatency& latency = pendingReconfigs_.latency();
+        if(latency.count > 0)
+        {
+            LOG(LINFO) << "Reconfiguration latency: " << latency.count << " sets, average "
+                << latency.average() << ", maximum " << latency.maximum;
+        }
+
         //Destroy all components and clear the vector
         components_.clear();   //Components are deleted here using a custom deallocator due to use of boost::shared_ptr
+        preparedComponents_.clear();
+        componentIO_.clear();
 
         //Destroy all internal buffers and clear the vector
+        componentOutputs_.clear();
         internalBuffers_.clear();
     }
 
@@ -107,7 +137,8 @@ namespace iris
         {
             (*i)->start();
         }
-        //Start the main engine thread
+        //Start the thread which destroys replaced components, then the main engine thread
+        reaperThread_.reset( new b::thread( b::bind( &PhyEngine::reaperLoop, this ) ) );
         thread_.reset( new b::thread( b::bind( &PhyEngine::threadLoop, this ) ) );
     }
 
@@ -120,11 +151,54 @@ namespace iris
         }
         thread_->interrupt();
         thread_->join();
+
+        //An empty pointer stops the reaper once it has destroyed everything before it
+        retiredComponents_.push(b::shared_ptr<PhyComponent>());
+        reaperThread_->join();
     }
 
-    void PhyEngine::addReconfiguration(ReconfigSet reconfigs)
+    bool PhyEngine::addReconfiguration(ReconfigSet& reconfigs)
     {
+        bool accepted = true;
+
+        //Load replacement components now so the engine thread only has to switch them
+        vector< StructuralReconfig >::iterator structIt;
+        for(structIt = reconfigs.structReconfigs.begin(); structIt != reconfigs.structReconfigs.end(); ++structIt)
+        {
+            if(structIt->changesGraph())
+            {
+                LOG(LERROR) << "Engine " << engineName_ << " can only replace components while running - "
+                    << "added, removed and relinked components were ignored";
+                StructuralReconfig replaceOnly;
+                replaceOnly.engineName = structIt->engineName;
+                replaceOnly.replacedComponents.swap(structIt->replacedComponents);
+                *structIt = replaceOnly;
+                accepted = false;
+            }
+
+            //Drop replacements which could not be prepared
+            vector< NewComponent >::iterator compIt = structIt->replacedComponents.begin();
+            while(compIt != structIt->replacedComponents.end())
+            {
+                if(prepareComponent(*compIt))
+                {
+                    ++compIt;
+                }
+                else
+                {
+                    compIt = structIt->replacedComponents.erase(compIt);
+                    accepted = false;
+                }
+            }
+        }
+
         reconfigQueue_.push(reconfigs);
+        return accepted;
+    }
+
+    void PhyEngine::addReconfiguration(const TypedParametricReconfig& reconfig)
+    {
+        typedReconfigQueue_.push(reconfig);
     }
 
     void PhyEngine::threadLoop()
@@ -140,24 +214,15 @@ namespace iris
                 b::this_thread::interruption_point();
 
                 //Check message queue for ReconfigSets
-                ReconfigSet currentReconfigSet;
-                while(reconfigQueue_.tryPop(currentReconfigSet))
-                {
-                    vector< ParametricReconfig >::iterator paramIt;
-                    for(paramIt = currentReconfigSet.paramReconfigs.begin();
-                        paramIt != currentReconfigSet.paramReconfigs.end();
-                        ++paramIt)
-                    {
-                        reconfigureParameter(*paramIt);
-                    }
-                }
+                processReconfigurations();
 
                 //Go through components in topological order
                 for(vector<unsigned>::reverse_iterator i = revTopoOrder.rbegin(); i != revTopoOrder.rend(); ++i)
                 {
                     if(i == revTopoOrder.rbegin()) //First component in the graph
                     {
-                        components_[*i]->doProcess();
+                        if(!outputsFull(*i))
+                            components_[*i]->doProcess();
                     }
                     else
                     {
@@ -165,7 +230,7 @@ namespace iris
                         for(b::tie(edgeIt, edgeItEnd) = in_edges(*i, engineGraph_); edgeIt != edgeItEnd; ++edgeIt)
                         {
                             //If there's data available in an input buffer, process it
-                            while( engineGraph_[*edgeIt].theBuffer->hasData() )
+                            while( engineGraph_[*edgeIt].theBuffer->hasData() && !outputsFull(*i) )
                             {
                                 components_[*i]->doProcess();
                             }
@@ -184,6 +249,56 @@ namespace iris
         }
     }
 
+    void PhyEngine::reaperLoop()
+    {
+        while(true)
+        {
+            b::shared_ptr<PhyComponent> comp;
+            retiredComponents_.waitAndPop(comp);
+            if(comp == NULL)
+                return;
+            comp.reset();   //Unloading a component can be slow, so keep it off the engine thread
+        }
+    }
+
+    bool PhyEngine::outputsFull(unsigned component) const
+    {
+        const vector< PhyDataBufferBase* >& outputs = componentOutputs_[component];
+        for(vector< PhyDataBufferBase* >::const_iterator i = outputs.begin(); i != outputs.end(); ++i)
+        {
+            if((*i)->isFull())
+                return true;
+        }
+        return false;
+    }
+
+    void PhyEngine::processReconfigurations()
+    {
+        ReconfigSet currentReconfigSet;
+        while(reconfigQueue_.tryPop(currentReconfigSet))
+        {
+            pendingReconfigs_.add(currentReconfigSet);
+        }
+
+        //Apply every set which is due before the next data, all at this boundary
+        bool timeKnown = false;
+        double dataTime = 0;
+        if(pendingReconfigs_.nextIsTimed())
+            timeKnown = getDataTime(dataTime);
+        while(pendingReconfigs_.popDue(timeKnown, dataTime, currentReconfigSet))
+        {
+            applyReconfigSet(currentReconfigSet);
+            if(!timeKnown && pendingReconfigs_.nextIsTimed())
+                timeKnown = getDataTime(dataTime);
+        }
+
+        TypedParametricReconfig typedReconfig;
+        while(typedReconfigQueue_.tryPop(typedReconfig))
+        {
+            reconfigureParameter(typedReconfig);
+        }
+    }
+
     void PhyEngine::checkGraph(RadioGraph& graph)
     {
         //Check graph obeys PhyEngine rules:
@@ -193,16 +308,20 @@ namespace iris
 
     void PhyEngine::buildEngineGraph(RadioGraph& graph)
     {
-        //Create the components
+        //Create the components concurrently - each is stored at its vertex index
+        components_.assign(num_vertices(graph), b::shared_ptr<PhyComponent>());
+        TaskGroup loaders;
         VertexIterator i, iend;
         for(b::tie(i,iend) = vertices(graph); i != iend; ++i)
         {
-            //Load the component and add to vector
-            ComponentDescription current = graph[*i];
-            b::shared_ptr<PhyComponent> comp = compManager_->loadComponent(current);
-            comp->setEngine(this);    //Provide an interface to the component
-            components_.push_back(comp);
+            loaders.add(b::bind(&PhyEngine::createComponent, this, b::cref(graph[*i]), b::ref(components_[*i])));
         }
+        loaders.run();
+
+        //Give derived engines a chance to examine the components before linking them
+        componentsLoaded(graph);
+        componentOutputs_.assign(components_.size(), vector< PhyDataBufferBase* >());
+        componentIO_.assign(components_.size(), ComponentIO());
 
         //Do a topological sort of the graph
         deque<unsigned> topoOrder;
@@ -238,6 +357,8 @@ namespace iris
 
             //Get output buffer types from component
             components_[*i]->calculateOutputTypes(inputTypes, outputTypes);
+            componentIO_[*i].inputTypes = inputTypes;
+            componentIO_[*i].outputTypes = outputTypes;
 
             // temporary shell for testing template components
             std::vector<int> inTypes, outTypes;
@@ -270,10 +391,12 @@ namespace iris
 
                 //Create a PhyDataBuffer of the correct type
                 int currentType = outputTypes[srcPort];
-                b::shared_ptr< DataBufferBase > buf = createPhyDataBuffer(currentType);
+                b::shared_ptr< DataBufferBase > buf = createPhyDataBuffer(currentType, getBufferLength(graph[*outEdgeIt]),
+                                                                          graph[*outEdgeIt].bufferCapacity, graph[*outEdgeIt].bufferPolicy);
                 graph[*outEdgeIt].theBuffer = buf;
                 graph[*outEdgeIt].theBuffer->setLinkDescription(graph[*outEdgeIt]);
                 internalBuffers_.push_back( buf );
+                componentOutputs_[*i].push_back( dynamic_cast<PhyDataBufferBase*>( buf.get() ) );
 
                 currentOutBufs.push_back( dynamic_cast<WriteBufferBase*>( buf.get() ) );
 
@@ -294,17 +417,106 @@ namespace iris
                 engOutputBuffers_.push_back(buf);
                 currentOutBufs.push_back( dynamic_cast<WriteBufferBase*>( buf.get() ) );
             }
+            outputTypes.clear();
 
             //Set the buffers in the component
             components_[*i]->setBuffers(currentInBufs, currentOutBufs);
 
-            //Initialize the component
-            components_[*i]->initialize();
-
+            componentIO_[*i].inBufs = currentInBufs;
+            componentIO_[*i].outBufs = currentOutBufs;
             currentInBufs.clear();
             currentOutBufs.clear();
         }
 
+        //All links are in place - initialize the components
+        if(parallelInitialize())
+        {
+            TaskGroup initializers;
+            for(vector< b::shared_ptr<PhyComponent> >::iterator i = components_.begin(); i != components_.end(); ++i)
+            {
+                initializers.add(b::bind(&PhyComponent::initialize, i->get()));
+            }
+            initializers.run();
+        }
+        else
+        {
+            for(vector< b::shared_ptr<PhyComponent> >::iterator i = components_.begin(); i != components_.end(); ++i)
+            {
+                initializeComponent(**i);
+            }
+        }
+    }
+
+    void PhyEngine::setParallelInitialize(bool parallel)
+    {
+        parallelInitialize() = parallel;
+    }
+
+    bool& PhyEngine::parallelInitialize()
+    {
+        static bool parallel = false;
+        return parallel;
+    }
+
+    void PhyEngine::initializeComponent(PhyComponent& comp)
+    {
+        if(parallelInitialize())
+        {
+            comp.initialize();
+            return;
+        }
+
+        //Engines are loaded concurrently, so serialize across all of them
+        static b::mutex initializeMutex;
+        b::mutex::scoped_lock lock(initializeMutex);
+        comp.initialize();
+    }
+
+    void PhyEngine::createComponent(const ComponentDescription& desc, b::shared_ptr<PhyComponent>& comp)
+    {
+        comp = compManager_->loadComponent(desc);
+        comp->setEngine(this);    //Provide an interface to the component
+        Logger::getPolicy()->setParent(desc.name, engineName_);   //Use our log level unless it has its own
+    }
+
+    bool PhyEngine::getDataTime(double& timeStamp)
+    {
+        //Without inputs the engine creates its data - the source is stamped with the clock
+        if(engInputBuffers_.empty())
+        {
+            timeStamp = currentTimeStamp();
+            return true;
+        }
+
+        //Wait for the first input as the source component would do anyway
+        if(!engInputBuffers_.front()->getNextTimeStamp(timeStamp, true))
+            return false;
+
+        //The next data boundary is the earliest input - unknown until every input has data
+        for(size_t i = 1; i < engInputBuffers_.size(); ++i)
+        {
+            double t;
+            if(!engInputBuffers_[i]->getNextTimeStamp(t, false))
+                return false;
+            timeStamp = std::min(timeStamp, t);
+        }
+        return true;
+    }
+
+    void PhyEngine::applyReconfigSet(const ReconfigSet& set)
+    {
+        vector< ParametricReconfig >::const_iterator paramIt;
+        for(paramIt = set.paramReconfigs.begin(); paramIt != set.paramReconfigs.end(); ++paramIt)
+        {
+            reconfigureParameter(*paramIt);
+        }
+        vector< StructuralReconfig >::const_iterator structIt;
+        for(structIt = set.structReconfigs.begin(); structIt != set.structReconfigs.end(); ++structIt)
+        {
+            reconfigureStructure(*structIt);
+        }
+        b::posix_time::time_duration latency = pendingReconfigs_.latency().record(set.issueTime);
+        LOG(LDEBUG) << "Applied " << set.paramReconfigs.size() << " reconfigurations after " << latency;
     }
 
     void PhyEngine::reconfigureParameter(ParametricReconfig reconfig)
@@ -330,12 +542,190 @@ namespace iris
         }
     }
 
+    void PhyEngine::reconfigureParameter(const TypedParametricReconfig& reconfig)
+    {
+        int index = reconfig.handle.componentIndex;
+        if(index < 0 || index >= (int)components_.size())
+        {
+            LOG(LERROR) << "Parametric reconfiguration failed: invalid component index " << index;
+            return;
+        }
+
+        //No logging on success - this path is used for frequent updates
+        PhyComponent& comp = *components_[index];
+        try
+        {
+            comp.setValue(reconfig.handle.parameterIndex, reconfig.value, reconfig.handle.generation);
+            comp.parameterHasChanged(comp.getParameterName(reconfig.handle.parameterIndex));
+        }
+        catch(IrisException& ex)
+        {
+            LOG(LERROR) << "Parametric reconfiguration of " << comp.getName() << " failed: " << ex.what();
+        }
+    }
+
+    bool PhyEngine::prepareComponent(const NewComponent& newComp)
+    {
+        int index = findComponentIndex(newComp.name);
+        if(index < 0)
+        {
+            LOG(LERROR) << "Structural reconfiguration failed: could not find component: " << newComp.name;
+            return false;
+        }
+
+        ComponentDescription desc;
+        desc.name = newComp.name;
+        desc.type = newComp.type;
+        desc.engineName = engineName_;
+        vector< pair<string, string> >::const_iterator paramIt;
+        for(paramIt = newComp.parameters.begin(); paramIt != newComp.parameters.end(); ++paramIt)
+        {
+            ParameterDescription p;
+            p.name = paramIt->first;
+            p.value = paramIt->second;
+            desc.parameters.push_back(p);
+        }
+
+        try
+        {
+            b::shared_ptr<PhyComponent> comp = compManager_->loadComponent(desc);
+            comp->setEngine(this);
+            Logger::getPolicy()->setParent(desc.name, engineName_);
+
+            //The new component must fit the buffers of the one it replaces
+            const ComponentIO& io = componentIO_[index];
+            map<string, int> inputTypes = io.inputTypes;
+            map<string, int> outputTypes;
+            comp->calculateOutputTypes(inputTypes, outputTypes);
+            if(outputTypes != io.outputTypes)
+            {
+                throw InvalidDataTypeException("Outputs of " + desc.type + " do not match those of component " + desc.name);
+            }
+            {
+                b::mutex::scoped_lock lock(componentsMutex_);
+                checkReplacement(*components_[index], *comp);
+            }
+
+            vector<int> inTypes, outTypes;
+            for(map<string, int>::iterator j = inputTypes.begin(); j != inputTypes.end(); ++j)
+            {
+                inTypes.push_back(j->second);
+            }
+            for(map<string, int>::iterator j = outputTypes.begin(); j != outputTypes.end(); ++j)
+            {
+                outTypes.push_back(j->second);
+            }
+            PhyComponent* x = comp->setupIO(inTypes, outTypes);
+            if(x != comp.get())
+            {
+                comp.reset(x);
+            }
+
+            //Handles resolved for the component being replaced must not reach this one
+            comp->setParameterGeneration(++generations_);
+            comp->setBuffers(io.inBufs, io.outBufs);
+            initializeComponent(*comp);
+
+            b::mutex::scoped_lock lock(componentsMutex_);
+            preparedComponents_[desc.name] = comp;
+        }
+        catch(IrisException& ex)
+        {
+            LOG(LERROR) << "Structural reconfiguration failed: could not prepare " << desc.type
+                << " to replace component " << desc.name << ": " << ex.what();
+            return false;
+        }
+        return true;
+    }
+
+    void PhyEngine::reconfigureStructure(const StructuralReconfig& reconfig)
+    {
+        bool replaced = false;
+        vector< NewComponent >::const_iterator compIt;
+        for(compIt = reconfig.replacedComponents.begin(); compIt != reconfig.replacedComponents.end(); ++compIt)
+        {
+            int index = findComponentIndex(compIt->name);
+            b::mutex::scoped_lock lock(componentsMutex_);
+            map< string, b::shared_ptr<PhyComponent> >::iterator it = preparedComponents_.find(compIt->name);
+            if(index < 0 || it == preparedComponents_.end())
+                continue;   //Preparation failed and was reported
+
+            //Switch components - the old one is destroyed by the reaper thread
+            b::posix_time::ptime start = b::posix_time::microsec_clock::universal_time();
+            b::shared_ptr<PhyComponent> old = components_[index];
+            old->stop();
+            it->second->start();
+            components_[index] = it->second;
+            preparedComponents_.erase(it);
+            b::posix_time::time_duration glitch = b::posix_time::microsec_clock::universal_time() - start;
+            lock.unlock();
+            retiredComponents_.push(old);
+
+            LOG(LINFO) << "Replaced component " << compIt->name << " with " << compIt->type << " in " << glitch;
+            replaced = true;
+        }
+
+        //The published parameters of the new components must be looked up again
+        if(replaced && engineManager_ != NULL)
+            engineManager_->componentsReplaced(engineName_);
+    }
+
+    int PhyEngine::findComponentIndex(string name) const
+    {
+        b::mutex::scoped_lock lock(componentsMutex_);
+        for(unsigned i = 0; i < components_.size(); ++i)
+        {
+            if(components_[i]->getName() == name)
+                return i;
+        }
+        return -1;
+    }
+
+    bool PhyEngine::resolveParameter(string paramName, string componentName,
+                                   ParameterHandle& handle)
+    {
+        b::mutex::scoped_lock lock(componentsMutex_);
+        for(unsigned i = 0; i < components_.size(); ++i)
+        {
+            if(components_[i]->getName() == componentName)
+            {
+                try
+                {
+                    handle.parameterIndex = components_[i]->getParameterIndex(paramName);
+                    handle.typeIdentifier = components_[i]->getParameterTypeIdentifier(paramName);
+                    handle.componentIndex = i;
+                    handle.generation = components_[i]->getParameterGeneration();
+                    return true;
+                }
+                catch(ParameterNotFoundException&)
+                {
+                    return false;
+                }
+            }
+        }
+        return false;
+    }
+
     void PhyEngine::postCommand(Command command)
     {
         LOG(LERROR) << "PhyComponents do not support commands - failed to post command " <<
                 command.commandName << " to " << command.componentName;
     }
 
+    void PhyEngine::getPublishedParameters(PublishedParameterMap& params)
+    {
+        b::mutex::scoped_lock lock(componentsMutex_);
+        vector< b::shared_ptr<PhyComponent> >::iterator compIt;
+        for(compIt = components_.begin(); compIt != components_.end(); ++compIt)
+        {
+            for(size_t i = 0; i < (*compIt)->getNumParameters(); ++i)
+            {
+                const string& name = (*compIt)->getParameterName(i);
+                params[make_pair((*compIt)->getName(), name)] = (*compIt)->getPublishedParameter(name);
+            }
+        }
+    }
+
     void PhyEngine::activateEvent(Event &e)
     {
         if(engineManager_ == NULL)
@@ -348,6 +738,14 @@ namespace iris
         engineManager_->activateEvent(e);
     }
 
+    int PhyEngine::resolveEvent(std::string eventName, std::string componentName)
+    {
+        if(engineManager_ == NULL)
+            return -1;
+
+        return engineManager_->resolveEvent(eventName, componentName);
+    }
+
     bool PhyEngine::sameLink(LinkDescription first, LinkDescription second) const
     {
         return (first.sourceComponent == second.sourceComponent &&
@@ -391,18 +789,18 @@ namespace iris
     template <int N = b::mpl::size<IrisDataTypes>::value>
     struct getPhyBufferOfType
     {
-        static bool EXEC(int type, b::shared_ptr<DataBufferBase> &ptr)
+        static bool EXEC(int type, int length, size_t capacity, BufferPolicy policy, b::shared_ptr<DataBufferBase> &ptr)
         {
             typedef typename b::mpl::at_c<IrisDataTypes,N-1>::type T;
 
             if(N-1 == type)
             {
-                ptr.reset(new PhyDataBuffer<T>);
+                ptr.reset(new PhyDataBuffer<T>(length, capacity, policy));
                 return true;
             }
             else
             {
-                return getPhyBufferOfType<N-1>::EXEC(type, ptr);
+                return getPhyBufferOfType<N-1>::EXEC(type, length, capacity, policy, ptr);
             }
         }
     };
@@ -410,7 +808,7 @@ namespace iris
     template <>
     struct getPhyBufferOfType<0>
     {
-        static bool EXEC(int type, b::shared_ptr<DataBufferBase> &ptr)
+        static bool EXEC(int type, int length, size_t capacity, BufferPolicy policy, b::shared_ptr<DataBufferBase> &ptr)
         {
             return false;
         }
@@ -429,10 +827,10 @@ namespace iris
     }
 
     //! Create a PhyDataBuffer of a particular data type
-    b::shared_ptr< DataBufferBase > PhyEngine::createPhyDataBuffer(int type) const
+    b::shared_ptr< DataBufferBase > PhyEngine::createPhyDataBuffer(int type, int length, size_t capacity, BufferPolicy policy) const
     {
         b::shared_ptr< DataBufferBase> ret;
-        if(!internal::getPhyBufferOfType<>::EXEC(type, ret))
+        if(!internal::getPhyBufferOfType<>::EXEC(type, length, capacity, policy, ret))
         {
             throw InvalidDataTypeException("Attempted to create DataBuffer with invalid data type value: " + type);
         }
@@ -0,0 +1,337 @@
+/**
+ * \file SdfEngine.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Implementation of SdfEngine class - the Iris synchronous dataflow engine.
+ */
+
+#include <sstream>
+#include <boost/thread/thread.hpp>
+
+#include "iris/SdfEngine.h"
+
+#include "irisapi/PhyComponent.h"
+
+using namespace std;
+namespace b = boost;
+
+namespace iris
+{
+
+    // Internal namespace for helper functions
+    namespace internal{
+    //! Greatest common divisor
+    unsigned long gcd(unsigned long a, unsigned long b)
+    {
+        while(b != 0)
+        {
+            unsigned long t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+    } /* namespace internal */
+
+    SdfEngine::SdfEngine(std::string name, std::string repository)
+        :PhyEngine(name, repository)
+    {
+    }
+
+    SdfEngine::~SdfEngine()
+    {
+    }
+
+    SdfSchedule SdfEngine::getSchedule() const
+    {
+        return schedule_;
+    }
+
+    void SdfEngine::threadLoop()
+    {
+        //The main loop of this engine thread
+        try{
+            while(true)
+            {
+                b::this_thread::interruption_point();
+
+                //Check message queue for ReconfigSets
+                processReconfigurations();
+
+                //Run one iteration of the schedule
+                for(vector< SdfFiring >::iterator i = schedule_.firings.begin(); i != schedule_.firings.end(); ++i)
+                {
+                    PhyComponent* comp = components_[i->actor].get();
+                    for(unsigned n = 0; n < i->count; ++n)
+                    {
+                        comp->doProcess();
+                    }
+                }
+            }
+        }
+        catch(IrisException& ex)
+        {
+            LOG(LFATAL) << "Error in engine " << engineName_ << ": " << ex.what() << " - Engine thread exiting.";
+        }
+        catch(b::thread_interrupted&)
+        {
+            LOG(LINFO) << "Thread in Engine " << engineName_ << " interrupted";
+        }
+    }
+
+    void SdfEngine::componentsLoaded(RadioGraph& graph)
+    {
+        //Get the declared rates of each link
+        vector< SdfEdge > sdfEdges;
+        vector< LinkDescription > links;
+        EdgeIterator i, iend;
+        for(b::tie(i, iend) = edges(graph); i != iend; ++i)
+        {
+            LinkDescription& l = graph[*i];
+            unsigned src = source(*i, graph);
+            unsigned snk = target(*i, graph);
+            unsigned prod = getPortRate(components_[src]->getOutputPorts(), l.sourcePort, l.sourceComponent);
+            unsigned cons = getPortRate(components_[snk]->getInputPorts(), l.sinkPort, l.sinkComponent);
+            sdfEdges.push_back(SdfEdge(src, snk, prod, cons));
+            links.push_back(l);
+        }
+
+        schedule_ = computeSchedule(num_vertices(graph), sdfEdges);
+
+        //Store the buffer sizes for each link
+        bufferLengths_.clear();
+        for(size_t j = 0; j < links.size(); ++j)
+        {
+            bufferLengths_[links[j].sourceComponent + "." + links[j].sourcePort] = schedule_.bufferSizes[j];
+        }
+
+        stringstream str;
+        for(size_t j = 0; j < schedule_.repetitions.size(); ++j)
+        {
+            str << " " << components_[j]->getName() << ":" << schedule_.repetitions[j];
+        }
+        LOG(LINFO) << "Engine " << engineName_ << " repetition vector:" << str.str();
+    }
+
+    int SdfEngine::getBufferLength(const LinkDescription& link) const
+    {
+        map< string, int >::const_iterator it = bufferLengths_.find(link.sourceComponent + "." + link.sourcePort);
+        if(it == bufferLengths_.end())
+        {
+            return PhyEngine::getBufferLength(link);
+        }
+        return it->second;
+    }
+
+    void SdfEngine::checkReplacement(const PhyComponent& current, const PhyComponent& replacement) const
+    {
+        //The schedule and buffer sizes were computed from the rates of the running component
+        checkPortRates(current.getInputPorts(), replacement.getInputPorts(), current.getName());
+        checkPortRates(current.getOutputPorts(), replacement.getOutputPorts(), current.getName());
+    }
+
+    void SdfEngine::checkPortRates(const vector< Port >& current, const vector< Port >& replacement,
+                                   string component) const
+    {
+        for(vector< Port >::const_iterator i = current.begin(); i != current.end(); ++i)
+        {
+            if(getPortRate(replacement, i->portName, component) != i->rate)
+            {
+                throw GraphStructureErrorException("Replacement for PhyComponent " + component +
+                    " changes the rate of port " + i->portName);
+            }
+        }
+    }
+
+    unsigned SdfEngine::getPortRate(const vector< Port >& ports, string name, string component) const
+    {
+        for(vector< Port >::const_iterator i = ports.begin(); i != ports.end(); ++i)
+        {
+            if(i->portName == name)
+            {
+                return i->rate;
+            }
+        }
+        throw ResourceNotFoundException("Port " + name + " could not be found on PhyComponent " + component);
+    }
+
+    SdfSchedule SdfEngine::computeSchedule(unsigned numActors, const vector< SdfEdge >& edges)
+    {
+        SdfSchedule s;
+
+        //Find the edges into and out of each actor
+        vector< vector< unsigned > > inEdges(numActors), outEdges(numActors);
+        for(unsigned e = 0; e < edges.size(); ++e)
+        {
+            if(edges[e].source >= numActors || edges[e].sink >= numActors)
+            {
+                throw GraphStructureErrorException("SDF edge refers to an actor which does not exist");
+            }
+            if(edges[e].production == 0 || edges[e].consumption == 0)
+            {
+                throw GraphStructureErrorException("SDF ports must produce or consume at least one DataSet");
+            }
+            outEdges[edges[e].source].push_back(e);
+            inEdges[edges[e].sink].push_back(e);
+        }
+
+        //Solve the balance equations - firing rates are held as fractions num/den
+        vector< unsigned long > num(numActors, 0), den(numActors, 1);
+        for(unsigned a = 0; a < numActors; ++a)
+        {
+            if(num[a] != 0)
+                continue;
+            num[a] = 1;
+            vector< unsigned > toVisit(1, a);
+            while(!toVisit.empty())
+            {
+                unsigned current = toVisit.back();
+                toVisit.pop_back();
+
+                //Neighbours are reached both along and against the edges
+                for(int dir = 0; dir < 2; ++dir)
+                {
+                    vector< unsigned >& adj = (dir == 0) ? outEdges[current] : inEdges[current];
+                    for(vector< unsigned >::iterator i = adj.begin(); i != adj.end(); ++i)
+                    {
+                        const SdfEdge& e = edges[*i];
+                        unsigned other = (dir == 0) ? e.sink : e.source;
+                        unsigned long n = num[current] * ((dir == 0) ? e.production : e.consumption);
+                        unsigned long d = den[current] * ((dir == 0) ? e.consumption : e.production);
+                        unsigned long g = internal::gcd(n, d);
+                        n /= g;
+                        d /= g;
+                        if(num[other] == 0)
+                        {
+                            num[other] = n;
+                            den[other] = d;
+                            toVisit.push_back(other);
+                        }
+                        else if(num[other] != n || den[other] != d)
+                        {
+                            throw GraphStructureErrorException("SDF graph is inconsistent - the rates of its ports cannot be balanced");
+                        }
+                    }
+                }
+            }
+        }
+
+        //Scale to the smallest integer solution
+        unsigned long lcm = 1;
+        for(unsigned a = 0; a < numActors; ++a)
+        {
+            lcm = lcm / internal::gcd(lcm, den[a]) * den[a];
+        }
+        unsigned long g = 0;
+        for(unsigned a = 0; a < numActors; ++a)
+        {
+            num[a] = num[a] * (lcm / den[a]);
+            g = internal::gcd(num[a], g);
+        }
+        s.repetitions.resize(numActors);
+        unsigned long total = 0;
+        for(unsigned a = 0; a < numActors; ++a)
+        {
+            s.repetitions[a] = num[a] / g;
+            total += s.repetitions[a];
+        }
+
+        //Sort the actors topologically
+        vector< unsigned > order, inCount(numActors);
+        for(unsigned a = 0; a < numActors; ++a)
+        {
+            inCount[a] = inEdges[a].size();
+            if(inCount[a] == 0)
+                order.push_back(a);
+        }
+        for(unsigned i = 0; i < order.size(); ++i)
+        {
+            vector< unsigned >& adj = outEdges[order[i]];
+            for(vector< unsigned >::iterator e = adj.begin(); e != adj.end(); ++e)
+            {
+                if(--inCount[edges[*e].sink] == 0)
+                    order.push_back(edges[*e].sink);
+            }
+        }
+        if(order.size() != numActors)
+        {
+            throw GraphStructureErrorException("SDF graph contains a cycle");
+        }
+
+        //Simulate one iteration, always firing the furthest downstream actor
+        //which can fire. This drains links as early as possible and keeps
+        //the buffers small.
+        vector< unsigned > remaining = s.repetitions;
+        vector< unsigned > tokens(edges.size(), 0);
+        s.bufferSizes.assign(edges.size(), 1);
+        while(total > 0)
+        {
+            bool fired = false;
+            for(vector< unsigned >::reverse_iterator a = order.rbegin(); a != order.rend() && !fired; ++a)
+            {
+                if(remaining[*a] == 0)
+                    continue;
+                bool ready = true;
+                for(vector< unsigned >::iterator e = inEdges[*a].begin(); e != inEdges[*a].end(); ++e)
+                {
+                    if(tokens[*e] < edges[*e].consumption)
+                        ready = false;
+                }
+                if(!ready)
+                    continue;
+
+                //Fire the actor
+                for(vector< unsigned >::iterator e = inEdges[*a].begin(); e != inEdges[*a].end(); ++e)
+                {
+                    tokens[*e] -= edges[*e].consumption;
+                }
+                for(vector< unsigned >::iterator e = outEdges[*a].begin(); e != outEdges[*a].end(); ++e)
+                {
+                    tokens[*e] += edges[*e].production;
+                    if(tokens[*e] > s.bufferSizes[*e])
+                        s.bufferSizes[*e] = tokens[*e];
+                }
+                if(!s.firings.empty() && s.firings.back().actor == *a)
+                    s.firings.back().count++;
+                else
+                    s.firings.push_back(SdfFiring(*a, 1));
+                --remaining[*a];
+                --total;
+                fired = true;
+            }
+            if(!fired)
+            {
+                throw GraphStructureErrorException("SDF graph deadlocks - no valid schedule exists");
+            }
+        }
+
+        return s;
+    }
+
+} /* namespace iris */
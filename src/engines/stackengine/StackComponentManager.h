@@ -39,12 +39,16 @@
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
 #include "boost/filesystem.hpp"
 
-#include "iris/SharedLibrary.h"
+#include "iris/LibraryCache.h"
+#include "iris/RepositoryIndex.h"
 #include "iris/RadioRepresentation.h"
 #include "irisapi/Logging.h"
 #include "irisapi/StackComponent.h"
+#include "irisapi/ComponentBundle.h"
 #include "irisapi/Exceptions.h"
 
 namespace iris
@@ -56,24 +60,20 @@ typedef const char* (*GETAPIVERSIONFUNCTION)();
 typedef StackComponent* (*CREATEFUNCTION)(std::string);
 //! Function pointer for "ReleaseComponent" in component library
 typedef void (*DESTROYFUNCTION)(StackComponent*);
+//! Function pointer for "GetComponentBundle" in component bundle
+typedef const ComponentBundleEntry<StackComponent>* (*GETBUNDLEFUNCTION)();
 
 //! A component library
 struct ComponentLibrary
 {
   boost::filesystem::path path;
   std::string name;
-  boost::shared_ptr< SharedLibrary > libPtr;
+  boost::shared_ptr< CachedLibrary > libPtr;
+  bool bundled;   //!< Is this a component bundle?
 
   //! Constructor initializes our variables
   ComponentLibrary()
-    :name(""){}
-};
-
-//! A repository containing a number of component libraries
-struct Repository
-{
-  boost::filesystem::path path;
-  std::vector< ComponentLibrary > componentLibs;
+    :name(""), bundled(false){}
 };
 
 /** The StackComponentManager class implements a component manager for the StackEngine.
@@ -83,11 +83,16 @@ struct Repository
 class StackComponentManager
 {
 private:
-  //! Repositories of components which can be loaded by this manager
-  std::vector< Repository > repositories_;
+  typedef boost::unordered_map< std::string, ComponentLibrary > LibraryMap;
+
+  //! Indexed repositories of components which can be loaded by this manager
+  std::vector< boost::shared_ptr<RepositoryIndex> > repositories_;
+
+  //! Loaded component libraries, keyed by component type
+  LibraryMap loadedLibraries_;
 
-  //! Loaded component libraries
-  std::vector< ComponentLibrary > loadedLibraries_;
+  //! Guards loadedLibraries_ when components are loaded concurrently
+  boost::mutex librariesMutex_;
 
 public:
   //! ctor
@@ -100,6 +105,7 @@ public:
   void addRepository(std::string repoPath);
   
   /** Load a StackComponent
+  *   Can be called from several threads at once
   *   \param desc   Description of StackComponent to be loaded
   *   \returns A pointer to the loaded StackComponent
   */
@@ -31,7 +31,10 @@
  * Implementation of StackEngine class - network stack engine for Iris.
  */
 
+#include <map>
+
 #include "iris/StackEngine.h"
+#include "iris/TaskGroup.h"
 
 #include "irisapi/StackComponent.h"
 #include "StackInTranslator.h"
@@ -67,7 +70,7 @@ namespace iris
     }
 
     std::vector< boost::shared_ptr< DataBufferBase > >
-    StackEngine::loadEngine(EngineDescription eng,
+    StackEngine::loadEngine(const EngineDescription& eng,
                             std::vector< boost::shared_ptr< DataBufferBase > > inputLinks)
     {
         //Set the external input buffer
@@ -91,12 +94,27 @@ namespace iris
         inTranslators_.clear();   
         //Destory all OutTranslators
         outTranslators_.clear();
+        //Remove any outstanding timers - they refer to our components
+        timerWheel_.clear();
+        //Report on reconfiguration latency
+        for( vector< b::shared_ptr<StackComponent> >::iterator i = components_.begin(); i != components_.end(); ++i)
+        {
+            ReconfigLatency latency = (*i)->getReconfigLatency();
+            if(latency.count > 0)
+            {
+                LOG(LINFO) << "Reconfiguration latency of " << (*i)->getName() << ": " << latency.count
+                    << " sets, average " << latency.average() << ", maximum " << latency.maximum;
+            }
+        }
         //Destroy all components and clear the vector
         components_.clear();   //Components are deleted here using a custom deallocator due to use of boost::shared_ptr
     }
 
     void StackEngine::startEngine()
     {
+        //Start the timer service used by the components
+        timerWheel_.start();
+
         //Start all the InTranslators
         for( vector< b::shared_ptr<StackInTranslator> >::iterator i = inTranslators_.begin(); i != inTranslators_.end(); ++i)
         {
@@ -138,18 +156,84 @@ namespace iris
             (*i)->stop();    //Call stop() on the component implementation
             (*i)->stopComponent();    //Stop the component thread
         }
+
+        //Stop the timer service
+        timerWheel_.stop();
     }
 
-    void StackEngine::addReconfiguration(ReconfigSet reconfigs)
+    bool StackEngine::addReconfiguration(ReconfigSet& reconfigs)
     {
-        //Go through parametric reconfigurations and give them to the relevent components
+        bool accepted = true;
+        if(!reconfigs.structReconfigs.empty())
+        {
+            LOG(LERROR) << "Engine " << engineName_ << " does not support structural reconfiguration - "
+                << reconfigs.structReconfigs.size() << " reconfigurations ignored";
+            reconfigs.structReconfigs.clear();
+            accepted = false;
+        }
+
+        //Split the set by component, keeping its timing, so each component
+        //applies all of its changes together at one message boundary
+        map< string, ReconfigSet > componentSets;
         vector< ParametricReconfig >::iterator paramIt;
         for(paramIt = reconfigs.paramReconfigs.begin();
             paramIt != reconfigs.paramReconfigs.end();
             ++paramIt)
         {
-            reconfigureParameter(*paramIt);
+            ReconfigSet& compSet = componentSets[paramIt->componentName];
+            compSet.isTimed = reconfigs.isTimed;
+            compSet.timeStamp = reconfigs.timeStamp;
+            compSet.issueTime = reconfigs.issueTime;
+            compSet.paramReconfigs.push_back(*paramIt);
         }
+
+        map< string, ReconfigSet >::iterator setIt;
+        for(setIt = componentSets.begin(); setIt != componentSets.end(); ++setIt)
+        {
+            b::shared_ptr<StackComponent> comp = findComponent(setIt->first);
+            if(comp == NULL)
+            {
+                LOG(LERROR) << "Parametric reconfiguration failed: could not find component: " << setIt->first;
+                continue;
+            }
+            comp->addReconfiguration(setIt->second);
+        }
+        return accepted;
+    }
+
+    void StackEngine::addReconfiguration(const TypedParametricReconfig& reconfig)
+    {
+        int index = reconfig.handle.componentIndex;
+        if(index < 0 || index >= (int)components_.size())
+        {
+            LOG(LERROR) << "Parametric reconfiguration failed: invalid component index " << index;
+            return;
+        }
+        components_[index]->addReconfiguration(reconfig);
+    }
+
+    bool StackEngine::resolveParameter(string paramName, string componentName,
+                                   ParameterHandle& handle)
+    {
+        for(unsigned i = 0; i < components_.size(); ++i)
+        {
+            if(components_[i]->getName() == componentName)
+            {
+                try
+                {
+                    handle.parameterIndex = components_[i]->getParameterIndex(paramName);
+                    handle.typeIdentifier = components_[i]->getParameterTypeIdentifier(paramName);
+                    handle.componentIndex = i;
+                    handle.generation = components_[i]->getParameterGeneration();
+                    return true;
+                }
+                catch(ParameterNotFoundException&)
+                {
+                    return false;
+                }
+            }
+        }
+        return false;
     }
 
     void StackEngine::postCommand(Command command)
@@ -173,24 +257,37 @@ namespace iris
         }
     }
 
+    void StackEngine::getPublishedParameters(PublishedParameterMap& params)
+    {
+        vector< b::shared_ptr<StackComponent> >::iterator compIt;
+        for(compIt = components_.begin(); compIt != components_.end(); ++compIt)
+        {
+            for(size_t i = 0; i < (*compIt)->getNumParameters(); ++i)
+            {
+                const string& name = (*compIt)->getParameterName(i);
+                params[make_pair((*compIt)->getName(), name)] = (*compIt)->getPublishedParameter(name);
+            }
+        }
+    }
+
     void StackEngine::checkGraph(RadioGraph& graph)
     {
         //Check graph obeys StackEngine rules:
     }
 
-    void StackEngine::buildEngineGraph(EngineDescription& eng)
+    void StackEngine::buildEngineGraph(const EngineDescription& eng)
     {
-        //Create the components
-        for(vector<ComponentDescription>::iterator i = eng.components.begin(); 
-            i != eng.components.end(); i++)
+        //Create the components concurrently, keeping the order of the description
+        components_.assign(eng.components.size(), b::shared_ptr<StackComponent>());
+        TaskGroup loaders;
+        for(size_t i = 0; i < eng.components.size(); ++i)
         {
-            b::shared_ptr<StackComponent> comp = compManager_->loadComponent(*i);
-            comp->setEngine(this);    //Provide an interface to the component
-            components_.push_back(comp);
+            loaders.add(b::bind(&StackEngine::createComponent, this, b::cref(eng.components[i]), b::ref(components_[i])));
         }
+        loaders.run();
 
          //Create the links
-        for(vector<LinkDescription>::iterator i = eng.links.begin(); 
+        for(vector<LinkDescription>::const_iterator i = eng.links.begin(); 
             i != eng.links.end(); i++)
         {
             if(i->sinkEngine != i->sourceEngine)
@@ -220,25 +317,12 @@ namespace iris
         }
     }
 
-    void StackEngine::reconfigureParameter(ParametricReconfig reconfig)
+    void StackEngine::createComponent(const ComponentDescription& desc, b::shared_ptr<StackComponent>& comp)
     {
-        bool bFound = false;
-
-        //Find component
-        vector< b::shared_ptr<StackComponent> >::iterator compIt;
-        for(compIt = components_.begin(); compIt != components_.end(); ++compIt)
-        {
-            if((*compIt)->getName() == reconfig.componentName)
-            {
-                (*compIt)->addReconfiguration(reconfig);
-                bFound = true;
-            }
-        }
-
-        if(!bFound)
-        {
-            LOG(LERROR) << "Parametric reconfiguration failed: could not find component: " << reconfig.componentName;
-        }
+        comp = compManager_->loadComponent(desc);
+        comp->setEngine(this);    //Provide an interface to the component
+        Logger::getPolicy()->setParent(desc.name, engineName_);   //Use our log level unless it has its own
+        comp->setTimerWheel(&timerWheel_);    //Provide the timer service to the component
     }
 
     void StackEngine::activateEvent(Event &e)
@@ -253,7 +337,15 @@ namespace iris
         engineManager_->activateEvent(e);
     }
 
-    void StackEngine::createExternalLink(LinkDescription& l)
+    int StackEngine::resolveEvent(std::string eventName, std::string componentName)
+    {
+        if(engineManager_ == NULL)
+            return -1;
+
+        return engineManager_->resolveEvent(eventName, componentName);
+    }
+
+    void StackEngine::createExternalLink(const LinkDescription& l)
     {
         if(l.sinkEngine == getName())
         {
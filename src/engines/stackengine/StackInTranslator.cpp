@@ -83,8 +83,8 @@ void StackInTranslator::threadLoop()
 
             //Create a StackDataSet and fill it with the info from the DataSet
             boost::shared_ptr<StackDataSet> set(new StackDataSet);
-            set->data.resize(inData->data.size());
-            std::copy(inData->data.begin(), inData->data.end(), set->data.begin());
+            set->data.resize(inData->size());
+            inData->copyTo(set->data.begin());
             set->timeStamp = inData->timeStamp;
 
             //Send up to the StackComponent
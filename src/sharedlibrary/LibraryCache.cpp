@@ -0,0 +1,146 @@
+/**
+ * \file LibraryCache.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Implementation of the LibraryCache class.
+ */
+
+#include <map>
+
+#include "iris/LibraryCache.h"
+#include "irisapi/Logging.h"
+
+using namespace std;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+
+namespace iris
+{
+
+// Internal namespace for the cached libraries
+namespace internal{
+/// A cached library - opened under its own lock so different libraries load concurrently
+struct CacheSlot
+{
+    b::mutex mutex;
+    b::shared_ptr<CachedLibrary> library;
+};
+
+/// All cached libraries, by absolute path and LoadFlags
+typedef map< pair<string, int>, b::shared_ptr<CacheSlot> > SlotMap;
+
+SlotMap& slots()
+{
+    static SlotMap theSlots;
+    return theSlots;
+}
+
+b::mutex& slotsMutex()
+{
+    static b::mutex theMutex;
+    return theMutex;
+}
+} /* namespace internal */
+
+CachedLibrary::CachedLibrary(const bfs::path& filename, int flags, time_t writeTime)
+    :library_(filename, flags), flags_(flags), writeTime_(writeTime)
+{}
+
+SharedLibrary::SymbolPointer CachedLibrary::getSymbol(const string& symbolName)
+{
+    b::mutex::scoped_lock lock(mutex_);
+    SymbolMap::iterator it = symbols_.find(symbolName);
+    if(it != symbols_.end())
+        return it->second;
+
+    SharedLibrary::SymbolPointer symbol = library_.getSymbol(symbolName);
+    symbols_[symbolName] = symbol;
+    return symbol;
+}
+
+b::shared_ptr<CachedLibrary> LibraryCache::get(const bfs::path& filename, int flags)
+{
+    b::shared_ptr<internal::CacheSlot> slot;
+    {
+        b::mutex::scoped_lock lock(internal::slotsMutex());
+        b::shared_ptr<internal::CacheSlot>& entry = internal::slots()[make_pair(bfs::absolute(filename).string(), flags)];
+        if(!entry)
+            entry.reset(new internal::CacheSlot);
+        slot = entry;
+    }
+
+    b::mutex::scoped_lock lock(slot->mutex);
+    b::system::error_code ec;
+    time_t writeTime = bfs::last_write_time(filename, ec);
+    if(ec)
+        writeTime = 0;
+    if(slot->library && slot->library->writeTime_ == writeTime)
+        return slot->library;
+
+    //Anyone still using the old library keeps it open
+    if(slot->library)
+    {
+        LOG(LINFO) << "Library " << filename.string() << " has changed - opening it again.";
+    }
+    slot->library.reset(new CachedLibrary(filename, flags, writeTime));
+    return slot->library;
+}
+
+void LibraryCache::releaseUnused()
+{
+    b::mutex::scoped_lock lock(internal::slotsMutex());
+    internal::SlotMap& slots = internal::slots();
+    internal::SlotMap::iterator it = slots.begin();
+    while(it != slots.end())
+    {
+        b::mutex::scoped_lock slotLock(it->second->mutex);
+        bool unused = !it->second->library || it->second->library.unique();
+        slotLock.unlock();
+        if(unused)
+            slots.erase(it++);
+        else
+            ++it;
+    }
+}
+
+size_t LibraryCache::size()
+{
+    b::mutex::scoped_lock lock(internal::slotsMutex());
+    size_t count = 0;
+    internal::SlotMap::iterator it;
+    for(it = internal::slots().begin(); it != internal::slots().end(); ++it)
+    {
+        b::mutex::scoped_lock slotLock(it->second->mutex);
+        if(it->second->library)
+            ++count;
+    }
+    return count;
+}
+
+} /* namespace iris */
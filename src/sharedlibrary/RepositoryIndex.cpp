@@ -0,0 +1,311 @@
+/**
+ * \file RepositoryIndex.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ * 
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Implementation of RepositoryIndex class - maps module types to the
+ * libraries in a repository directory.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <boost/algorithm/string.hpp>
+
+#include "iris/RepositoryIndex.h"
+#include "iris/SharedLibrary.h"
+#include "irisapi/Logging.h"
+
+using namespace std;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+
+namespace iris
+{
+
+// Internal namespace for the shared indices
+namespace internal{
+/// All indices created so far, by directory and LoadFlags
+typedef map< pair<string, int>, b::shared_ptr<RepositoryIndex> > IndexMap;
+
+IndexMap& indices()
+{
+    static IndexMap theIndices;
+    return theIndices;
+}
+
+b::mutex& indicesMutex()
+{
+    static b::mutex theMutex;
+    return theMutex;
+}
+} /* namespace internal */
+
+b::shared_ptr<RepositoryIndex> RepositoryIndex::get(string path, int loadFlags)
+{
+    bfs::path currentPath(path);
+
+    //Check that the path exists and is a directory
+    b::system::error_code ec;
+    if(!bfs::is_directory(currentPath, ec))
+    {
+        LOG(LFATAL) << "Could not add repository " << path << " path does not exist or is not a directory.";
+        throw ResourceNotFoundException("Could not add repository " + path + " path does not exist or is not a directory.");
+    }
+
+    b::shared_ptr<RepositoryIndex> index;
+    {
+        b::mutex::scoped_lock lock(internal::indicesMutex());
+        b::shared_ptr<RepositoryIndex>& entry =
+            internal::indices()[make_pair(bfs::absolute(currentPath).string(), loadFlags)];
+        if(!entry)
+            entry.reset(new RepositoryIndex(currentPath, loadFlags));
+        index = entry;
+    }
+    index->refresh();
+    return index;
+}
+
+vector< b::shared_ptr<RepositoryIndex> > RepositoryIndex::getAll(string repoPaths)
+{
+    vector< b::shared_ptr<RepositoryIndex> > result;
+    vector<string> paths;
+    b::split(paths, repoPaths, b::is_any_of(";"));
+    for(vector<string>::iterator i = paths.begin(); i != paths.end(); ++i)
+    {
+        //Skip empty entries, e.g. with repos="/path/to/1;"
+        if(i->empty())
+            continue;
+
+        //Binding modes follow the path, e.g. "/path/to/1?lazy,local"
+        size_t pos = i->find_last_of('?');
+        if(pos == string::npos)
+            result.push_back(get(*i));
+        else
+            result.push_back(get(i->substr(0, pos), parseLoadFlags(i->substr(pos+1))));
+    }
+    return result;
+}
+
+bool RepositoryIndex::findLibrary(const vector< b::shared_ptr<RepositoryIndex> >& repositories,
+                                  const string& type, LibraryLocation& library)
+{
+    bool found = false;
+    vector< b::shared_ptr<RepositoryIndex> >::const_iterator i;
+    for(i = repositories.begin(); i != repositories.end(); ++i)
+    {
+        LibraryLocation current;
+        if(!(*i)->find(type, current))
+            continue;
+        if(!found)
+        {   //First library found which matches
+            library = current;
+            found = true;
+        }
+        else if(bfs::last_write_time(current.path) > bfs::last_write_time(library.path))
+        {   //Found more than one library which matches - choose the more recent one
+            library = current;
+        }
+    }
+    return found;
+}
+
+int RepositoryIndex::parseLoadFlags(string modes)
+{
+    int flags = SharedLibrary::LOAD_DEFAULT;
+    vector<string> names;
+    b::to_lower(modes);
+    b::split(names, modes, b::is_any_of(","));
+    for(vector<string>::iterator i = names.begin(); i != names.end(); ++i)
+    {
+        b::trim(*i);
+        if(*i == "now")
+            flags &= ~SharedLibrary::LOAD_LAZY;
+        else if(*i == "lazy")
+            flags |= SharedLibrary::LOAD_LAZY;
+        else if(*i == "global")
+            flags &= ~SharedLibrary::LOAD_LOCAL;
+        else if(*i == "local")
+            flags |= SharedLibrary::LOAD_LOCAL;
+        else if(*i == "deepbind")
+            flags |= SharedLibrary::LOAD_DEEPBIND;
+        else if(!i->empty())
+            throw InvalidDataException("Unknown library binding mode " + *i);
+    }
+    return flags;
+}
+
+RepositoryIndex::RepositoryIndex(const bfs::path& path, int loadFlags)
+    :path_(path), dirWrite_(0), scanTime_(0), loadFlags_(loadFlags)
+{}
+
+bool RepositoryIndex::contains(const string& type) const
+{
+    b::mutex::scoped_lock lock(mutex_);
+    return libraries_.find(type) != libraries_.end();
+}
+
+bool RepositoryIndex::find(const string& type, LibraryLocation& library) const
+{
+    b::mutex::scoped_lock lock(mutex_);
+    LibraryMap::const_iterator it = libraries_.find(type);
+    if(it == libraries_.end())
+        return false;
+    library.path = it->second.path;
+    library.bundled = it->second.bundled;
+    library.loadFlags = loadFlags_;
+    return true;
+}
+
+size_t RepositoryIndex::size() const
+{
+    b::mutex::scoped_lock lock(mutex_);
+    return libraries_.size();
+}
+
+vector<string> RepositoryIndex::getTypes() const
+{
+    b::mutex::scoped_lock lock(mutex_);
+    vector<string> types;
+    for(LibraryMap::const_iterator it = libraries_.begin(); it != libraries_.end(); ++it)
+        types.push_back(it->first);
+    lock.unlock();
+    sort(types.begin(), types.end());
+    return types;
+}
+
+time_t RepositoryIndex::getDirectoryTime() const
+{
+    b::mutex::scoped_lock lock(mutex_);
+    return dirWrite_;
+}
+
+void RepositoryIndex::refresh()
+{
+    b::mutex::scoped_lock lock(mutex_);
+
+    //Adding, removing or renaming a library changes the directory.
+    //Times have a resolution of a second, so a directory changed in the
+    //second it was scanned is scanned again.
+    b::system::error_code ec;
+    time_t current = bfs::last_write_time(path_, ec);
+    if(scanTime_ != 0 && !ec && current == dirWrite_ && dirWrite_ < scanTime_)
+        return;
+
+    //Only note the scan once it has succeeded, so a failed one is retried
+    time_t scanStart = time(NULL);
+    scan();
+    dirWrite_ = current;
+    scanTime_ = scanStart;
+}
+
+void RepositoryIndex::scan()
+{
+    //Build a new map, so the old one is kept if reading the directory fails
+    LibraryMap libraries;
+    vector<bfs::path> manifests;
+
+    //Go through files in the repository and add any libraries
+    bfs::directory_iterator dir_iter(path_), dir_end;
+    for(;dir_iter != dir_end; ++dir_iter)
+    {
+        //Check that the file path contains the system library extension
+        string filename = dir_iter->path().filename().string();
+        size_t pos = filename.find_last_of('.');
+        if(pos == string::npos)
+            continue;
+        if(filename.substr(pos) == ".bundle")
+        {
+            manifests.push_back(dir_iter->path());
+            continue;
+        }
+        if(filename.substr(pos) != SharedLibrary::getSystemExtension())
+            continue;
+
+        size_t pre = SharedLibrary::getSystemPrefix().length();
+        string name = filename.substr(pre,pos-pre); //Remove library prefix and postfix
+        b::to_lower(name);
+        addLibrary(libraries, name, dir_iter->path(), false);
+    }
+
+    //Bundles are read last so they replace the entries for their libraries
+    for(vector<bfs::path>::iterator i = manifests.begin(); i != manifests.end(); ++i)
+        readBundle(libraries, *i);
+
+    libraries_.swap(libraries);
+    LOG(LDEBUG) << "Indexed " << libraries_.size() << " libraries in " << path_.string();
+}
+
+void RepositoryIndex::addLibrary(LibraryMap& libraries, const string& type, const bfs::path& path, bool bundled)
+{
+    Library library;
+    library.path = path;
+    library.bundled = bundled;
+    pair<LibraryMap::iterator, bool> entry = libraries.insert(make_pair(type, library));
+    if(!entry.second && bfs::last_write_time(path) > bfs::last_write_time(entry.first->second.path))
+    {   //Found more than one library which matches - choose the more recent one
+        entry.first->second = library;
+    }
+}
+
+void RepositoryIndex::readBundle(LibraryMap& libraries, const bfs::path& manifest)
+{
+    bfs::path library = manifest;
+    library.replace_extension(SharedLibrary::getSystemExtension());
+    if(!bfs::exists(library))
+    {
+        LOG(LWARNING) << "Ignoring bundle manifest " << manifest.string() << " - " << library.string() << " does not exist.";
+        return;
+    }
+
+    //The bundle library is not a type itself
+    LibraryMap::iterator it = libraries.begin();
+    while(it != libraries.end())
+    {
+        if(it->second.path == library && !it->second.bundled)
+            it = libraries.erase(it);
+        else
+            ++it;
+    }
+
+    //One type per line, "#" starts a comment
+    std::ifstream in(manifest.string().c_str());
+    string line;
+    while(getline(in, line))
+    {
+        size_t pos = line.find('#');
+        if(pos != string::npos)
+            line.erase(pos);
+        b::trim(line);
+        b::to_lower(line);
+        if(!line.empty())
+            addLibrary(libraries, line, library, true);
+    }
+}
+
+} /* namespace iris */
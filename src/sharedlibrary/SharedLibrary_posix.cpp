@@ -41,14 +41,14 @@
 namespace iris
 {
 
-SharedLibrary::SharedLibrary(boost::filesystem::path filename)
+SharedLibrary::SharedLibrary(boost::filesystem::path filename, int flags)
   : filename_(filename), library_(NULL)
 {
-    this->open(filename);
+    this->open(filename, flags);
 }
 
 void
-SharedLibrary::open(boost::filesystem::path filename)
+SharedLibrary::open(boost::filesystem::path filename, int flags)
 {
     if (library_ != NULL)
     {
@@ -82,7 +82,14 @@ SharedLibrary::open(boost::filesystem::path filename)
 
     const char* system_filename = fString.c_str();
 
-    library_ = dlopen(system_filename, RTLD_NOW | RTLD_GLOBAL);
+    int mode = (flags & LOAD_LAZY) ? RTLD_LAZY : RTLD_NOW;
+    mode |= (flags & LOAD_LOCAL) ? RTLD_LOCAL : RTLD_GLOBAL;
+#ifdef RTLD_DEEPBIND
+    if (flags & LOAD_DEEPBIND)
+        mode |= RTLD_DEEPBIND;
+#endif
+
+    library_ = dlopen(system_filename, mode);
 
     if (library_ == NULL)
     {
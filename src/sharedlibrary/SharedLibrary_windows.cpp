@@ -48,14 +48,15 @@
 namespace iris
 {
 
-SharedLibrary::SharedLibrary(boost::filesystem::path filename)
+SharedLibrary::SharedLibrary(boost::filesystem::path filename, int flags)
   : filename_(filename), library_(NULL)
 {
-    this->open(filename);
+    this->open(filename, flags);
 }
 
+// LoadLibrary always binds eagerly and keeps symbols local - flags are ignored
 void
-SharedLibrary::open(boost::filesystem::path filename)
+SharedLibrary::open(boost::filesystem::path filename, int /*flags*/)
 {
     if (library_ != NULL)
     {
@@ -168,4 +168,107 @@ BOOST_AUTO_TEST_CASE(CommandPrison_MultiRelease_Test)
     BOOST_CHECK(prison->size() == 0);
 }
 
+//! Wait for any of the given commands
+static void trapMulti(std::vector<std::string> commands, boost::shared_ptr<CommandPrison> prison, std::string* result)
+{
+    Command c = prison->trap(commands);
+    *result = c.commandName;
+}
+
+//! Wait for any of the given commands with a long timeout
+static void trapTimed(std::vector<std::string> commands, boost::shared_ptr<CommandPrison> prison, Command* result)
+{
+    BOOST_CHECK(prison->trapFor(commands, boost::posix_time::seconds(10), *result));
+}
+
+BOOST_AUTO_TEST_CASE(CommandPrison_Timeout_Test)
+{
+    boost::shared_ptr<CommandPrison> prison(new CommandPrison);
+    Command c;
+
+    //No command is issued so we time out
+    BOOST_CHECK(!prison->trapFor("go1", boost::posix_time::milliseconds(50), c));
+    BOOST_CHECK(prison->size() == 0);
+
+    //A command released after the timeout must not be picked up later
+    Command r;
+    r.commandName = "go1";
+    prison->release(r);
+
+    //A command issued within the timeout releases the thread
+    boost::thread t0( boost::bind( &trap, "go2", prison ,0) );
+    std::vector<std::string> names;
+    names.push_back("go3");
+    boost::thread t1( boost::bind( &trapTimed, names, prison, &c ) );
+    boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+    BOOST_CHECK(prison->size() == 2);
+
+    r.commandName = "go3";
+    r.componentName = "test";
+    prison->release(r);
+    t1.join();
+    BOOST_CHECK(c.commandName == "go3");
+    BOOST_CHECK(c.componentName == "test");
+    BOOST_CHECK(prison->size() == 1);
+
+    r.commandName = "go2";
+    prison->release(r);
+    t0.join();
+    BOOST_CHECK(prison->size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(CommandPrison_MultiCommand_Test)
+{
+    boost::shared_ptr<CommandPrison> prison(new CommandPrison);
+
+    std::vector<std::string> names;
+    names.push_back("go1");
+    names.push_back("go2");
+    names.push_back("go3");
+    std::string result0, result1;
+    boost::thread t0( boost::bind( &trapMulti, names, prison, &result0 ) );
+    boost::thread t1( boost::bind( &trapMulti, names, prison, &result1 ) );
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+    BOOST_CHECK(prison->size() == 2);
+
+    //Any of the commands releases both threads
+    Command c;
+    c.commandName = "go2";
+    prison->release(c);
+    t0.join();
+    t1.join();
+    BOOST_CHECK(result0 == "go2");
+    BOOST_CHECK(result1 == "go2");
+    BOOST_CHECK(prison->size() == 0);
+
+    //Issuing the other commands now has no effect
+    c.commandName = "go1";
+    prison->release(c);
+    c.commandName = "go3";
+    prison->release(c);
+    BOOST_CHECK(prison->size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(CommandPrison_Interrupt_Test)
+{
+    boost::shared_ptr<CommandPrison> prison(new CommandPrison);
+
+    boost::thread t0( boost::bind( &trap, "go1", prison ,0) );
+    boost::thread t1( boost::bind( &trap, "go1", prison ,1) );
+    boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+    BOOST_CHECK(prison->size() == 2);
+
+    //An interrupted thread leaves the prison
+    t0.interrupt();
+    BOOST_CHECK(t0.timed_join(boost::posix_time::seconds(5)));
+    BOOST_CHECK(prison->size() == 1);
+
+    Command c;
+    c.commandName = "go1";
+    prison->release(c);
+    t1.join();
+    BOOST_CHECK(prison->size() == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
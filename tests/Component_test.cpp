@@ -36,6 +36,7 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <algorithm>
 #include <string>
@@ -199,5 +200,112 @@ BOOST_AUTO_TEST_CASE (ComponentParametersExceptions)
     delete comp;
 }
 
+static void publishRanges(TestComponent* comp, int n)
+{
+    for(int i=0; i<n; ++i)
+        comp->setValue("range", (i%2) ? 2.0f : 8.0f);
+}
+
+BOOST_AUTO_TEST_CASE (ComponentPublishedParameters)
+{
+    TestComponent comp;
+
+    //Defaults are published when parameters are registered
+    BOOST_CHECK_EQUAL(comp.getPublishedValue("debug"), "false");
+    BOOST_CHECK_EQUAL(comp.getPublishedValue("hello"), "hello world");
+    BOOST_CHECK_EQUAL(comp.getPublishedValue("range"), comp.getValue("range"));
+
+    //setValue() publishes immediately
+    comp.setValue("number", 7);
+    comp.setValue("hello", "goodbye");
+    comp.setValue("debug", "on");
+    int number = 0;
+    comp.getPublishedValue("number", &number);
+    BOOST_CHECK_EQUAL(number, 7);
+    string hello;
+    comp.getPublishedValue("hello", &hello);
+    BOOST_CHECK_EQUAL(hello, "goodbye");
+    BOOST_CHECK_EQUAL(comp.getPublishedValue("debug"), "true");
+
+    //Changes made by the component are seen after publishParameters()
+    comp.changeRange(4.5f);
+    float range = 0;
+    comp.getPublishedValue("range", &range);
+    BOOST_CHECK_EQUAL(range, 1.0f);
+    comp.publishParameters();
+    comp.getPublishedValue("range", &range);
+    BOOST_CHECK_EQUAL(range, 4.5f);
+
+    //Unchanged values are not published again
+    PublishedParameter published = comp.getPublishedParameter("Range");
+    unsigned version = published.value->version();
+    comp.publishParameters();
+    BOOST_CHECK_EQUAL(published.value->version(), version);
+    comp.changeRange(5.5f);
+    comp.publishParameters();
+    BOOST_CHECK_EQUAL(published.value->version(), version + 1);
+    BOOST_CHECK_EQUAL(published.toString(), comp.getValue("range"));
+    comp.changeRange(4.5f);
+    comp.publishParameters();
+
+    BOOST_CHECK_THROW(comp.getPublishedValue("dummy"), ParameterNotFoundException);
+    BOOST_CHECK_THROW(comp.getPublishedValue("range", &number), InvalidDataTypeException);
+
+    //Readers always see a complete value while another thread writes
+    boost::thread writer(boost::bind(&publishRanges, &comp, 100000));
+    for(int i=0; i<100000; ++i)
+    {
+        comp.getPublishedValue("range", &range);
+        BOOST_REQUIRE(range == 2.0f || range == 8.0f || range == 4.5f);
+    }
+    writer.join();
+}
+
+BOOST_AUTO_TEST_CASE (ComponentBinaryParameters)
+{
+    TestComponent comp;
+
+    //Indices follow the order of registration
+    BOOST_CHECK_EQUAL(comp.getParameterIndex("debug"), 0);
+    BOOST_CHECK_EQUAL(comp.getParameterIndex("Range"), 4);
+    BOOST_CHECK_EQUAL(comp.getParameterName(2), "hello");
+    BOOST_CHECK_EQUAL(comp.getParameterTypeIdentifier("range"), ParameterTypeInfo<float>::identifier);
+    BOOST_CHECK_THROW(comp.getParameterIndex("dummy"), ParameterNotFoundException);
+    BOOST_CHECK_THROW(comp.getParameterName(5), ParameterNotFoundException);
+
+    int range = comp.getParameterIndex("range");
+    comp.setValue(range, ParameterValue(7.5f), 0);
+    float f = 0;
+    comp.getValue("range", &f);
+    BOOST_CHECK_EQUAL(f, 7.5f);
+    comp.getPublishedValue("range", &f);
+    BOOST_CHECK_EQUAL(f, 7.5f);
+
+    comp.setValue(comp.getParameterIndex("debug"), ParameterValue(true), 0);
+    BOOST_CHECK_EQUAL(comp.getValue("debug"), "true");
+
+    //Allowed values are still checked
+    BOOST_CHECK_THROW(comp.setValue(range, ParameterValue(12.0f), 0), ParameterOutOfRangeException);
+    BOOST_CHECK_THROW(comp.setValue(comp.getParameterIndex("number"), ParameterValue(2), 0),
+                      ParameterOutOfRangeException);
+    comp.setValue(comp.getParameterIndex("number"), ParameterValue(9), 0);
+    BOOST_CHECK_EQUAL(comp.getValue("number"), "9");
+
+    //The value must have the type of the parameter
+    BOOST_CHECK_THROW(comp.setValue(range, ParameterValue(7.5), 0), InvalidDataTypeException);
+    BOOST_CHECK_THROW(comp.setValue(comp.getParameterIndex("hello"), ParameterValue(1), 0),
+                      InvalidDataTypeException);
+    BOOST_CHECK_THROW(comp.setValue(range, ParameterValue(), 0), InvalidDataTypeException);
+    comp.getValue("range", &f);
+    BOOST_CHECK_EQUAL(f, 7.5f);
+
+    //Indices taken before the component was replaced are rejected
+    comp.setParameterGeneration(1);
+    BOOST_CHECK_THROW(comp.setValue(range, ParameterValue(5.0f), 0), ParameterNotFoundException);
+    comp.setValue(range, ParameterValue(5.0f), comp.getParameterGeneration());
+    comp.getValue("range", &f);
+    BOOST_CHECK_EQUAL(f, 5.0f);
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,205 @@
+/**
+ * \file ControllerExecutor_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for running controllers on a shared ControllerExecutor.
+ */
+
+#define BOOST_TEST_MODULE ControllerExecutorTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <string>
+
+#include "iris/ControllerExecutor.h"
+
+using namespace std;
+using namespace iris;
+namespace b = boost;
+
+/// Runs controllers on an executor - the other callbacks do nothing
+class ExecutorOwner : public ControllerCallbackInterface
+{
+public:
+  ControllerExecutor executor;
+
+  explicit ExecutorOwner(unsigned threads) : executor(threads) {}
+  void reconfigureRadio(ReconfigSet reconfigs) {}
+  void postCommand(Command command) {}
+  string getParameterValue(string paramName, string componentName) { return ""; }
+  ParameterHandle resolveParameter(string paramName, string componentName) { return ParameterHandle(); }
+  void reconfigureParameter(const TypedParametricReconfig& reconfig) {}
+  void subscribeToEvent(string eventName, string componentName, Controller *cont, const EventPolicy& policy) {}
+  void scheduleController(Controller *cont) { executor.schedule(cont); }
+};
+
+/// A controller which checks that its events arrive in order
+class SequenceController : public Controller
+{
+public:
+  b::mutex mutex;
+  b::condition_variable received;
+  int last;
+  unsigned count;
+  bool inOrder;
+  bool concurrent;
+  bool running;
+  bool initialized;
+  bool destroyed;
+
+  SequenceController()
+    : Controller("sequencecontroller", "Checks event order", "Iris", "1.0")
+    ,last(-1), count(0), inOrder(true), concurrent(false), running(false)
+    ,initialized(false), destroyed(false)
+  {}
+
+  virtual void processEvent(Event &e)
+  {
+    {
+      b::mutex::scoped_lock lock(mutex);
+      concurrent = concurrent || running;
+      running = true;
+    }
+    int value = e.get<int>();
+    b::mutex::scoped_lock lock(mutex);
+    inOrder = inOrder && value == last + 1;
+    last = value;
+    ++count;
+    running = false;
+    received.notify_all();
+  }
+
+  bool waitFor(unsigned n)
+  {
+    b::mutex::scoped_lock lock(mutex);
+    b::system_time timeout = b::get_system_time() + b::posix_time::seconds(10);
+    while(count < n)
+    {
+      if(!received.timed_wait(lock, timeout))
+        return false;
+    }
+    return true;
+  }
+
+protected:
+  virtual void initialize() { initialized = true; }
+  virtual void destroy() { destroyed = true; }
+  virtual void subscribeToEvents() {}
+};
+
+BOOST_AUTO_TEST_SUITE (ControllerExecutorTest)
+
+BOOST_AUTO_TEST_CASE(ControllerExecutor_Ordering)
+{
+    const unsigned numControllers = 8;
+    const int numEvents = 2000;
+    ExecutorOwner owner(2);
+    EventSource source;
+    source.id = 0;
+    source.eventName = "sequence";
+    source.componentName = "test";
+
+    b::ptr_vector<SequenceController> controllers;
+    for(unsigned i = 0; i < numControllers; ++i)
+    {
+        controllers.push_back(new SequenceController);
+        controllers[i].setCallbackInterface(&owner);
+        controllers[i].load(false);
+        controllers[i].start();
+    }
+
+    //Fan each event out to all controllers, as the ControllerManager does
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    Event e;
+    for(int n = 0; n < numEvents; ++n)
+    {
+        e.setValues(&n, 1);
+        for(unsigned i = 0; i < numControllers; ++i)
+            controllers[i].postEvent(e, &source);
+    }
+    for(unsigned i = 0; i < numControllers; ++i)
+        BOOST_REQUIRE(controllers[i].waitFor(numEvents));
+    b::posix_time::time_duration taken = b::posix_time::microsec_clock::local_time() - start;
+    BOOST_TEST_MESSAGE("Passing " << numEvents << " events to " << numControllers
+        << " controllers on " << owner.executor.size() << " threads took " << taken);
+
+    for(unsigned i = 0; i < numControllers; ++i)
+    {
+        BOOST_CHECK(controllers[i].inOrder);
+        BOOST_CHECK(!controllers[i].concurrent);
+        BOOST_CHECK(controllers[i].initialized);
+
+        ControllerMetrics metrics = controllers[i].getMetrics();
+        BOOST_CHECK_EQUAL(metrics.eventsProcessed, (unsigned long)numEvents);
+        BOOST_CHECK_EQUAL(metrics.queueDepth, 0u);
+        BOOST_CHECK(metrics.maxQueueDepth >= 1);
+        BOOST_CHECK(metrics.maxHandlingTime >= metrics.meanHandlingTime);
+
+        controllers[i].stop();
+        controllers[i].unload();
+        BOOST_CHECK(controllers[i].destroyed);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ControllerExecutor_Stopped)
+{
+    ExecutorOwner owner(1);
+    EventSource source;
+    source.id = 0;
+
+    SequenceController cont;
+    cont.setCallbackInterface(&owner);
+    cont.load(false);
+
+    //Events wait while the controller is stopped
+    Event e;
+    for(int n = 0; n < 10; ++n)
+    {
+        e.setValues(&n, 1);
+        cont.postEvent(e, &source);
+    }
+    b::this_thread::sleep(b::posix_time::milliseconds(20));
+    BOOST_CHECK_EQUAL(cont.count, 0u);
+    BOOST_CHECK_EQUAL(cont.getMetrics().queueDepth, 10u);
+
+    cont.start();
+    BOOST_REQUIRE(cont.waitFor(10));
+    BOOST_CHECK(cont.inOrder);
+
+    cont.stop();
+    cont.unload();
+    BOOST_CHECK(cont.destroyed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
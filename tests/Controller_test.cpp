@@ -36,6 +36,9 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <string>
 
@@ -43,6 +46,101 @@
 
 using namespace std;
 using namespace iris;
+namespace b = boost;
+
+/// A controller which counts its timers and checks they don't overlap with events
+class TimerController : public Controller
+{
+public:
+  b::mutex mutex;
+  b::condition_variable fired;
+  b::thread::id controllerThread;
+  b::thread::id timerThread;
+  unsigned oneShots;
+  unsigned ticks;
+  unsigned events;
+  bool busy;
+  bool overlapped;
+
+  TimerController()
+    : Controller("timercontroller", "Uses timers", "Iris", "1.0")
+    ,oneShots(0), ticks(0), events(0), busy(false), overlapped(false)
+  {}
+
+  TimerId once(unsigned ms)
+  {
+    return scheduleTimer(b::posix_time::milliseconds(ms), b::bind(&TimerController::oneShot, this));
+  }
+
+  TimerId every(unsigned ms)
+  {
+    return schedulePeriodicTimer(b::posix_time::milliseconds(ms), b::bind(&TimerController::tick, this));
+  }
+
+  bool cancel(TimerId id)
+  {
+    return cancelTimer(id);
+  }
+
+  virtual void processEvent(Event &e)
+  {
+    enter();
+    b::this_thread::sleep(b::posix_time::microseconds(100));
+    leave(events);
+  }
+
+  bool waitForTicks(unsigned n)
+  {
+    b::mutex::scoped_lock lock(mutex);
+    b::system_time timeout = b::get_system_time() + b::posix_time::seconds(10);
+    while(ticks < n)
+    {
+      if(!fired.timed_wait(lock, timeout))
+        return false;
+    }
+    return true;
+  }
+
+  unsigned getTicks()
+  {
+    b::mutex::scoped_lock lock(mutex);
+    return ticks;
+  }
+
+protected:
+  virtual void initialize() { controllerThread = b::this_thread::get_id(); }
+  virtual void destroy() {}
+  virtual void subscribeToEvents() {}
+
+private:
+  void oneShot()
+  {
+    enter();
+    timerThread = b::this_thread::get_id();
+    leave(oneShots);
+  }
+
+  void tick()
+  {
+    enter();
+    leave(ticks);
+  }
+
+  void enter()
+  {
+    b::mutex::scoped_lock lock(mutex);
+    overlapped = overlapped || busy;
+    busy = true;
+  }
+
+  void leave(unsigned& counter)
+  {
+    b::mutex::scoped_lock lock(mutex);
+    busy = false;
+    ++counter;
+    fired.notify_all();
+  }
+};
 
 BOOST_AUTO_TEST_SUITE (ControllerTests)
 
@@ -50,4 +148,66 @@ BOOST_AUTO_TEST_CASE(ControllerBasic)
 {
 }
 
+BOOST_AUTO_TEST_CASE(ControllerTimers)
+{
+    TimerWheel wheel;
+    wheel.start();
+    TimerController cont;
+    cont.setTimerWheel(&wheel);
+    cont.load();
+    cont.start();
+
+    //Timer callbacks run on the controller thread
+    BOOST_CHECK(cont.once(5) != 0);
+    TimerId cancelled = cont.once(50);
+    BOOST_CHECK(cont.cancel(cancelled));
+    TimerId periodic = cont.every(10);
+    BOOST_REQUIRE(cont.waitForTicks(5));
+    BOOST_CHECK_EQUAL(cont.oneShots, 1u);
+    BOOST_CHECK(cont.timerThread == cont.controllerThread);
+
+    //Nothing runs after a periodic timer is cancelled
+    BOOST_CHECK(cont.cancel(periodic));
+    unsigned ticks = cont.getTicks();
+    b::this_thread::sleep(b::posix_time::milliseconds(100));
+    BOOST_CHECK_EQUAL(cont.getTicks(), ticks);
+    BOOST_CHECK_EQUAL(cont.oneShots, 1u);
+    BOOST_CHECK(!cont.cancel(periodic));
+
+    cont.stop();
+    cont.unload();
+    wheel.stop();
+}
+
+BOOST_AUTO_TEST_CASE(ControllerTimersWithEvents)
+{
+    TimerWheel wheel;
+    wheel.start();
+    TimerController cont;
+    cont.setTimerWheel(&wheel);
+    cont.load();
+    cont.start();
+
+    EventSource source;
+    source.id = 0;
+    Event e;
+    int value = 1;
+    e.setValues(&value, 1);
+
+    //Timers are queued with events, so callbacks never overlap processEvent()
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    TimerId periodic = cont.every(1);
+    for(int i = 0; i < 500; ++i)
+        cont.postEvent(e, &source);
+    BOOST_REQUIRE(cont.waitForTicks(20));
+    cont.cancel(periodic);
+    b::posix_time::time_duration taken = b::posix_time::microsec_clock::local_time() - start;
+    BOOST_TEST_MESSAGE(cont.getTicks() << " ticks of a 1ms timer in " << taken);
+    BOOST_CHECK(!cont.overlapped);
+
+    cont.stop();
+    cont.unload();
+    wheel.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
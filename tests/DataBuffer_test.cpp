@@ -169,4 +169,128 @@ BOOST_AUTO_TEST_CASE(DataBufferDataCheck)
     }
 }
 
+BOOST_AUTO_TEST_CASE(DataBufferNextTimeStamp)
+{
+    DataBuffer<int32_t> myBuffer(4);
+    double t = -1;
+    BOOST_CHECK(!myBuffer.getNextTimeStamp(t, false));
+
+    DataSet<int32_t>* setPtr = NULL;
+    for(int i=1; i<=2; i++)
+    {
+        myBuffer.getWriteData(setPtr, 1);
+        setPtr->timeStamp = i * 0.5;
+        myBuffer.releaseWriteData(setPtr);
+    }
+
+    //Peeking does not consume the DataSet
+    BOOST_CHECK(myBuffer.getNextTimeStamp(t, true));
+    BOOST_CHECK_EQUAL(t, 0.5);
+    BOOST_CHECK(myBuffer.getNextTimeStamp(t, false));
+    BOOST_CHECK_EQUAL(t, 0.5);
+
+    myBuffer.getReadData(setPtr);
+    myBuffer.releaseReadData(setPtr);
+    BOOST_CHECK(myBuffer.getNextTimeStamp(t, false));
+    BOOST_CHECK_EQUAL(t, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(DataBufferViews)
+{
+    DataBuffer<int> in(2), outA(2), outB(2), gathered(2);
+
+    //Write some data
+    DataSet<int>* set = NULL;
+    in.getWriteData(set, 10);
+    for(int i = 0; i < 10; ++i)
+        set->data[i] = i;
+    in.releaseWriteData(set);
+
+    //Split it into two views without copying
+    DataSet<int>* input = NULL;
+    in.getReadData(input);
+    const int* storage = &input->data[0];
+    DataSet<int>* a = NULL;
+    DataSet<int>* b = NULL;
+    outA.getWriteData(a, 0);
+    outB.getWriteData(b, 0);
+    a->appendView(*input, 0, 4);
+    b->appendView(*input, 4, 6);
+    BOOST_CHECK_THROW(b->appendView(*input, 8, 4), InvalidDataException);
+    outA.releaseWriteData(a);
+    outB.releaseWriteData(b);
+    in.releaseReadData(input);
+
+    //Gather the two views back together in reverse order
+    outA.getReadData(a);
+    outB.getReadData(b);
+    BOOST_CHECK(a->isView());
+    BOOST_CHECK_EQUAL(a->size(), 4u);
+    BOOST_CHECK_EQUAL(b->size(), 6u);
+    BOOST_CHECK_EQUAL(a->segments[0].begin(), storage);
+    DataSet<int>* g = NULL;
+    gathered.getWriteData(g, 0);
+    g->appendView(*b, 0, b->size());
+    g->appendView(*a, 0, a->size());
+    gathered.releaseWriteData(g);
+    outA.releaseReadData(a);
+    outB.releaseReadData(b);
+
+    //The shared data outlives the original DataSet
+    in.getWriteData(set, 3);
+    in.releaseWriteData(set);
+
+    gathered.getReadData(g);
+    BOOST_CHECK_EQUAL(g->size(), 10u);
+    BOOST_CHECK_EQUAL(g->at(0), 4);
+    BOOST_CHECK_EQUAL(g->at(6), 0);
+    vector<int> copy(g->size());
+    g->copyTo(copy.begin());
+    BOOST_CHECK_EQUAL(copy[5], 9);
+    BOOST_CHECK_EQUAL(copy[9], 3);
+    g->flatten();
+    BOOST_CHECK(!g->isView());
+    BOOST_CHECK(g->data == copy);
+    gathered.releaseReadData(g);
+
+    //Reused DataSets are no longer views
+    gathered.getWriteData(g, 2);
+    BOOST_CHECK(!g->isView());
+    BOOST_CHECK_EQUAL(g->size(), 2u);
+
+    //Appending a view discards the data written so far
+    DataSet<int> source(5);
+    g->appendView(source, 0, 3);
+    BOOST_CHECK_EQUAL(g->size(), 3u);
+    BOOST_CHECK(g->data.empty());
+    gathered.releaseWriteData(g);
+}
+
+BOOST_AUTO_TEST_CASE(DataSetShareReusesStorage)
+{
+    DataSet<int> set(10);
+    const int* first = &set.data[0];
+    set.share();
+    BOOST_CHECK(set.data.empty());
+
+    //Once no view refers to the storage, sharing swaps it back into data
+    set.segments.clear();
+    set.data.resize(10);
+    set.share();
+    BOOST_CHECK_EQUAL(set.data.capacity(), 10u);
+    set.segments.clear();
+    set.data.resize(10);
+    BOOST_CHECK_EQUAL(&set.data[0], first);
+
+    //Storage which is still referred to is left alone
+    DataSet<int> view(0);
+    view.appendView(set, 0, 10);
+    const int* shared = set.segments[0].begin();
+    set.segments.clear();
+    set.data.resize(10);
+    set.share();
+    BOOST_CHECK_EQUAL(view.segments[0].begin(), shared);
+    BOOST_CHECK(set.segments[0].begin() != shared);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,386 @@
+/**
+ * \file Event_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for passing events from components to controllers.
+ */
+
+#define BOOST_TEST_MODULE EventTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <string>
+#include <vector>
+
+#include "irisapi/ComponentBase.h"
+#include "irisapi/Controller.h"
+#include "iris/ControllerManager.h"
+
+using namespace std;
+using namespace iris;
+namespace b = boost;
+
+/// A component which activates events
+class EventComponent : public ComponentBase
+{
+public:
+  int snrEvent;
+  int samplesEvent;
+
+  EventComponent()
+    : ComponentBase("eventcomponent", "eventcomponent", "Activates events", "Iris", "1.0")
+  {
+    snrEvent = registerEvent("snr", "Signal to noise ratio", TypeInfo<float>::identifier);
+    samplesEvent = registerEvent("samples", "Some samples", TypeInfo<double>::identifier);
+  }
+};
+
+/// Records the events activated by a component
+class RecordingEngine : public ComponentCallbackInterface
+{
+public:
+  vector<Event> events;
+  int resolved;
+
+  RecordingEngine() : resolved(0) {}
+  void activateEvent(Event &e) { events.push_back(e); }
+  int resolveEvent(string eventName, string componentName) { return resolved++; }
+};
+
+/// Passes the events activated by a component to a ControllerManager
+class ForwardingEngine : public ComponentCallbackInterface
+{
+public:
+  ControllerManager& manager;
+
+  explicit ForwardingEngine(ControllerManager& m) : manager(m) {}
+  void activateEvent(Event &e) { manager.activateEvent(e); }
+  int resolveEvent(string eventName, string componentName) { return manager.resolveEvent(eventName, componentName); }
+};
+
+/// A controller which counts the events it receives
+class EventController : public Controller
+{
+public:
+  b::mutex mutex;
+  b::condition_variable received;
+  vector<Event> events;
+  unsigned count;
+  unsigned batches;
+  bool subscribed;
+  EventPolicy snrPolicy;
+
+  EventController()
+    : Controller("eventcontroller", "Counts events", "Iris", "1.0"), count(0), batches(0), subscribed(false)
+  {}
+
+  virtual void processEvents(vector<Event> &batch)
+  {
+    {
+      b::mutex::scoped_lock lock(mutex);
+      ++batches;
+    }
+    Controller::processEvents(batch);
+  }
+
+  virtual void processEvent(Event &e)
+  {
+    b::mutex::scoped_lock lock(mutex);
+    if(events.size() < 10)
+      events.push_back(e);
+    ++count;
+    received.notify_all();
+  }
+
+  bool waitFor(unsigned n)
+  {
+    b::mutex::scoped_lock lock(mutex);
+    b::system_time timeout = b::get_system_time() + b::posix_time::seconds(10);
+    while(count < n)
+    {
+      if(!received.timed_wait(lock, timeout))
+        return false;
+    }
+    return true;
+  }
+
+  bool waitForSubscription()
+  {
+    b::mutex::scoped_lock lock(mutex);
+    b::system_time timeout = b::get_system_time() + b::posix_time::seconds(10);
+    while(!subscribed)
+    {
+      if(!received.timed_wait(lock, timeout))
+        return false;
+    }
+    return true;
+  }
+
+protected:
+  virtual void initialize() {}
+  virtual void destroy() {}
+  virtual void subscribeToEvents()
+  {
+    subscribeToEvent("snr", "eventcomponent", snrPolicy);
+    subscribeToEvent("samples", "eventcomponent");
+    b::mutex::scoped_lock lock(mutex);
+    subscribed = true;
+    received.notify_all();
+  }
+};
+
+BOOST_AUTO_TEST_SUITE (EventTest)
+
+BOOST_AUTO_TEST_CASE(Event_InlineValues)
+{
+    Event e;
+    float values[] = {1.5f, 2.5f, 3.5f};
+    BOOST_REQUIRE(e.setValues(values, 3));
+    BOOST_CHECK_EQUAL(e.typeId, (int)TypeInfo<float>::identifier);
+    BOOST_CHECK_EQUAL(e.size(), 3u);
+    BOOST_CHECK(e.data.empty());
+    BOOST_CHECK_EQUAL(e.get<float>(2), 3.5f);
+    BOOST_CHECK_THROW(e.get<double>(), InvalidDataTypeException);
+    BOOST_CHECK_THROW(e.get<float>(3), InvalidDataException);
+
+    //Controllers can read the values from data too
+    e.unpack();
+    BOOST_REQUIRE_EQUAL(e.data.size(), 3u);
+    BOOST_CHECK_EQUAL(b::any_cast<float>(e.data[1]), 2.5f);
+    BOOST_CHECK_EQUAL(e.get<float>(0), 1.5f);
+
+    double many[5] = {0};
+    BOOST_CHECK(!e.setValues(many, 5));
+}
+
+BOOST_AUTO_TEST_CASE(Event_ComponentActivation)
+{
+    EventComponent comp;
+    RecordingEngine engine;
+    comp.setEngine(&engine);
+
+    float snr = 12.5f;
+    comp.activateEvent("SNR", snr);
+    comp.activateEvent(comp.snrEvent, snr);
+    BOOST_CHECK_EQUAL(engine.resolved, 1);
+    BOOST_REQUIRE_EQUAL(engine.events.size(), 2u);
+    BOOST_CHECK_EQUAL(engine.events[1].eventId, 0);
+    BOOST_CHECK(engine.events[1].eventName.empty());
+    BOOST_CHECK(engine.events[1].data.empty());
+    BOOST_CHECK_EQUAL(engine.events[1].get<float>(), 12.5f);
+
+    //Vectors which don't fit are passed in data
+    vector<double> samples(10, 0.5);
+    comp.activateEvent(comp.samplesEvent, samples);
+    BOOST_REQUIRE_EQUAL(engine.events.size(), 3u);
+    BOOST_CHECK_EQUAL(engine.events[2].eventId, 1);
+    BOOST_CHECK_EQUAL(engine.events[2].data.size(), 10u);
+    BOOST_CHECK_EQUAL(engine.events[2].get<double>(9), 0.5);
+
+    double wrongType = 1.0;
+    BOOST_CHECK_THROW(comp.activateEvent(comp.snrEvent, wrongType), InvalidDataTypeException);
+    BOOST_CHECK_THROW(comp.activateEvent("crc", snr), EventNotFoundException);
+}
+
+BOOST_AUTO_TEST_CASE(Event_ControllerDelivery)
+{
+    ControllerManager manager;
+    ForwardingEngine engine(manager);
+    EventComponent comp;
+    comp.setEngine(&engine);
+
+    EventController cont;
+    cont.setCallbackInterface(&manager);
+    cont.load();
+    cont.start();
+    BOOST_REQUIRE(cont.waitForSubscription());
+
+    float snr = 3.0f;
+    comp.activateEvent(comp.snrEvent, snr);
+    vector<double> samples(10, 0.25);
+    comp.activateEvent("samples", samples);
+    BOOST_REQUIRE(cont.waitFor(2));
+
+    //Names are filled in and inline values unpacked before processEvent()
+    BOOST_CHECK_EQUAL(cont.events[0].eventName, "snr");
+    BOOST_CHECK_EQUAL(cont.events[0].componentName, "eventcomponent");
+    BOOST_REQUIRE_EQUAL(cont.events[0].data.size(), 1u);
+    BOOST_CHECK_EQUAL(b::any_cast<float>(cont.events[0].data[0]), 3.0f);
+    BOOST_CHECK_EQUAL(cont.events[1].eventName, "samples");
+    BOOST_CHECK_EQUAL(cont.events[1].data.size(), 10u);
+
+    //Time a burst of events from the component
+    const unsigned iterations = 100000;
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+        comp.activateEvent(comp.snrEvent, snr);
+    b::posix_time::time_duration taken = b::posix_time::microsec_clock::local_time() - start;
+    BOOST_REQUIRE(cont.waitFor(iterations + 2));
+    BOOST_TEST_MESSAGE("Activating " << iterations << " events took " << taken);
+
+    cont.stop();
+    cont.unload();
+}
+
+BOOST_AUTO_TEST_CASE(Event_ChannelPolicies)
+{
+    EventSource source;
+    source.id = 0;
+    Event e;
+    vector<Event> taken;
+
+    //Only the latest event is kept while one is waiting
+    EventChannel latest(&source, EventPolicy::latest());
+    for(int i = 0; i < 5; ++i)
+    {
+        e.setValues(&i, 1);
+        BOOST_CHECK_EQUAL(latest.store(e), i == 0 ? EventChannel::QUEUE : EventChannel::HELD);
+    }
+    latest.take(taken);
+    BOOST_REQUIRE_EQUAL(taken.size(), 1u);
+    BOOST_CHECK_EQUAL(taken[0].get<int>(), 4);
+    BOOST_CHECK_EQUAL(latest.getDropped(), 4u);
+
+    //Batches are queued when full - further events are dropped until taken
+    EventChannel batch(&source, EventPolicy::batch(3));
+    EventChannel::StoreResult expected[4] = {EventChannel::ARM_FLUSH, EventChannel::HELD,
+        EventChannel::QUEUE, EventChannel::HELD};
+    for(int i = 0; i < 4; ++i)
+    {
+        e.setValues(&i, 1);
+        BOOST_CHECK_EQUAL(batch.store(e), expected[i]);
+    }
+    batch.take(taken);
+    BOOST_REQUIRE_EQUAL(taken.size(), 3u);
+    BOOST_CHECK_EQUAL(taken[2].get<int>(), 2);
+    BOOST_CHECK_EQUAL(batch.getDropped(), 1u);
+
+    //A partial batch is queued once its first event has waited maxDelay
+    Event samples;
+    samples.data.assign(10, b::any(0.5));
+    b::int64_t wait = 0;
+    EventChannel partial(&source, EventPolicy::batch(3, 0.02));
+    BOOST_CHECK_EQUAL(partial.store(e), EventChannel::ARM_FLUSH);
+    BOOST_CHECK_EQUAL(partial.store(samples), EventChannel::HELD);
+    BOOST_CHECK_EQUAL(partial.flush(wait), EventChannel::ARM_FLUSH);
+    BOOST_CHECK(wait > 0);
+    b::this_thread::sleep(b::posix_time::microseconds(wait / 1000 + 1));
+    BOOST_CHECK_EQUAL(partial.flush(wait), EventChannel::QUEUE);
+    BOOST_CHECK_EQUAL(partial.store(e), EventChannel::HELD);
+    partial.take(taken);
+    BOOST_REQUIRE_EQUAL(taken.size(), 3u);
+    BOOST_CHECK_EQUAL(taken[0].get<int>(), 3);
+    BOOST_CHECK_EQUAL(taken[1].data.size(), 10u);
+    BOOST_CHECK_EQUAL(partial.flush(wait), EventChannel::HELD);
+
+    //At most one event per second gets through a burst
+    EventChannel rate(&source, EventPolicy::rate(1));
+    unsigned admitted = 0;
+    for(int i = 0; i < 1000; ++i)
+        admitted += rate.admit();
+    BOOST_CHECK_EQUAL(admitted, 1u);
+    BOOST_CHECK_EQUAL(rate.getDropped(), 999u);
+
+    EventPolicy invalid = EventPolicy::latest();
+    invalid.batchSize = 4;
+    BOOST_CHECK_THROW(EventChannel(&source, invalid), InvalidDataException);
+    BOOST_CHECK_THROW(EventChannel(&source, EventPolicy::batch(0)), InvalidDataException);
+}
+
+BOOST_AUTO_TEST_CASE(Event_LatestDelivery)
+{
+    ControllerManager manager;
+    ForwardingEngine engine(manager);
+    EventComponent comp;
+    comp.setEngine(&engine);
+
+    //Subscribe, but don't process events until the burst is over
+    EventController cont;
+    cont.snrPolicy = EventPolicy::latest();
+    cont.setCallbackInterface(&manager);
+    cont.load();
+    BOOST_REQUIRE(cont.waitForSubscription());
+
+    for(int i = 0; i < 1000; ++i)
+    {
+        float snr = (float)i;
+        comp.activateEvent(comp.snrEvent, snr);
+    }
+    cont.start();
+    BOOST_REQUIRE(cont.waitFor(1));
+    b::this_thread::sleep(b::posix_time::milliseconds(50));
+    BOOST_CHECK_EQUAL(cont.count, 1u);
+    BOOST_CHECK_EQUAL(cont.events[0].eventName, "snr");
+    BOOST_CHECK_EQUAL(b::any_cast<float>(cont.events[0].data[0]), 999.0f);
+
+    cont.stop();
+    cont.unload();
+}
+
+BOOST_AUTO_TEST_CASE(Event_BatchedDelivery)
+{
+    ControllerManager manager;
+    ForwardingEngine engine(manager);
+    EventComponent comp;
+    comp.setEngine(&engine);
+
+    TimerWheel wheel;
+    wheel.start();
+    EventController cont;
+    cont.snrPolicy = EventPolicy::batch(4, 0.05);
+    cont.setCallbackInterface(&manager);
+    cont.setTimerWheel(&wheel);
+    cont.load();
+    cont.start();
+    BOOST_REQUIRE(cont.waitForSubscription());
+
+    for(int i = 0; i < 10; ++i)
+    {
+        float snr = (float)i;
+        comp.activateEvent(comp.snrEvent, snr);
+        if(i % 4 == 3)
+            BOOST_REQUIRE(cont.waitFor(i + 1));
+    }
+
+    //Two full batches are delivered - the last two events follow once they have waited
+    BOOST_REQUIRE(cont.waitFor(10));
+    BOOST_CHECK_EQUAL(cont.batches, 3u);
+    BOOST_CHECK_EQUAL(cont.events[7].componentName, "eventcomponent");
+    BOOST_CHECK_EQUAL(b::any_cast<float>(cont.events[7].data[0]), 7.0f);
+    BOOST_CHECK_EQUAL(b::any_cast<float>(cont.events[9].data[0]), 9.0f);
+
+    cont.stop();
+    cont.unload();
+    wheel.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
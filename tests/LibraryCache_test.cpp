@@ -0,0 +1,146 @@
+/**
+ * \file LibraryCache_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for LibraryCache class.
+ */
+
+#define BOOST_TEST_MODULE LibraryCacheTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "boost/filesystem.hpp"
+#include <string>
+
+#include "iris/LibraryCache.h"
+#include "irisapi/Exceptions.h"
+#include "config_tests.h"
+
+using namespace std;
+using namespace iris;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+
+typedef string (*TESTFUNCTION)();
+
+/// Find the test library built alongside the tests
+bfs::path findTestLibrary()
+{
+    string s = SharedLibrary::getSystemPrefix() + "testlibrary" + SharedLibrary::getSystemExtension();
+    bfs::path path = bfs::path(TESTLIB_DIR) / s;
+    if(!bfs::exists(path))
+        path = bfs::path(".") / s;
+    return path;
+}
+
+BOOST_AUTO_TEST_SUITE (LibraryCacheTest)
+
+BOOST_AUTO_TEST_CASE(LibraryCache_Reuse)
+{
+    bfs::path path = findTestLibrary();
+    BOOST_REQUIRE_MESSAGE(bfs::exists(path), "Could not find testlibrary.");
+
+    b::shared_ptr<CachedLibrary> first = LibraryCache::get(path);
+    TESTFUNCTION f = (TESTFUNCTION)first->getSymbol("GetName");
+    BOOST_CHECK(f() == "TestLibrary");
+    BOOST_CHECK_THROW(first->getSymbol("NoSuchSymbol"), LibrarySymbolException);
+
+    //Dropping every reference but the cache's must not close the library
+    first.reset();
+    b::shared_ptr<CachedLibrary> second = LibraryCache::get(path);
+    BOOST_CHECK(second->getSymbol("GetName") == (SharedLibrary::SymbolPointer)f);
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 1u);
+
+    //Libraries in use are kept when unused ones are released
+    LibraryCache::releaseUnused();
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 1u);
+    BOOST_CHECK(LibraryCache::get(path) == second);
+
+    second.reset();
+    LibraryCache::releaseUnused();
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(LibraryCache_Flags)
+{
+    bfs::path path = findTestLibrary();
+    BOOST_REQUIRE(bfs::exists(path));
+
+    //A library asked for with other flags is not the cached copy
+    b::shared_ptr<CachedLibrary> first = LibraryCache::get(path);
+    b::shared_ptr<CachedLibrary> lazy = LibraryCache::get(path, SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL);
+    BOOST_CHECK(first != lazy);
+    BOOST_CHECK_EQUAL(first->getFlags(), SharedLibrary::LOAD_DEFAULT);
+    BOOST_CHECK_EQUAL(lazy->getFlags(), SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL);
+    BOOST_CHECK(LibraryCache::get(path, SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL) == lazy);
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 2u);
+
+    first.reset();
+    lazy.reset();
+    LibraryCache::releaseUnused();
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(LibraryCache_Missing)
+{
+    BOOST_CHECK_THROW(LibraryCache::get("no/such/library.so"), FileNotFoundException);
+    LibraryCache::releaseUnused();
+    BOOST_CHECK_EQUAL(LibraryCache::size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(LibraryCache_ReloadTime)
+{
+    bfs::path path = findTestLibrary();
+    BOOST_REQUIRE(bfs::exists(path));
+
+    //Open and close the library, as every radio load did before
+    const int iterations = 1000;
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    for(int i = 0; i < iterations; ++i)
+    {
+        SharedLibrary lib(path);
+        lib.getSymbol("GetName");
+    }
+    b::posix_time::time_duration opened = b::posix_time::microsec_clock::local_time() - start;
+
+    b::shared_ptr<CachedLibrary> held = LibraryCache::get(path);
+    start = b::posix_time::microsec_clock::local_time();
+    for(int i = 0; i < iterations; ++i)
+    {
+        b::shared_ptr<CachedLibrary> lib = LibraryCache::get(path);
+        lib->getSymbol("GetName");
+    }
+    b::posix_time::time_duration cached = b::posix_time::microsec_clock::local_time() - start;
+
+    BOOST_TEST_MESSAGE("Opening testlibrary " << iterations << " times: dlopen " << opened
+                       << ", cache " << cached);
+    BOOST_CHECK(cached < opened);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -47,6 +47,8 @@
 
 #include "irisapi/Logging.h"
 
+namespace b = boost;
+
 
 BOOST_AUTO_TEST_SUITE (Logging)
 
@@ -241,4 +243,236 @@ BOOST_AUTO_TEST_CASE(MultipleThreads)
 
 
 
+/// Count the lines of a file which contain some text
+unsigned countLines(const char* fileName, const std::string& text)
+{
+    std::ifstream file(fileName);
+    std::string line;
+    unsigned n = 0;
+    while(std::getline(file, line))
+    {
+        if(line.find(text) != std::string::npos)
+            ++n;
+    }
+    return n;
+}
+
+BOOST_AUTO_TEST_CASE(Asynchronous)
+{
+    using namespace std;
+    using namespace iris;
+
+    FILE* pFile = fopen("iris2_async.log", "w");
+    BOOST_REQUIRE(pFile!=NULL);
+    LoggingPolicy* policy = LoggingPolicy::getPolicyInstance();
+    policy->setFileStream(pFile);
+    policy->ReportingLevel() = LWARNING;
+    policy->setAsynchronous(true);
+    BOOST_REQUIRE(policy->isAsynchronous());
+
+    //Messages are in order once flushed
+    for(int i = 0; i < 100; ++i)
+        LOG(LWARNING) << "async " << i;
+    policy->flush();
+    BOOST_CHECK_EQUAL(countLines("iris2_async.log", "async "), 100u);
+
+    //Fatal messages are written before LOG returns
+    LOG(LFATAL) << "async fatal";
+    BOOST_CHECK_EQUAL(countLines("iris2_async.log", "async fatal"), 1u);
+
+    //Time a burst of messages
+    const unsigned iterations = 2000;
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+        LOG(LWARNING) << "burst " << i;
+    b::posix_time::time_duration taken = b::posix_time::microsec_clock::local_time() - start;
+    policy->setAsynchronous(false);
+    BOOST_TEST_MESSAGE("Logging " << iterations << " messages asynchronously took " << taken);
+    BOOST_CHECK_EQUAL(countLines("iris2_async.log", "burst ") + policy->getDropped(), iterations);
+
+    policy->setFileStream(NULL);
+    fclose(pFile);
+}
+
+BOOST_AUTO_TEST_CASE(AsynchronousOverflow)
+{
+    using namespace std;
+    using namespace iris;
+
+    FILE* pFile = fopen("iris2_async.log", "w");
+    BOOST_REQUIRE(pFile!=NULL);
+    LoggingPolicy* policy = LoggingPolicy::getPolicyInstance();
+    policy->setFileStream(pFile);
+    policy->ReportingLevel() = LWARNING;
+
+    //With a tiny queue, messages are either written or counted as dropped
+    policy->setOverflowPolicy(LOG_BLOCK);
+    policy->setAsynchronous(true, 4);
+    for(int i = 0; i < 500; ++i)
+        LOG(LWARNING) << "blocking " << i;
+    policy->flush();
+    BOOST_CHECK_EQUAL(countLines("iris2_async.log", "blocking "), 500u);
+
+    policy->setOverflowPolicy(LOG_DROP);
+    unsigned long dropped = policy->getDropped();
+    for(int i = 0; i < 500; ++i)
+        LOG(LWARNING) << "dropping " << i;
+    policy->setAsynchronous(false);
+    BOOST_CHECK_EQUAL(countLines("iris2_async.log", "dropping ") + policy->getDropped() - dropped, 500u);
+
+    policy->setFileStream(NULL);
+    fclose(pFile);
+}
+
+enum TestEnum { FIRST, SECOND };
+
+BOOST_AUTO_TEST_CASE(BinaryArguments)
+{
+    using namespace std;
+    using namespace iris;
+
+    FILE* pFile = fopen("iris2_binary.log", "w");
+    BOOST_REQUIRE(pFile!=NULL);
+    LoggingPolicy* policy = LoggingPolicy::getPolicyInstance();
+    policy->setConsoleStream(NULL);
+    policy->setFileStream(pFile);
+    policy->ReportingLevel() = LDEBUG;
+    policy->setAsynchronous(true);
+
+    //Messages come out as if they had been formatted with an ostringstream
+    string name = "component";
+    const char* text = "text";
+    unsigned short port = 8080;
+    string longText(300, 'x');
+    ostringstream expected[4];
+    LOG(LDEBUG) << name << " " << 42 << " " << -7L << " " << 3.5 << " " << 2.25f << " " << true << " " << 'c' << " " << text << " " << port;
+    expected[0] << getName() << ": " << name << " " << 42 << " " << -7L << " " << 3.5 << " " << 2.25f << " " << true << " " << 'c' << " " << text << " " << port;
+    LOG(LINFO) << std::hex << 255 << " " << std::dec << 255 << " " << std::boolalpha << false;
+    expected[1] << getName() << ": " << std::hex << 255 << " " << std::dec << 255 << " " << std::boolalpha << false;
+    LOG(LWARNING) << 1 << " " << SECOND << " " << b::posix_time::milliseconds(5) << " " << 2;
+    expected[2] << getName() << ": " << 1 << " " << SECOND << " " << b::posix_time::milliseconds(5) << " " << 2;
+    LOG(LERROR) << "long " << longText << " " << 3;
+    expected[3] << getName() << ": " << "long " << longText << " " << 3;
+    policy->setAsynchronous(false);
+    policy->setFileStream(NULL);
+    fclose(pFile);
+
+    const char* prefixes[] = {"[DEBUG]   ", "[INFO]    ", "[WARNING] ", "[ERROR]   "};
+    ifstream file("iris2_binary.log");
+    string line;
+    for(int i = 0; i < 4; ++i)
+    {
+        BOOST_REQUIRE(getline(file, line));
+        string message = string(prefixes[i]) + expected[i].str();
+        BOOST_REQUIRE(line.size() > message.size());
+        BOOST_CHECK_EQUAL(line.substr(line.size() - message.size()), message);
+    }
+
+    //Compare the cost of a LOG call with formatting the same message into a string
+    policy->setOverflowPolicy(LOG_DROP);
+    policy->setAsynchronous(true);
+    const unsigned iterations = 20000;
+    double value = 0.5;
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+        LOG(LDEBUG) << "iteration " << i << " value " << value << " of " << name;
+    b::posix_time::time_duration binary = b::posix_time::microsec_clock::local_time() - start;
+    policy->setAsynchronous(false);
+
+    start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+    {
+        ostringstream os;
+        string prefix = "[";
+        prefix += Logger::ToString(LDEBUG);
+        prefix += "]";
+        prefix += string(sizeof("WARNING")+1 - prefix.size(), ' ');
+        os << prefix << " " << getName() << ": " << "iteration " << i << " value " << value << " of " << name << endl;
+        string msg = os.str();
+    }
+    b::posix_time::time_duration formatted = b::posix_time::microsec_clock::local_time() - start;
+    BOOST_TEST_MESSAGE(iterations << " LOG calls took " << binary << ", formatting the messages took " << formatted);
+
+    policy->setConsoleStream(stderr);
+}
+
+/// An object with its own reporting level, like a component
+struct NamedLogger
+{
+    NamedLogger(std::string name) : name_(name) {}
+    std::string getName() const { return name_; }
+    iris::LogLevel getReportingLevel() const { return logLevel_.get(name_); }
+    void debug(int i) { LOG(LDEBUG) << "debug " << i; }
+    void warning(int i) { LOG(LWARNING) << "warning " << i; }
+    std::string name_;
+    iris::LogLevelCache logLevel_;
+};
+
+BOOST_AUTO_TEST_CASE(NamedLevels)
+{
+    using namespace std;
+    using namespace iris;
+
+    LoggingPolicy* policy = LoggingPolicy::getPolicyInstance();
+    policy->ReportingLevel() = LWARNING;
+
+    //Names use the global level until given their own or their parent's
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LWARNING);
+    policy->setParent("comp1", "engine1");
+    policy->setLevel("engine1", LDEBUG);
+    BOOST_CHECK_EQUAL(policy->getLevel("engine1"), LDEBUG);
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LDEBUG);
+    policy->setLevel("comp1", LERROR);
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LERROR);
+    policy->clearLevel("comp1");
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LDEBUG);
+    policy->clearLevel("engine1");
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LWARNING);
+    policy->ReportingLevel() = LINFO;
+    BOOST_CHECK_EQUAL(policy->getLevel("comp1"), LINFO);
+    BOOST_CHECK_EQUAL(policy->ReportingLevel(), LINFO);
+
+    //Only the object with a debug level logs debug messages
+    FILE* pFile = fopen("iris2_named.log", "w");
+    BOOST_REQUIRE(pFile!=NULL);
+    policy->setConsoleStream(NULL);
+    policy->setFileStream(pFile);
+    policy->ReportingLevel() = LWARNING;
+    NamedLogger quiet("quiet");
+    NamedLogger noisy("noisy");
+    policy->setLevel("noisy", LDEBUG);
+    for(int i = 0; i < 10; ++i)
+    {
+        quiet.debug(i);
+        quiet.warning(i);
+        noisy.debug(i);
+        noisy.warning(i);
+    }
+    policy->setFileStream(NULL);
+    fclose(pFile);
+    BOOST_CHECK_EQUAL(countLines("iris2_named.log", "quiet: debug"), 0u);
+    BOOST_CHECK_EQUAL(countLines("iris2_named.log", "quiet: warning"), 10u);
+    BOOST_CHECK_EQUAL(countLines("iris2_named.log", "noisy: debug"), 10u);
+    BOOST_CHECK_EQUAL(countLines("iris2_named.log", "noisy: warning"), 10u);
+
+    //Levels can be changed while objects are logging
+    policy->clearLevel("noisy");
+    BOOST_CHECK_EQUAL(noisy.getReportingLevel(), LWARNING);
+
+    //Time the level check of a disabled message
+    const unsigned iterations = 1000000;
+    b::posix_time::ptime start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+        LOG(LDEBUG) << "disabled " << i;
+    b::posix_time::time_duration global = b::posix_time::microsec_clock::local_time() - start;
+    start = b::posix_time::microsec_clock::local_time();
+    for(unsigned i = 0; i < iterations; ++i)
+        quiet.debug(i);
+    b::posix_time::time_duration named = b::posix_time::microsec_clock::local_time() - start;
+    BOOST_TEST_MESSAGE(iterations << " disabled messages took " << global << " with the global level, "
+                       << named << " with a named level");
+
+    policy->setConsoleStream(stderr);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+/**
+ * \file PendingReconfigurations_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for PendingReconfigurations class
+ */
+
+#define BOOST_TEST_MODULE PendingReconfigurations_Test
+
+#include <boost/test/unit_test.hpp>
+
+#include "irisapi/PendingReconfigurations.h"
+
+using namespace std;
+using namespace iris;
+namespace bpt = boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE (PendingReconfigurations_Test)
+
+//! Make a set with a single parametric reconfiguration
+ReconfigSet makeSet(string value, bool timed = false, double timeStamp = 0)
+{
+    ParametricReconfig p;
+    p.engineName = "engine1";
+    p.componentName = "comp1";
+    p.parameterName = "param1";
+    p.parameterValue = value;
+    ReconfigSet set;
+    set.paramReconfigs.push_back(p);
+    set.isTimed = timed;
+    set.timeStamp = timeStamp;
+    return set;
+}
+
+BOOST_AUTO_TEST_CASE(PendingReconfigurationsImmediate)
+{
+    PendingReconfigurations pending;
+    ReconfigSet set;
+    BOOST_CHECK(pending.empty());
+    BOOST_CHECK(!pending.popDue(false, 0, set));
+
+    //Sets which are not timed are due in the order they were added
+    pending.add(makeSet("a"));
+    pending.add(makeSet("b"));
+    BOOST_CHECK(!pending.nextIsTimed());
+    BOOST_REQUIRE(pending.popDue(false, 0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "a");
+    BOOST_REQUIRE(pending.popDue(false, 0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "b");
+    BOOST_CHECK(pending.empty());
+}
+
+BOOST_AUTO_TEST_CASE(PendingReconfigurationsTimed)
+{
+    PendingReconfigurations pending;
+    ReconfigSet set;
+
+    pending.add(makeSet("late", true, 2.0));
+    pending.add(makeSet("early", true, 1.0));
+    pending.add(makeSet("late2", true, 2.0));
+    pending.add(makeSet("now"));
+
+    //Sets which are not timed go first
+    BOOST_REQUIRE(pending.popDue(false, 0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "now");
+
+    //Timed sets wait for a known timestamp
+    BOOST_CHECK(pending.nextIsTimed());
+    BOOST_CHECK(!pending.popDue(false, 5.0, set));
+    BOOST_CHECK(!pending.popDue(true, 0.5, set));
+
+    //Then go in order of their timestamps
+    BOOST_REQUIRE(pending.popDue(true, 1.0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "early");
+    BOOST_CHECK(!pending.popDue(true, 1.5, set));
+    BOOST_REQUIRE(pending.popDue(true, 3.0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "late");
+    BOOST_REQUIRE(pending.popDue(true, 3.0, set));
+    BOOST_CHECK_EQUAL(set.paramReconfigs[0].parameterValue, "late2");
+    BOOST_CHECK(pending.empty());
+}
+
+BOOST_AUTO_TEST_CASE(PendingReconfigurationsLatency)
+{
+    ReconfigLatency latency;
+
+    //Sets without an issue time are not counted
+    latency.record(bpt::ptime());
+    BOOST_CHECK_EQUAL(latency.count, 0u);
+    BOOST_CHECK_EQUAL(latency.average(), bpt::time_duration());
+
+    bpt::ptime now = bpt::microsec_clock::universal_time();
+    bpt::time_duration d = latency.record(now - bpt::milliseconds(10));
+    BOOST_CHECK(d >= bpt::milliseconds(10));
+    latency.record(now);
+    BOOST_CHECK_EQUAL(latency.count, 2u);
+    BOOST_CHECK_EQUAL(latency.maximum, d);
+    BOOST_CHECK(latency.average() <= d);
+    BOOST_CHECK(latency.average() >= bpt::milliseconds(5));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
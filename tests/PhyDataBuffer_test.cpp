@@ -0,0 +1,170 @@
+/**
+ * \file PhyDataBuffer_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for PhyDataBuffer class.
+ */
+
+#define BOOST_TEST_MODULE PhyDataBufferTest
+
+#include <boost/test/unit_test.hpp>
+
+#include "src/engines/phyengine/PhyDataBuffer.h"
+
+using namespace std;
+using namespace iris;
+
+BOOST_AUTO_TEST_SUITE (PhyDataBufferTest)
+
+//! Write a DataSet holding a single value
+static void writeValue(PhyDataBuffer<int>& buf, int value)
+{
+    DataSet<int>* set = NULL;
+    buf.getWriteData(set, 1);
+    set->data[0] = value;
+    buf.releaseWriteData(set);
+}
+
+//! Read a DataSet holding a single value
+static int readValue(PhyDataBuffer<int>& buf)
+{
+    DataSet<int>* set = NULL;
+    buf.getReadData(set);
+    int value = set->data[0];
+    buf.releaseReadData(set);
+    return value;
+}
+
+BOOST_AUTO_TEST_CASE(PhyDataBufferGrow)
+{
+    PhyDataBuffer<int> buf(2, 4, POLICY_GROW);
+
+    //Read one DataSet so the oldest data is not at the start of the buffer
+    writeValue(buf, 0);
+    BOOST_CHECK_EQUAL(readValue(buf), 0);
+
+    //Fill the buffer - it grows to its capacity
+    DataSet<int>* set = NULL;
+    buf.getWriteData(set, 1);
+    set->data[0] = 1;
+    DataSet<int>* first = set;
+    buf.releaseWriteData(set);
+    for(int i = 2; i <= 4; ++i)
+    {
+        BOOST_CHECK(!buf.isFull());
+        writeValue(buf, i);
+    }
+    BOOST_CHECK(buf.isFull());
+
+    PhyBufferStatistics stats = buf.getStatistics();
+    BOOST_CHECK_EQUAL(stats.length, 4u);
+    BOOST_CHECK_EQUAL(stats.growths, 2u);
+    BOOST_CHECK_EQUAL(stats.highWaterMark, 4u);
+
+    //Data is read back in order and existing DataSets did not move
+    buf.getReadData(set);
+    BOOST_CHECK_EQUAL(set, first);
+    BOOST_CHECK_EQUAL(set->data[0], 1);
+    buf.releaseReadData(set);
+    BOOST_CHECK(!buf.isFull());
+    for(int i = 2; i <= 4; ++i)
+        BOOST_CHECK_EQUAL(readValue(buf), i);
+    BOOST_CHECK(!buf.hasData());
+}
+
+BOOST_AUTO_TEST_CASE(PhyDataBufferBackpressure)
+{
+    PhyDataBuffer<int> buf(1, 3, POLICY_BACKPRESSURE);
+    BOOST_CHECK_EQUAL(buf.getStatistics().length, 3u);
+
+    for(int i = 0; i < 3; ++i)
+        writeValue(buf, i);
+    BOOST_CHECK(buf.isFull());
+    BOOST_CHECK_EQUAL(buf.getStatistics().growths, 0u);
+
+    //A writer which ignores isFull() grows the buffer rather than losing data
+    writeValue(buf, 3);
+    BOOST_CHECK_EQUAL(buf.getStatistics().growths, 1u);
+    for(int i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(readValue(buf), i);
+}
+
+BOOST_AUTO_TEST_CASE(PhyDataBufferDrop)
+{
+    PhyDataBuffer<int> buf(1, 3, POLICY_DROP);
+
+    for(int i = 0; i < 5; ++i)
+        writeValue(buf, i);
+    BOOST_CHECK(!buf.isFull());
+
+    PhyBufferStatistics stats = buf.getStatistics();
+    BOOST_CHECK_EQUAL(stats.length, 3u);
+    BOOST_CHECK_EQUAL(stats.drops, 2u);
+    BOOST_CHECK_EQUAL(stats.growths, 0u);
+
+    //The oldest data was dropped
+    for(int i = 2; i < 5; ++i)
+        BOOST_CHECK_EQUAL(readValue(buf), i);
+    BOOST_CHECK(!buf.hasData());
+
+    //While the oldest DataSet is being read, the newest is dropped
+    for(int i = 0; i < 3; ++i)
+        writeValue(buf, i);
+    DataSet<int>* readSet = NULL;
+    buf.getReadData(readSet);
+    writeValue(buf, 3);
+    stats = buf.getStatistics();
+    BOOST_CHECK_EQUAL(stats.length, 3u);
+    BOOST_CHECK_EQUAL(stats.drops, 3u);
+    BOOST_CHECK_EQUAL(stats.growths, 0u);
+    BOOST_CHECK_EQUAL(readSet->data[0], 0);
+    buf.releaseReadData(readSet);
+    BOOST_CHECK_EQUAL(readValue(buf), 1);
+    BOOST_CHECK_EQUAL(readValue(buf), 3);
+    BOOST_CHECK(!buf.hasData());
+}
+
+BOOST_AUTO_TEST_CASE(PhyDataBufferNextTimeStamp)
+{
+    PhyDataBuffer<int> buf(1, 2, POLICY_GROW);
+
+    //Nobody else can fill the buffer, so waiting on an empty one is an error
+    double t = -1;
+    BOOST_CHECK(!buf.getNextTimeStamp(t, false));
+    BOOST_CHECK_THROW(buf.getNextTimeStamp(t, true), DataBufferReleaseException);
+
+    DataSet<int>* set = NULL;
+    buf.getWriteData(set, 1);
+    set->timeStamp = 2.5;
+    buf.releaseWriteData(set);
+    BOOST_CHECK(buf.getNextTimeStamp(t, true));
+    BOOST_CHECK_EQUAL(t, 2.5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
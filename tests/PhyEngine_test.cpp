@@ -40,13 +40,55 @@
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
 
+#include <boost/filesystem.hpp>
+
 #include <algorithm>
+#include <fstream>
 #include <string>
 
 #include "iris/PhyEngine.h"
+#include "iris/SharedLibrary.h"
+#include "irisapi/PhyComponent.h"
+#include "config_tests.h"
 
 using namespace std;
 using namespace iris;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+
+/// A repository holding the test bundle, removed when the test ends
+struct BundleRepository
+{
+    bfs::path path;
+
+    BundleRepository()
+    {
+        path = bfs::temp_directory_path() / bfs::unique_path("iris-repo-%%%%-%%%%");
+        bfs::create_directories(path);
+
+        string lib = SharedLibrary::getSystemPrefix() + "testbundle" + SharedLibrary::getSystemExtension();
+        bfs::path built = bfs::path(TESTLIB_DIR) / lib;
+        if(!bfs::exists(built))
+            built = bfs::path(".") / lib;
+        bfs::copy_file(built, path / lib);
+        ofstream((path / (SharedLibrary::getSystemPrefix() + "testbundle.bundle")).string().c_str())
+            << "first\nsecond\n";
+    }
+
+    ~BundleRepository()
+    {
+        b::system::error_code ec;
+        bfs::remove_all(path, ec);
+    }
+};
+
+/// Gives the tests access to the running components
+class SwapEngine : public PhyEngine
+{
+public:
+  SwapEngine(string repository) : PhyEngine("SwapEngine", repository) {}
+  string getComponentType(unsigned index) const { return components_[index]->getType(); }
+};
 
 BOOST_AUTO_TEST_SUITE (PhyEngineTest)
 
@@ -56,4 +98,55 @@ BOOST_AUTO_TEST_CASE(PhyEngineBasic)
     PhyEngine thePhyEngine("MyEngine", ".");
 }
 
+BOOST_AUTO_TEST_CASE(PhyEngineReplaceComponent)
+{
+    BundleRepository repo;
+    SwapEngine engine(repo.path.string());
+
+    EngineDescription desc;
+    desc.name = "SwapEngine";
+    desc.type = "phyengine";
+    ComponentDescription comp;
+    comp.name = "comp";
+    comp.type = "first";
+    comp.engineName = desc.name;
+    add_vertex(comp, desc.engineGraph);
+    engine.loadEngine(desc, vector< b::shared_ptr<DataBufferBase> >());
+
+    ParameterHandle before;
+    BOOST_REQUIRE(engine.resolveParameter("gain", "comp", before));
+    engine.startEngine();
+
+    //A replacement which cannot be loaded is removed from the set
+    ReconfigSet reconfigs;
+    StructuralReconfig s;
+    s.engineName = desc.name;
+    NewComponent missing;
+    missing.name = "comp";
+    missing.type = "third";
+    s.replacedComponents.push_back(missing);
+    NewComponent second;
+    second.name = "comp";
+    second.type = "second";
+    s.replacedComponents.push_back(second);
+    reconfigs.structReconfigs.push_back(s);
+    BOOST_CHECK(!engine.addReconfiguration(reconfigs));
+    BOOST_REQUIRE_EQUAL(reconfigs.structReconfigs[0].replacedComponents.size(), 1u);
+    BOOST_CHECK_EQUAL(reconfigs.structReconfigs[0].replacedComponents[0].type, "second");
+
+    //Wait for the engine thread to switch the components
+    ParameterHandle after;
+    for(int i = 0; i < 500 && after.generation == before.generation; ++i)
+    {
+        b::this_thread::sleep(b::posix_time::milliseconds(10));
+        BOOST_REQUIRE(engine.resolveParameter("gain", "comp", after));
+    }
+    BOOST_CHECK(after.generation != before.generation);
+    BOOST_CHECK_EQUAL(after.parameterIndex, before.parameterIndex);
+
+    engine.stopEngine();
+    BOOST_CHECK_EQUAL(engine.getComponentType(0), "second");
+    engine.unloadEngine();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
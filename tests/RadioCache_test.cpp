@@ -0,0 +1,240 @@
+/**
+ * \file RadioCache_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for RadioCache class.
+ */
+
+#define BOOST_TEST_MODULE RadioCacheTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "iris/RadioCache.h"
+#include "iris/XmlParser.h"
+
+using namespace std;
+using namespace iris;
+namespace bfs = boost::filesystem;
+
+static const string xmlConfig("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\
+<softwareradio>\
+<controller class=\"testcontroller\">\
+<parameter name=\"testparam\" value=\"2\" />\
+</controller>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\">\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"splitter1\" class=\"splitterphycomponent\">\
+<parameter name=\"x_numoutputs\" value=\"2\" />\
+<port name=\"input1\" class=\"input\" />\
+<port name=\"output1\" class=\"output\" />\
+<port name=\"output2\" class=\"output\" />\
+</component>\
+</engine>\
+<engine name=\"phyengine2\" class=\"phyengine\">\
+<component name=\"snk1\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<engine name=\"phyengine3\" class=\"phyengine\">\
+<component name=\"snk2\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<link source=\"src1.output1\" sink=\"splitter1.input1\" capacity=\"16\" policy=\"drop\" />\
+<link source=\"splitter1.output1\" sink=\"snk1.input1\" />\
+<link source=\"splitter1.output2\" sink=\"snk2.input1\" />\
+</softwareradio>\
+");
+
+/// Creates an empty temporary directory and removes it again
+struct TempDir
+{
+  TempDir()
+    :path(bfs::temp_directory_path() / bfs::unique_path("iris_cache_%%%%-%%%%"))
+  {
+    bfs::create_directories(path);
+  }
+  ~TempDir()
+  {
+    boost::system::error_code ec;
+    bfs::remove_all(path, ec);
+  }
+  bfs::path path;
+};
+
+BOOST_AUTO_TEST_SUITE (RadioCacheTest)
+
+BOOST_AUTO_TEST_CASE(RadioCacheRoundTrip)
+{
+    TempDir dir;
+    string xml = xmlConfig;
+    RadioRepresentation parsed;
+    BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString(xml, parsed));
+
+    vector<string> reps;
+    boost::uint64_t key = RadioCache::computeKey(xml, reps);
+    string file = RadioCache::getCacheFile(dir.path.string(), "radio.xml");
+    BOOST_REQUIRE_NO_THROW(RadioCache::save(parsed, key, file));
+
+    RadioRepresentation cached;
+    BOOST_REQUIRE(RadioCache::load(file, key, cached));
+    BOOST_CHECK(cached.isGraphBuilt());
+
+    //The cached radio is identical to the parsed one
+    string result;
+    BOOST_REQUIRE_NO_THROW(XmlParser::generateXmlString(cached, result));
+    BOOST_CHECK(boost::equals(xmlConfig, result));
+    BOOST_CHECK(cached.getEngines() == parsed.getEngines());
+    BOOST_CHECK_EQUAL(cached.getExternalLinks().size(), parsed.getExternalLinks().size());
+    BOOST_CHECK_EQUAL(cached.getLinks()[0].bufferCapacity, 16u);
+    BOOST_CHECK(cached.getLinks()[0].bufferPolicy == POLICY_DROP);
+}
+
+BOOST_AUTO_TEST_CASE(RadioCacheRejectsInvalidFiles)
+{
+    TempDir dir;
+    string xml = xmlConfig;
+    RadioRepresentation parsed;
+    BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString(xml, parsed));
+
+    vector<string> reps;
+    boost::uint64_t key = RadioCache::computeKey(xml, reps);
+    string file = RadioCache::getCacheFile(dir.path.string(), "radio.xml");
+
+    //Missing file
+    RadioRepresentation radio;
+    BOOST_CHECK(!RadioCache::load(file, key, radio));
+
+    //Stale key
+    BOOST_REQUIRE_NO_THROW(RadioCache::save(parsed, key, file));
+    BOOST_CHECK(!RadioCache::load(file, key + 1, radio));
+    BOOST_CHECK(!radio.isGraphBuilt());
+
+    //Truncated file
+    boost::uintmax_t size = bfs::file_size(file);
+    bfs::resize_file(file, size / 2);
+    BOOST_CHECK(!RadioCache::load(file, key, radio));
+    BOOST_CHECK(!radio.isGraphBuilt());
+
+    //Corrupt file
+    {
+        ofstream out(file.c_str(), ios::binary | ios::trunc);
+        out << "this is not a radio cache";
+    }
+    BOOST_CHECK(!RadioCache::load(file, key, radio));
+    BOOST_CHECK(!radio.isGraphBuilt());
+}
+
+BOOST_AUTO_TEST_CASE(RadioCacheKey)
+{
+    TempDir dir;
+    vector<string> reps;
+    reps.push_back(dir.path.string());
+
+    boost::uint64_t key = RadioCache::computeKey(xmlConfig, reps);
+    BOOST_CHECK_EQUAL(key, RadioCache::computeKey(xmlConfig, reps));
+
+    //A changed configuration changes the key
+    string changed = boost::replace_all_copy(xmlConfig, "value=\"2\"", "value=\"3\"");
+    BOOST_CHECK(key != RadioCache::computeKey(changed, reps));
+
+    //A new library in a repository changes the key
+    {
+        ofstream out((dir.path / "libtest.so").string().c_str());
+        out << "library";
+    }
+    boost::uint64_t withLibrary = RadioCache::computeKey(xmlConfig, reps);
+    BOOST_CHECK(key != withLibrary);
+
+    //So does a relinked one, which the linker writes as a new file
+    bfs::remove(dir.path / "libtest.so");
+    {
+        ofstream out((dir.path / "libtest.so").string().c_str());
+        out << "library rebuilt";
+    }
+    bfs::last_write_time(dir.path, bfs::last_write_time(dir.path) + 2);
+    BOOST_CHECK(withLibrary != RadioCache::computeKey(xmlConfig, reps));
+}
+
+BOOST_AUTO_TEST_CASE(RadioCacheLoadTime)
+{
+    //Compare parsing a large configuration with loading it from the cache
+    stringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?><softwareradio>";
+    xml << "<engine name=\"phyengine1\" class=\"phyengine\">";
+    const int numComponents = 2000;
+    for(int i = 0; i < numComponents; ++i)
+    {
+        xml << "<component name=\"comp" << i << "\" class=\"testphycomponent\">";
+        xml << "<parameter name=\"p1\" value=\"" << i << "\" />";
+        xml << "<parameter name=\"p2\" value=\"somevalue\" />";
+        xml << "<port name=\"input1\" class=\"input\" />";
+        xml << "<port name=\"output1\" class=\"output\" />";
+        xml << "</component>";
+    }
+    xml << "</engine>";
+    for(int i = 1; i < numComponents; ++i)
+        xml << "<link source=\"comp" << i-1 << ".output1\" sink=\"comp" << i << ".input1\" />";
+    xml << "</softwareradio>";
+    string config = xml.str();
+
+    TempDir dir;
+    vector<string> reps;
+    boost::uint64_t key = RadioCache::computeKey(config, reps);
+    string file = RadioCache::getCacheFile(dir.path.string(), "large.xml");
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    RadioRepresentation parsed;
+    BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString(config, parsed));
+    boost::posix_time::ptime parseEnd = boost::posix_time::microsec_clock::universal_time();
+
+    BOOST_REQUIRE_NO_THROW(RadioCache::save(parsed, key, file));
+
+    boost::posix_time::ptime loadStart = boost::posix_time::microsec_clock::universal_time();
+    RadioRepresentation cached;
+    BOOST_REQUIRE(RadioCache::load(file, key, cached));
+    boost::posix_time::ptime loadEnd = boost::posix_time::microsec_clock::universal_time();
+
+    BOOST_CHECK(cached.getEngines() == parsed.getEngines());
+    BOOST_TEST_MESSAGE("Parsed " << numComponents << " components in " << (parseEnd - start)
+                       << ", loaded from cache in " << (loadEnd - loadStart));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -39,12 +39,16 @@
 #include <boost/thread/condition.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <algorithm>
 #include <string>
 #include <iostream>
+#include <malloc.h>
 
 #include "iris/RadioRepresentation.h"
+#include "irisapi/ReconfigurationDescriptions.h"
 
 using namespace std;
 using namespace iris;
@@ -190,4 +194,225 @@ BOOST_AUTO_TEST_CASE(RadioRepresentationDirtyBuild)
     BOOST_CHECK_EQUAL(r.isGraphBuilt(), false);
 }
 
+BOOST_AUTO_TEST_CASE(RadioRepresentationParameterLookup)
+{
+    ParameterDescription par1, par2;
+    par1.name = "parameter1";
+    par1.value = "1";
+    par2.name = "parameter2";
+    par2.value = "2";
+
+    ComponentDescription comp1, comp2;
+    comp1.name = "comp1";
+    comp1.type = "testcomp";
+    comp1.parameters.push_back(par1);
+    comp1.parameters.push_back(par2);
+    comp1.engineName = "eng1";
+    comp2.name = "comp2";
+    comp2.type = "testcomp";
+    comp2.parameters.push_back(par1);
+    comp2.engineName = "eng1";
+
+    EngineDescription eng1;
+    eng1.name = "eng1";
+    eng1.type = "testengine";
+    eng1.components.push_back(comp1);
+    eng1.components.push_back(comp2);
+
+    RadioRepresentation r;
+    r.addEngineDescription(eng1);
+
+    //Nothing can be found before the graphs are built
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp1"), "");
+    BOOST_REQUIRE_NO_THROW(r.buildGraphs());
+
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp1"), "1");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter2", "comp1"), "2");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp2"), "1");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter2", "comp2"), "");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp3"), "");
+
+    //Copies share the current values but are reconfigured independently
+    RadioRepresentation copy(r);
+
+    ParametricReconfig p;
+    p.engineName = "eng1";
+    p.componentName = "comp1";
+    p.parameterName = "parameter1";
+    p.parameterValue = "10";
+    ReconfigSet reconfigs;
+    reconfigs.paramReconfigs.push_back(p);
+    p.componentName = "comp2";
+    p.parameterValue = "20";
+    reconfigs.paramReconfigs.push_back(p);
+    BOOST_REQUIRE_NO_THROW(r.reconfigureRepresentation(reconfigs));
+
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp1"), "10");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp2"), "20");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter2", "comp1"), "2");
+    BOOST_CHECK_EQUAL(copy.getParameterValue("parameter1", "comp1"), "1");
+
+    //Unknown parameters are not added to the index
+    ReconfigSet unknown;
+    p.parameterName = "parameter3";
+    unknown.paramReconfigs.push_back(p);
+    BOOST_REQUIRE_NO_THROW(r.reconfigureRepresentation(unknown));
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter3", "comp2"), "");
+
+    //Reconfigurations applied before a failure remain visible
+    ReconfigSet failing;
+    p.parameterName = "parameter2";
+    p.componentName = "comp1";
+    p.parameterValue = "30";
+    failing.paramReconfigs.push_back(p);
+    p.componentName = "comp3";
+    failing.paramReconfigs.push_back(p);
+    BOOST_CHECK_THROW(r.reconfigureRepresentation(failing), ResourceNotFoundException);
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter2", "comp1"), "30");
+}
+
+BOOST_AUTO_TEST_CASE(RadioRepresentationReplaceComponent)
+{
+    ParameterDescription par1;
+    par1.name = "parameter1";
+    par1.value = "1";
+
+    ComponentDescription comp1;
+    comp1.name = "comp1";
+    comp1.type = "testcomp";
+    comp1.parameters.push_back(par1);
+    comp1.engineName = "eng1";
+
+    EngineDescription eng1;
+    eng1.name = "eng1";
+    eng1.type = "testengine";
+    eng1.components.push_back(comp1);
+
+    RadioRepresentation r;
+    r.addEngineDescription(eng1);
+    BOOST_REQUIRE_NO_THROW(r.buildGraphs());
+
+    NewComponent c;
+    c.name = "comp1";
+    c.type = "othercomp";
+    c.parameters.push_back(make_pair(string("parameter2"), string("2")));
+    StructuralReconfig s;
+    s.engineName = "eng1";
+    s.replacedComponents.push_back(c);
+    ReconfigSet reconfigs;
+    reconfigs.structReconfigs.push_back(s);
+    BOOST_REQUIRE_NO_THROW(r.reconfigureRepresentation(reconfigs));
+
+    //The component keeps its name but takes the new type and parameters
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter1", "comp1"), "");
+    BOOST_CHECK_EQUAL(r.getParameterValue("parameter2", "comp1"), "2");
+    vector<EngineDescription> engines = r.getEngines();
+    BOOST_REQUIRE(engines.size() == 1);
+    BOOST_REQUIRE(engines[0].components.size() == 1);
+    BOOST_CHECK_EQUAL(engines[0].components[0].type, "othercomp");
+    Vertex v;
+    RadioGraph g = r.getRadioGraph();
+    BOOST_REQUIRE(RadioRepresentation::findComponent("comp1", g, v));
+    BOOST_CHECK_EQUAL(g[v].type, "othercomp");
+
+    //Unknown components are reported
+    reconfigs.structReconfigs[0].replacedComponents[0].name = "comp2";
+    BOOST_CHECK_THROW(r.reconfigureRepresentation(reconfigs), ResourceNotFoundException);
+}
+
+//! Bytes currently allocated on the heap, or 0 if this cannot be measured
+size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(RadioRepresentationSharedCopies)
+{
+    //A synthetic radio of 8 engines with 500 chained components each
+    RadioRepresentation r;
+    for(int e = 0; e < 8; ++e)
+    {
+        EngineDescription eng;
+        eng.name = "engine" + b::lexical_cast<string>(e);
+        eng.type = "phyengine";
+        for(int c = 0; c < 500; ++c)
+        {
+            ComponentDescription comp;
+            comp.name = eng.name + "comp" + b::lexical_cast<string>(c);
+            comp.type = "testcomponent";
+            comp.engineName = eng.name;
+            ParameterDescription param;
+            param.name = "param1";
+            param.value = "1";
+            comp.parameters.push_back(param);
+            eng.components.push_back(comp);
+            if(c > 0)
+            {
+                LinkDescription l;
+                l.sourceComponent = eng.name + "comp" + b::lexical_cast<string>(c - 1);
+                l.sourcePort = "output1";
+                l.sinkComponent = comp.name;
+                l.sinkPort = "input1";
+                r.addLinkDescription(l);
+            }
+        }
+        r.addEngineDescription(eng);
+    }
+    BOOST_REQUIRE_NO_THROW(r.buildGraphs());
+
+    //Snapshots share the contents of the radio
+    size_t before = heapInUse();
+    b::posix_time::ptime start = b::posix_time::microsec_clock::universal_time();
+    vector<RadioRepresentation> snapshots(100, r);
+    b::posix_time::time_duration elapsed = b::posix_time::microsec_clock::universal_time() - start;
+    size_t shared = heapInUse() - before;
+    BOOST_TEST_MESSAGE("100 snapshots of 4000 components took " << elapsed << " and " << shared << " bytes");
+    for(size_t i = 0; i < snapshots.size(); ++i)
+        BOOST_REQUIRE(snapshots[i].sharesContents(r));
+
+    //Changing a snapshot copies the contents once and leaves the others alone
+    before = heapInUse();
+    ParametricReconfig p;
+    p.engineName = "engine3";
+    p.componentName = "engine3comp250";
+    p.parameterName = "param1";
+    p.parameterValue = "2";
+    ReconfigSet reconfigs;
+    reconfigs.paramReconfigs.push_back(p);
+    BOOST_REQUIRE_NO_THROW(snapshots[0].reconfigureRepresentation(reconfigs));
+    size_t copied = heapInUse() - before;
+    BOOST_TEST_MESSAGE("Reconfiguring a snapshot copied " << copied << " bytes");
+    BOOST_CHECK(!snapshots[0].sharesContents(r));
+    BOOST_CHECK(snapshots[1].sharesContents(r));
+    BOOST_CHECK_EQUAL(snapshots[0].getParameterValue("param1", "engine3comp250"), "2");
+    BOOST_CHECK_EQUAL(r.getParameterValue("param1", "engine3comp250"), "1");
+    BOOST_CHECK_EQUAL(snapshots[1].getParameterValue("param1", "engine3comp250"), "1");
+    BOOST_CHECK(shared < copied);
+
+    //A representation nobody shares is changed in place
+    before = heapInUse();
+    reconfigs.paramReconfigs[0].parameterValue = "3";
+    BOOST_REQUIRE_NO_THROW(snapshots[0].reconfigureRepresentation(reconfigs));
+    BOOST_TEST_MESSAGE("Reconfiguring an unshared representation used " << heapInUse() - before << " bytes");
+    BOOST_CHECK_EQUAL(snapshots[0].getParameterValue("param1", "engine3comp250"), "3");
+    vector<EngineDescription> engines = snapshots[0].getEngines();
+    BOOST_CHECK_EQUAL(engines[3].components[250].parameters[0].value, "3");
+    EngineGraph g = snapshots[0].getEngineGraph();
+    EngVertex v;
+    BOOST_REQUIRE(RadioRepresentation::findEngine("engine3", g, v));
+    BOOST_CHECK_EQUAL(g[v].components[250].parameters[0].value, "3");
+    BOOST_CHECK(g[v].fingerprint == engines[3].fingerprint);
+
+    //Engine descriptions being read are not changed underneath the reader
+    b::shared_ptr< const vector<EngineDescription> > held = snapshots[0].getEngineDescriptions();
+    reconfigs.paramReconfigs[0].parameterValue = "4";
+    BOOST_REQUIRE_NO_THROW(snapshots[0].reconfigureRepresentation(reconfigs));
+    BOOST_CHECK_EQUAL((*held)[3].components[250].parameters[0].value, "3");
+    BOOST_CHECK_EQUAL(snapshots[0].getEngineDescriptions()->at(3).components[250].parameters[0].value, "4");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
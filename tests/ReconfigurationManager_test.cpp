@@ -39,6 +39,9 @@
 #include <boost/thread/condition.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <algorithm>
 #include <string>
@@ -109,4 +112,187 @@ BOOST_AUTO_TEST_CASE(ReconfigurationManagerParametersTest)
 
 }
 
+BOOST_AUTO_TEST_CASE(ReconfigurationManagerStructureTest)
+{
+    string xmlConfig1("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\
+<softwareradio>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\">\
+<parameter name=\"param1\" value=\"1\" />\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"demod1\" class=\"bpskdemod\">\
+<port name=\"input1\" class=\"input\" />\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"snk1\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<link source=\"src1.output1\" sink=\"demod1.input1\" />\
+<link source=\"demod1.output1\" sink=\"snk1.input1\" />\
+</softwareradio>\
+");
+
+    string xmlConfig2("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\
+<softwareradio>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\">\
+<parameter name=\"param1\" value=\"1\" />\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"demod1\" class=\"qpskdemod\">\
+<parameter name=\"param1\" value=\"3\" />\
+<port name=\"input1\" class=\"input\" />\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"snk2\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<link source=\"src1.output1\" sink=\"demod1.input1\" />\
+<link source=\"demod1.output1\" sink=\"snk2.input1\" />\
+</softwareradio>\
+");
+
+    RadioRepresentation first;
+    RadioRepresentation second;
+    XmlParser::parseXmlString(xmlConfig1, first);
+    XmlParser::parseXmlString(xmlConfig2, second);
+
+    ReconfigSet reconfigs = ReconfigurationManager::compareRadios(first, second);
+    BOOST_CHECK(reconfigs.paramReconfigs.empty());
+    BOOST_REQUIRE(reconfigs.structReconfigs.size() == 1);
+    StructuralReconfig& s = reconfigs.structReconfigs.front();
+    BOOST_CHECK(s.engineName == "phyengine1");
+
+    BOOST_REQUIRE(s.replacedComponents.size() == 1);
+    BOOST_CHECK(s.replacedComponents[0].name == "demod1");
+    BOOST_CHECK(s.replacedComponents[0].type == "qpskdemod");
+    BOOST_REQUIRE(s.replacedComponents[0].parameters.size() == 1);
+    BOOST_CHECK(s.replacedComponents[0].parameters[0] == make_pair(string("param1"), string("3")));
+
+    BOOST_REQUIRE(s.removedComponents.size() == 1);
+    BOOST_CHECK(s.removedComponents[0] == "snk1");
+    BOOST_REQUIRE(s.newComponents.size() == 1);
+    BOOST_CHECK(s.newComponents[0].name == "snk2");
+
+    BOOST_REQUIRE(s.removedLinks.size() == 1);
+    BOOST_CHECK(s.removedLinks[0].sinkComponent == "snk1");
+    BOOST_REQUIRE(s.newLinks.size() == 1);
+    BOOST_CHECK(s.newLinks[0].sinkComponent == "snk2");
+    BOOST_CHECK(s.changesGraph());
+
+    //Identical radios need no reconfiguration
+    BOOST_CHECK(ReconfigurationManager::compareRadios(first, first).structReconfigs.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ReconfigurationManagerLinkBufferTest)
+{
+    string xmlConfig1("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\
+<softwareradio>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\">\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"snk1\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<link source=\"src1.output1\" sink=\"snk1.input1\" />\
+</softwareradio>\
+");
+    string xmlConfig2(xmlConfig1);
+    boost::replace_first(xmlConfig2, "sink=\"snk1.input1\"", "sink=\"snk1.input1\" capacity=\"8\" policy=\"drop\"");
+
+    RadioRepresentation first;
+    RadioRepresentation second;
+    XmlParser::parseXmlString(xmlConfig1, first);
+    XmlParser::parseXmlString(xmlConfig2, second);
+
+    //A link with new buffer settings is rebuilt
+    ReconfigSet reconfigs = ReconfigurationManager::compareRadios(first, second);
+    BOOST_REQUIRE(reconfigs.structReconfigs.size() == 1);
+    StructuralReconfig& s = reconfigs.structReconfigs.front();
+    BOOST_REQUIRE(s.removedLinks.size() == 1);
+    BOOST_CHECK_EQUAL(s.removedLinks[0].bufferCapacity, 0u);
+    BOOST_REQUIRE(s.newLinks.size() == 1);
+    BOOST_CHECK_EQUAL(s.newLinks[0].bufferCapacity, 8u);
+    BOOST_CHECK(s.newLinks[0].bufferPolicy == POLICY_DROP);
+}
+
+//! Build a synthetic radio of chained components with a few parameters each
+void buildLargeRadio(RadioRepresentation& radio, int numEngines, int numComponents, string changed)
+{
+    for(int e = 0; e < numEngines; ++e)
+    {
+        EngineDescription eng;
+        eng.name = "engine" + boost::lexical_cast<string>(e);
+        eng.type = "phyengine";
+        for(int c = 0; c < numComponents; ++c)
+        {
+            ComponentDescription comp;
+            comp.name = eng.name + "comp" + boost::lexical_cast<string>(c);
+            comp.type = "testcomponent";
+            comp.engineName = eng.name;
+            for(int p = 0; p < 5; ++p)
+            {
+                ParameterDescription param;
+                param.name = "param" + boost::lexical_cast<string>(p);
+                param.value = (comp.name == changed && p == 0) ? "2" : "1";
+                comp.parameters.push_back(param);
+            }
+            eng.components.push_back(comp);
+
+            if(c > 0)
+            {
+                LinkDescription l;
+                l.sourceComponent = eng.name + "comp" + boost::lexical_cast<string>(c - 1);
+                l.sourcePort = "output1";
+                l.sinkComponent = comp.name;
+                l.sinkPort = "input1";
+                radio.addLinkDescription(l);
+            }
+        }
+        radio.addEngineDescription(eng);
+    }
+    radio.buildGraphs();
+}
+
+BOOST_AUTO_TEST_CASE(ReconfigurationManagerLargeRadioTest)
+{
+    RadioRepresentation first;
+    RadioRepresentation second;
+    buildLargeRadio(first, 8, 500, "");
+    buildLargeRadio(second, 8, 500, "engine3comp250");
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    ReconfigSet reconfigs;
+    for(int i = 0; i < 100; ++i)
+        reconfigs = ReconfigurationManager::compareRadios(first, second);
+    boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+    BOOST_TEST_MESSAGE("Compared radios of 4000 components 100 times in " << elapsed);
+
+    //Only the changed engine and component are looked into
+    BOOST_REQUIRE(reconfigs.paramReconfigs.size() == 1);
+    BOOST_CHECK(reconfigs.paramReconfigs[0].engineName == "engine3");
+    BOOST_CHECK(reconfigs.paramReconfigs[0].componentName == "engine3comp250");
+    BOOST_CHECK(reconfigs.paramReconfigs[0].parameterName == "param0");
+    BOOST_CHECK(reconfigs.paramReconfigs[0].parameterValue == "2");
+    BOOST_CHECK(reconfigs.structReconfigs.empty());
+
+    //Descriptions without fingerprints are compared in full
+    RadioRepresentation unbuilt;
+    EngineDescription eng = second.getEngines()[3];
+    eng.fingerprint = 0;
+    for(vector<ComponentDescription>::iterator i = eng.components.begin(); i != eng.components.end(); ++i)
+        i->fingerprint = 0;
+    unbuilt.addEngineDescription(eng);
+    reconfigs = ReconfigurationManager::compareRadios(first, unbuilt);
+    BOOST_CHECK(reconfigs.paramReconfigs.size() == 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,194 @@
+/**
+ * \file RepositoryIndex_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for RepositoryIndex class.
+ */
+
+#define BOOST_TEST_MODULE RepositoryIndexTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "iris/RepositoryIndex.h"
+#include "iris/SharedLibrary.h"
+#include "irisapi/Exceptions.h"
+
+using namespace std;
+using namespace iris;
+namespace b = boost;
+namespace bfs = boost::filesystem;
+
+/// Creates a temporary repository directory, removed when the test ends
+struct TempRepository
+{
+    bfs::path path;
+
+    TempRepository()
+    {
+        path = bfs::temp_directory_path() / bfs::unique_path("iris-repo-%%%%-%%%%");
+        bfs::create_directories(path);
+    }
+
+    ~TempRepository()
+    {
+        b::system::error_code ec;
+        bfs::remove_all(path, ec);
+    }
+
+    bfs::path addLibrary(string name)
+    {
+        bfs::path lib = path / (SharedLibrary::getSystemPrefix() + name + SharedLibrary::getSystemExtension());
+        ofstream out(lib.string().c_str());
+        out << name;
+        return lib;
+    }
+};
+
+BOOST_AUTO_TEST_SUITE (RepositoryIndexTest)
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_Lookup)
+{
+    TempRepository repo;
+    bfs::path lib = repo.addLibrary("Example");
+    repo.addLibrary("other");
+    ofstream((repo.path / "readme.txt").string().c_str()) << "not a library";
+
+    b::shared_ptr<RepositoryIndex> index = RepositoryIndex::get(repo.path.string());
+    BOOST_CHECK_EQUAL(index->size(), 2u);
+    BOOST_CHECK(index->contains("example"));
+    BOOST_CHECK(index->contains("other"));
+    BOOST_CHECK(!index->contains("Example"));
+    BOOST_CHECK(!index->contains("readme"));
+
+    vector< b::shared_ptr<RepositoryIndex> > repos(1, index);
+    LibraryLocation found;
+    BOOST_REQUIRE(RepositoryIndex::findLibrary(repos, "example", found));
+    BOOST_CHECK(found.path == lib);
+    BOOST_CHECK(!found.bundled);
+    BOOST_CHECK_EQUAL(found.loadFlags, SharedLibrary::LOAD_DEFAULT);
+    BOOST_CHECK(!RepositoryIndex::findLibrary(repos, "missing", found));
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_Shared)
+{
+    TempRepository repo;
+    repo.addLibrary("example");
+
+    b::shared_ptr<RepositoryIndex> first = RepositoryIndex::get(repo.path.string());
+    b::shared_ptr<RepositoryIndex> second = RepositoryIndex::get(repo.path.string());
+    BOOST_CHECK(first == second);
+
+    //Other load flags get their own index and leave the shared one alone
+    b::shared_ptr<RepositoryIndex> lazy = RepositoryIndex::get(repo.path.string(), SharedLibrary::LOAD_LAZY);
+    BOOST_CHECK(lazy != first);
+    BOOST_CHECK_EQUAL(lazy->getLoadFlags(), SharedLibrary::LOAD_LAZY);
+    BOOST_CHECK_EQUAL(first->getLoadFlags(), SharedLibrary::LOAD_DEFAULT);
+    BOOST_CHECK(lazy->contains("example"));
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_Refresh)
+{
+    TempRepository repo;
+    repo.addLibrary("example");
+
+    b::shared_ptr<RepositoryIndex> index = RepositoryIndex::get(repo.path.string());
+    BOOST_CHECK(!index->contains("added"));
+
+    repo.addLibrary("added");
+    index->refresh();
+    BOOST_CHECK(index->contains("added"));
+    BOOST_CHECK(index->contains("example"));
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_MultiplePaths)
+{
+    TempRepository repo1, repo2;
+    repo1.addLibrary("first");
+    repo2.addLibrary("second");
+
+    vector< b::shared_ptr<RepositoryIndex> > repos =
+        RepositoryIndex::getAll(repo1.path.string() + ";" + repo2.path.string() + ";");
+    BOOST_REQUIRE_EQUAL(repos.size(), 2u);
+
+    LibraryLocation found;
+    BOOST_CHECK(RepositoryIndex::findLibrary(repos, "first", found));
+    BOOST_CHECK(RepositoryIndex::findLibrary(repos, "second", found));
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_LoadFlags)
+{
+    TempRepository repo;
+    repo.addLibrary("example");
+
+    vector< b::shared_ptr<RepositoryIndex> > repos = RepositoryIndex::getAll(repo.path.string() + "?lazy, local");
+    BOOST_REQUIRE_EQUAL(repos.size(), 1u);
+    BOOST_CHECK_EQUAL(repos[0]->getLoadFlags(), SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL);
+
+    LibraryLocation found;
+    BOOST_REQUIRE(RepositoryIndex::findLibrary(repos, "example", found));
+    BOOST_CHECK_EQUAL(found.loadFlags, SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL);
+
+    BOOST_CHECK_EQUAL(RepositoryIndex::parseLoadFlags("DeepBind"), SharedLibrary::LOAD_DEEPBIND);
+    BOOST_CHECK_EQUAL(RepositoryIndex::parseLoadFlags("lazy,now"), SharedLibrary::LOAD_DEFAULT);
+    BOOST_CHECK_THROW(RepositoryIndex::parseLoadFlags("eager"), InvalidDataException);
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_Bundle)
+{
+    TempRepository repo;
+    bfs::path lib = repo.addLibrary("bundle");
+    ofstream((repo.path / (SharedLibrary::getSystemPrefix() + "bundle.bundle")).string().c_str())
+        << "# Components in the bundle\nFirst\n  second  \n\n";
+    ofstream((repo.path / "orphan.bundle").string().c_str()) << "third\n";
+
+    b::shared_ptr<RepositoryIndex> index = RepositoryIndex::get(repo.path.string());
+    BOOST_CHECK_EQUAL(index->size(), 2u);
+    BOOST_CHECK(!index->contains("bundle"));
+    BOOST_CHECK(!index->contains("third"));
+
+    vector< b::shared_ptr<RepositoryIndex> > repos(1, index);
+    LibraryLocation found;
+    BOOST_REQUIRE(RepositoryIndex::findLibrary(repos, "first", found));
+    BOOST_CHECK(found.path == lib);
+    BOOST_CHECK(found.bundled);
+    BOOST_CHECK(RepositoryIndex::findLibrary(repos, "second", found));
+}
+
+BOOST_AUTO_TEST_CASE(RepositoryIndex_MissingDirectory)
+{
+    TempRepository repo;
+    BOOST_CHECK_THROW(RepositoryIndex::get((repo.path / "missing").string()), ResourceNotFoundException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+/**
+ * \file SdfEngine_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for SdfEngine class.
+ */
+
+#define BOOST_TEST_MODULE SdfEngineTest
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "iris/SdfEngine.h"
+
+using namespace std;
+using namespace iris;
+
+BOOST_AUTO_TEST_SUITE (SdfEngineTest)
+
+//! Check that a schedule fires each actor the right number of times and never underflows a buffer
+static void checkSchedule(unsigned numActors, const vector<SdfEdge>& edges, const SdfSchedule& s)
+{
+    vector<unsigned> fired(numActors, 0);
+    vector<unsigned> tokens(edges.size(), 0);
+    for(vector<SdfFiring>::const_iterator f = s.firings.begin(); f != s.firings.end(); ++f)
+    {
+        for(unsigned n = 0; n < f->count; ++n)
+        {
+            for(unsigned e = 0; e < edges.size(); ++e)
+            {
+                if(edges[e].sink == f->actor)
+                {
+                    BOOST_REQUIRE(tokens[e] >= edges[e].consumption);
+                    tokens[e] -= edges[e].consumption;
+                }
+            }
+            for(unsigned e = 0; e < edges.size(); ++e)
+            {
+                if(edges[e].source == f->actor)
+                {
+                    tokens[e] += edges[e].production;
+                    BOOST_REQUIRE(tokens[e] <= s.bufferSizes[e]);
+                }
+            }
+            fired[f->actor]++;
+        }
+    }
+    for(unsigned a = 0; a < numActors; ++a)
+        BOOST_CHECK_EQUAL(fired[a], s.repetitions[a]);
+    for(unsigned e = 0; e < edges.size(); ++e)
+        BOOST_CHECK_EQUAL(tokens[e], 0u);
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineBasic)
+{
+    SdfEngine theSdfEngine("MyEngine", ".");
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineSingleRate)
+{
+    vector<SdfEdge> edges;
+    edges.push_back(SdfEdge(0, 1));
+    edges.push_back(SdfEdge(1, 2));
+    SdfSchedule s = SdfEngine::computeSchedule(3, edges);
+
+    BOOST_CHECK_EQUAL(s.repetitions[0], 1u);
+    BOOST_CHECK_EQUAL(s.repetitions[1], 1u);
+    BOOST_CHECK_EQUAL(s.repetitions[2], 1u);
+    BOOST_CHECK_EQUAL(s.bufferSizes[0], 1u);
+    BOOST_CHECK_EQUAL(s.bufferSizes[1], 1u);
+    BOOST_REQUIRE_EQUAL(s.firings.size(), 3u);
+    checkSchedule(3, edges, s);
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineMultiRate)
+{
+    // Source -> 1:3 interpolator -> 2:1 decimator -> sink
+    vector<SdfEdge> edges;
+    edges.push_back(SdfEdge(0, 1, 1, 1));
+    edges.push_back(SdfEdge(1, 2, 3, 2));
+    edges.push_back(SdfEdge(2, 3, 1, 1));
+    SdfSchedule s = SdfEngine::computeSchedule(4, edges);
+
+    BOOST_CHECK_EQUAL(s.repetitions[0], 2u);
+    BOOST_CHECK_EQUAL(s.repetitions[1], 2u);
+    BOOST_CHECK_EQUAL(s.repetitions[2], 3u);
+    BOOST_CHECK_EQUAL(s.repetitions[3], 3u);
+    BOOST_CHECK_EQUAL(s.bufferSizes[0], 1u);
+    BOOST_CHECK_EQUAL(s.bufferSizes[1], 4u);
+    BOOST_CHECK_EQUAL(s.bufferSizes[2], 1u);
+    checkSchedule(4, edges, s);
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineFork)
+{
+    // A splitter feeding two branches which are merged again
+    vector<SdfEdge> edges;
+    edges.push_back(SdfEdge(0, 1, 2, 1));
+    edges.push_back(SdfEdge(0, 2, 1, 1));
+    edges.push_back(SdfEdge(1, 3, 1, 2));
+    edges.push_back(SdfEdge(2, 3, 1, 1));
+    SdfSchedule s = SdfEngine::computeSchedule(4, edges);
+
+    BOOST_CHECK_EQUAL(s.repetitions[0], 1u);
+    BOOST_CHECK_EQUAL(s.repetitions[1], 2u);
+    BOOST_CHECK_EQUAL(s.repetitions[2], 1u);
+    BOOST_CHECK_EQUAL(s.repetitions[3], 1u);
+    checkSchedule(4, edges, s);
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineInconsistent)
+{
+    vector<SdfEdge> edges;
+    edges.push_back(SdfEdge(0, 1, 2, 1));
+    edges.push_back(SdfEdge(0, 2, 1, 1));
+    edges.push_back(SdfEdge(1, 3, 1, 1));
+    edges.push_back(SdfEdge(2, 3, 1, 1));
+    BOOST_CHECK_THROW(SdfEngine::computeSchedule(4, edges), GraphStructureErrorException);
+}
+
+BOOST_AUTO_TEST_CASE(SdfEngineCycle)
+{
+    vector<SdfEdge> edges;
+    edges.push_back(SdfEdge(0, 1));
+    edges.push_back(SdfEdge(1, 0));
+    BOOST_CHECK_THROW(SdfEngine::computeSchedule(2, edges), GraphStructureErrorException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -34,17 +34,32 @@
 #define BOOST_TEST_MODULE SharedLibraryTest
 
 #include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include "boost/filesystem.hpp"
 #include <iostream>
 
 #include "iris/SharedLibrary.h"
+#include "irisapi/PhyComponent.h"
+#include "irisapi/ComponentBundle.h"
 #include "config_tests.h"
 
 using namespace std;
 using namespace iris;
 namespace bfs=boost::filesystem;
+namespace bpt=boost::posix_time;
 
 typedef string (*TESTFUNCTION)();
+typedef const ComponentBundleEntry<PhyComponent>* (*GETBUNDLEFUNCTION)();
+
+/// Find a library built alongside the tests
+bfs::path findTestLibrary(string name)
+{
+    name = SharedLibrary::getSystemPrefix() + name + SharedLibrary::getSystemExtension();
+    bfs::path path = bfs::path(TESTLIB_DIR) / name;
+    if(!bfs::exists(path))
+        path = bfs::path(".") / name;
+    return path;
+}
 
 BOOST_AUTO_TEST_SUITE (SharedLibraryTest)
 
@@ -86,4 +101,53 @@ BOOST_AUTO_TEST_CASE(SharedLibraryBasic)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SharedLibraryBindingModes)
+{
+    bfs::path path = findTestLibrary("testbundle");
+    BOOST_REQUIRE_MESSAGE(bfs::exists(path), "Could not find testbundle.");
+
+    const int modes[] = {
+        SharedLibrary::LOAD_DEFAULT,
+        SharedLibrary::LOAD_LAZY,
+        SharedLibrary::LOAD_LOCAL,
+        SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL,
+        SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL | SharedLibrary::LOAD_DEEPBIND
+    };
+    const char* names[] = {"now,global", "lazy,global", "now,local", "lazy,local", "lazy,local,deepbind"};
+
+    //Open and close the library in each mode and report the load times
+    const int iterations = 200;
+    for(int m = 0; m < 5; ++m)
+    {
+        bpt::ptime start = bpt::microsec_clock::local_time();
+        for(int i = 0; i < iterations; ++i)
+        {
+            SharedLibrary lib(path, modes[m]);
+            BOOST_REQUIRE(lib.getSymbol("GetComponentBundle") != NULL);
+        }
+        bpt::time_duration taken = bpt::microsec_clock::local_time() - start;
+        BOOST_TEST_MESSAGE("Loading testbundle " << iterations << " times with " << names[m] << ": " << taken);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SharedLibraryBundle)
+{
+    bfs::path path = findTestLibrary("testbundle");
+    BOOST_REQUIRE_MESSAGE(bfs::exists(path), "Could not find testbundle.");
+
+    SharedLibrary lib(path, SharedLibrary::LOAD_LAZY | SharedLibrary::LOAD_LOCAL);
+    GETBUNDLEFUNCTION getBundle = (GETBUNDLEFUNCTION)lib.getSymbol("GetComponentBundle");
+    BOOST_CHECK_THROW(lib.getSymbol("CreateComponent"), LibrarySymbolException);
+
+    const ComponentBundleEntry<PhyComponent>* entry = findBundledComponent(getBundle(), "Second");
+    BOOST_REQUIRE(entry != NULL);
+    PhyComponent* comp = entry->create("comp1");
+    BOOST_CHECK_EQUAL(comp->getName(), "comp1");
+    BOOST_CHECK_EQUAL(comp->getType(), "second");
+    entry->release(comp);
+
+    BOOST_CHECK(findBundledComponent(getBundle(), "first") != NULL);
+    BOOST_CHECK(findBundledComponent(getBundle(), "third") == NULL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
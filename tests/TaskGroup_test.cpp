@@ -0,0 +1,138 @@
+/**
+ * \file TaskGroup_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for TaskGroup class.
+ */
+
+#define BOOST_TEST_MODULE TaskGroupTest
+
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <vector>
+
+#include "iris/TaskGroup.h"
+#include "irisapi/Exceptions.h"
+
+using namespace std;
+using namespace iris;
+namespace b = boost;
+
+void square(int in, int& out)
+{
+    out = in * in;
+}
+
+void waitFor(b::barrier& barrier, bool& done)
+{
+    //Only returns if all tasks are running at the same time
+    barrier.wait();
+    done = true;
+}
+
+void recordThread(b::thread::id& id)
+{
+    id = b::this_thread::get_id();
+}
+
+void fail(int i)
+{
+    if(i == 3)
+        throw ResourceNotFoundException("Task 3 failed");
+    if(i == 5)
+        throw InvalidDataException("Task 5 failed");
+}
+
+BOOST_AUTO_TEST_SUITE (TaskGroupTest)
+
+BOOST_AUTO_TEST_CASE(TaskGroupResults)
+{
+    //Results are stored by task, whatever order the tasks run in
+    vector<int> results(100);
+    TaskGroup group(4);
+    for(int i = 0; i < 100; ++i)
+        group.add(b::bind(&square, i, b::ref(results[i])));
+    BOOST_CHECK_EQUAL(group.size(), 100u);
+    group.run();
+    for(int i = 0; i < 100; ++i)
+        BOOST_CHECK_EQUAL(results[i], i * i);
+}
+
+BOOST_AUTO_TEST_CASE(TaskGroupConcurrent)
+{
+    //Four tasks waiting on a barrier can only finish if they run concurrently
+    b::barrier barrier(4);
+    bool done[4] = {false, false, false, false};
+    TaskGroup group(4);
+    for(int i = 0; i < 4; ++i)
+        group.add(b::bind(&waitFor, b::ref(barrier), b::ref(done[i])));
+    group.run();
+    for(int i = 0; i < 4; ++i)
+        BOOST_CHECK(done[i]);
+}
+
+BOOST_AUTO_TEST_CASE(TaskGroupSingleThread)
+{
+    //With one thread, tasks run in the calling thread
+    b::thread::id ids[3];
+    TaskGroup group(1);
+    for(int i = 0; i < 3; ++i)
+        group.add(b::bind(&recordThread, b::ref(ids[i])));
+    group.run();
+    for(int i = 0; i < 3; ++i)
+        BOOST_CHECK(ids[i] == b::this_thread::get_id());
+
+    //The default can be changed
+    TaskGroup::setDefaultThreads(2);
+    BOOST_CHECK_EQUAL(TaskGroup().getMaxThreads(), 2u);
+    TaskGroup::setDefaultThreads(0);
+    BOOST_CHECK(TaskGroup().getMaxThreads() >= 1u);
+}
+
+BOOST_AUTO_TEST_CASE(TaskGroupExceptions)
+{
+    //The exception of the first failed task is rethrown with its type
+    vector<int> results(8);
+    TaskGroup group(4);
+    for(int i = 0; i < 8; ++i)
+    {
+        group.add(b::bind(&fail, i));
+        group.add(b::bind(&square, i, b::ref(results[i])));
+    }
+    BOOST_CHECK_THROW(group.run(), ResourceNotFoundException);
+
+    //All other tasks still ran
+    for(int i = 0; i < 8; ++i)
+        BOOST_CHECK_EQUAL(results[i], i * i);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+ /**
+ * \file TestBundle.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * A component bundle used by SharedLibrary_test.cpp and PhyEngine_test.cpp.
+ */
+
+#include <map>
+#include <string>
+#include "irisapi/PhyComponent.h"
+#include "irisapi/ComponentBundle.h"
+
+namespace iris
+{
+
+/// A component which does nothing, for testing bundles
+class BundledComponent
+  : public PhyComponent
+{
+public:
+  BundledComponent(std::string name, std::string type)
+    : PhyComponent(name, type, "A component in a test bundle", "Iris", "1.0")
+  {
+    registerParameter("gain", "A parameter to reconfigure", "1", true, gain_);
+  }
+  virtual void calculateOutputTypes(std::map<std::string, int>& inputTypes,
+                                    std::map<std::string, int>& outputTypes) {}
+  virtual void registerPorts() {}
+  virtual void initialize() {}
+  virtual void process() {}
+private:
+  float gain_;
+};
+
+class FirstComponent : public BundledComponent
+{
+public:
+  FirstComponent(std::string name) : BundledComponent(name, "first") {}
+};
+
+class SecondComponent : public BundledComponent
+{
+public:
+  SecondComponent(std::string name) : BundledComponent(name, "second") {}
+};
+
+} /* namespace iris */
+
+IRIS_COMPONENT_BUNDLE_BEGIN(iris::PhyComponent)
+  IRIS_BUNDLE_COMPONENT(first, iris::FirstComponent)
+  IRIS_BUNDLE_COMPONENT(second, iris::SecondComponent)
+IRIS_COMPONENT_BUNDLE_END()
@@ -82,6 +82,12 @@ public:
      registerEvent("testevent", "a simple event for testing", TypeInfo<uint32_t>::identifier);
   }
 
+  /// Change a parameter the way a running component would
+  void changeRange(float r)
+  {
+    x_range = r;
+  }
+
   void testEvents()
   {
     uint32_t x = 0;
@@ -0,0 +1,211 @@
+/**
+ * \file TimerWheel_test.cpp
+ * \version 1.0
+ *
+ * \section COPYRIGHT
+ *
+ * Copyright 2012-2013 The Iris Project Developers. See the
+ * COPYRIGHT file at the top-level directory of this distribution
+ * and at http://www.softwareradiosystems.com/iris/copyright.html.
+ *
+ * \section LICENSE
+ *
+ * This file is part of the Iris Project.
+ *
+ * Iris is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * Iris is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * A copy of the GNU Lesser General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ * \section DESCRIPTION
+ *
+ * Main test file for TimerWheel class
+ */
+
+#define BOOST_TEST_MODULE TimerWheel_Test
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "irisapi/Logging.h"
+#include "irisapi/TimerWheel.h"
+
+using namespace std;
+using namespace iris;
+namespace bpt = boost::posix_time;
+
+BOOST_AUTO_TEST_SUITE (TimerWheel_Test)
+
+//! getName function is used for logging
+std::string getName()
+{
+    return "TimerWheel_Test";
+}
+
+//! A listener which dispatches expired timers immediately
+class TestListener : public TimerListener
+{
+public:
+    TestListener(TimerWheel& w) : wheel(w), numExpired(0) {}
+    void timerExpired(TimerId id)
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ++numExpired;
+        wheel.dispatch(id);
+    }
+    TimerWheel& wheel;
+    int numExpired;
+    boost::mutex mutex;
+};
+
+//! Record that a timer fired
+static void record(vector<int>* fired, int value)
+{
+    fired->push_back(value);
+}
+
+BOOST_AUTO_TEST_CASE(TimerWheel_Expiry_Test)
+{
+    TimerWheel wheel(bpt::milliseconds(1));
+    TestListener listener(wheel);
+    vector<int> fired;
+
+    wheel.schedule(&listener, bpt::milliseconds(3), boost::bind(&record, &fired, 3));
+    wheel.schedule(&listener, bpt::milliseconds(1), boost::bind(&record, &fired, 1));
+    wheel.schedule(&listener, bpt::microseconds(1500), boost::bind(&record, &fired, 2));
+    BOOST_CHECK_EQUAL(wheel.size(), 3u);
+
+    wheel.advance(1);
+    BOOST_REQUIRE_EQUAL(fired.size(), 1u);
+    BOOST_CHECK_EQUAL(fired[0], 1);
+
+    wheel.advance(1);
+    BOOST_REQUIRE_EQUAL(fired.size(), 2u);
+    BOOST_CHECK_EQUAL(fired[1], 2);
+
+    wheel.advance(1);
+    BOOST_REQUIRE_EQUAL(fired.size(), 3u);
+    BOOST_CHECK_EQUAL(fired[2], 3);
+    BOOST_CHECK_EQUAL(wheel.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TimerWheel_Cascade_Test)
+{
+    TimerWheel wheel(bpt::milliseconds(1));
+    TestListener listener(wheel);
+    vector<int> fired;
+
+    // Delays which fall into each of the outer wheels
+    int delays[] = {255, 256, 257, 1000, 65535, 65536, 70000, 17000000};
+    int numDelays = sizeof(delays)/sizeof(delays[0]);
+    for(int i = 0; i < numDelays; ++i)
+        wheel.schedule(&listener, bpt::milliseconds(delays[i]), boost::bind(&record, &fired, delays[i]));
+
+    // Advance one tick at a time and check each timer fires exactly on time
+    int expected = 0;
+    for(int tick = 1; tick <= 70000; ++tick)
+    {
+        wheel.advance(1);
+        if(expected < numDelays && delays[expected] == tick)
+        {
+            BOOST_REQUIRE_EQUAL(fired.size(), size_t(expected + 1));
+            BOOST_CHECK_EQUAL(fired.back(), tick);
+            ++expected;
+        }
+        BOOST_REQUIRE_EQUAL(fired.size(), size_t(expected));
+    }
+
+    // The last timer is in the outermost wheel
+    wheel.advance(17000000 - 70000 - 1);
+    BOOST_CHECK_EQUAL(fired.size(), size_t(numDelays - 1));
+    wheel.advance(1);
+    BOOST_REQUIRE_EQUAL(fired.size(), size_t(numDelays));
+    BOOST_CHECK_EQUAL(fired.back(), 17000000);
+}
+
+BOOST_AUTO_TEST_CASE(TimerWheel_Cancel_Test)
+{
+    TimerWheel wheel(bpt::milliseconds(1));
+    TestListener listener(wheel);
+    vector<int> fired;
+
+    TimerId a = wheel.schedule(&listener, bpt::milliseconds(5), boost::bind(&record, &fired, 1));
+    TimerId b = wheel.schedule(&listener, bpt::milliseconds(5), boost::bind(&record, &fired, 2));
+    TimerId c = wheel.schedule(&listener, bpt::milliseconds(500), boost::bind(&record, &fired, 3));
+
+    BOOST_CHECK(wheel.cancel(a));
+    BOOST_CHECK(!wheel.cancel(a));
+    BOOST_CHECK(wheel.cancel(c));
+    BOOST_CHECK_EQUAL(wheel.size(), 1u);
+
+    wheel.advance(1000);
+    BOOST_REQUIRE_EQUAL(fired.size(), 1u);
+    BOOST_CHECK_EQUAL(fired[0], 2);
+    BOOST_CHECK(!wheel.cancel(b));
+
+    // Ids of released nodes must not match reused nodes
+    TimerId d = wheel.schedule(&listener, bpt::milliseconds(5), boost::bind(&record, &fired, 4));
+    BOOST_CHECK(d != a && d != b && d != c);
+    BOOST_CHECK(!wheel.cancel(a));
+    BOOST_CHECK(wheel.cancel(d));
+    BOOST_CHECK_EQUAL(wheel.size(), 0u);
+}
+
+//! A listener which does not dispatch, so timers can be cancelled after expiry
+class QueueingListener : public TimerListener
+{
+public:
+    void timerExpired(TimerId id) { expired.push_back(id); }
+    vector<TimerId> expired;
+};
+
+BOOST_AUTO_TEST_CASE(TimerWheel_CancelExpired_Test)
+{
+    TimerWheel wheel(bpt::milliseconds(1));
+    QueueingListener listener;
+    vector<int> fired;
+
+    TimerId a = wheel.schedule(&listener, bpt::milliseconds(2), boost::bind(&record, &fired, 1));
+    TimerId b = wheel.schedule(&listener, bpt::milliseconds(2), boost::bind(&record, &fired, 2));
+    wheel.advance(2);
+    BOOST_REQUIRE_EQUAL(listener.expired.size(), 2u);
+
+    // Cancelling an expired timer before it is dispatched stops it running
+    BOOST_CHECK(wheel.cancel(a));
+    BOOST_CHECK(!wheel.dispatch(a));
+    BOOST_CHECK(wheel.dispatch(b));
+    BOOST_CHECK(!wheel.dispatch(b));
+    BOOST_REQUIRE_EQUAL(fired.size(), 1u);
+    BOOST_CHECK_EQUAL(fired[0], 2);
+}
+
+BOOST_AUTO_TEST_CASE(TimerWheel_Thread_Test)
+{
+    TimerWheel wheel(bpt::milliseconds(1));
+    TestListener listener(wheel);
+    vector<int> fired;
+
+    wheel.start();
+    for(int i = 0; i < 100; ++i)
+        wheel.schedule(&listener, bpt::milliseconds(10 + i), boost::bind(&record, &fired, i));
+
+    boost::this_thread::sleep(bpt::milliseconds(500));
+    wheel.stop();
+
+    BOOST_CHECK_EQUAL(listener.numExpired, 100);
+    BOOST_CHECK_EQUAL(fired.size(), 100u);
+    BOOST_CHECK_EQUAL(wheel.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -40,8 +40,10 @@
 #include <boost/thread/thread.hpp>
 #include <boost/bind.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <algorithm>
+#include <sstream>
 #include <string>
 
 #include "iris/XmlParser.h"
@@ -115,6 +117,41 @@ BOOST_AUTO_TEST_CASE(XmlParserCleanParse)
     BOOST_REQUIRE(boost::equals(xmlConfig, result));
 }
 
+BOOST_AUTO_TEST_CASE(XmlParserLinkBuffer)
+{
+    string xmlConfig("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\
+<softwareradio>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\">\
+<port name=\"output1\" class=\"output\" />\
+</component>\
+<component name=\"snk1\" class=\"sinkphycomponent\">\
+<port name=\"input1\" class=\"input\" />\
+</component>\
+</engine>\
+<link source=\"src1.output1\" sink=\"snk1.input1\" capacity=\"16\" policy=\"drop\" />\
+</softwareradio>\
+");
+
+    RadioRepresentation theRadio;
+    BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString( xmlConfig, theRadio));
+    vector<LinkDescription> links = theRadio.getLinks();
+    BOOST_REQUIRE_EQUAL(links.size(), 1u);
+    BOOST_CHECK_EQUAL(links[0].bufferCapacity, 16u);
+    BOOST_CHECK(links[0].bufferPolicy == POLICY_DROP);
+
+    //The buffer settings are written back out
+    string result;
+    BOOST_CHECK_NO_THROW(XmlParser::generateXmlString(theRadio, result));
+    BOOST_CHECK(boost::equals(xmlConfig, result));
+
+    //Invalid settings are rejected
+    string badConfig = boost::replace_all_copy(xmlConfig, "drop", "sometimes");
+    RadioRepresentation badRadio;
+    BOOST_CHECK_THROW(XmlParser::parseXmlString( badConfig, badRadio), XmlParsingException);
+}
+
 BOOST_AUTO_TEST_CASE(XmlParserDirtyParse1)
 {
     string xmlConfig("\
@@ -191,4 +228,167 @@ BOOST_AUTO_TEST_CASE(XmlParserDirtyParse2)
     BOOST_CHECK_THROW(XmlParser::parseXmlString( xmlConfig, theRadio), GraphStructureErrorException);
 }
 
+/// Selects a parser for the duration of a test
+struct UseParser
+{
+  UseParser(XmlParser::ParserType type) { XmlParser::setParserType(type); }
+  ~UseParser() { XmlParser::setParserType(XmlParser::DOM_PARSER); }
+};
+
+/// Parse a configuration with one parser, returning the regenerated xml or the error
+string parseWith(XmlParser::ParserType type, string xml)
+{
+    UseParser parser(type);
+    RadioRepresentation theRadio;
+    try
+    {
+        XmlParser::parseXmlString(xml, theRadio);
+    }
+    catch(XmlParsingException& ex)
+    {
+        return string("XmlParsingException: ") + ex.what();
+    }
+    catch(GraphStructureErrorException& ex)
+    {
+        return string("GraphStructureErrorException: ") + ex.what();
+    }
+    string result;
+    XmlParser::generateXmlString(theRadio, result);
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(XmlParserStreamingParse)
+{
+    string xmlConfig("\
+<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n\
+<!-- A test radio -->\n\
+<softwareradio>\n\
+  <controller class=\"TestController\">\n\
+    <parameter name=\"testparam\" value=\"a &amp; b &#65;\" />\n\
+  </controller>\n\
+  <engine name=\"phyengine1\" class=\"phyengine\">\n\
+    <component name=\"src1\" class='sourcephycomponent'>\n\
+      <port name=\"output1\" class=\"output\"/>\n\
+    </component>\n\
+    <component name=\"snk1\" class=\"sinkphycomponent\">\n\
+      <parameter name=\"x\" value=\"1\"><ignored/></parameter>\n\
+      <port name=\"input1\" class=\"input\" />\n\
+    </component>\n\
+  </engine>\n\
+  <link source=\"src1.output1\" sink=\"snk1.input1\" capacity=\"16\" policy=\"Drop\" />\n\
+</softwareradio>\n\
+");
+
+    //Both parsers produce the same radio
+    string dom = parseWith(XmlParser::DOM_PARSER, xmlConfig);
+    string streaming = parseWith(XmlParser::STREAMING_PARSER, xmlConfig);
+    BOOST_CHECK(boost::starts_with(dom, "<?xml"));
+    BOOST_CHECK_EQUAL(dom, streaming);
+
+    UseParser parser(XmlParser::STREAMING_PARSER);
+    RadioRepresentation theRadio;
+    BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString(xmlConfig, theRadio));
+    BOOST_CHECK_EQUAL(theRadio.getControllers()[0].parameters[0].value, "a & b a");
+    BOOST_CHECK_EQUAL(theRadio.getLinks()[0].bufferCapacity, 16u);
+    BOOST_CHECK(theRadio.getLinks()[0].bufferPolicy == POLICY_DROP);
+}
+
+BOOST_AUTO_TEST_CASE(XmlParserStreamingErrors)
+{
+    string head("<?xml version=\"1.0\" ?><softwareradio>\
+<engine name=\"phyengine1\" class=\"phyengine\">\
+<component name=\"src1\" class=\"sourcephycomponent\"><port name=\"output1\" class=\"output\" /></component>\
+<component name=\"snk1\" class=\"sinkphycomponent\"><port name=\"input1\" class=\"input\" /></component>\
+</engine>");
+    string link("<link source=\"src1.output1\" sink=\"snk1.input1\" />");
+
+    //Configurations which are rejected for the same reason by both parsers
+    vector<string> configs;
+    configs.push_back(head + link + "<other />" + "</softwareradio>");
+    configs.push_back(head + "<controller class=\"c\"><port /></controller>" + link + "</softwareradio>");
+    configs.push_back(boost::replace_all_copy(head, "<port name=\"input1\"", "<link name=\"input1\"") + link + "</softwareradio>");
+    configs.push_back(boost::replace_all_copy(head, "</engine>", "<link /></engine>") + link + "</softwareradio>");
+    configs.push_back(head + "<link source=\"src1.output1\" sink=\"snk1.input1\"><port /></link></softwareradio>");
+    configs.push_back(head + "<link source=\"src1.output1\" sink=\"snk1.input1\" capacity=\"lots\" /></softwareradio>");
+    configs.push_back(head + "<link source=\"src1.output1\" sink=\"snk1.input1\" policy=\"sometimes\" /></softwareradio>");
+    configs.push_back(head + "<link source=\"src1.output1\" sink=\"snk3.input1\" /></softwareradio>");
+    configs.push_back(boost::replace_all_copy(head, "<softwareradio>", "<hardwareradio>") + link + "</hardwareradio>");
+    for(size_t i = 0; i < configs.size(); ++i)
+    {
+        string dom = parseWith(XmlParser::DOM_PARSER, configs[i]);
+        string streaming = parseWith(XmlParser::STREAMING_PARSER, configs[i]);
+        BOOST_TEST_MESSAGE("Config " << i << ": " << dom);
+        BOOST_CHECK(boost::contains(dom, "Exception"));
+        BOOST_CHECK_EQUAL(dom, streaming);
+    }
+
+    //Malformed xml is reported with its position
+    string unclosed = head + link + "</softwareradi>";
+    BOOST_CHECK(boost::starts_with(parseWith(XmlParser::DOM_PARSER, unclosed), "XmlParsingException"));
+    string streaming = parseWith(XmlParser::STREAMING_PARSER, unclosed);
+    BOOST_CHECK(boost::starts_with(streaming, "XmlParsingException: Error parsing xml. Description: Error reading end tag."));
+    BOOST_CHECK(boost::contains(streaming, "Line: 1"));
+
+    vector<string> malformed;
+    malformed.push_back("");
+    malformed.push_back(head);
+    malformed.push_back(head + "<link source=\"src1.output1 />");
+    malformed.push_back(head + "<!-- unclosed comment");
+    malformed.push_back(head + "<link source=src1.output1 /></softwareradio>");
+    for(size_t i = 0; i < malformed.size(); ++i)
+    {
+        BOOST_CHECK(boost::starts_with(parseWith(XmlParser::STREAMING_PARSER, malformed[i]), "XmlParsingException"));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(XmlParserStreamingBenchmark)
+{
+    //Compare parse times for a large generated configuration
+    stringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n<softwareradio>\n";
+    const int numEngines = 4;
+    const int numComponents = 1000;
+    for(int e = 0; e < numEngines; ++e)
+    {
+        xml << "<engine name=\"phyengine" << e << "\" class=\"phyengine\">\n";
+        for(int i = 0; i < numComponents; ++i)
+        {
+            xml << "  <component name=\"comp" << e << "_" << i << "\" class=\"testphycomponent\">\n";
+            xml << "    <parameter name=\"p1\" value=\"" << i << "\" />\n";
+            xml << "    <parameter name=\"p2\" value=\"somevalue\" />\n";
+            xml << "    <port name=\"input1\" class=\"input\" />\n";
+            xml << "    <port name=\"output1\" class=\"output\" />\n";
+            xml << "  </component>\n";
+        }
+        xml << "</engine>\n";
+    }
+    for(int e = 0; e < numEngines; ++e)
+        for(int i = 1; i < numComponents; ++i)
+            xml << "<link source=\"comp" << e << "_" << i-1 << ".output1\" sink=\"comp" << e << "_" << i << ".input1\" />\n";
+    xml << "</softwareradio>\n";
+    string config = xml.str();
+
+    //Keep logging out of the measurement
+    LogLevel level = LoggingPolicy::getPolicyInstance()->ReportingLevel();
+    LoggingPolicy::getPolicyInstance()->ReportingLevel() = LWARNING;
+
+    boost::posix_time::time_duration times[2];
+    string results[2];
+    XmlParser::ParserType types[2] = {XmlParser::DOM_PARSER, XmlParser::STREAMING_PARSER};
+    for(int t = 0; t < 2; ++t)
+    {
+        UseParser parser(types[t]);
+        RadioRepresentation theRadio;
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        BOOST_REQUIRE_NO_THROW(XmlParser::parseXmlString(config, theRadio));
+        times[t] = boost::posix_time::microsec_clock::universal_time() - start;
+        XmlParser::generateXmlString(theRadio, results[t]);
+    }
+    LoggingPolicy::getPolicyInstance()->ReportingLevel() = level;
+
+    BOOST_CHECK(results[0] == results[1]);
+    BOOST_TEST_MESSAGE("Parsed " << numEngines * numComponents << " components - dom: " << times[0]
+                       << ", streaming: " << times[1]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()